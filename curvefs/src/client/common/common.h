@@ -61,6 +61,7 @@ enum class MetaServerOpType {
     UpdateVolumeExtent,
     CreateManageInode,
     UpdateDeallocatableBlockGroup,
+    BatchUpdateInodeAttr,
 };
 
 std::ostream &operator<<(std::ostream &os, MetaServerOpType optype);
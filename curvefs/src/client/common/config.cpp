@@ -132,6 +132,19 @@ void InitMetaCacheOption(Configuration *conf, MetaCacheOpt *opts) {
                               &opts->metacacheRPCRetryIntervalUS);
     conf->GetValueFatalIfFail("metaCacheOpt.metacacheGetLeaderRPCTimeOutMS",
                               &opts->metacacheGetLeaderRPCTimeOutMS);
+    LOG_IF(WARNING, !conf->GetBoolValue("metaCacheOpt.backgroundRefreshLeader",
+                                        &opts->backgroundRefreshLeader))
+        << "Not found `metaCacheOpt.backgroundRefreshLeader` in conf, use "
+           "default value `" << opts->backgroundRefreshLeader << '`';
+    LOG_IF(WARNING,
+           !conf->GetUInt32Value(
+               "metaCacheOpt.backgroundRefreshLeaderIntervalMS",
+               &opts->backgroundRefreshLeaderIntervalMS))
+        << "Not found `metaCacheOpt.backgroundRefreshLeaderIntervalMS` in "
+           "conf, use default value `"
+        << opts->backgroundRefreshLeaderIntervalMS << '`';
+    conf->GetValueFatalIfFail("metaCacheOpt.refreshPartitionIntervalSec",
+                              &opts->refreshPartitionIntervalSec);
 }
 
 void InitExcutorOption(Configuration *conf, ExcutorOpt *opts, bool internal) {
@@ -157,6 +170,8 @@ void InitExcutorOption(Configuration *conf, ExcutorOpt *opts, bool internal) {
                               &opts->maxRetryTimesBeforeConsiderSuspend);
     conf->GetValueFatalIfFail("executorOpt.batchInodeAttrLimit",
                               &opts->batchInodeAttrLimit);
+    conf->GetValueFatalIfFail("executorOpt.enableFollowerRead",
+                              &opts->enableFollowerRead);
     conf->GetValueFatalIfFail("fuseClient.enableMultiMountPointRename",
                               &opts->enableRenameParallel);
 }
@@ -227,6 +242,18 @@ void InitS3Option(Configuration *conf, S3Option *s3Opt) {
                               &s3Opt->s3ClientAdaptorOpt.readCacheMaxByte);
     conf->GetValueFatalIfFail("s3.readCacheThreads",
                               &s3Opt->s3ClientAdaptorOpt.readCacheThreads);
+    std::string readCacheCpus;
+    if (conf->GetStringValue("s3.readCacheCpuAffinity", &readCacheCpus)) {
+        std::vector<std::string> cpus;
+        curve::common::SplitString(readCacheCpus, ",", &cpus);
+        for (const auto& cpu : cpus) {
+            int32_t id = 0;
+            LOG_IF(FATAL, !curve::common::StringToInt(cpu, &id) || id < 0)
+                << "Invalid cpu `" << cpu
+                << "` in s3.readCacheCpuAffinity: " << readCacheCpus;
+            s3Opt->s3ClientAdaptorOpt.readCacheCpuAffinity.push_back(id);
+        }
+    }
     conf->GetValueFatalIfFail("s3.nearfullRatio",
                               &s3Opt->s3ClientAdaptorOpt.nearfullRatio);
     conf->GetValueFatalIfFail("s3.baseSleepUs",
@@ -251,6 +278,18 @@ void InitVolumeOption(Configuration *conf, VolumeOption *volumeOpt) {
                               &volumeOpt->threshold);
     conf->GetValueFatalIfFail("volume.space.releaseInterSec",
                               &volumeOpt->releaseInterSec);
+    LOG_IF(WARNING, !conf->GetUInt32Value("volume.space.reservedBlockGroups",
+                                          &volumeOpt->reservedBlockGroups))
+        << "Not found `volume.space.reservedBlockGroups` in conf, use default "
+           "value `" << volumeOpt->reservedBlockGroups << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("volume.space.refillRetryIntervalMs",
+                                          &volumeOpt->refillRetryIntervalMs))
+        << "Not found `volume.space.refillRetryIntervalMs` in conf, use "
+           "default value `" << volumeOpt->refillRetryIntervalMs << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("volume.space.bitmapSyncThreads",
+                                          &volumeOpt->bitmapSyncThreads))
+        << "Not found `volume.space.bitmapSyncThreads` in conf, use default "
+           "value `" << volumeOpt->bitmapSyncThreads << '`';
 
     conf->GetValueFatalIfFail(
         "volume.blockGroup.allocateOnce",
@@ -273,6 +312,15 @@ void InitExtentManagerOption(Configuration *conf,
                              ExtentManagerOption *extentManagerOpt) {
     conf->GetValueFatalIfFail("extentManager.preAllocSize",
                               &extentManagerOpt->preAllocSize);
+    LOG_IF(WARNING,
+           !conf->GetUInt64Value("extentManager.appendPreAllocSize",
+                                 &extentManagerOpt->appendPreAllocSize))
+        << "Not found `extentManager.appendPreAllocSize` in conf, use default "
+           "value `" << extentManagerOpt->appendPreAllocSize << '`';
+    LOG_IF(WARNING, !conf->GetBoolValue("extentManager.deltaFlush",
+                                        &extentManagerOpt->deltaFlush))
+        << "Not found `extentManager.deltaFlush` in conf, use default value `"
+        << extentManagerOpt->deltaFlush << '`';
 }
 
 void InitLeaseOpt(Configuration *conf, LeaseOpt *leaseOpt) {
@@ -287,6 +335,8 @@ void InitRefreshDataOpt(Configuration *conf,
                               &opt->maxDataSize);
     conf->GetValueFatalIfFail("fuseClient.refreshDataIntervalSec",
                               &opt->refreshDataIntervalSec);
+    conf->GetValueFatalIfFail("fuseClient.lazyLoadS3ChunkInfo",
+                              &opt->lazyLoadS3ChunkInfo);
 }
 
 void InitKVClientManagerOpt(Configuration *conf,
@@ -297,6 +347,8 @@ void InitKVClientManagerOpt(Configuration *conf,
                               &config->setThreadPooln);
     conf->GetValueFatalIfFail("fuseClient.getThreadPool",
                               &config->getThreadPooln);
+    conf->GetValueFatalIfFail("fuseClient.kvMaxConnections",
+                              &config->maxConnections);
 }
 
 void InitFileSystemOption(Configuration* c, FileSystemOption* option) {
@@ -340,11 +392,14 @@ void InitFileSystemOption(Configuration* c, FileSystemOption* option) {
     {  // rpc option
         auto o = &option->rpcOption;
         c->GetValueFatalIfFail("fs.rpc.listDentryLimit", &o->listDentryLimit);
+        c->GetValueFatalIfFail("fs.rpc.streamListDentry",
+                               &o->streamListDentry);
     }
     {  // defer sync option
         auto o = &option->deferSyncOption;
         c->GetValueFatalIfFail("fs.deferSync.delay", &o->delay);
         c->GetValueFatalIfFail("fs.deferSync.deferDirMtime", &o->deferDirMtime);
+        c->GetValueFatalIfFail("fs.deferSync.batchSync", &o->batchSync);
     }
 }
 
@@ -382,6 +437,10 @@ void InitFuseClientOption(Configuration *conf, FuseClientOption *clientOption) {
                               &clientOption->downloadMaxRetryTimes);
     conf->GetValueFatalIfFail("fuseClient.warmupThreadsNum",
                               &clientOption->warmupThreadsNum);
+    conf->GetValueFatalIfFail("fuseClient.warmupMaxInflightObjects",
+                              &clientOption->warmupMaxInflightObjects);
+    conf->GetValueFatalIfFail("fuseClient.warmupBandwidthBytes",
+                              &clientOption->warmupBandwidthBytes);
     LOG_IF(WARNING, conf->GetBoolValue("fuseClient.enableSplice",
                                        &clientOption->enableFuseSplice))
         << "Not found `fuseClient.enableSplice` in conf, use default value `"
@@ -25,6 +25,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "curvefs/src/client/common/common.h"
 #include "curvefs/proto/common.pb.h"
@@ -52,6 +53,16 @@ struct MetaCacheOpt {
 
     uint16_t getPartitionCountOnce = 3;
     uint16_t createPartitionOnce = 3;
+
+    // refresh the leaders of all copysets in background
+    // once a leader change is found
+    bool backgroundRefreshLeader = false;
+    uint32_t backgroundRefreshLeaderIntervalMS = 1000;
+
+    // list partitions from mds again after this interval when selecting
+    // partition for new inode, so that partitions split by mds are used,
+    // 0 means never
+    uint32_t refreshPartitionIntervalSec = 0;
 };
 
 struct ExcutorOpt {
@@ -65,6 +76,8 @@ struct ExcutorOpt {
     uint64_t maxRetryTimesBeforeConsiderSuspend = 20;
     uint32_t batchInodeAttrLimit = 10000;
     bool enableRenameParallel = false;
+    // send readonly requests to a random replica instead of leader
+    bool enableFollowerRead = false;
 };
 
 struct LeaseOpt {
@@ -76,6 +89,8 @@ struct LeaseOpt {
 struct KVClientManagerOpt {
     int setThreadPooln = 4;
     int getThreadPooln = 4;
+    // max connections to each memcached server, 0 means no limit
+    uint32_t maxConnections = 64;
 };
 
 struct DiskCacheOption {
@@ -128,6 +143,9 @@ struct S3ClientAdaptorOption {
     uint64_t writeCacheMaxByte;
     uint64_t readCacheMaxByte;
     uint32_t readCacheThreads;
+    // cpus that read cache threads are pinned to in turn, empty means they
+    // aren't pinned
+    std::vector<int> readCacheCpuAffinity;
     uint32_t nearfullRatio;
     uint32_t baseSleepUs;
     uint32_t maxReadRetryIntervalMs;
@@ -164,15 +182,25 @@ struct VolumeOption {
 
     double threshold{1.0};
     uint64_t releaseInterSec{300};
+    uint32_t reservedBlockGroups{0};
+    uint32_t refillRetryIntervalMs{1000};
+    uint32_t bitmapSyncThreads{4};
 };
 
 struct ExtentManagerOption {
     uint64_t preAllocSize;
+    // preallocation size for sequential writes
+    uint64_t appendPreAllocSize{4ULL * 1024 * 1024};
+    // flush changed extents only, requires all metaservers are upgraded
+    bool deltaFlush{false};
 };
 
 struct RefreshDataOption {
     uint64_t maxDataSize = 1024;
     uint32_t refreshDataIntervalSec = 30;
+    // only fetch inode attributes when getting s3 inode, s3chunkinfo lists
+    // are loaded per chunk index on demand
+    bool lazyLoadS3ChunkInfo = false;
 };
 
 // { filesystem option
@@ -205,11 +233,14 @@ struct OpenFilesOption {
 
 struct RPCOption {
     uint32_t listDentryLimit;
+    // list large directory in one rpc with remaining entries sent by stream
+    bool streamListDentry;
 };
 
 struct DeferSyncOption {
     uint32_t delay;
     bool deferDirMtime;
+    bool batchSync;
 };
 
 struct FileSystemOption {
@@ -248,6 +279,10 @@ struct FuseClientOption {
     bool enableFuseSplice = false;
     uint32_t downloadMaxRetryTimes;
     uint32_t warmupThreadsNum = 10;
+    // max objects being downloaded by warmup at the same time, 0 = unlimited
+    uint32_t warmupMaxInflightObjects = 64;
+    // max bytes per second downloaded by warmup, 0 = unlimited
+    uint64_t warmupBandwidthBytes = 0;
 };
 
 void InitFuseClientOption(Configuration *conf, FuseClientOption *clientOption);
@@ -111,6 +111,29 @@ CURVEFS_ERROR DentryCacheManagerImpl::ListDentry(uint64_t parent,
     MetaStatusCode ret = MetaStatusCode::OK;
     bool perceed = true;
     std::string last = "";
+    if (streamListDentry_ && !onlyDir && limit > 0) {
+        bool streamed = false;
+        ret = metaClient_->StreamListDentry(fsId_, parent, last, limit,
+                                            dentryList, &streamed);
+        VLOG(6) << "StreamListDentry fsId = " << fsId_
+                << ", parent = " << parent << ", count = " << limit
+                << ", ret = " << ret << ", streamed = " << streamed
+                << ", size = " << dentryList->size();
+        if (ret != MetaStatusCode::OK) {
+            LOG(ERROR) << "metaClient_ StreamListDentry failed"
+                       << ", MetaStatusCode_Name = " << MetaStatusCode_Name(ret)
+                       << ", parent = " << parent << ", count = " << limit;
+            return ToFSError(ret);
+        }
+
+        if (streamed || dentryList->size() < limit) {
+            return CURVEFS_ERROR::OK;
+        }
+
+        // server doesn't support streaming, list the rest page by page
+        last = dentryList->back().name();
+    }
+
     do {
         std::list<Dentry> part;
         ret = metaClient_->ListDentry(fsId_, parent, last, limit, onlyDir,
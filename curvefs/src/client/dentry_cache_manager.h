@@ -50,13 +50,17 @@ static const char* kDentryKeyDelimiter = ":";
 
 class DentryCacheManager {
  public:
-    DentryCacheManager() : fsId_(0) {}
+    DentryCacheManager() : fsId_(0), streamListDentry_(false) {}
     virtual ~DentryCacheManager() {}
 
     void SetFsId(uint32_t fsId) {
         fsId_ = fsId;
     }
 
+    void SetStreamListDentry(bool enable) {
+        streamListDentry_ = enable;
+    }
+
     virtual CURVEFS_ERROR GetDentry(uint64_t parent,
         const std::string &name, Dentry *out) = 0;
 
@@ -72,6 +76,7 @@ class DentryCacheManager {
 
  protected:
     uint32_t fsId_;
+    bool streamListDentry_;
 };
 
 class DentryCacheManagerImpl : public DentryCacheManager {
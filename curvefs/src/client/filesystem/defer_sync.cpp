@@ -22,6 +22,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_set>
 
 #include "curvefs/src/client/filesystem/defer_sync.h"
 #include "curvefs/src/client/filesystem/utils.h"
@@ -30,8 +31,10 @@ namespace curvefs {
 namespace client {
 namespace filesystem {
 
-DeferSync::DeferSync(DeferSyncOption option)
+DeferSync::DeferSync(DeferSyncOption option,
+                     std::shared_ptr<MetaServerClient> metaClient)
     : option_(option),
+      metaClient_(metaClient),
       mutex_(),
       running_(false),
       thread_(),
@@ -64,15 +67,41 @@ void DeferSync::SyncTask() {
             LockGuard lk(mutex_);
             inodes.swap(inodes_);
         }
+        SyncInodes(inodes);
+        inodes.clear();
+
+        if (!running) {
+            break;
+        }
+    }
+}
+
+void DeferSync::SyncInodes(
+    const std::vector<std::shared_ptr<InodeWrapper>>& inodes) {
+    if (!option_.batchSync || metaClient_ == nullptr) {
         for (const auto& inode : inodes) {
             UniqueLock lk(inode->GetUniqueLock());
             inode->Async(nullptr, true);
         }
-        inodes.clear();
+        return;
+    }
 
-        if (!running) {
-            break;
+    // the syncing lock of inode is held until its update is sent,
+    // so the same inode can only be added into batch once
+    UpdateInodeBatch batch;
+    std::unordered_set<uint64_t> synced;
+    for (const auto& inode : inodes) {
+        if (!synced.insert(inode->GetInodeId()).second) {
+            continue;
         }
+        UniqueLock lk(inode->GetUniqueLock());
+        inode->Async(nullptr, true, &batch);
+    }
+
+    VLOG(9) << "Defer sync " << synced.size() << " inodes in batch, "
+            << batch.Size() << " of them are dirty";
+    if (!batch.Empty()) {
+        metaClient_->BatchUpdateInodeAttrAsync(&batch);
     }
 }
 
@@ -30,12 +30,15 @@
 #include "src/common/interruptible_sleeper.h"
 #include "curvefs/src/client/common/config.h"
 #include "curvefs/src/client/filesystem/meta.h"
+#include "curvefs/src/client/rpcclient/metaserver_client.h"
 
 namespace curvefs {
 namespace client {
 namespace filesystem {
 
 using ::curvefs::client::common::DeferSyncOption;
+using ::curvefs::client::rpcclient::MetaServerClient;
+using ::curvefs::client::rpcclient::UpdateInodeBatch;
 
 using ::curve::common::Mutex;
 using ::curve::common::LockGuard;
@@ -43,7 +46,10 @@ using ::curve::common::InterruptibleSleeper;
 
 class DeferSync {
  public:
-    explicit DeferSync(DeferSyncOption option);
+    // The deferred updates are sent in batch by |metaClient| if
+    // |option.batchSync| is enabled, otherwise they are sent one by one.
+    explicit DeferSync(DeferSyncOption option,
+                       std::shared_ptr<MetaServerClient> metaClient = nullptr);
 
     void Start();
 
@@ -54,8 +60,11 @@ class DeferSync {
  private:
     void SyncTask();
 
+    void SyncInodes(const std::vector<std::shared_ptr<InodeWrapper>>& inodes);
+
  private:
     DeferSyncOption option_;
+    std::shared_ptr<MetaServerClient> metaClient_;
     Mutex mutex_;
     std::atomic<bool> running_;
     std::thread thread_;
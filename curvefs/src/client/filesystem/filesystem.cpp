@@ -31,7 +31,8 @@ namespace filesystem {
 
 FileSystem::FileSystem(FileSystemOption option, ExternalMember member)
     : option_(option), member(member) {
-    deferSync_ = std::make_shared<DeferSync>(option.deferSyncOption);
+    deferSync_ = std::make_shared<DeferSync>(option.deferSyncOption,
+                                             member.metaClient);
     negative_ = std::make_shared<LookupCache>(option.lookupCacheOption);
     dirCache_ = std::make_shared<DirCache>(option.dirCacheOption);
     openFiles_ = std::make_shared<OpenFiles>(option_.openFilesOption,
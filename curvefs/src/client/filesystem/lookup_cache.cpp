@@ -44,7 +44,10 @@ LookupCache::LookupCache(LookupCacheOption option)
     : enable_(option.negativeTimeoutSec > 0),
       rwlock_(),
       option_(option) {
-    lru_ = std::make_shared<LRUType>(option.lruSize);
+    ShardedLRUCacheOption lruOption;
+    lruOption.maxCount = option.lruSize;
+    lruOption.secondChance = true;
+    lru_ = std::make_shared<LRUType>(lruOption);
     if (enable_) {
         LOG(INFO) << "Using lookup negative lru cache"
                   << ", timeout = " << option.negativeTimeoutSec
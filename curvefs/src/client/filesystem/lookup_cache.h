@@ -35,6 +35,8 @@ namespace client {
 namespace filesystem {
 
 using ::curve::common::LRUCache;
+using ::curve::common::ShardedLRUCache;
+using ::curve::common::ShardedLRUCacheOption;
 using ::curve::common::RWLock;
 using ::curve::common::ReadLockGuard;
 using ::curve::common::WriteLockGuard;
@@ -49,7 +51,10 @@ class LookupCache {
         TimeSpec expireTime;
     };
 
-    using LRUType = LRUCache<std::string, CacheEntry>;
+    // hits only mark the entry referenced instead of moving it (second
+    // chance), so Get() takes nothing but read locks and lookups run in
+    // parallel
+    using LRUType = ShardedLRUCache<std::string, CacheEntry>;
 
  public:
     explicit LookupCache(LookupCacheOption option);
@@ -36,12 +36,15 @@ namespace filesystem {
 struct ExternalMember {  // external member depended by FileSystem
     ExternalMember() = delete;
     ExternalMember(std::shared_ptr<DentryCacheManager> dentryManager,
-                   std::shared_ptr<InodeCacheManager> inodeManager)
+                   std::shared_ptr<InodeCacheManager> inodeManager,
+                   std::shared_ptr<MetaServerClient> metaClient = nullptr)
         : dentryManager(dentryManager),
-          inodeManager(inodeManager) {}
+          inodeManager(inodeManager),
+          metaClient(metaClient) {}
 
     std::shared_ptr<DentryCacheManager> dentryManager;
     std::shared_ptr<InodeCacheManager> inodeManager;
+    std::shared_ptr<MetaServerClient> metaClient;
 };
 
 }  // namespace filesystem
@@ -160,7 +160,7 @@ CURVEFS_ERROR FuseClient::Init(const FuseClientOption &option) {
     curve::client::ClientDummyServerInfo::GetInstance().SetIP(localIp);
 
     {
-        ExternalMember member(dentryManager_, inodeManager_);
+        ExternalMember member(dentryManager_, inodeManager_, metaClient_);
         fs_ = std::make_shared<FileSystem>(option_.fileSystemOption, member);
     }
 
@@ -1347,6 +1347,8 @@ FuseClient::SetMountStatus(const struct MountOption *mountOption) {
     }
     inodeManager_->SetFsId(fsInfo_->fsid());
     dentryManager_->SetFsId(fsInfo_->fsid());
+    dentryManager_->SetStreamListDentry(
+        option_.fileSystemOption.rpcOption.streamListDentry);
     enableSumInDir_.store(fsInfo_->enablesumindir());
     if (fsInfo_->has_recycletimehour()) {
         enableSumInDir_.store(enableSumInDir_.load() &&
@@ -80,7 +80,8 @@ CURVEFS_ERROR FuseS3Client::Init(const FuseClientOption &option) {
     auto fsCacheManager = std::make_shared<FsCacheManager>(
         dynamic_cast<S3ClientAdaptorImpl *>(s3Adaptor_.get()),
         opt.s3Opt.s3ClientAdaptorOpt.readCacheMaxByte, writeCacheMaxByte,
-        opt.s3Opt.s3ClientAdaptorOpt.readCacheThreads, kvClientManager_);
+        opt.s3Opt.s3ClientAdaptorOpt.readCacheThreads, kvClientManager_,
+        opt.s3Opt.s3ClientAdaptorOpt.readCacheCpuAffinity);
     if (opt.s3Opt.s3ClientAdaptorOpt.diskCacheOpt.diskCacheType !=
         DiskCacheType::Disable) {
         auto s3DiskCacheClient = std::make_shared<S3ClientImpl>();
@@ -115,7 +116,8 @@ bool FuseS3Client::InitKVCache(const KVClientManagerOpt &opt) {
     }
 
     // init kvcache client
-    auto memcacheClient = std::make_shared<MemCachedClient>();
+    auto memcacheClient =
+        std::make_shared<MemCachedClient>(opt.maxConnections);
     if (!memcacheClient->Init(kvcachecluster)) {
         LOG(ERROR) << "FLAGS_supportKVcache = " << FLAGS_supportKVcache
                    << ", but init memcache client fail";
@@ -118,6 +118,9 @@ CURVEFS_ERROR FuseVolumeClient::FuseOpInit(void *userdata,
         volOpts_.allocatorOption.bitmapAllocatorOption.smallAllocProportion;
     option.threshold = volOpts_.threshold;
     option.releaseInterSec = volOpts_.releaseInterSec;
+    option.reservedBlockGroups = volOpts_.reservedBlockGroups;
+    option.refillRetryIntervalMs = volOpts_.refillRetryIntervalMs;
+    option.bitmapSyncThreads = volOpts_.bitmapSyncThreads;
 
     spaceManager_ = absl::make_unique<SpaceManagerImpl>(option, mdsClient_,
                                                         blockDeviceClient_);
@@ -129,6 +132,8 @@ CURVEFS_ERROR FuseVolumeClient::FuseOpInit(void *userdata,
     ExtentCacheOption extentOpt;
     extentOpt.blockSize = vol.blocksize();
     extentOpt.sliceSize = vol.slicesize();
+    extentOpt.appendPreAllocSize = option_.extentManagerOpt.appendPreAllocSize;
+    extentOpt.deltaFlush = option_.extentManagerOpt.deltaFlush;
 
     ExtentCache::SetOption(extentOpt);
 
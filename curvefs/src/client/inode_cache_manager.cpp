@@ -76,6 +76,10 @@ InodeCacheManagerImpl::GetInode(uint64_t inodeId,
         return CURVEFS_ERROR::OK;
     }
 
+    if (option_.lazyLoadS3ChunkInfo) {
+        return GetInodeLazily(inodeId, out);
+    }
+
     // get inode from metaserver
     Inode inode;
     bool streaming = false;
@@ -91,6 +95,36 @@ InodeCacheManagerImpl::GetInode(uint64_t inodeId,
     return CURVEFS_ERROR::OK;
 }
 
+CURVEFS_ERROR
+InodeCacheManagerImpl::GetInodeLazily(uint64_t inodeId,
+                                      std::shared_ptr<InodeWrapper> &out) {
+    Inode inode;
+    MetaStatusCode ret =
+        metaClient_->GetInodeWithoutS3ChunkInfo(fsId_, inodeId, &inode);
+    if (ret != MetaStatusCode::OK) {
+        LOG_IF(ERROR, ret != MetaStatusCode::NOT_FOUND)
+            << "metaClient_ GetInodeWithoutS3ChunkInfo failed"
+            << ", MetaStatusCode = " << ret
+            << ", MetaStatusCode_Name = " << MetaStatusCode_Name(ret)
+            << ", inodeid = " << inodeId;
+        return ToFSError(ret);
+    }
+
+    auto type = inode.type();
+    out = std::make_shared<InodeWrapper>(
+        std::move(inode), metaClient_, s3ChunkInfoMetric_, option_.maxDataSize,
+        option_.refreshDataIntervalSec);
+
+    // s3chunkinfo will be loaded by chunk when it's being read,
+    // volume extents are still refreshed as before
+    if (type == FsFileType::TYPE_S3) {
+        out->EnableLazyLoadS3ChunkInfo();
+        return CURVEFS_ERROR::OK;
+    }
+    REFRESH_DATA_REMOTE(out, false);
+    return CURVEFS_ERROR::OK;
+}
+
 CURVEFS_ERROR InodeCacheManagerImpl::GetInodeAttr(uint64_t inodeId,
                                                   InodeAttr *out) {
     NameLockGuard lock(nameLock_, std::to_string(inodeId));
@@ -163,6 +163,10 @@ class InodeCacheManagerImpl : public InodeCacheManager,
         const std::shared_ptr<InodeWrapper> &inodeWrapper) override;
 
  private:
+    // get inode without s3chunkinfo, see RefreshDataOption
+    CURVEFS_ERROR GetInodeLazily(uint64_t inodeId,
+                                 std::shared_ptr<InodeWrapper> &out);  // NOLINT
+
     CURVEFS_ERROR RefreshData(std::shared_ptr<InodeWrapper> &inode,  // NOLINT
                               bool streaming = true);
 
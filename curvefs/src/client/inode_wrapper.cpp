@@ -221,12 +221,13 @@ CURVEFS_ERROR InodeWrapper::SyncS3ChunkInfo(bool internal) {
 }
 
 void InodeWrapper::AsyncFlushAttr(MetaServerClientDone* done,
-                                  bool /*internal*/) {
+                                  bool /*internal*/,
+                                  UpdateInodeBatch* batch) {
     if (dirty_) {
         LockSyncingInode();
-        metaClient_->UpdateInodeWithOutNlinkAsync(
-            inode_.fsid(), inode_.inodeid(), dirtyAttr_,
-            new UpdateInodeAsyncDone(shared_from_this(), done));
+        UpdateInodeWithOutNlinkAsync(
+            new UpdateInodeAsyncDone(shared_from_this(), done), DataIndices(),
+            batch);
         dirtyAttr_.Clear();
         return;
     }
@@ -285,6 +286,10 @@ void InodeWrapper::FlushVolumeExtentAsync() {
 }
 
 CURVEFS_ERROR InodeWrapper::RefreshS3ChunkInfo() {
+    if (lazyLoadS3ChunkInfo_) {
+        return ResetLazyS3ChunkInfo();
+    }
+
     curve::common::UniqueLock lock = GetSyncingS3ChunkInfoUniqueLock();
     google::protobuf::Map<
                 uint64_t, S3ChunkInfoList> s3ChunkInfoMap;
@@ -307,6 +312,69 @@ CURVEFS_ERROR InodeWrapper::RefreshS3ChunkInfo() {
     return CURVEFS_ERROR::OK;
 }
 
+CURVEFS_ERROR InodeWrapper::LoadS3ChunkInfoLocked(
+    const std::set<uint64_t>& chunkIndexes) {
+    if (!lazyLoadS3ChunkInfo_) {
+        return CURVEFS_ERROR::OK;
+    }
+
+    std::vector<uint64_t> toLoad;
+    for (const auto& chunkIndex : chunkIndexes) {
+        if (loadedChunkIndexes_.count(chunkIndex) == 0) {
+            toLoad.push_back(chunkIndex);
+        }
+    }
+    if (toLoad.empty()) {
+        return CURVEFS_ERROR::OK;
+    }
+
+    // NOTE: the pending s3chunkinfo is appended by the same request,
+    // so the lists we received are complete and replace the local ones.
+    curve::common::UniqueLock lock = GetSyncingS3ChunkInfoUniqueLock();
+    google::protobuf::Map<uint64_t, S3ChunkInfoList> s3ChunkInfoMap;
+    MetaStatusCode ret = metaClient_->GetS3ChunkInfoByIndexes(
+        inode_.fsid(), inode_.inodeid(), s3ChunkInfoAdd_, toLoad,
+        &s3ChunkInfoMap);
+    if (ret != MetaStatusCode::OK) {
+        LOG(ERROR) << "metaClient_ GetS3ChunkInfoByIndexes failed, "
+                   << "MetaStatusCode: " << ret
+                   << ", MetaStatusCode_Name: " << MetaStatusCode_Name(ret)
+                   << ", inodeid: " << inode_.inodeid();
+        return ToFSError(ret);
+    }
+
+    auto before = s3ChunkInfoSize_;
+    auto* chunkInfoMap = inode_.mutable_s3chunkinfomap();
+    for (const auto& chunkIndex : toLoad) {
+        chunkInfoMap->erase(chunkIndex);
+        loadedChunkIndexes_.insert(chunkIndex);
+    }
+    for (auto& item : s3ChunkInfoMap) {
+        (*chunkInfoMap)[item.first].Swap(&item.second);
+        loadedChunkIndexes_.insert(item.first);
+    }
+    UpdateS3ChunkInfoMetric(CalS3ChunkInfoSize() - before);
+    ClearS3ChunkInfoAdd();
+    VLOG(6) << "LoadS3ChunkInfo, inodeid: " << inode_.inodeid()
+            << ", load chunks: " << toLoad.size()
+            << ", loaded chunks: " << loadedChunkIndexes_.size();
+    return CURVEFS_ERROR::OK;
+}
+
+CURVEFS_ERROR InodeWrapper::ResetLazyS3ChunkInfo() {
+    CURVEFS_ERROR rc = SyncS3ChunkInfo();
+    if (rc != CURVEFS_ERROR::OK) {
+        return rc;
+    }
+
+    auto before = s3ChunkInfoSize_;
+    inode_.mutable_s3chunkinfomap()->clear();
+    loadedChunkIndexes_.clear();
+    UpdateS3ChunkInfoMetric(CalS3ChunkInfoSize() - before);
+    lastRefreshTime_ = TimeUtility::GetTimeofDaySec();
+    return CURVEFS_ERROR::OK;
+}
+
 CURVEFS_ERROR InodeWrapper::Link(uint64_t parent) {
     curve::common::UniqueLock lg(mtx_);
     REFRESH_NLINK;
@@ -458,18 +526,19 @@ CURVEFS_ERROR InodeWrapper::Sync(bool internal) {
     return ret;
 }
 
-void InodeWrapper::Async(MetaServerClientDone *done, bool internal) {
+void InodeWrapper::Async(MetaServerClientDone *done, bool internal,
+                         UpdateInodeBatch *batch) {
     VLOG(9) << "async inode: " << inode_.ShortDebugString();
 
     switch (inode_.type()) {
         case FsFileType::TYPE_S3:
-            return AsyncS3(done, internal);
+            return AsyncS3(done, internal, batch);
         case FsFileType::TYPE_FILE:
-            return AsyncFlushAttrAndExtents(done, internal);
+            return AsyncFlushAttrAndExtents(done, internal, batch);
         case FsFileType::TYPE_DIRECTORY:
             FALLTHROUGH_INTENDED;
         case FsFileType::TYPE_SYM_LINK:
-            return AsyncFlushAttr(done, internal);
+            return AsyncFlushAttr(done, internal, batch);
     }
 
     CHECK(false) << "Unexpected inode type: " << inode_.type() << ", "
@@ -477,7 +546,8 @@ void InodeWrapper::Async(MetaServerClientDone *done, bool internal) {
 }
 
 void InodeWrapper::AsyncFlushAttrAndExtents(MetaServerClientDone *done,
-                                            bool /*internal*/) {
+                                            bool /*internal*/,
+                                            UpdateInodeBatch *batch) {
     VLOG(9) << "async inode: " << inode_.ShortDebugString()
             << ", is dirty: " << dirty_
             << ", has dirty extents: " << extentCache_.HasDirtyExtents();
@@ -492,10 +562,9 @@ void InodeWrapper::AsyncFlushAttrAndExtents(MetaServerClientDone *done,
                     << indices.volumeExtents->ShortDebugString();
         }
 
-        metaClient_->UpdateInodeWithOutNlinkAsync(
-            inode_.fsid(), inode_.inodeid(), dirtyAttr_,
+        UpdateInodeWithOutNlinkAsync(
             new UpdateInodeAttrAndExtentClosure{shared_from_this(), done},
-            std::move(indices));
+            std::move(indices), batch);
 
         dirtyAttr_.Clear();
         return;
@@ -566,7 +635,8 @@ class UpdateInodeAsyncS3Done : public MetaServerClientDone {
 };
 }  // namespace
 
-void InodeWrapper::AsyncS3(MetaServerClientDone *done, bool internal) {
+void InodeWrapper::AsyncS3(MetaServerClientDone *done, bool internal,
+                           UpdateInodeBatch *batch) {
     (void)internal;
     if (dirty_ || !s3ChunkInfoAdd_.empty()) {
         LockSyncingInode();
@@ -575,10 +645,9 @@ void InodeWrapper::AsyncS3(MetaServerClientDone *done, bool internal) {
         if (!s3ChunkInfoAdd_.empty()) {
             indices.s3ChunkInfoMap = std::move(s3ChunkInfoAdd_);
         }
-        metaClient_->UpdateInodeWithOutNlinkAsync(
-            inode_.fsid(), inode_.inodeid(), dirtyAttr_,
+        UpdateInodeWithOutNlinkAsync(
             new UpdateInodeAsyncS3Done{shared_from_this(), done},
-            std::move(indices));
+            std::move(indices), batch);
         dirtyAttr_.Clear();
         ClearS3ChunkInfoAdd();
         return;
@@ -590,6 +659,20 @@ void InodeWrapper::AsyncS3(MetaServerClientDone *done, bool internal) {
     }
 }
 
+void InodeWrapper::UpdateInodeWithOutNlinkAsync(MetaServerClientDone *done,
+                                                DataIndices &&indices,
+                                                UpdateInodeBatch *batch) {
+    if (batch != nullptr) {
+        batch->Add(inode_.fsid(), inode_.inodeid(), dirtyAttr_, done,
+                   std::move(indices));
+        return;
+    }
+
+    metaClient_->UpdateInodeWithOutNlinkAsync(inode_.fsid(), inode_.inodeid(),
+                                              dirtyAttr_, done,
+                                              std::move(indices));
+}
+
 CURVEFS_ERROR InodeWrapper::RefreshVolumeExtent() {
     VolumeExtentSliceList extents;
     auto st = metaClient_->GetVolumeExtent(inode_.fsid(), inode_.inodeid(),
@@ -31,6 +31,8 @@
 #include <utility>
 #include <memory>
 #include <string>
+#include <set>
+#include <unordered_set>
 
 #include "curvefs/src/common/define.h"
 #include "curvefs/proto/metaserver.pb.h"
@@ -64,6 +66,8 @@ enum class InodeStatus {
 using rpcclient::MetaServerClient;
 using rpcclient::MetaServerClientImpl;
 using rpcclient::MetaServerClientDone;
+using rpcclient::DataIndices;
+using rpcclient::UpdateInodeBatch;
 using metric::S3ChunkInfoMetric;
 using common::NlinkChange;
 using curve::common::TimeUtility;
@@ -91,6 +95,7 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
           metaClient_(std::move(metaClient)),
           s3ChunkInfoMetric_(std::move(s3ChunkInfoMetric)),
           dirty_(false),
+          lazyLoadS3ChunkInfo_(false),
           time_(TimeUtility::GetTimeofDaySec()) {
         UpdateS3ChunkInfoMetric(CalS3ChunkInfoSize());
         g_alive_inode_count << 1;
@@ -227,18 +232,41 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
 
     CURVEFS_ERROR SyncS3(bool internal = false);
 
-    void Async(MetaServerClientDone *done, bool internal = false);
+    // Flush dirty attributes and data indices asynchronously, the update is
+    // added into |batch| instead of being sent directly if |batch| is given.
+    void Async(MetaServerClientDone *done, bool internal = false,
+               UpdateInodeBatch *batch = nullptr);
 
-    void AsyncS3(MetaServerClientDone *done, bool internal = false);
+    void AsyncS3(MetaServerClientDone *done, bool internal = false,
+                 UpdateInodeBatch *batch = nullptr);
 
     CURVEFS_ERROR SyncAttr(bool internal = false);
 
-    void AsyncFlushAttr(MetaServerClientDone *done, bool internal);
+    void AsyncFlushAttr(MetaServerClientDone *done, bool internal,
+                        UpdateInodeBatch *batch = nullptr);
 
     void FlushS3ChunkInfoAsync();
 
     CURVEFS_ERROR RefreshS3ChunkInfo();
 
+    // Mark the s3chunkinfo of inode is not fetched from metaserver,
+    // the s3chunkinfo list of each chunk will be loaded on demand
+    // by LoadS3ChunkInfoLocked().
+    void EnableLazyLoadS3ChunkInfo() {
+        curve::common::UniqueLock lg(mtx_);
+        lazyLoadS3ChunkInfo_ = true;
+        loadedChunkIndexes_.clear();
+    }
+
+    bool IsLazyLoadS3ChunkInfo() const {
+        return lazyLoadS3ChunkInfo_;
+    }
+
+    // Make sure the s3chunkinfo lists of |chunkIndexes| are loaded,
+    // it does nothing if inode is not in lazy load mode.
+    // REQUIRES: |mtx_| is held
+    CURVEFS_ERROR LoadS3ChunkInfoLocked(const std::set<uint64_t>& chunkIndexes);
+
     CURVEFS_ERROR Open();
 
     bool IsOpen();
@@ -362,6 +390,10 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
         }
     }
 
+    // Drop all loaded s3chunkinfo lists after flushing pending s3chunkinfo,
+    // which will be reloaded on demand.
+    CURVEFS_ERROR ResetLazyS3ChunkInfo();
+
     void ClearS3ChunkInfoAdd() {
         UpdateS3ChunkInfoMetric(-s3ChunkInfoAddSize_);
         s3ChunkInfoAdd_.clear();
@@ -381,7 +413,15 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
 
     // Flush inode attributes and extents asynchronously.
     // REQUIRES: |mtx_| is held
-    void AsyncFlushAttrAndExtents(MetaServerClientDone *done, bool internal);
+    void AsyncFlushAttrAndExtents(MetaServerClientDone *done, bool internal,
+                                  UpdateInodeBatch *batch = nullptr);
+
+    // Send |dirtyAttr_| and |indices| to metaserver, or add them into
+    // |batch| if it isn't nullptr.
+    // REQUIRES: |mtx_| is held
+    void UpdateInodeWithOutNlinkAsync(MetaServerClientDone *done,
+                                      DataIndices &&indices,
+                                      UpdateInodeBatch *batch);
 
  private:
     friend class UpdateVolumeExtentClosure;
@@ -413,6 +453,10 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
     bool dirty_;
     mutable ::curve::common::Mutex mtx_;
 
+    // chunk indexes whose s3chunkinfo list has been loaded in lazy load mode
+    bool lazyLoadS3ChunkInfo_;
+    std::unordered_set<uint64_t> loadedChunkIndexes_;
+
     mutable ::curve::common::Mutex syncingInodeMtx_;
     mutable ::curve::common::Mutex syncingS3ChunkInfoMtx_;
 
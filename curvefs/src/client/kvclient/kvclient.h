@@ -23,6 +23,7 @@
 #define CURVEFS_SRC_CLIENT_KVCLIENT_KVCLIENT_H_
 
 #include <string>
+#include <vector>
 
 namespace curvefs {
 
@@ -51,6 +52,45 @@ class KVClient {
 
     virtual bool Get(const std::string &key, char *value, uint64_t offset,
                      uint64_t length, std::string *errorlog) = 0;
+
+    struct GetRequest {
+        std::string key;
+        char *value;
+        uint64_t offset;
+        uint64_t length;
+        bool res;
+    };
+
+    struct SetRequest {
+        std::string key;
+        const char *value;
+        uint64_t length;
+        bool res;
+    };
+
+    /**
+     * @brief: batch get, the result of each request is set in its res.
+     *         The default implementation gets the keys one by one,
+     *         clients which support pipelining should override it.
+     */
+    virtual void MultiGet(std::vector<GetRequest> *requests) {
+        std::string errorlog;
+        for (auto &request : *requests) {
+            request.res = Get(request.key, request.value, request.offset,
+                              request.length, &errorlog);
+        }
+    }
+
+    /**
+     * @brief: batch set, the result of each request is set in its res.
+     */
+    virtual void MultiSet(std::vector<SetRequest> *requests) {
+        std::string errorlog;
+        for (auto &request : *requests) {
+            request.res =
+                Set(request.key, request.value, request.length, &errorlog);
+        }
+    }
 };
 
 }  // namespace client
@@ -21,7 +21,10 @@
  */
 
 #include "curvefs/src/client/kvclient/kvclient_manager.h"
+#include <cstring>
 #include <memory>
+#include <string>
+#include <vector>
 #include "src/client/client_metric.h"
 #include "src/common/concurrent/count_down_event.h"
 
@@ -66,17 +69,125 @@ void KVClientManager::Set(std::shared_ptr<SetKVCacheTask> task) {
 
 void KVClientManager::Get(std::shared_ptr<GetKVCacheTask> task) {
     threadPool_.Enqueue([task, this]() {
+        if (!AddInflightGet(task)) {
+            return;
+        }
         LatencyGuard guard(&kvClientMetric_.kvClientGet.latency);
 
         std::string error_log;
         task->res = client_->Get(task->key, task->value, task->offset,
                                 task->length, &error_log);
-        task->timer.stop();
-        ONRETURN(Get, task->res);
+        FinishInflightGet(task);
+    });
+}
 
-        task->done(task);
+void KVClientManager::BatchSet(
+    std::vector<std::shared_ptr<SetKVCacheTask>> tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+    threadPool_.Enqueue([tasks, this]() {
+        LatencyGuard guard(&kvClientMetric_.kvClientSet.latency);
+        kvClientMetric_.kvClientMultiSetSize << tasks.size();
+
+        std::vector<KVClient::SetRequest> requests;
+        requests.reserve(tasks.size());
+        for (const auto& task : tasks) {
+            requests.push_back(
+                {task->key, task->value, task->length, false});
+        }
+        client_->MultiSet(&requests);
+
+        for (size_t i = 0; i < tasks.size(); i++) {
+            tasks[i]->res = requests[i].res;
+            tasks[i]->timer.stop();
+            ONRETURN(Set, tasks[i]->res);
+            tasks[i]->done(tasks[i]);
+        }
     });
 }
 
+void KVClientManager::BatchGet(
+    std::vector<std::shared_ptr<GetKVCacheTask>> tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+    threadPool_.Enqueue([tasks, this]() { DoBatchGet(tasks); });
+}
+
+void KVClientManager::DoBatchGet(
+    const std::vector<std::shared_ptr<GetKVCacheTask>>& tasks) {
+    std::vector<std::shared_ptr<GetKVCacheTask>> leaders;
+    leaders.reserve(tasks.size());
+    for (const auto& task : tasks) {
+        if (AddInflightGet(task)) {
+            leaders.emplace_back(task);
+        }
+    }
+    if (leaders.empty()) {
+        return;
+    }
+
+    LatencyGuard guard(&kvClientMetric_.kvClientGet.latency);
+    kvClientMetric_.kvClientMultiGetSize << leaders.size();
+
+    std::vector<KVClient::GetRequest> requests;
+    requests.reserve(leaders.size());
+    for (const auto& task : leaders) {
+        requests.push_back(
+            {task->key, task->value, task->offset, task->length, false});
+    }
+    client_->MultiGet(&requests);
+
+    for (size_t i = 0; i < leaders.size(); i++) {
+        leaders[i]->res = requests[i].res;
+        FinishInflightGet(leaders[i]);
+    }
+}
+
+std::string KVClientManager::InflightGetKey(const GetKVCacheTask& task) {
+    return task.key + "@" + std::to_string(task.offset) + "_" +
+           std::to_string(task.length);
+}
+
+bool KVClientManager::AddInflightGet(
+    const std::shared_ptr<GetKVCacheTask>& task) {
+    std::lock_guard<std::mutex> lock(inflightGetsMtx_);
+    auto ret = inflightGets_.emplace(
+        InflightGetKey(*task), std::vector<std::shared_ptr<GetKVCacheTask>>());
+    if (!ret.second) {
+        ret.first->second.emplace_back(task);
+        kvClientMetric_.kvClientGetDedup << 1;
+        return false;
+    }
+    return true;
+}
+
+void KVClientManager::FinishInflightGet(
+    const std::shared_ptr<GetKVCacheTask>& task) {
+    std::vector<std::shared_ptr<GetKVCacheTask>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(inflightGetsMtx_);
+        auto iter = inflightGets_.find(InflightGetKey(*task));
+        if (iter != inflightGets_.end()) {
+            waiters.swap(iter->second);
+            inflightGets_.erase(iter);
+        }
+    }
+
+    task->timer.stop();
+    ONRETURN(Get, task->res);
+    for (const auto& waiter : waiters) {
+        if (task->res) {
+            memcpy(waiter->value, task->value, task->length);
+        }
+        waiter->res = task->res;
+        waiter->timer.stop();
+        ONRETURN(Get, waiter->res);
+        waiter->done(waiter);
+    }
+    task->done(task);
+}
+
 }  // namespace client
 }  // namespace curvefs
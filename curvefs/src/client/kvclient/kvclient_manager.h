@@ -27,8 +27,11 @@
 
 #include <thread>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "curvefs/src/client/kvclient/kvclient.h"
@@ -104,15 +107,43 @@ class KVClientManager {
 
     void Get(std::shared_ptr<GetKVCacheTask> task);
 
+    /**
+     * Batch version of Set/Get, the tasks are sent to the kv cluster
+     * together, and the done of each task is still called one by one.
+     * Concurrent gets of the same range of a key are merged into one.
+     */
+    void BatchSet(std::vector<std::shared_ptr<SetKVCacheTask>> tasks);
+
+    void BatchGet(std::vector<std::shared_ptr<GetKVCacheTask>> tasks);
+
     KVClientMetric *GetClientMetricForTesting() { return &kvClientMetric_; }
 
  private:
     void Uninit();
 
+    void DoBatchGet(const std::vector<std::shared_ptr<GetKVCacheTask>>& tasks);
+
+    /**
+     * @return true if the task should be sent to the kv cluster,
+     *         false if there is an inflight get for the same range of the key
+     *         and the task will be finished with it.
+     */
+    bool AddInflightGet(const std::shared_ptr<GetKVCacheTask>& task);
+
+    // finish the task and all the gets waiting for it
+    void FinishInflightGet(const std::shared_ptr<GetKVCacheTask>& task);
+
+    static std::string InflightGetKey(const GetKVCacheTask& task);
+
  private:
     TaskThreadPool<bthread::Mutex, bthread::ConditionVariable> threadPool_;
     std::shared_ptr<KVClient> client_;
     KVClientMetric kvClientMetric_;
+
+    std::mutex inflightGetsMtx_;
+    std::unordered_map<std::string,
+                       std::vector<std::shared_ptr<GetKVCacheTask>>>
+        inflightGets_;
 };
 
 }  // namespace client
@@ -22,10 +22,172 @@
 
 #include "curvefs/src/client/kvclient/memcache_client.h"
 
+#include <butil/time.h>
+
 namespace curvefs {
 namespace client {
 
-thread_local memcached_st* tcli = nullptr;
+memcached_st *MemcachedConnPool::Acquire() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cond_.wait(lock, [this]() {
+        return !idle_.empty() || maxConnections_ == 0 ||
+               created_ < maxConnections_;
+    });
+    if (!idle_.empty()) {
+        memcached_st *cli = idle_.back();
+        idle_.pop_back();
+        return cli;
+    }
+    ++created_;
+    return memcached_clone(nullptr, master_);
+}
+
+void MemcachedConnPool::Release(memcached_st *cli, bool broken) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (broken) {
+        memcached_free(cli);
+        --created_;
+    } else {
+        idle_.emplace_back(cli);
+    }
+    cond_.notify_one();
+}
+
+void MemcachedConnPool::Clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto *cli : idle_) {
+        memcached_free(cli);
+    }
+    created_ -= idle_.size();
+    idle_.clear();
+    master_ = nullptr;
+}
+
+KVServerMetric *MemCachedClient::GetServerMetric(memcached_st *cli,
+                                                 uint32_t server) {
+    const memcached_instance_st *instance =
+        memcached_server_instance_by_position(cli, server);
+    std::string name = std::to_string(server);
+    if (instance != nullptr) {
+        name = std::string(memcached_server_name(instance)) + "_" +
+               std::to_string(memcached_server_port(instance));
+    }
+    std::lock_guard<std::mutex> lock(serverMetricsMtx_);
+    auto iter = serverMetrics_.find(name);
+    if (iter == serverMetrics_.end()) {
+        iter = serverMetrics_
+                   .emplace(name, std::unique_ptr<KVServerMetric>(
+                                      new KVServerMetric(name)))
+                   .first;
+    }
+    return iter->second.get();
+}
+
+void MemCachedClient::MultiGet(std::vector<GetRequest> *requests) {
+    for (auto &request : *requests) {
+        request.res = false;
+    }
+    memcached_st *cli = pool_.Acquire();
+    bool broken = false;
+    auto groups = GroupByServer(cli, requests);
+    for (auto &group : groups) {
+        butil::Timer timer;
+        timer.start();
+
+        std::vector<const char *> keys;
+        std::vector<size_t> keyLengths;
+        // the same key may be requested more than once
+        std::unordered_map<std::string, std::vector<GetRequest *>> key2Requests;
+        for (auto *request : group.second) {
+            auto &same = key2Requests[request->key];
+            if (same.empty()) {
+                keys.emplace_back(request->key.c_str());
+                keyLengths.emplace_back(request->key.length());
+            }
+            same.emplace_back(request);
+        }
+
+        memcached_return_t rc =
+            memcached_mget(cli, keys.data(), keyLengths.data(), keys.size());
+        if (rc != MEMCACHED_SUCCESS) {
+            LOG(ERROR) << "MultiGet " << keys.size()
+                       << " keys error = " << ResError(rc);
+            broken = true;
+            break;
+        }
+
+        memcached_result_st result;
+        memcached_result_create(cli, &result);
+        while (memcached_fetch_result(cli, &result, &rc) != nullptr) {
+            std::string key(memcached_result_key_value(&result),
+                            memcached_result_key_length(&result));
+            auto iter = key2Requests.find(key);
+            if (iter == key2Requests.end()) {
+                continue;
+            }
+            const char *value = memcached_result_value(&result);
+            size_t valueLength = memcached_result_length(&result);
+            for (auto *request : iter->second) {
+                if (request->value != nullptr &&
+                    valueLength >= request->offset + request->length) {
+                    memcpy(request->value, value + request->offset,
+                           request->length);
+                    request->res = true;
+                }
+            }
+        }
+        memcached_result_free(&result);
+        if (rc != MEMCACHED_END && rc != MEMCACHED_SUCCESS &&
+            rc != MEMCACHED_NOTFOUND) {
+            LOG(ERROR) << "MultiGet fetch result error = " << ResError(rc);
+            broken = true;
+        }
+
+        timer.stop();
+        GetServerMetric(cli, group.first)->getLatency << timer.u_elapsed();
+        if (broken) {
+            break;
+        }
+    }
+    pool_.Release(cli, broken);
+}
+
+void MemCachedClient::MultiSet(std::vector<SetRequest> *requests) {
+    memcached_st *cli = pool_.Acquire();
+    bool broken = false;
+    auto groups = GroupByServer(cli, requests);
+    memcached_behavior_set(cli, MEMCACHED_BEHAVIOR_BUFFER_REQUESTS, 1);
+    for (auto &group : groups) {
+        butil::Timer timer;
+        timer.start();
+
+        for (auto *request : group.second) {
+            memcached_return_t rc =
+                memcached_set(cli, request->key.c_str(), request->key.length(),
+                              request->value, request->length, 0, 0);
+            request->res =
+                (rc == MEMCACHED_SUCCESS || rc == MEMCACHED_BUFFERED);
+            if (!request->res) {
+                LOG(ERROR) << "MultiSet key = " << request->key
+                           << " error = " << ResError(rc);
+                broken = true;
+            }
+        }
+        memcached_return_t rc = memcached_flush_buffers(cli);
+        if (rc != MEMCACHED_SUCCESS) {
+            LOG(ERROR) << "MultiSet flush error = " << ResError(rc);
+            for (auto *request : group.second) {
+                request->res = false;
+            }
+            broken = true;
+        }
+
+        timer.stop();
+        GetServerMetric(cli, group.first)->setLatency << timer.u_elapsed();
+    }
+    memcached_behavior_set(cli, MEMCACHED_BEHAVIOR_BUFFER_REQUESTS, 0);
+    pool_.Release(cli, broken);
+}
 
 }  // namespace client
 }  // namespace curvefs
@@ -27,9 +27,15 @@
 #include <libmemcached-1.0/memcached.h>
 #include <libmemcached-1.0/types/return.h>
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "curvefs/src/client/kvclient/kvclient.h"
+#include "curvefs/src/client/metric/client_metric.h"
 #include "curvefs/proto/topology.pb.h"
 
 namespace curvefs {
@@ -37,54 +43,63 @@ namespace curvefs {
 namespace client {
 
 using curvefs::mds::topology::MemcacheClusterInfo;
+using curvefs::client::metric::KVServerMetric;
 
 /**
- * only the threadpool will operate the kvclient,
- * for threadsafe and fast, we can make every thread has a client.
+ * A bounded pool of memcached_st cloned from the master one. Every
+ * memcached_st keeps one connection to each server, so it's also the
+ * per-server connection pool.
  */
-extern thread_local memcached_st *tcli;
+class MemcachedConnPool {
+ public:
+    explicit MemcachedConnPool(uint32_t maxConnections)
+        : maxConnections_(maxConnections), created_(0), master_(nullptr) {}
 
-/**
- * MemCachedClient is a client to memcached cluster. You'd better
- * don't use it directly.
- * normal usage example:
- * auto client = std::make_unique<MemCachedClient>();
- *      (make_unique is after c++14)
- * std::string error_log;
- * auto ue = client->AddServer("x.x.x.x", port);
- * ... (the number of your memcached cluster)
- * if (!ue) {...}
- * ue = client->PushServer();
- * if (!ue) {...}
- * uint64_t data;
- * client->SetClientAttr(MEMCACHED_BEHAVIOR_NO_BLOCK, data);
- * client->SetClientAttr(MEMCACHED_BEHAVIOR_TCP_NODELAY, data);
- * KVClientManager manager;
- * config.kvclient = std::move(client_);
- * config.threadPooln = n;
- * manager.Init(&conf);
- * char key[] = "curve";
- * char value[] = "yyds"
- * manager.Set(key, value, strlen(value));
- * ... (don't get it immediately, the kvmanager has a threadpool
- * it will perform tasks asynchronously)
- * std::string res;
- * ue = manager.Get(key, &res);
- * if (!ue) {...}
- * then ...
- * manager.Unint();
- */
+    ~MemcachedConnPool() { Clear(); }
+
+    void SetMaster(memcached_st *master) {
+        Clear();
+        std::lock_guard<std::mutex> lock(mtx_);
+        master_ = master;
+    }
+
+    // block if all the connections are in use
+    memcached_st *Acquire();
+
+    // broken connection will be freed instead of put back
+    void Release(memcached_st *cli, bool broken);
+
+    void Clear();
+
+ private:
+    const uint32_t maxConnections_;
+    uint32_t created_;
+    memcached_st *master_;
+    std::vector<memcached_st *> idle_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+};
 
 class MemCachedClient : public KVClient {
  public:
-    MemCachedClient() : server_(nullptr) {
+    static constexpr uint32_t kDefaultMaxConnections = 64;
+
+    explicit MemCachedClient(
+        uint32_t maxConnections = kDefaultMaxConnections)
+        : server_(nullptr), pool_(maxConnections) {
         client_ = memcached_create(nullptr);
+        pool_.SetMaster(client_);
+    }
+    explicit MemCachedClient(memcached_st *cli)
+        : server_(nullptr), client_(cli), pool_(kDefaultMaxConnections) {
+        pool_.SetMaster(client_);
     }
-    explicit MemCachedClient(memcached_st *cli) : client_(cli) {}
     ~MemCachedClient() { UnInit(); }
 
     bool Init(const MemcacheClusterInfo &kvcachecluster) {
+        UnInit();
         client_ = memcached(nullptr, 0);
+        pool_.SetMaster(client_);
 
         for (int i = 0; i < kvcachecluster.servers_size(); i++) {
             if (!AddServer(kvcachecluster.servers(i).ip(),
@@ -100,6 +115,7 @@ class MemCachedClient : public KVClient {
     }
 
     void UnInit() override {
+        pool_.Clear();
         if (client_) {
             memcached_free(client_);
             client_ = nullptr;
@@ -108,54 +124,66 @@ class MemCachedClient : public KVClient {
 
     bool Set(const std::string &key, const char *value,
              const uint64_t value_len, std::string *errorlog) override {
-        if (nullptr == tcli) {
-            tcli = memcached_clone(nullptr, client_);
-        }
-        auto res = memcached_set(tcli, key.c_str(), key.length(), value,
+        memcached_st *cli = pool_.Acquire();
+        auto res = memcached_set(cli, key.c_str(), key.length(), value,
                                  value_len, 0, 0);
         if (MEMCACHED_SUCCESS == res) {
             VLOG(9) << "Set key = " << key << " OK";
+            pool_.Release(cli, false);
             return true;
         }
         *errorlog = ResError(res);
-        memcached_free(tcli);
-        tcli = nullptr;
+        pool_.Release(cli, true);
         LOG(ERROR) << "Set key = " << key << " error = " << *errorlog;
         return false;
     }
 
     bool Get(const std::string &key, char *value, uint64_t offset,
              uint64_t length, std::string *errorlog) override {
-        if (nullptr == tcli) {
-            // multi thread use a memcached_st* client is unsafe.
-            // should clone it or use memcached_st_pool.
-            tcli = memcached_clone(nullptr, client_);
-        }
+        // multi thread use a memcached_st* client is unsafe,
+        // so every request takes its own one from the pool.
+        memcached_st *cli = pool_.Acquire();
         uint32_t flags = 0;
         size_t value_length = 0;
         memcached_return_t ue;
-        char *res = memcached_get(tcli, key.c_str(), key.length(),
+        char *res = memcached_get(cli, key.c_str(), key.length(),
                                   &value_length, &flags, &ue);
         if (MEMCACHED_SUCCESS == ue && res != nullptr && value &&
-            value_length >= length) {
+            value_length >= offset + length) {
             VLOG(9) << "Get key = " << key << " OK";
             memcpy(value, res + offset, length);
             free(res);
+            pool_.Release(cli, false);
             return true;
         }
+        if (res != nullptr) {
+            free(res);
+        }
 
         *errorlog = ResError(ue);
-        if (ue != MEMCACHED_NOTFOUND) {
+        if (ue != MEMCACHED_NOTFOUND && ue != MEMCACHED_SUCCESS) {
           LOG(ERROR) << "Get key = " << key << " error = " << *errorlog
                      << ", get_value_len = " << value_length
                      << ", expect_value_len = " << length;
-          memcached_free(tcli);
-          tcli = nullptr;
+          pool_.Release(cli, true);
+        } else {
+          pool_.Release(cli, false);
         }
 
         return false;
     }
 
+    /**
+     * @brief: keys are grouped by the server they belong to, and the keys
+     *         of one server are fetched by one pipelined mget.
+     */
+    void MultiGet(std::vector<GetRequest> *requests) override;
+
+    /**
+     * @brief: sets of one server are buffered and flushed together.
+     */
+    void MultiSet(std::vector<SetRequest> *requests) override;
+
     // transform the res to a error string
     const std::string ResError(const memcached_return_t res) {
         return memcached_strerror(nullptr, res);
@@ -196,9 +224,30 @@ class MemCachedClient : public KVClient {
         return static_cast<int>(memcached_server_count(client_));
     }
 
+ private:
+    // group the keys by the index of the server they belong to
+    template <typename RequestType>
+    std::unordered_map<uint32_t, std::vector<RequestType *>> GroupByServer(
+        memcached_st *cli, std::vector<RequestType> *requests) {
+        std::unordered_map<uint32_t, std::vector<RequestType *>> groups;
+        for (auto &request : *requests) {
+            uint32_t server = memcached_generate_hash(
+                cli, request.key.c_str(), request.key.length());
+            groups[server].emplace_back(&request);
+        }
+        return groups;
+    }
+
+    KVServerMetric *GetServerMetric(memcached_st *cli, uint32_t server);
+
  private:
     memcached_server_st *server_;
     memcached_st *client_;
+    MemcachedConnPool pool_;
+
+    std::mutex serverMetricsMtx_;
+    std::unordered_map<std::string, std::unique_ptr<KVServerMetric>>
+        serverMetrics_;
 };
 
 }  //  namespace client
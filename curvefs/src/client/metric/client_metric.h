@@ -86,6 +86,9 @@ struct MetaServerClientMetric {
     InterfaceMetric batchGetXattr;
     InterfaceMetric createInode;
     InterfaceMetric updateInode;
+    InterfaceMetric batchUpdateInodeAttr;
+    // number of inodes updated by each BatchUpdateInodeAttr rpc
+    bvar::LatencyRecorder batchUpdateInodeAttrSize;
     InterfaceMetric deleteInode;
     InterfaceMetric appendS3ChunkInfo;
 
@@ -105,6 +108,8 @@ struct MetaServerClientMetric {
           batchGetXattr(prefix, "batchGetXattr"),
           createInode(prefix, "createInode"),
           updateInode(prefix, "updateInode"),
+          batchUpdateInodeAttr(prefix, "batchUpdateInodeAttr"),
+          batchUpdateInodeAttrSize(prefix, "batchUpdateInodeAttr_size"),
           deleteInode(prefix, "deleteInode"),
           appendS3ChunkInfo(prefix, "appendS3ChunkInfo"),
           prepareRenameTx(prefix, "prepareRenameTx"),
@@ -293,9 +298,29 @@ struct KVClientMetric {
     static const std::string prefix;
     InterfaceMetric kvClientGet;
     InterfaceMetric kvClientSet;
+    // number of keys per batch get/set
+    bvar::LatencyRecorder kvClientMultiGetSize;
+    bvar::LatencyRecorder kvClientMultiSetSize;
+    // gets served by a concurrent get of the same key
+    bvar::Adder<uint64_t> kvClientGetDedup;
 
     KVClientMetric()
-        : kvClientGet(prefix, "get"), kvClientSet(prefix, "set") {}
+        : kvClientGet(prefix, "get"),
+          kvClientSet(prefix, "set"),
+          kvClientMultiGetSize(prefix, "multi_get_size"),
+          kvClientMultiSetSize(prefix, "multi_set_size"),
+          kvClientGetDedup(prefix, "get_dedup") {}
+};
+
+// latency of the requests sent to one kv cache server
+struct KVServerMetric {
+    static const std::string prefix;
+    bvar::LatencyRecorder getLatency;
+    bvar::LatencyRecorder setLatency;
+
+    explicit KVServerMetric(const std::string& server)
+        : getLatency(prefix, server + "_get"),
+          setLatency(prefix, server + "_set") {}
 };
 
 struct S3ChunkInfoMetric {
@@ -286,6 +286,10 @@ bool MdsClientImpl::GetMetaServerListInCopysets(
                 csinfo.internalAddr = PeerAddr(internal);
                 csinfo.externalAddr = PeerAddr(external);
                 copysetseverl.AddCopysetPeerInfo(csinfo);
+                if (info.has_leaderid() &&
+                    info.leaderid() == csl.metaserverid()) {
+                    copysetseverl.UpdateLeaderIndex(j);
+                }
             }
             cpinfoVec->push_back(copysetseverl);
         }
@@ -22,15 +22,18 @@
 
 #include <butil/fast_rand.h>
 #include <algorithm>
+#include <chrono>
 #include <iterator>
 #include <vector>
 #include <map>
 #include <utility>
 #include "curvefs/src/client/rpcclient/metacache.h"
 #include "src/client/metacache.h"
+#include "src/common/timeutility.h"
 
 using ::curve::common::ReadLockGuard;
 using ::curve::common::WriteLockGuard;
+using ::curve::common::TimeUtility;
 
 namespace curvefs {
 namespace client {
@@ -52,16 +55,16 @@ void MetaCache::GetTxId(uint32_t partitionId, uint64_t *txId) {
 
 bool MetaCache::GetTxId(uint32_t fsId, uint64_t inodeId, uint32_t *partitionId,
                         uint64_t *txId) {
-    for (const auto &partition : partitionInfos_) {
-        if (fsId == partition.fsid() && inodeId >= partition.start() &&
-            inodeId <= partition.end()) {
-            *partitionId = partition.partitionid();
-            *txId = partition.txid();
-            GetTxId(*partitionId, txId);
-            return true;
-        }
+    auto table = GetRoutingTable();
+    const PartitionInfo *partition = table->FindPartition(inodeId);
+    if (partition == nullptr || partition->fsid() != fsId) {
+        return false;
     }
-    return false;
+
+    *partitionId = partition->partitionid();
+    *txId = partition->txid();
+    GetTxId(*partitionId, txId);
+    return true;
 }
 
 void MetaCache::GetAllTxIds(std::vector<PartitionTxId> *txIds) {
@@ -114,6 +117,12 @@ bool MetaCache::GetTarget(uint32_t fsID, uint64_t inodeID,
 }
 
 bool MetaCache::SelectTarget(uint32_t fsID, CopysetTarget *target) {
+    // mds may split hot partitions, list partitions again to pick up the
+    // new ones, the cached partitions are still usable if it fails
+    if (PartitionsNeedRefresh() && !ListPartitions(fsID)) {
+        LOG(WARNING) << "refresh partitions for {fsid:" << fsID << "} fail";
+    }
+
     // select a partition
     if (!SelectPartition(target)) {
         // list from mds
@@ -137,10 +146,9 @@ bool MetaCache::SelectTarget(uint32_t fsID, CopysetTarget *target) {
 bool MetaCache::IsLeaderMayChange(const CopysetGroupID &groupID) {
     const auto key = CalcLogicPoolCopysetID(groupID);
 
-
-    ReadLockGuard rl(rwlock4copysetInfoMap_);
-    auto iter = copysetInfoMap_.find(key);
-    if (iter == copysetInfoMap_.end()) {
+    auto table = GetRoutingTable();
+    auto iter = table->copysets.find(key);
+    if (iter == table->copysets.end()) {
         LOG(WARNING) << "get information for copyset:" << groupID.ToString()
                      << " fail, copyset not found.";
         return false;
@@ -153,8 +161,23 @@ void MetaCache::UpdateCopysetInfo(const CopysetGroupID &groupID,
                                   const CopysetInfo<MetaserverID> &csinfo) {
     const auto key = CalcLogicPoolCopysetID(groupID);
 
-    WriteLockGuard wl(rwlock4copysetInfoMap_);
-    copysetInfoMap_[key] = csinfo;
+    UpdateRoutingTable([&](RoutingTable *table) {
+        table->copysets[key] = csinfo;
+    });
+}
+
+bool MetaCache::GetTargetReplica(CopysetTarget *target) {
+    CopysetInfo<MetaserverID> copysetInfo;
+    if (!GetCopysetInfowithCopySetID(target->groupID, &copysetInfo) ||
+        copysetInfo.csinfos_.empty()) {
+        return false;
+    }
+
+    const auto index = butil::fast_rand() % copysetInfo.csinfos_.size();
+    const auto &peer = copysetInfo.csinfos_[index];
+    target->metaServerID = peer.peerID;
+    target->endPoint = peer.externalAddr.addr_;
+    return true;
 }
 
 bool MetaCache::GetTargetLeader(CopysetTarget *target, bool refresh) {
@@ -179,6 +202,8 @@ bool MetaCache::GetTargetLeader(CopysetTarget *target, bool refresh) {
 
     // if cacahe do not have invalid leader, refresh leader
     VLOG(3) << "refresh leader for " << target->groupID.ToString();
+    // leader of one copyset changed, others may changed too
+    NotifyLeaderChanged();
     bool ret = true;
     int retry = 0;
     while (retry++ < metacacheopt_.metacacheGetLeaderRetry) {
@@ -214,8 +239,7 @@ bool MetaCache::GetTargetLeader(CopysetTarget *target, bool refresh) {
 }
 
 bool MetaCache::ListPartitions(uint32_t fsID) {
-    WriteLockGuard wl4PartitionMap(rwlock4Partitions_);
-    WriteLockGuard wl4CopysetMap(rwlock4copysetInfoMap_);
+    std::lock_guard<Mutex> lg(createMutex_);
 
     fsID_ = fsID;
     PartitionInfoList partitionInfos;
@@ -226,21 +250,39 @@ bool MetaCache::ListPartitions(uint32_t fsID) {
 
     DoAddOrResetPartitionAndCopyset(std::move(partitionInfos),
                                     std::move(copysetMap), true);
+    lastListPartitionsMs_.store(TimeUtility::GetTimeofDayMs());
     return true;
 }
 
+bool MetaCache::PartitionsNeedRefresh() {
+    if (metacacheopt_.refreshPartitionIntervalSec == 0) {
+        return false;
+    }
+
+    uint64_t last = lastListPartitionsMs_.load();
+    uint64_t now = TimeUtility::GetTimeofDayMs();
+    // never listed, partitions are listed on demand
+    if (last == 0 ||
+        now < last + metacacheopt_.refreshPartitionIntervalSec * 1000ull) {
+        return false;
+    }
+
+    return lastListPartitionsMs_.compare_exchange_strong(last, now);
+}
+
 bool MetaCache::CreatePartitions(int currentNum,
                                  PartitionInfoList *newPartitions) {
     std::lock_guard<Mutex> lg(createMutex_);
 
     // already create
     {
-        ReadLockGuard rl(rwlock4Partitions_);
-        if (static_cast<int>(partitionInfos_.size()) > currentNum) {
-            newPartitions->reserve(partitionInfos_.size() - currentNum);
+        auto table = GetRoutingTable();
+        const auto &partitions = table->partitions;
+        if (static_cast<int>(partitions.size()) > currentNum) {
+            newPartitions->reserve(partitions.size() - currentNum);
             newPartitions->insert(newPartitions->end(),
-                                  partitionInfos_.begin() + currentNum,
-                                  partitionInfos_.end());
+                                  partitions.begin() + currentNum,
+                                  partitions.end());
             return true;
         }
     }
@@ -252,8 +294,6 @@ bool MetaCache::CreatePartitions(int currentNum,
     }
 
     // add partition and copyset info
-    WriteLockGuard wl4PartitionMap(rwlock4Partitions_);
-    WriteLockGuard wl4CopysetMap(rwlock4copysetInfoMap_);
     DoAddOrResetPartitionAndCopyset(*newPartitions, std::move(copysetMap),
                                     false);
 
@@ -280,6 +320,7 @@ bool MetaCache::DoListOrCreatePartitions(
 
     // gather partitionIDs
     std::vector<PartitionID> partitionIDList;
+    auto table = GetRoutingTable();
     for_each(partitionInfos->begin(), partitionInfos->end(),
              [&](const PartitionInfo &info) {
                  auto key = CalcLogicPoolCopysetID(
@@ -287,8 +328,7 @@ bool MetaCache::DoListOrCreatePartitions(
                  bool exist = false;
 
                  if (!list) {
-                     ReadLockGuard rl(rwlock4copysetInfoMap_);
-                     exist = (copysetInfoMap_.count(key) > 0);
+                     exist = (table->copysets.count(key) > 0);
                  }
 
                  if (!exist) {
@@ -345,11 +385,6 @@ void MetaCache::DoAddOrResetPartitionAndCopyset(
     PartitionInfoList partitionInfos,
     std::map<PoolIDCopysetID, CopysetInfo<MetaserverID>> copysetMap,
     bool reset) {
-    if (reset) {
-        partitionInfos_.clear();
-        copysetInfoMap_.clear();
-    }
-
     LOG(INFO) << "add partition and copyset infos for {fsid:" << fsID_
               << "} ok, partition size = " << partitionInfos.size()
               << ", copyset size = " << copysetMap.size()
@@ -359,13 +394,21 @@ void MetaCache::DoAddOrResetPartitionAndCopyset(
                   [&](const PartitionInfo &item) {
                       SetTxId(item.partitionid(), item.txid());
                   });
-    // add partitionInfo
-    partitionInfos_.insert(partitionInfos_.end(),
-                           std::make_move_iterator(partitionInfos.begin()),
-                           std::make_move_iterator(partitionInfos.end()));
-    // add copysetInfo
-    copysetInfoMap_.insert(std::make_move_iterator(copysetMap.begin()),
-                           std::make_move_iterator(copysetMap.end()));
+    UpdateRoutingTable([&](RoutingTable *table) {
+        if (reset) {
+            table->partitions.clear();
+            table->copysets.clear();
+        }
+        // add partitionInfo
+        table->partitions.insert(
+            table->partitions.end(),
+            std::make_move_iterator(partitionInfos.begin()),
+            std::make_move_iterator(partitionInfos.end()));
+        // add copysetInfo
+        table->copysets.insert(std::make_move_iterator(copysetMap.begin()),
+                               std::make_move_iterator(copysetMap.end()));
+        table->BuildPartitionIndex();
+    });
 }
 
 bool MetaCache::UpdateCopysetInfoFromMDS(
@@ -423,15 +466,14 @@ bool MetaCache::UpdateLeaderInternal(
 }
 
 bool MetaCache::MarkPartitionUnavailable(PartitionID pid) {
-    WriteLockGuard wl(rwlock4Partitions_);
-
-    for (auto iter = partitionInfos_.begin(); iter != partitionInfos_.end();
-         iter++) {
-        if (iter->partitionid() == pid) {
-            iter->set_status(PartitionStatus::READONLY);
-            break;
+    UpdateRoutingTable([&](RoutingTable *table) {
+        for (auto &partition : table->partitions) {
+            if (partition.partitionid() == pid) {
+                partition.set_status(PartitionStatus::READONLY);
+                break;
+            }
         }
-    }
+    });
     return true;
 }
 
@@ -456,9 +498,9 @@ bool MetaCache::SelectPartition(CopysetTarget *target) {
     std::map<PartitionID, PartitionInfo> candidate;
     int currentNum = 0;
     {
-        ReadLockGuard rl(rwlock4Partitions_);
-        currentNum = partitionInfos_.size();
-        for_each(partitionInfos_.begin(), partitionInfos_.end(),
+        auto table = GetRoutingTable();
+        currentNum = table->partitions.size();
+        for_each(table->partitions.begin(), table->partitions.end(),
                  [&](const PartitionInfo &pInfo) {
                      if (pInfo.status() == PartitionStatus::READWRITE) {
                          candidate[pInfo.partitionid()] = pInfo;
@@ -499,26 +541,25 @@ bool MetaCache::GetCopysetIDwithInodeID(uint64_t inodeID,
                                         CopysetGroupID *groupID,
                                         PartitionID *partitionID,
                                         uint64_t *txId) {
-    ReadLockGuard rl(rwlock4Partitions_);
-    for (auto iter = partitionInfos_.begin(); iter != partitionInfos_.end();
-         ++iter) {
-        if (iter->start() <= inodeID && iter->end() >= inodeID) {
-            *groupID = CopysetGroupID(iter->poolid(), iter->copysetid());
-            *partitionID = iter->partitionid();
-            *txId = iter->txid();
-            GetTxId(*partitionID, txId);
-            return true;
-        }
+    auto table = GetRoutingTable();
+    const PartitionInfo *partition = table->FindPartition(inodeID);
+    if (partition == nullptr) {
+        return false;
     }
-    return false;
+
+    *groupID = CopysetGroupID(partition->poolid(), partition->copysetid());
+    *partitionID = partition->partitionid();
+    *txId = partition->txid();
+    GetTxId(*partitionID, txId);
+    return true;
 }
 
 bool MetaCache::GetCopysetInfowithCopySetID(
     const CopysetGroupID &groupID, CopysetInfo<MetaserverID> *targetInfo) {
     const auto key = CalcLogicPoolCopysetID(groupID);
-    ReadLockGuard rl(rwlock4copysetInfoMap_);
-    auto iter = copysetInfoMap_.find(key);
-    if (iter == copysetInfoMap_.end()) {
+    auto table = GetRoutingTable();
+    auto iter = table->copysets.find(key);
+    if (iter == table->copysets.end()) {
         return false;
     }
 
@@ -526,35 +567,176 @@ bool MetaCache::GetCopysetInfowithCopySetID(
     return true;
 }
 
-bool TryGetPartitionIdByInodeId(const std::vector<PartitionInfo> &plist,
-                                RWLock *lock, uint64_t inodeID,
-                                PartitionID *pid) {
-    ReadLockGuard rl(*lock);
-    for (const auto &it : plist) {
-        if (it.start() <= inodeID && it.end() >= inodeID) {
-            *pid = it.partitionid();
-            return true;
-        }
-    }
-    return false;
-}
-
 bool MetaCache::GetPartitionIdByInodeId(uint32_t fsID, uint64_t inodeID,
                                         PartitionID *pid) {
-    if (!TryGetPartitionIdByInodeId(partitionInfos_, &rwlock4Partitions_,
-                                    inodeID, pid)) {
+    const PartitionInfo *partition = GetRoutingTable()->FindPartition(inodeID);
+    if (partition == nullptr) {
         // list form mds
         if (!ListPartitions(fsID)) {
             LOG(ERROR) << "ListPartitions for {fsid:" << fsID
                        << "} fail, partition list not exist";
             return false;
         }
-        return TryGetPartitionIdByInodeId(partitionInfos_, &rwlock4Partitions_,
-                                          inodeID, pid);
+
+        auto table = GetRoutingTable();
+        partition = table->FindPartition(inodeID);
+        if (partition == nullptr) {
+            return false;
+        }
+        *pid = partition->partitionid();
+        return true;
     }
+
+    *pid = partition->partitionid();
     return true;
 }
 
+bool MetaCache::RefreshAllLeaders() {
+    auto table = GetRoutingTable();
+    std::map<LogicPoolID, std::vector<CopysetID>> lpool2Copyset;
+    for (const auto &item : table->copysets) {
+        lpool2Copyset[static_cast<LogicPoolID>(item.first >> 32)]
+            .emplace_back(static_cast<CopysetID>(item.first & 0xffffffff));
+    }
+
+    bool ok = true;
+    std::vector<std::pair<PoolIDCopysetID, CopysetInfo<MetaserverID>>> updates;
+    for (const auto &item : lpool2Copyset) {
+        std::vector<CopysetInfo<MetaserverID>> cpinfoVec;
+        if (!mdsClient_->GetMetaServerListInCopysets(item.first, item.second,
+                                                     &cpinfoVec)) {
+            LOG(WARNING) << "refresh leaders of copysets in {poolid:"
+                         << item.first << "} fail";
+            ok = false;
+            continue;
+        }
+
+        for (auto &info : cpinfoVec) {
+            // mds do not know the leader yet, keep the cached one
+            if (info.GetCurrentLeaderIndex() < 0) {
+                continue;
+            }
+            const auto key =
+                CalcLogicPoolCopysetID(CopysetGroupID(item.first, info.cpid_));
+            updates.emplace_back(key, std::move(info));
+        }
+    }
+
+    size_t updated = 0;
+    if (!updates.empty()) {
+        UpdateRoutingTable([&](RoutingTable *newTable) {
+            for (auto &item : updates) {
+                // skip copysets dropped by a concurrent reset, and keep the
+                // leaders which are still trusted, mds learns leaders by
+                // heartbeat, so they may be staler than the ones got from
+                // metaserver
+                auto iter = newTable->copysets.find(item.first);
+                if (iter != newTable->copysets.end() &&
+                    !iter->second.HasValidLeader()) {
+                    iter->second = std::move(item.second);
+                    updated++;
+                }
+            }
+        });
+    }
+
+    VLOG(3) << "refresh leaders of " << table->copysets.size()
+            << " copysets in " << lpool2Copyset.size()
+            << " pools, updated = " << updated << ", ok = " << ok;
+    return ok;
+}
+
+void MetaCache::StartBackgroundRefresh() {
+    if (!metacacheopt_.backgroundRefreshLeader ||
+        refreshThread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(refreshMtx_);
+        refreshStop_ = false;
+        needRefresh_ = false;
+    }
+    refreshThread_ = std::thread(&MetaCache::BackgroundRefresh, this);
+    LOG(INFO) << "start background leader refresh, interval = "
+              << metacacheopt_.backgroundRefreshLeaderIntervalMS << "ms";
+}
+
+void MetaCache::StopBackgroundRefresh() {
+    if (!refreshThread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(refreshMtx_);
+        refreshStop_ = true;
+    }
+    refreshCond_.notify_all();
+    refreshThread_.join();
+}
+
+void MetaCache::NotifyLeaderChanged() {
+    if (!metacacheopt_.backgroundRefreshLeader) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(refreshMtx_);
+        needRefresh_ = true;
+    }
+    refreshCond_.notify_one();
+}
+
+void MetaCache::BackgroundRefresh() {
+    const auto interval = std::chrono::milliseconds(
+        metacacheopt_.backgroundRefreshLeaderIntervalMS);
+    std::unique_lock<std::mutex> lk(refreshMtx_);
+    while (!refreshStop_) {
+        refreshCond_.wait(
+            lk, [this]() { return refreshStop_ || needRefresh_; });
+        if (refreshStop_) {
+            break;
+        }
+
+        needRefresh_ = false;
+        lk.unlock();
+        RefreshAllLeaders();
+        lk.lock();
+
+        // leader changes usually come in a burst, merge them into one refresh
+        refreshCond_.wait_for(lk, interval, [this]() { return refreshStop_; });
+    }
+}
+
+void MetaCache::RoutingTable::BuildPartitionIndex() {
+    partitionIndex.clear();
+    partitionIndex.reserve(partitions.size());
+    for (size_t i = 0; i < partitions.size(); i++) {
+        partitionIndex.emplace_back(partitions[i].end(), i);
+    }
+    std::sort(partitionIndex.begin(), partitionIndex.end());
+}
+
+const PartitionInfo *
+MetaCache::RoutingTable::FindPartition(uint64_t inodeID) const {
+    // inode ranges of partitions do not overlap, the first partition whose
+    // end is not less than inodeID is the only candidate
+    auto iter = std::lower_bound(
+        partitionIndex.begin(), partitionIndex.end(), inodeID,
+        [](const std::pair<uint64_t, size_t> &item, uint64_t id) {
+            return item.first < id;
+        });
+    if (iter == partitionIndex.end()) {
+        return nullptr;
+    }
+
+    const PartitionInfo &partition = partitions[iter->second];
+    if (partition.start() > inodeID) {
+        return nullptr;
+    }
+    return &partition;
+}
+
 }  // namespace rpcclient
 }  // namespace client
 }  // namespace curvefs
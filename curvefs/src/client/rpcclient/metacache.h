@@ -26,9 +26,13 @@
 #include <brpc/channel.h>
 #include <brpc/controller.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -110,12 +114,15 @@ inline std::ostream &operator<<(std::ostream &os, const CopysetTarget &t) {
 
 class MetaCache {
  public:
+    virtual ~MetaCache() { StopBackgroundRefresh(); }
+
     void Init(MetaCacheOpt opt, std::shared_ptr<Cli2Client> cli2Client,
               std::shared_ptr<MdsClient> mdsClient) {
         metacacheopt_ = std::move(opt);
         cli2Client_ = std::move(cli2Client);
         mdsClient_ = std::move(mdsClient);
         init_ = false;
+        StartBackgroundRefresh();
     }
 
     using PoolIDCopysetID = uint64_t;
@@ -123,6 +130,23 @@ class MetaCache {
     using CopysetInfoMap =
         std::unordered_map<PoolIDCopysetID, CopysetInfo<MetaserverID>>;
 
+    /**
+     * The routing table is immutable once it is published. Readers take
+     * a snapshot of it without any lock, writers copy the current one,
+     * modify the copy and publish it atomically.
+     */
+    struct RoutingTable {
+        PartitionInfoList partitions;
+        CopysetInfoMap copysets;
+        // (end of inode range, index in partitions), sorted by the end
+        std::vector<std::pair<uint64_t, size_t>> partitionIndex;
+
+        void BuildPartitionIndex();
+
+        const PartitionInfo *FindPartition(uint64_t inodeID) const;
+    };
+    using RoutingTablePtr = std::shared_ptr<const RoutingTable>;
+
     virtual void SetTxId(uint32_t partitionId, uint64_t txId);
 
     virtual bool GetTxId(uint32_t fsId, uint64_t inodeId, uint32_t *partitionId,
@@ -144,6 +168,10 @@ class MetaCache {
 
     virtual bool GetTargetLeader(CopysetTarget *target, bool refresh = false);
 
+    // Replace target's metaserver with a random replica of its copyset,
+    // used by follower read to spread readonly requests
+    virtual bool GetTargetReplica(CopysetTarget *target);
+
     virtual bool GetPartitionIdByInodeId(uint32_t fsID, uint64_t inodeID,
                                          PartitionID *pid);
 
@@ -152,6 +180,15 @@ class MetaCache {
     // list or create partitions for fs
     bool ListPartitions(uint32_t fsID);
 
+    // refresh the leaders of all cached copysets from mds,
+    // one rpc for each logic pool, only copysets whose leader is unknown
+    // or may have changed are updated
+    bool RefreshAllLeaders();
+
+    RoutingTablePtr GetRoutingTable() const {
+        return std::atomic_load(&routingTable_);
+    }
+
  private:
     void GetTxId(uint32_t partitionId, uint64_t *txId);
     bool CreatePartitions(int currentNum, PartitionInfoList *newPartitions);
@@ -163,6 +200,16 @@ class MetaCache {
         std::map<PoolIDCopysetID, CopysetInfo<MetaserverID>> copysetMap,
         bool reset);
 
+    // copy the routing table, modify it by update and publish it
+    template <typename UpdateFunc>
+    void UpdateRoutingTable(const UpdateFunc &update) {
+        std::lock_guard<Mutex> lg(updateMutex_);
+        auto table = std::make_shared<RoutingTable>(*GetRoutingTable());
+        update(table.get());
+        std::atomic_store(&routingTable_,
+                          RoutingTablePtr(std::move(table)));
+    }
+
     // retry policy
     // TODO(@lixiaocui): rpc service may be split to ServiceHelper
     bool UpdateCopysetInfoFromMDS(const CopysetGroupID &groupID,
@@ -173,6 +220,10 @@ class MetaCache {
                                                const PeerAddr &leaderAddr);
 
 
+    // whether partitions are listed long enough ago and should be listed
+    // again, only one caller gets true in one interval
+    bool PartitionsNeedRefresh();
+
     // select a dest parition for inode create
     // TODO(@lixiaocui): select parititon may be need SelectPolicy to support
     // more policies
@@ -185,6 +236,11 @@ class MetaCache {
     bool GetCopysetInfowithCopySetID(const CopysetGroupID &groupID,
                                      CopysetInfo<MetaserverID> *targetInfo);
 
+    // background leader refresh
+    void StartBackgroundRefresh();
+    void StopBackgroundRefresh();
+    void NotifyLeaderChanged();
+    void BackgroundRefresh();
 
     // key tansform
     static PoolIDCopysetID
@@ -197,10 +253,9 @@ class MetaCache {
     RWLock txIdLock_;
     std::unordered_map<uint32_t, uint64_t> partitionTxId_;
 
-    RWLock rwlock4Partitions_;
-    PartitionInfoList partitionInfos_;
-    RWLock rwlock4copysetInfoMap_;
-    CopysetInfoMap copysetInfoMap_;
+    RoutingTablePtr routingTable_ = std::make_shared<RoutingTable>();
+    // serialize the writers of routing table
+    Mutex updateMutex_;
 
     Mutex createMutex_;
 
@@ -210,6 +265,14 @@ class MetaCache {
 
     uint32_t fsID_;
     std::atomic_bool init_;
+    // time of the last successful ListPartitions, in milliseconds
+    std::atomic<uint64_t> lastListPartitionsMs_{0};
+
+    std::thread refreshThread_;
+    std::mutex refreshMtx_;
+    std::condition_variable refreshCond_;
+    bool refreshStop_ = false;
+    bool needRefresh_ = false;
 };
 
 }  // namespace rpcclient
@@ -28,6 +28,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <utility>
 #include <algorithm>
@@ -46,6 +47,8 @@ using curvefs::metaserver::BatchGetInodeAttrRequest;
 using curvefs::metaserver::BatchGetInodeAttrResponse;
 using curvefs::metaserver::BatchGetXAttrRequest;
 using curvefs::metaserver::BatchGetXAttrResponse;
+using curvefs::metaserver::BatchUpdateInodeAttrRequest;
+using curvefs::metaserver::BatchUpdateInodeAttrResponse;
 using curvefs::metaserver::GetOrModifyS3ChunkInfoRequest;
 using curvefs::metaserver::GetOrModifyS3ChunkInfoResponse;
 
@@ -59,6 +62,7 @@ using DeleteDentryExcutor = TaskExecutor;
 using PrepareRenameTxExcutor = TaskExecutor;
 using DeleteInodeExcutor = TaskExecutor;
 using UpdateInodeExcutor = TaskExecutor;
+using BatchUpdateInodeAttrExcutor = TaskExecutor;
 using GetInodeExcutor = TaskExecutor;
 using BatchGetInodeAttrExcutor = TaskExecutor;
 using BatchGetXAttrExcutor = TaskExecutor;
@@ -237,6 +241,134 @@ MetaStatusCode MetaServerClientImpl::ListDentry(uint32_t fsId, uint64_t inodeid,
     return ConvertToMetaStatusCode(excutor.DoRPCTask());
 }
 
+namespace {
+
+// dentries received from stream, the receive callback may still run after
+// StreamListDentry returns on error or timeout, so it's shared with callback
+struct StreamedDentries {
+    std::mutex mtx;
+    std::list<Dentry> dentrys;
+};
+
+struct ParseDentryPageCallBack {
+    explicit ParseDentryPageCallBack(std::shared_ptr<StreamedDentries> streamed)
+        : streamed(std::move(streamed)) {}
+
+    bool operator()(butil::IOBuf *data) const {
+        metaserver::DentryVec page;
+        if (!brpc::ParsePbFromIOBuf(&page, *data)) {
+            LOG(ERROR) << "Failed to parse streamed dentry page";
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lk(streamed->mtx);
+        for (auto &dentry : *page.mutable_dentrys()) {
+            streamed->dentrys.push_back(std::move(dentry));
+        }
+        return true;
+    }
+
+    std::shared_ptr<StreamedDentries> streamed;
+};
+
+}  // namespace
+
+MetaStatusCode MetaServerClientImpl::StreamListDentry(
+    uint32_t fsId, uint64_t inodeid, const std::string &last, uint32_t count,
+    std::list<Dentry> *dentryList, bool *streamed) {
+    auto task = RPCTask {
+        (void)taskExecutorDone;
+        metric_.listDentry.qps.count << 1;
+        LatencyUpdater updater(&metric_.listDentry.latency);
+        ListDentryRequest request;
+        ListDentryResponse response;
+        request.set_poolid(poolID);
+        request.set_copysetid(copysetID);
+        request.set_partitionid(partitionID);
+        request.set_fsid(fsId);
+        request.set_dirinodeid(inodeid);
+        request.set_txid(txId);
+        request.set_last(last);
+        request.set_count(count);
+        request.set_onlydir(false);
+        request.set_streaming(true);
+
+        // pages may arrive before response is handled, so they are kept
+        // apart and appended after the first page, a retry drops them all
+        auto remaining = std::make_shared<StreamedDentries>();
+        std::shared_ptr<StreamConnection> connection;
+        auto closeConn = absl::MakeCleanup([this, &connection]() {
+            if (connection != nullptr) {
+                streamClient_.Close(connection);
+            }
+        });
+        StreamOptions opts(opt_.rpcStreamIdleTimeoutMS);
+        connection = streamClient_.Connect(
+            cntl, ParseDentryPageCallBack{remaining}, opts);
+        if (connection == nullptr) {
+            LOG(ERROR) << "Failed to connection remote side, inodeid: "
+                       << inodeid << ", poolid: " << poolID
+                       << ", copysetid: " << copysetID
+                       << ", remote side: " << cntl->remote_side();
+            return MetaStatusCode::RPC_STREAM_ERROR;
+        }
+
+        curvefs::metaserver::MetaServerService_Stub stub(channel);
+        stub.ListDentry(cntl, &request, &response, nullptr);
+
+        if (cntl->Failed()) {
+            metric_.listDentry.eps.count << 1;
+            LOG(WARNING) << "StreamListDentry Failed, errorcode = "
+                         << cntl->ErrorCode()
+                         << ", error content:" << cntl->ErrorText()
+                         << ", log id = " << cntl->log_id();
+            return -cntl->ErrorCode();
+        }
+
+        MetaStatusCode ret = response.statuscode();
+        if (ret != MetaStatusCode::OK) {
+            metric_.listDentry.eps.count << 1;
+            LOG(WARNING) << "StreamListDentry: fsId = " << fsId
+                         << ", inodeid = " << inodeid << ", last = " << last
+                         << ", count = " << count << ", errcode = " << ret
+                         << ", errmsg = " << MetaStatusCode_Name(ret);
+            return ret;
+        }
+
+        *streamed = response.streaming();
+        if (response.streaming()) {
+            auto status = connection->WaitAllDataReceived();
+            if (status != StreamStatus::STREAM_OK) {
+                LOG(ERROR) << "StreamListDentry failed to receive data"
+                           << ", inodeid = " << inodeid
+                           << ", status = " << status;
+                return MetaStatusCode::RPC_STREAM_ERROR;
+            }
+        }
+
+        for (auto &dentry : *response.mutable_dentrys()) {
+            dentryList->push_back(std::move(dentry));
+        }
+        {
+            std::lock_guard<std::mutex> lk(remaining->mtx);
+            dentryList->splice(dentryList->end(), remaining->dentrys);
+        }
+
+        VLOG(6) << "StreamListDentry done, fsId = " << fsId
+                << ", inodeid = " << inodeid << ", last = " << last
+                << ", streamed = " << *streamed
+                << ", size = " << dentryList->size();
+        return ret;
+    };
+
+    auto taskCtx = std::make_shared<TaskContext>(MetaServerOpType::ListDentry,
+                                                 task, fsId, inodeid, true,
+                                                 opt_.enableRenameParallel);
+    ListDentryExcutor excutor(opt_, metaCache_, channelManager_,
+                              std::move(taskCtx));
+    return ConvertToMetaStatusCode(excutor.DoRPCTask());
+}
+
 MetaStatusCode MetaServerClientImpl::CreateDentry(const Dentry &dentry) {
     auto task = RPCTask {
         (void)taskExecutorDone;
@@ -403,6 +535,21 @@ MetaServerClientImpl::PrepareRenameTx(const std::vector<Dentry> &dentrys) {
 
 MetaStatusCode MetaServerClientImpl::GetInode(uint32_t fsId, uint64_t inodeid,
                                               Inode *out, bool *streaming) {
+    return DoGetInode(fsId, inodeid, /*skipS3ChunkInfo=*/false, out,
+                      streaming);
+}
+
+MetaStatusCode MetaServerClientImpl::GetInodeWithoutS3ChunkInfo(
+    uint32_t fsId, uint64_t inodeid, Inode *out) {
+    bool streaming = false;
+    return DoGetInode(fsId, inodeid, /*skipS3ChunkInfo=*/true, out,
+                      &streaming);
+}
+
+MetaStatusCode MetaServerClientImpl::DoGetInode(uint32_t fsId,
+                                                uint64_t inodeid,
+                                                bool skipS3ChunkInfo,
+                                                Inode *out, bool *streaming) {
     auto task = RPCTask {
         (void)txId;
         (void)taskExecutorDone;
@@ -416,6 +563,9 @@ MetaStatusCode MetaServerClientImpl::GetInode(uint32_t fsId, uint64_t inodeid,
         request.set_fsid(fsId);
         request.set_inodeid(inodeid);
         request.set_supportstreaming(true);
+        if (skipS3ChunkInfo) {
+            request.set_skips3chunkinfo(true);
+        }
 
         curvefs::metaserver::MetaServerService_Stub stub(channel);
         stub.GetInode(cntl, &request, &response, nullptr);
@@ -918,6 +1068,180 @@ void MetaServerClientImpl::UpdateInodeWithOutNlinkAsync(
     UpdateInodeAsync(request, done);
 }
 
+void UpdateInodeBatch::Add(uint32_t fsId, uint64_t inodeId,
+                           const InodeAttr &attr, MetaServerClientDone *done,
+                           DataIndices &&indices) {
+    UpdateInodeRequest request;
+    FillInodeAttr(fsId, inodeId, attr, /*nlink=*/false, &request);
+    FillDataIndices(std::move(indices), &request);
+    requests_.emplace_back(std::move(request));
+    dones_.emplace_back(done);
+}
+
+namespace {
+
+// Dispatch the status of each update to its own done
+class BatchUpdateInodeAttrDone : public MetaServerClientDone {
+ public:
+    explicit BatchUpdateInodeAttrDone(
+        std::vector<MetaServerClientDone *> &&dones)
+        : dones_(std::move(dones)) {}
+
+    void SetUpdateStatus(
+        const google::protobuf::RepeatedField<int> &status) {
+        status_.assign(status.begin(), status.end());
+    }
+
+    void Run() override {
+        std::unique_ptr<BatchUpdateInodeAttrDone> self_guard(this);
+        MetaStatusCode ret = GetStatusCode();
+        for (size_t i = 0; i < dones_.size(); i++) {
+            if (dones_[i] == nullptr) {
+                continue;
+            }
+            MetaStatusCode status = ret;
+            if (ret == MetaStatusCode::OK && i < status_.size()) {
+                status = static_cast<MetaStatusCode>(status_[i]);
+            }
+            dones_[i]->SetMetaStatusCode(status);
+            dones_[i]->Run();
+        }
+    }
+
+ private:
+    std::vector<MetaServerClientDone *> dones_;
+    std::vector<int> status_;
+};
+
+}  // namespace
+
+class BatchUpdateInodeAttrRpcDone : public MetaServerClientRpcDoneBase {
+ public:
+    using MetaServerClientRpcDoneBase::MetaServerClientRpcDoneBase;
+
+    void Run() override;
+    BatchUpdateInodeAttrResponse response;
+};
+
+void BatchUpdateInodeAttrRpcDone::Run() {
+    std::unique_ptr<BatchUpdateInodeAttrRpcDone> self_guard(this);
+    brpc::ClosureGuard done_guard(done_);
+    auto taskCtx = done_->GetTaskExcutor()->GetTaskCxt();
+    auto &cntl = taskCtx->cntl_;
+    if (cntl.Failed()) {
+        metric_->batchUpdateInodeAttr.eps.count << 1;
+        LOG(WARNING) << "BatchUpdateInodeAttr Failed, errorcode = "
+                     << cntl.ErrorCode()
+                     << ", error content: " << cntl.ErrorText()
+                     << ", log id: " << cntl.log_id();
+        done_->SetRetCode(-cntl.ErrorCode());
+        return;
+    }
+    metric_->batchUpdateInodeAttr.latency << cntl.latency_us();
+
+    MetaStatusCode ret = response.statuscode();
+    if (ret != MetaStatusCode::OK) {
+        LOG(WARNING) << "BatchUpdateInodeAttr failed"
+                     << ", errcode = " << ret
+                     << ", errmsg = " << MetaStatusCode_Name(ret);
+    } else {
+        dynamic_cast<BatchUpdateInodeAttrDone *>(done_->GetDone())
+            ->SetUpdateStatus(response.updatestatus());
+    }
+
+    VLOG(6) << "BatchUpdateInodeAttr done, "
+            << "response: " << response.ShortDebugString();
+    done_->SetRetCode(ret);
+}
+
+void MetaServerClientImpl::BatchUpdateInodeAttrAsync(UpdateInodeBatch *batch) {
+    auto &requests = batch->requests_;
+    auto &dones = batch->dones_;
+
+    // group updates by partition, the update whose partition is unknown
+    // is sent alone
+    std::unordered_map<uint32_t, std::vector<size_t>> groups;
+    for (size_t i = 0; i < requests.size(); i++) {
+        uint32_t partitionId = 0;
+        if (!metaCache_->GetPartitionIdByInodeId(
+                requests[i].fsid(), requests[i].inodeid(), &partitionId)) {
+            UpdateInodeAsync(requests[i], dones[i]);
+            continue;
+        }
+        groups[partitionId].emplace_back(i);
+    }
+
+    uint32_t batchLimit = std::max(opt_.batchInodeAttrLimit, 1U);
+    for (const auto &group : groups) {
+        const auto &indexes = group.second;
+        for (size_t begin = 0; begin < indexes.size(); begin += batchLimit) {
+            size_t end = std::min<size_t>(indexes.size(), begin + batchLimit);
+            if (end - begin == 1) {
+                UpdateInodeAsync(requests[indexes[begin]],
+                                 dones[indexes[begin]]);
+                continue;
+            }
+
+            std::vector<UpdateInodeRequest> updates;
+            std::vector<MetaServerClientDone *> updateDones;
+            updates.reserve(end - begin);
+            updateDones.reserve(end - begin);
+            for (size_t i = begin; i < end; i++) {
+                updates.emplace_back(std::move(requests[indexes[i]]));
+                updateDones.emplace_back(dones[indexes[i]]);
+            }
+            BatchUpdateInodeAttrAsync(std::move(updates),
+                                      std::move(updateDones));
+        }
+    }
+
+    requests.clear();
+    dones.clear();
+}
+
+void MetaServerClientImpl::BatchUpdateInodeAttrAsync(
+    std::vector<UpdateInodeRequest> &&updates,
+    std::vector<MetaServerClientDone *> &&dones) {
+    uint32_t fsId = updates.front().fsid();
+    uint64_t inodeId = updates.front().inodeid();
+    metric_.batchUpdateInodeAttrSize << updates.size();
+
+    auto task = AsyncRPCTask {
+        (void)txId;
+        metric_.batchUpdateInodeAttr.qps.count << 1;
+        BatchUpdateInodeAttrRequest request;
+        request.set_poolid(poolID);
+        request.set_copysetid(copysetID);
+        request.set_partitionid(partitionID);
+        request.set_fsid(fsId);
+        for (const auto &update : updates) {
+            UpdateInodeRequest *req = request.add_update();
+            *req = update;
+            req->set_poolid(poolID);
+            req->set_copysetid(copysetID);
+            req->set_partitionid(partitionID);
+        }
+        VLOG(9) << "batch update inode attr async, fsId: " << fsId
+                << ", partitionId: " << partitionID
+                << ", size: " << request.update_size();
+
+        auto *rpcDone =
+            new BatchUpdateInodeAttrRpcDone(taskExecutorDone, &metric_);
+        curvefs::metaserver::MetaServerService_Stub stub(channel);
+        stub.BatchUpdateInodeAttr(cntl, &request, &rpcDone->response,
+                                  rpcDone);
+        return MetaStatusCode::OK;
+    };
+
+    auto taskCtx = std::make_shared<TaskContext>(
+        MetaServerOpType::BatchUpdateInodeAttr, task, fsId, inodeId);
+    auto excutor = std::make_shared<BatchUpdateInodeAttrExcutor>(
+        opt_, metaCache_, channelManager_, std::move(taskCtx));
+    TaskExecutorDone *taskDone = new TaskExecutorDone(
+        excutor, new BatchUpdateInodeAttrDone(std::move(dones)));
+    excutor->DoAsyncRPCTask(taskDone);
+}
+
 bool MetaServerClientImpl::ParseS3MetaStreamBuffer(butil::IOBuf *buffer,
                                                    uint64_t *chunkIndex,
                                                    S3ChunkInfoList *list) {
@@ -966,6 +1290,25 @@ MetaStatusCode MetaServerClientImpl::GetOrModifyS3ChunkInfo(
     const google::protobuf::Map<uint64_t, S3ChunkInfoList> &s3ChunkInfos,
     bool returnS3ChunkInfoMap,
     google::protobuf::Map<uint64_t, S3ChunkInfoList> *out, bool internal) {
+    return DoGetOrModifyS3ChunkInfo(fsId, inodeId, s3ChunkInfos,
+                                    returnS3ChunkInfoMap, {}, out, internal);
+}
+
+MetaStatusCode MetaServerClientImpl::GetS3ChunkInfoByIndexes(
+    uint32_t fsId, uint64_t inodeId,
+    const google::protobuf::Map<uint64_t, S3ChunkInfoList> &s3ChunkInfos,
+    const std::vector<uint64_t> &chunkIndexes,
+    google::protobuf::Map<uint64_t, S3ChunkInfoList> *out) {
+    return DoGetOrModifyS3ChunkInfo(fsId, inodeId, s3ChunkInfos, true,
+                                    chunkIndexes, out, false);
+}
+
+MetaStatusCode MetaServerClientImpl::DoGetOrModifyS3ChunkInfo(
+    uint32_t fsId, uint64_t inodeId,
+    const google::protobuf::Map<uint64_t, S3ChunkInfoList> &s3ChunkInfos,
+    bool returnS3ChunkInfoMap,
+    const std::vector<uint64_t> &chunkIndexes,
+    google::protobuf::Map<uint64_t, S3ChunkInfoList> *out, bool internal) {
     auto task = RPCTask {
         (void)txId;
         (void)taskExecutorDone;
@@ -981,6 +1324,9 @@ MetaStatusCode MetaServerClientImpl::GetOrModifyS3ChunkInfo(
         request.set_returns3chunkinfomap(returnS3ChunkInfoMap);
         *(request.mutable_s3chunkinfoadd()) = s3ChunkInfos;
         request.set_supportstreaming(true);
+        for (const auto &chunkIndex : chunkIndexes) {
+            request.add_chunkindexes(chunkIndex);
+        }
 
         curvefs::metaserver::MetaServerService_Stub stub(channel);
 
@@ -70,6 +70,27 @@ struct DataIndices {
     absl::optional<VolumeExtentSliceList> volumeExtents;
 };
 
+// Inode updates collected for MetaServerClient::BatchUpdateInodeAttrAsync(),
+// updates which belong to the same partition are sent by one rpc.
+class UpdateInodeBatch {
+ public:
+    void Add(uint32_t fsId,
+             uint64_t inodeId,
+             const InodeAttr& attr,
+             MetaServerClientDone* done,
+             DataIndices&& indices = {});
+
+    bool Empty() const { return requests_.empty(); }
+
+    size_t Size() const { return requests_.size(); }
+
+ private:
+    friend class MetaServerClientImpl;
+
+    std::vector<UpdateInodeRequest> requests_;
+    std::vector<MetaServerClientDone*> dones_;
+};
+
 class MetaServerClient {
  public:
     virtual ~MetaServerClient() = default;
@@ -92,6 +113,16 @@ class MetaServerClient {
                                       bool onlyDir,
                                       std::list<Dentry> *dentryList) = 0;
 
+    // List all dentries after |last|, the first |count| entries are returned
+    // in response and remaining ones are sent by stream in pages of |count|.
+    // |streamed| is false if server doesn't support streaming, in which case
+    // only the first page is returned.
+    virtual MetaStatusCode StreamListDentry(uint32_t fsId, uint64_t inodeid,
+                                            const std::string &last,
+                                            uint32_t count,
+                                            std::list<Dentry> *dentryList,
+                                            bool *streamed) = 0;
+
     virtual MetaStatusCode CreateDentry(const Dentry &dentry) = 0;
 
     virtual MetaStatusCode DeleteDentry(uint32_t fsId, uint64_t inodeid,
@@ -104,6 +135,12 @@ class MetaServerClient {
     virtual MetaStatusCode GetInode(uint32_t fsId, uint64_t inodeid,
                                     Inode *out, bool* streaming) = 0;
 
+    // Get inode without its s3chunkinfo map, which can be loaded on demand
+    // by GetS3ChunkInfoByIndexes().
+    virtual MetaStatusCode GetInodeWithoutS3ChunkInfo(uint32_t fsId,
+                                                      uint64_t inodeid,
+                                                      Inode *out) = 0;
+
     virtual MetaStatusCode GetInodeAttr(uint32_t fsId, uint64_t inodeid,
                                         InodeAttr *attr) = 0;
 
@@ -137,6 +174,10 @@ class MetaServerClient {
         MetaServerClientDone* done,
         DataIndices&& indices = {}) = 0;
 
+    // Send all updates in |batch| asynchronously and clear it, the done of
+    // each update is invoked with its own status.
+    virtual void BatchUpdateInodeAttrAsync(UpdateInodeBatch* batch) = 0;
+
     virtual MetaStatusCode GetOrModifyS3ChunkInfo(
         uint32_t fsId, uint64_t inodeId,
         const google::protobuf::Map<
@@ -152,6 +193,15 @@ class MetaServerClient {
             uint64_t, S3ChunkInfoList> &s3ChunkInfos,
         MetaServerClientDone *done) = 0;
 
+    // Append |s3ChunkInfos| and receive s3chunkinfo lists of |chunkIndexes|
+    // by streaming.
+    virtual MetaStatusCode GetS3ChunkInfoByIndexes(
+        uint32_t fsId, uint64_t inodeId,
+        const google::protobuf::Map<
+            uint64_t, S3ChunkInfoList> &s3ChunkInfos,
+        const std::vector<uint64_t> &chunkIndexes,
+        google::protobuf::Map<uint64_t, S3ChunkInfoList> *out) = 0;
+
     virtual MetaStatusCode CreateInode(const InodeParam &param, Inode *out) = 0;
 
     virtual MetaStatusCode CreateManageInode(const InodeParam &param,
@@ -200,6 +250,11 @@ class MetaServerClientImpl : public MetaServerClient {
                               bool onlyDir,
                               std::list<Dentry> *dentryList) override;
 
+    MetaStatusCode StreamListDentry(uint32_t fsId, uint64_t inodeid,
+                                    const std::string &last, uint32_t count,
+                                    std::list<Dentry> *dentryList,
+                                    bool *streamed) override;
+
     MetaStatusCode CreateDentry(const Dentry &dentry) override;
 
     MetaStatusCode DeleteDentry(uint32_t fsId, uint64_t inodeid,
@@ -211,6 +266,10 @@ class MetaServerClientImpl : public MetaServerClient {
     MetaStatusCode GetInode(uint32_t fsId, uint64_t inodeid,
                             Inode *out, bool* streaming) override;
 
+    MetaStatusCode GetInodeWithoutS3ChunkInfo(uint32_t fsId,
+                                              uint64_t inodeid,
+                                              Inode *out) override;
+
     MetaStatusCode GetInodeAttr(uint32_t fsId, uint64_t inodeid,
                                 InodeAttr *attr) override;
 
@@ -245,6 +304,8 @@ class MetaServerClientImpl : public MetaServerClient {
         MetaServerClientDone* done,
         DataIndices&& indices = {}) override;
 
+    void BatchUpdateInodeAttrAsync(UpdateInodeBatch* batch) override;
+
     MetaStatusCode GetOrModifyS3ChunkInfo(
         uint32_t fsId, uint64_t inodeId,
         const google::protobuf::Map<
@@ -260,6 +321,13 @@ class MetaServerClientImpl : public MetaServerClient {
             uint64_t, S3ChunkInfoList> &s3ChunkInfos,
         MetaServerClientDone *done) override;
 
+    MetaStatusCode GetS3ChunkInfoByIndexes(
+        uint32_t fsId, uint64_t inodeId,
+        const google::protobuf::Map<
+            uint64_t, S3ChunkInfoList> &s3ChunkInfos,
+        const std::vector<uint64_t> &chunkIndexes,
+        google::protobuf::Map<uint64_t, S3ChunkInfoList> *out) override;
+
     MetaStatusCode CreateInode(const InodeParam &param, Inode *out) override;
 
     MetaStatusCode CreateManageInode(const InodeParam &param,
@@ -286,12 +354,28 @@ class MetaServerClientImpl : public MetaServerClient {
         DeallocatableBlockGroupMap *statistic) override;
 
  private:
+    MetaStatusCode DoGetInode(uint32_t fsId, uint64_t inodeid,
+                              bool skipS3ChunkInfo, Inode *out,
+                              bool *streaming);
+
+    MetaStatusCode DoGetOrModifyS3ChunkInfo(
+        uint32_t fsId, uint64_t inodeId,
+        const google::protobuf::Map<uint64_t, S3ChunkInfoList> &s3ChunkInfos,
+        bool returnS3ChunkInfoMap,
+        const std::vector<uint64_t> &chunkIndexes,
+        google::protobuf::Map<uint64_t, S3ChunkInfoList> *out,
+        bool internal);
+
     MetaStatusCode UpdateInode(const UpdateInodeRequest &request,
                                bool internal = false);
 
     void UpdateInodeAsync(const UpdateInodeRequest &request,
                           MetaServerClientDone *done);
 
+    // REQUIRES: all updates belong to the same partition
+    void BatchUpdateInodeAttrAsync(std::vector<UpdateInodeRequest> &&updates,
+                                   std::vector<MetaServerClientDone *> &&dones);
+
     bool ParseS3MetaStreamBuffer(butil::IOBuf* buffer,
                                  uint64_t* chunkIndex,
                                  S3ChunkInfoList* list);
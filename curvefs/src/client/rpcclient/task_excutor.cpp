@@ -36,6 +36,24 @@ namespace curvefs {
 namespace client {
 namespace rpcclient {
 
+namespace {
+
+bool IsReadOnlyOperator(MetaServerOpType optype) {
+    switch (optype) {
+        case MetaServerOpType::GetDentry:
+        case MetaServerOpType::ListDentry:
+        case MetaServerOpType::GetInode:
+        case MetaServerOpType::BatchGetInodeAttr:
+        case MetaServerOpType::BatchGetXAttr:
+        case MetaServerOpType::GetVolumeExtent:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
 MetaStatusCode ConvertToMetaStatusCode(int retcode) {
     if (retcode < 0) {
         return MetaStatusCode::RPC_ERROR;
@@ -225,6 +243,11 @@ bool TaskExecutor::GetTarget() {
         LOG(ERROR) << "fetch target for task fail, " << task_->TaskContextStr();
         return false;
     }
+
+    // spread readonly requests among all replicas
+    if (opt_.enableFollowerRead && IsReadOnlyOperator(task_->optype)) {
+        task_->followerRead = metaCache_->GetTargetReplica(&task_->target);
+    }
     return true;
 }
 
@@ -246,11 +269,22 @@ bool TaskExecutor::OnPartitionNotExist() {
     return metaCache_->ListPartitions(task_->fsID);
 }
 
-void TaskExecutor::OnReDirected() { RefreshLeader(); }
+void TaskExecutor::OnReDirected() {
+    // follower can't serve the read request now, fall back to leader
+    if (task_->followerRead) {
+        task_->followerRead = false;
+        task_->retryDirectly =
+            metaCache_->GetTargetLeader(&task_->target, false);
+        return;
+    }
+
+    RefreshLeader();
+}
 
 void TaskExecutor::RefreshLeader() {
     // refresh leader according to copyset
     MetaserverID oldTarget = task_->target.metaServerID;
+    task_->followerRead = false;
 
     bool ok =
         metaCache_->GetTargetLeader(&task_->target, true);
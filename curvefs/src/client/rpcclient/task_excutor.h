@@ -107,6 +107,9 @@ class TaskContext {
 
     bool refreshTxId = false;
 
+    // whether target is a replica selected for follower read
+    bool followerRead = false;
+
     brpc::Controller cntl_;
 };
 
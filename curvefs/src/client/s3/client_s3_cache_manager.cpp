@@ -372,6 +372,19 @@ int FileCacheManager::GenerateKVRequest(
     std::vector<S3ReadRequest> *kvRequest) {
 
     ::curve::common::UniqueLock lgGuard = inodeWrapper->GetUniqueLock();
+    if (inodeWrapper->IsLazyLoadS3ChunkInfo()) {
+        std::set<uint64_t> chunkIndexes;
+        for (const auto &req : readRequest) {
+            chunkIndexes.insert(req.index);
+        }
+        CURVEFS_ERROR rc = inodeWrapper->LoadS3ChunkInfoLocked(chunkIndexes);
+        if (rc != CURVEFS_ERROR::OK) {
+            LOG(ERROR) << "load s3chunkinfo of inode = "
+                       << inodeWrapper->GetInodeId() << " fail, rc = " << rc;
+            return -1;
+        }
+    }
+
     const Inode *inode = inodeWrapper->GetInodeLocked();
     const auto *s3chunkinfo = inodeWrapper->GetChunkInfoMap();
     VLOG(9) << "process inode: " << inode->DebugString();
@@ -451,8 +464,10 @@ int FileCacheManager::Read(uint64_t inodeId, uint64_t offset, uint64_t length,
     do {
         // generate kv request
         std::vector<S3ReadRequest> kvRequests;
-        GenerateKVRequest(inodeWrapper, memCacheMissRequest, dataBuf,
-                          &kvRequests);
+        if (0 != GenerateKVRequest(inodeWrapper, memCacheMissRequest, dataBuf,
+                                   &kvRequests)) {
+            return -1;
+        }
 
         // read from kv cluster (localcache -> remote kv cluster -> s3)
         // localcache/remote kv cluster fail will not return error code.
@@ -504,15 +519,13 @@ bool FileCacheManager::ReadKVRequestFromLocalCache(const std::string &name,
     return true;
 }
 
-bool FileCacheManager::ReadKVRequestFromRemoteCache(const std::string &name,
-                                                    char *databuf,
-                                                    uint64_t offset,
-                                                    uint64_t length) {
-    if (!kvClientManager_) {
-        return false;
+void FileCacheManager::ReadKVRequestFromRemoteCache(
+    std::vector<KVBlockRead *> *blocks) {
+    if (!kvClientManager_ || blocks->empty()) {
+        return;
     }
 
-    CountDownEvent event(1);
+    CountDownEvent event(blocks->size());
     GetKVCacheDone cb = [&](const std::shared_ptr<GetKVCacheTask>& task) {
         if (task->res && s3ClientAdaptor_->s3Metric_ != nullptr) {
             metric::CollectMetrics(
@@ -523,12 +536,26 @@ bool FileCacheManager::ReadKVRequestFromRemoteCache(const std::string &name,
         return;
     };
 
-    auto task =
-        std::make_shared<GetKVCacheTask>(name, databuf, offset, length, cb);
-    kvClientManager_->Get(task);
+    std::vector<std::shared_ptr<GetKVCacheTask>> tasks;
+    tasks.reserve(blocks->size());
+    for (auto *block : *blocks) {
+        tasks.emplace_back(std::make_shared<GetKVCacheTask>(
+            block->name, block->buf, block->offset, block->len, cb));
+    }
+    kvClientManager_->BatchGet(tasks);
     event.Wait();
 
-    return task->res;
+    // only keep the blocks which are not in remote cache
+    std::vector<KVBlockRead *> misses;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (tasks[i]->res) {
+            VLOG(9) << "read " << (*blocks)[i]->name
+                    << " from remote cache ok";
+        } else {
+            misses.emplace_back((*blocks)[i]);
+        }
+    }
+    blocks->swap(misses);
 }
 
 bool FileCacheManager::ReadKVRequestFromS3(const std::string &name,
@@ -560,8 +587,10 @@ FileCacheManager::ReadKVRequest(const std::vector<S3ReadRequest> &kvRequests,
     std::atomic<bool> isCanceled{false};
     std::atomic<int> retCode{0};
 
+    std::vector<curve::common::Task> tasks;
+    tasks.reserve(kvRequests.size());
     for (const auto &req : kvRequests) {
-        readTaskPool_->Enqueue([&]() {
+        tasks.emplace_back([&]() {
             auto defer = absl::MakeCleanup([&]() { counter.DecrementCount(); });
             if (isCanceled) {
                 LOG(WARNING) << "kv request is canceled " << req.DebugString();
@@ -571,6 +600,7 @@ FileCacheManager::ReadKVRequest(const std::vector<S3ReadRequest> &kvRequests,
                              retCode);
         });
     }
+    readTaskPool_->EnqueueBatch(std::move(tasks));
 
     counter.Wait();
     return toReadStatus(retCode.load());
@@ -607,47 +637,22 @@ void FileCacheManager::ProcessKVRequest(const S3ReadRequest &req, char *dataBuf,
     uint64_t currentReadLen = 0;
     uint64_t readBufOffset = 0;
     uint64_t objectOffset = req.objectOffset;
+    const uint64_t firstBlockIndex = blockIndex;
 
+    // split the request into blocks
+    std::vector<KVBlockRead> blocks;
     while (length > 0) {
         currentReadLen =
             length + blockPos > blockSize ? blockSize - blockPos : length;
         assert(blockPos >= objectOffset);
-        std::string name = curvefs::common::s3util::GenObjName(
+        KVBlockRead block;
+        block.name = curvefs::common::s3util::GenObjName(
             req.chunkId, blockIndex, req.compaction, req.fsId, req.inodeId,
             objectPrefix);
-        char *currentBuf = dataBuf + req.readOffset + readBufOffset;
-
-        // read from localcache -> remotecache -> s3
-        do {
-            if (ReadKVRequestFromLocalCache(name, currentBuf,
-                                            blockPos - objectOffset,
-                                            currentReadLen)) {
-                VLOG(9) << "read " << name << " from local cache ok";
-                break;
-            }
-
-            if (ReadKVRequestFromRemoteCache(name, currentBuf,
-                                             blockPos - objectOffset,
-                                             currentReadLen)) {
-                VLOG(9) << "read " << name << " from remote cache ok";
-                break;
-            }
-
-            int ret = 0;
-            if (ReadKVRequestFromS3(name, currentBuf, blockPos - objectOffset,
-                                    currentReadLen, &ret)) {
-                VLOG(9) << "read " << name << " from s3 ok";
-                break;
-            }
-
-            LOG(ERROR) << "read " << name << " fail";
-            // make sure variable is set only once
-            std::call_once(cancelFlag, [&]() {
-                isCanceled.store(true);
-                retCode.store(ret);
-            });
-            return;
-        } while (false);
+        block.buf = dataBuf + req.readOffset + readBufOffset;
+        block.offset = blockPos - objectOffset;
+        block.len = currentReadLen;
+        blocks.emplace_back(std::move(block));
 
         // update param
         {
@@ -658,6 +663,39 @@ void FileCacheManager::ProcessKVRequest(const S3ReadRequest &req, char *dataBuf,
             objectOffset = 0;
         }
     }
+    VLOG(9) << "read " << blocks.size() << " blocks start from block "
+            << firstBlockIndex;
+
+    // read from localcache -> remotecache -> s3
+    std::vector<KVBlockRead *> misses;
+    for (auto &block : blocks) {
+        if (ReadKVRequestFromLocalCache(block.name, block.buf, block.offset,
+                                        block.len)) {
+            VLOG(9) << "read " << block.name << " from local cache ok";
+            continue;
+        }
+        misses.emplace_back(&block);
+    }
+
+    // the blocks missed in local cache are read from remote cache together
+    ReadKVRequestFromRemoteCache(&misses);
+
+    for (auto *block : misses) {
+        int ret = 0;
+        if (ReadKVRequestFromS3(block->name, block->buf, block->offset,
+                                block->len, &ret)) {
+            VLOG(9) << "read " << block->name << " from s3 ok";
+            continue;
+        }
+
+        LOG(ERROR) << "read " << block->name << " fail";
+        // make sure variable is set only once
+        std::call_once(cancelFlag, [&]() {
+            isCanceled.store(true);
+            retCode.store(ret);
+        });
+        return;
+    }
 
     // add data to memory read cache
     if (!curvefs::client::common::FLAGS_enableCto) {
@@ -2472,8 +2510,8 @@ void DataCache::FlushTaskExecute(
         std::for_each(kvCacheTasks.begin(), kvCacheTasks.end(),
                       [&](const std::shared_ptr<SetKVCacheTask> &task) {
                           task->done = kvdone;
-                          kvClientManager_->Set(task);
                       });
+        kvClientManager_->BatchSet(kvCacheTasks);
         kvTaskEvent.Wait();
     }
 
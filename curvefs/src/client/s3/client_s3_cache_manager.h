@@ -37,13 +37,14 @@
 #include "curvefs/src/client/filesystem/error.h"
 #include "curvefs/src/client/s3/client_s3.h"
 #include "src/common/concurrent/concurrent.h"
-#include "src/common/concurrent/task_thread_pool.h"
+#include "src/common/concurrent/work_stealing_thread_pool.h"
 #include "curvefs/src/client/kvclient/kvclient_manager.h"
 #include "curvefs/src/client/inode_wrapper.h"
 
 using curve::common::ReadLockGuard;
 using curve::common::RWLock;
 using curve::common::WriteLockGuard;
+using curve::common::WorkStealingThreadPool;
 
 namespace curvefs {
 namespace client {
@@ -333,7 +334,7 @@ class FileCacheManager {
     FileCacheManager(uint32_t fsid, uint64_t inode,
                      S3ClientAdaptorImpl *s3ClientAdaptor,
                      std::shared_ptr<KVClientManager> kvClientManager,
-                     std::shared_ptr<TaskThreadPool<>> threadPool)
+                     std::shared_ptr<WorkStealingThreadPool<>> threadPool)
         : fsId_(fsid), inode_(inode), s3ClientAdaptor_(s3ClientAdaptor),
           kvClientManager_(std::move(kvClientManager)),
           readTaskPool_(threadPool) {}
@@ -437,9 +438,17 @@ class FileCacheManager {
     bool ReadKVRequestFromLocalCache(const std::string &name, char *databuf,
                                      uint64_t offset, uint64_t len);
 
-    // read kv request from remote cache like memcached
-    bool ReadKVRequestFromRemoteCache(const std::string &name, char *databuf,
-                                      uint64_t offset, uint64_t length);
+    // a block of the kv request
+    struct KVBlockRead {
+        std::string name;
+        char *buf;
+        uint64_t offset;
+        uint64_t len;
+    };
+
+    // read kv request from remote cache like memcached in one batch,
+    // the blocks read successfully are removed from blocks
+    void ReadKVRequestFromRemoteCache(std::vector<KVBlockRead *> *blocks);
 
     // read kv request from s3
     bool ReadKVRequestFromS3(const std::string &name, char *databuf,
@@ -467,7 +476,7 @@ class FileCacheManager {
     std::set<std::string> downloadingObj_;
 
     std::shared_ptr<KVClientManager> kvClientManager_;
-    std::shared_ptr<TaskThreadPool<>> readTaskPool_;
+    std::shared_ptr<WorkStealingThreadPool<>> readTaskPool_;
 };
 
 class FsCacheManager {
@@ -475,12 +484,15 @@ class FsCacheManager {
     FsCacheManager(S3ClientAdaptorImpl *s3ClientAdaptor,
                    uint64_t readCacheMaxByte, uint64_t writeCacheMaxByte,
                    uint32_t readCacheThreads,
-                   std::shared_ptr<KVClientManager> kvClientManager)
+                   std::shared_ptr<KVClientManager> kvClientManager,
+                   const std::vector<int>& readCacheCpus = {})
         : lruByte_(0), wDataCacheNum_(0), wDataCacheByte_(0),
           readCacheMaxByte_(readCacheMaxByte),
           writeCacheMaxByte_(writeCacheMaxByte),
           s3ClientAdaptor_(s3ClientAdaptor), isWaiting_(false),
           kvClientManager_(std::move(kvClientManager)) {
+        readTaskPool_->ExposeMetric("fs_cache_manager_read_task_pool");
+        readTaskPool_->SetCpuAffinity(readCacheCpus);
         readTaskPool_->Start(readCacheThreads);
     }
     FsCacheManager() = default;
@@ -594,8 +606,8 @@ class FsCacheManager {
 
     std::shared_ptr<KVClientManager> kvClientManager_;
 
-    std::shared_ptr<TaskThreadPool<>> readTaskPool_ =
-        std::make_shared<TaskThreadPool<>>();
+    std::shared_ptr<WorkStealingThreadPool<>> readTaskPool_ =
+        std::make_shared<WorkStealingThreadPool<>>();
 };
 
 }  // namespace client
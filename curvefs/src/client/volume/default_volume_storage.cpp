@@ -25,6 +25,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include <map>
 #include <sstream>
 #include <type_traits>
 #include <vector>
@@ -45,6 +46,7 @@ DECLARE_bool(enableCto);
 }  // namespace common
 
 using ::curvefs::common::LatencyUpdater;
+using ::curvefs::volume::Extent;
 
 namespace {
 
@@ -199,12 +201,46 @@ CURVEFS_ERROR DefaultVolumeStorage::Flush(uint64_t ino) {
     }
 
     auto lk = inodeWrapper->GetUniqueLock();
+
+    // space reserved for sequential writes but not used is given back at
+    // close, after extents without it are persisted
+    auto* extentCache = inodeWrapper->GetMutableExtentCacheLocked();
+    std::map<uint64_t, PExtent> trimmed;
+    extentCache->TrimUnwritten(inodeWrapper->GetLengthLocked(), &trimmed);
+
     ret = inodeWrapper->Sync();
-    LOG_IF(ERROR, ret != CURVEFS_ERROR::OK)
-        << "Flush sync inode error, ino: " << ino << ", error: " << ret;
+    if (ret != CURVEFS_ERROR::OK) {
+        LOG(ERROR) << "Flush sync inode error, ino: " << ino
+                   << ", error: " << ret;
+        RestoreTrimmedExtents(trimmed, extentCache);
+        return ret;
+    }
+
+    if (!trimmed.empty()) {
+        std::vector<Extent> unused;
+        unused.reserve(trimmed.size());
+        for (const auto& ext : trimmed) {
+            unused.emplace_back(ext.second.pOffset, ext.second.len);
+        }
+
+        // extents are kept by the cache if they can't be given back
+        if (!spaceManager_->Free(unused)) {
+            LOG(WARNING) << "Free unused space failed, ino: " << ino;
+            RestoreTrimmedExtents(trimmed, extentCache);
+        }
+    }
+
     return ret;
 }
 
+void DefaultVolumeStorage::RestoreTrimmedExtents(
+    const std::map<uint64_t, PExtent>& trimmed,
+    ExtentCache* extentCache) {
+    for (const auto& ext : trimmed) {
+        extentCache->Merge(ext.first, ext.second);
+    }
+}
+
 bool DefaultVolumeStorage::Shutdown() {
     return true;
 }
@@ -25,8 +25,10 @@
 
 #include <bvar/bvar.h>
 
+#include <map>
 #include <memory>
 
+#include "curvefs/src/client/volume/extent.h"
 #include "curvefs/src/client/volume/metric.h"
 #include "curvefs/src/client/volume/volume_storage.h"
 #include "curvefs/src/volume/block_device_client.h"
@@ -42,6 +44,7 @@ using ::curvefs::volume::SpaceManager;
 using ::curvefs::client::filesystem::CURVEFS_ERROR;
 using ::curvefs::client::filesystem::FileOut;
 
+class ExtentCache;
 class InodeCacheManager;
 
 // `DefaultVolumeStorage` implements from `VolumeStorage`
@@ -77,6 +80,11 @@ class DefaultVolumeStorage final : public VolumeStorage {
 
     bool Shutdown() override;
 
+ private:
+    static void RestoreTrimmedExtents(
+        const std::map<uint64_t, PExtent>& trimmed,
+        ExtentCache* extentCache);
+
  private:
     SpaceManager* spaceManager_;
     BlockDeviceClient* blockDeviceClient_;
@@ -59,7 +59,9 @@ bvar::LatencyRecorder g_mark_written_latency("extent_cache_mark_written");
 std::ostream& operator<<(std::ostream& os, const ExtentCacheOption& opt) {
     os << "prealloc size: " << opt.preAllocSize
        << ", slice size: " << opt.sliceSize
-       << ", block size: " << opt.blockSize;
+       << ", block size: " << opt.blockSize
+       << ", append prealloc size: " << opt.appendPreAllocSize
+       << ", delta flush: " << opt.deltaFlush;
 
     return os;
 }
@@ -90,6 +92,8 @@ void ExtentCache::Merge(uint64_t loffset, const PExtent& pExt) {
 
     slice->second.Merge(loffset, pExt);
     dirties_.insert(&slice->second);
+    lastExtentOffset_ = loffset;
+    lastExtent_ = pExt;
     VLOG(9) << "merge extent, loffset: " << loffset
             << ", physical offset: " << pExt.pOffset << ", len: " << pExt.len
             << ", written: " << !pExt.UnWritten
@@ -102,21 +106,34 @@ void ExtentCache::DivideForWrite(uint64_t offset,
                                  std::vector<WritePart>* allocated,
                                  std::vector<AllocPart>* needAlloc) {
     LatencyUpdater updater(&g_write_divide_latency);
+    const bool sequential = IsSequentialWrite(offset, len);
     ReadLockGuard lk(lock_);
 
+    if (sequential &&
+        DivideForWriteWithinLastExtent(offset, len, data, allocated)) {
+        return;
+    }
+
+    // sequential writes reserve larger space, so following writes are
+    // likely to fall into the last extent
+    const auto preAllocSize =
+        sequential ? std::max(option_.preAllocSize, option_.appendPreAllocSize)
+                   : option_.preAllocSize;
     const auto end = offset + len;
     const char* datap = data;
 
     while (offset < end) {
-        const auto length = std::min(
-            end - offset, option_.sliceSize - (offset & ~option_.sliceSize));
+        const auto length =
+            std::min(end - offset,
+                     option_.sliceSize - (offset & (option_.sliceSize - 1)));
 
         auto slice = slices_.find(align_down(offset, option_.sliceSize));
         if (slice != slices_.end()) {
-            slice->second.DivideForWrite(offset, length, datap, allocated,
-                                         needAlloc);
+            slice->second.DivideForWrite(offset, length, datap, preAllocSize,
+                                         allocated, needAlloc);
         } else {
-            DivideForWriteWithinEmptySlice(offset, length, datap, needAlloc);
+            DivideForWriteWithinEmptySlice(offset, length, datap, preAllocSize,
+                                           needAlloc);
         }
 
         datap += length;
@@ -124,10 +141,41 @@ void ExtentCache::DivideForWrite(uint64_t offset,
     }
 }
 
+bool ExtentCache::IsSequentialWrite(uint64_t offset, uint64_t len) {
+    const auto end = offset + len;
+    auto writeEnd = writeEnd_.load(std::memory_order_relaxed);
+    while (writeEnd < end &&
+           !writeEnd_.compare_exchange_weak(writeEnd, end,
+                                            std::memory_order_relaxed)) {
+    }
+
+    return nextWriteOffset_.exchange(end, std::memory_order_relaxed) ==
+           offset;
+}
+
+bool ExtentCache::DivideForWriteWithinLastExtent(
+    uint64_t offset,
+    uint64_t len,
+    const char* data,
+    std::vector<WritePart>* allocated) const {
+    if (offset < lastExtentOffset_ ||
+        offset + len > lastExtentOffset_ + lastExtent_.len) {
+        return false;
+    }
+
+    WritePart part;
+    part.offset = lastExtent_.pOffset + (offset - lastExtentOffset_);
+    part.length = len;
+    part.data = data;
+    allocated->push_back(part);
+    return true;
+}
+
 void ExtentCache::DivideForWriteWithinEmptySlice(
     uint64_t offset,
     uint64_t len,
     const char* data,
+    uint64_t preAllocSize,
     std::vector<AllocPart>* needAlloc) {
     AllocPart part;
     part.data = data;
@@ -137,12 +185,11 @@ void ExtentCache::DivideForWriteWithinEmptySlice(
 
     uint64_t alloclength = 0;
     if (offset == alignedoffset) {
-        alloclength =
-            align_up(std::max(len, option_.preAllocSize), option_.blockSize);
+        alloclength = align_up(std::max(len, preAllocSize), option_.blockSize);
     } else {
         auto alignedend = align_up(offset + len, option_.blockSize);
         alloclength =
-            align_up(std::max(alignedend - alignedoffset, option_.preAllocSize),
+            align_up(std::max(alignedend - alignedoffset, preAllocSize),
                      option_.blockSize);
     }
 
@@ -170,8 +217,8 @@ void ExtentCache::MarkWritten(uint64_t offset, uint64_t len) {
             << ", cur: " << cur << ", end: " << end;
 
     while (cur < end) {
-        const auto length =
-            std::min(end - cur, option_.sliceSize - (cur & ~option_.sliceSize));
+        const auto length = std::min(
+            end - cur, option_.sliceSize - (cur & (option_.sliceSize - 1)));
         auto slice = slices_.find(align_down(cur, option_.sliceSize));
         assert(slice != slices_.end());
         VLOG(9) << "mark written for offset: " << offset << ", len: " << len
@@ -191,6 +238,30 @@ void ExtentCache::MarkWritten(uint64_t offset, uint64_t len) {
     }
 }
 
+void ExtentCache::TrimUnwritten(uint64_t length,
+                                std::map<uint64_t, PExtent>* trimmed) {
+    WriteLockGuard lk(lock_);
+
+    // extents before the end of issued writes may be merged but not written
+    const auto from = align_up(
+        std::max(length, writeEnd_.load(std::memory_order_relaxed)),
+        option_.blockSize);
+
+    for (auto& slice : slices_) {
+        if (slice.first + option_.sliceSize <= from) {
+            continue;
+        }
+
+        if (slice.second.TrimUnwritten(std::max(from, slice.first), trimmed)) {
+            dirties_.insert(&slice.second);
+        }
+    }
+
+    lastExtent_.len = 0;
+    VLOG(9) << "extent cache trim unwritten extents from: " << from
+            << ", trimmed: " << trimmed->size();
+}
+
 std::unordered_map<uint64_t, std::map<uint64_t, PExtent>>
 ExtentCache::GetExtentsForTesting() const {
     std::unordered_map<uint64_t, std::map<uint64_t, PExtent>> result;
@@ -217,8 +288,9 @@ void ExtentCache::DivideForRead(uint64_t offset,
     char* datap = data;
 
     while (offset < end) {
-        const auto length = std::min(
-            end - offset, option_.sliceSize - (offset & ~option_.sliceSize));
+        const auto length =
+            std::min(end - offset,
+                     option_.sliceSize - (offset & (option_.sliceSize - 1)));
 
         auto slice = slices_.find(align_down(offset, option_.sliceSize));
         if (slice != slices_.end()) {
@@ -247,6 +319,9 @@ void ExtentCache::SetOption(const ExtentCacheOption& option) {
         << "slice size must be power of 2, current is " << option.sliceSize;
     CHECK(is_alignment(option.blockSize))
         << "block size must be power of 2, current is " << option.blockSize;
+    CHECK(is_alignment(option.appendPreAllocSize))
+        << "append prealloc size must be power of 2, current is "
+        << option.appendPreAllocSize;
 
     option_ = option;
 
@@ -257,6 +332,7 @@ void ExtentCache::Build(const VolumeExtentSliceList &extents) {
     WriteLockGuard lk(lock_);
     slices_.clear();
     dirties_.clear();
+    lastExtent_.len = 0;
 
     for (const auto& s : extents.slices()) {
         slices_.emplace(s.offset(), ExtentSlice{s});
@@ -266,10 +342,20 @@ void ExtentCache::Build(const VolumeExtentSliceList &extents) {
 VolumeExtentSliceList ExtentCache::GetDirtyExtents() {
     VolumeExtentSliceList result;
     WriteLockGuard lk(lock_);
-    for (const auto* slice : dirties_) {
-        *result.add_slices() = slice->ToVolumeExtentSlice();
+
+    // removed extents can't be merged, so slices are replaced as a whole
+    const bool full =
+        !option_.deltaFlush ||
+        std::any_of(
+            dirties_.begin(), dirties_.end(),
+            [](const ExtentSlice* slice) { return slice->NeedFullSync(); });
+
+    for (auto* slice : dirties_) {
+        *result.add_slices() =
+            full ? slice->TakeAllExtents() : slice->TakeDirtyExtents();
     }
 
+    result.set_delta(!full);
     dirties_.clear();
     VLOG(9) << "extent cache get and clear dirty extents";
     return result;
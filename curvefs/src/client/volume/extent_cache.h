@@ -25,6 +25,8 @@
 
 #include <bvar/bvar.h>
 
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <map>
 #include <unordered_map>
@@ -53,6 +55,14 @@ struct ExtentCacheOption {
     uint64_t sliceSize = 1ULL * 1024 * 1024 * 1024;
     // minimum allocate and read/write unit
     uint32_t blockSize = 4096;
+    // preallocation size for sequential writes, appending writes reserve
+    // larger contiguous space, and the unused part is trimmed at close
+    uint64_t appendPreAllocSize = 4ULL * 1024 * 1024;
+    // flush only extents changed since last flush, metaserver merges them
+    // into stored slices. Metaservers which don't know the delta flag
+    // replace whole slices with them, so it must be enabled only after all
+    // metaservers are upgraded
+    bool deltaFlush = false;
 };
 
 class ExtentCache {
@@ -79,8 +89,16 @@ class ExtentCache {
 
     void MarkWritten(uint64_t offset, uint64_t len);
 
+    // Remove unwritten extents beyond both |length| and the end of writes
+    // issued so far, they're preallocated but not used. Removed extents are
+    // returned in |trimmed|, and they can be given back by Merge().
+    void TrimUnwritten(uint64_t length, std::map<uint64_t, PExtent>* trimmed);
+
     bool HasDirtyExtents() const;
 
+    // Return dirty slices and clear them. If delta flush is enabled, only
+    // extents changed since last call are returned, and the result is a
+    // delta which is merged into extents stored in metaserver
     VolumeExtentSliceList GetDirtyExtents();
 
     std::unordered_map<uint64_t, std::map<uint64_t, PExtent>>
@@ -91,11 +109,32 @@ class ExtentCache {
         uint64_t offset,
         uint64_t len,
         const char* data,
+        uint64_t preAllocSize,
         std::vector<AllocPart>* needAlloc);
 
+    // Return whether current write continues the previous one
+    bool IsSequentialWrite(uint64_t offset, uint64_t len);
+
+    // Divide write which falls entirely in the last merged extent
+    bool DivideForWriteWithinLastExtent(uint64_t offset,
+                                        uint64_t len,
+                                        const char* data,
+                                        std::vector<WritePart>* allocated) const;
+
  private:
     mutable curve::common::RWLock lock_;
 
+    // expected offset of next sequential write
+    std::atomic<uint64_t> nextWriteOffset_{UINT64_MAX};
+
+    // end of the furthest write, space before it may be under writing
+    std::atomic<uint64_t> writeEnd_{0};
+
+    // the extent merged last time, appending writes usually fall into it,
+    // |lastExtent_.len| is 0 if it's unknown
+    uint64_t lastExtentOffset_ = 0;
+    PExtent lastExtent_{0, 0, true};
+
     // key is offset
     std::unordered_map<uint64_t, ExtentSlice> slices_;
 
@@ -23,6 +23,7 @@
 #include "curvefs/src/client/volume/extent_slice.h"
 
 #include <algorithm>
+#include <iterator>
 #include <utility>
 
 #include "absl/types/optional.h"
@@ -51,43 +52,140 @@ ExtentSlice::ExtentSlice(const VolumeExtentSlice& slice) {
     }
 }
 
+namespace {
+
+// Append an extent to |slice|, it's merged with the last one if both
+// logical and physical ranges are continuous and in the same state
+void AppendExtent(uint64_t loffset, const PExtent& ext,
+                  VolumeExtentSlice* slice) {
+    if (slice->extents_size() > 0) {
+        auto* prev = slice->mutable_extents(slice->extents_size() - 1);
+        if (prev->isused() != ext.UnWritten &&
+            prev->fsoffset() + prev->length() == loffset &&
+            prev->volumeoffset() + prev->length() == ext.pOffset) {
+            prev->set_length(prev->length() + ext.len);
+            return;
+        }
+    }
+
+    auto* pext = slice->add_extents();
+    pext->set_fsoffset(loffset);
+    pext->set_volumeoffset(ext.pOffset);
+    pext->set_length(ext.len);
+    pext->set_isused(!ext.UnWritten);
+}
+
+}  // namespace
+
 VolumeExtentSlice ExtentSlice::ToVolumeExtentSlice() const {
     VolumeExtentSlice slice;
 
+    slice.set_offset(offset_);
+    for (const auto& ext : extents_) {
+        AppendExtent(ext.first, ext.second, &slice);
+    }
+
+    return slice;
+}
+
+VolumeExtentSlice ExtentSlice::TakeDirtyExtents() {
+    VolumeExtentSlice slice;
     slice.set_offset(offset_);
 
-    auto mergable = [](const VolumeExtent* prev,
-                       const std::pair<const uint64_t, PExtent>& ext) {
-        if (!prev) {
-            return false;
+    // end of last appended extent, an extent may overlap with more than one
+    // dirty range, but it's only appended once
+    uint64_t appendedEnd = 0;
+    for (const auto& range : dirtyRanges_) {
+        auto it = extents_.lower_bound(range.first);
+        if (it != extents_.begin()) {
+            auto prev = std::prev(it);
+            if (prev->first + prev->second.len > range.first) {
+                it = prev;
+            }
         }
 
-        return prev->isused() != ext.second.UnWritten &&
-               prev->fsoffset() + prev->length() == ext.first &&
-               prev->volumeoffset() + prev->length() == ext.second.pOffset;
-    };
+        for (; it != extents_.end() && it->first < range.second; ++it) {
+            if (it->first + it->second.len <= appendedEnd) {
+                continue;
+            }
 
-    VolumeExtent* prev = nullptr;
-    for (const auto& ext : extents_) {
-        if (mergable(prev, ext)) {
-            prev->set_length(prev->length() + ext.second.len);
+            AppendExtent(it->first, it->second, &slice);
+            appendedEnd = it->first + it->second.len;
+        }
+    }
+
+    dirtyRanges_.clear();
+    return slice;
+}
+
+VolumeExtentSlice ExtentSlice::TakeAllExtents() {
+    dirtyRanges_.clear();
+    needFullSync_ = false;
+    return ToVolumeExtentSlice();
+}
+
+bool ExtentSlice::TrimUnwritten(uint64_t offset,
+                                std::map<uint64_t, PExtent>* trimmed) {
+    assert(is_aligned(offset, ExtentCache::option_.blockSize));
+
+    bool removed = false;
+    auto it = extents_.lower_bound(offset);
+    if (it != extents_.begin()) {
+        auto prev = std::prev(it);
+        const auto prevEnd = prev->first + prev->second.len;
+        if (prev->second.UnWritten && prevEnd > offset) {
+            // extent   |-----------|
+            // trim           |-------->
+            const auto keep = offset - prev->first;
+            trimmed->emplace(offset,
+                             PExtent{prevEnd - offset,
+                                     prev->second.pOffset + keep, true});
+            prev->second.len = keep;
+            removed = true;
+        }
+    }
+
+    while (it != extents_.end()) {
+        if (!it->second.UnWritten) {
+            ++it;
             continue;
         }
 
-        auto* pext = slice.add_extents();
-        pext->set_fsoffset(ext.first);
-        pext->set_volumeoffset(ext.second.pOffset);
-        pext->set_length(ext.second.len);
-        pext->set_isused(!ext.second.UnWritten);
-        prev = pext;
+        trimmed->emplace(it->first, it->second);
+        it = extents_.erase(it);
+        removed = true;
     }
 
-    return slice;
+    needFullSync_ = needFullSync_ || removed;
+    return removed;
+}
+
+void ExtentSlice::MarkDirty(uint64_t offset, uint64_t len) {
+    uint64_t start = offset;
+    uint64_t end = offset + len;
+
+    auto it = dirtyRanges_.upper_bound(start);
+    if (it != dirtyRanges_.begin()) {
+        auto prev = std::prev(it);
+        if (prev->second >= start) {
+            start = prev->first;
+            end = std::max(end, prev->second);
+            dirtyRanges_.erase(prev);
+        }
+    }
+
+    while (it != dirtyRanges_.end() && it->first <= end) {
+        end = std::max(end, it->second);
+        it = dirtyRanges_.erase(it);
+    }
+
+    dirtyRanges_.emplace(start, end);
 }
 
 void ExtentSlice::DivideForWrite(uint64_t offset,
                                  uint64_t len,
                                  const char* data,
+                                 uint64_t preAllocSize,
                                  std::vector<WritePart>* allocated,
                                  std::vector<AllocPart>* needAlloc) const {
     uint64_t curOff = offset;
@@ -233,10 +331,14 @@ void ExtentSlice::DivideForWrite(uint64_t offset,
 
         part.allocInfo.lOffset = alignedoffset;
         part.allocInfo.len =
-            align_up(std::max(alignedend - alignedoffset,
-                              ExtentCache::option_.preAllocSize),
+            align_up(std::max(alignedend - alignedoffset, preAllocSize),
                      ExtentCache::option_.blockSize);
 
+        // preallocation doesn't go beyond current slice
+        part.allocInfo.len =
+            std::min(offset_ + ExtentCache::option_.sliceSize - alignedoffset,
+                     part.allocInfo.len);
+
         if (upper != extents_.end()) {
             part.allocInfo.len =
                 std::min(upper->first - alignedoffset, part.allocInfo.len);
@@ -355,6 +457,8 @@ void ExtentSlice::DivideForRead(uint64_t offset,
 }
 
 void ExtentSlice::Merge(uint64_t loffset, const PExtent &extent) {
+    MarkDirty(loffset, extent.len);
+
     if (extents_.empty()) {
         extents_.emplace(loffset, extent);
         return;
@@ -392,6 +496,15 @@ void ExtentSlice::Merge(uint64_t loffset, const PExtent &extent) {
 }
 
 bool ExtentSlice::MarkWritten(uint64_t offset, uint64_t len) {
+    const bool changed = MarkWrittenInternal(offset, len);
+    if (changed) {
+        MarkDirty(offset, len);
+    }
+
+    return changed;
+}
+
+bool ExtentSlice::MarkWrittenInternal(uint64_t offset, uint64_t len) {
     bool changed = false;
     uint64_t curOff = offset;
     const uint64_t curEnd = offset + len;
@@ -46,6 +46,7 @@ class ExtentSlice {
     void DivideForWrite(uint64_t offset,
                         uint64_t len,
                         const char* data,
+                        uint64_t preAllocSize,
                         std::vector<WritePart>* allocated,
                         std::vector<AllocPart>* needAlloc) const;
 
@@ -62,11 +63,37 @@ class ExtentSlice {
 
     VolumeExtentSlice ToVolumeExtentSlice() const;
 
+    // Return extents which are changed since last call, and reset changes.
+    // The result only covers changed ranges and is merged into the slice
+    // stored in metaserver.
+    VolumeExtentSlice TakeDirtyExtents();
+
+    // Remove unwritten extents beyond |offset|, return whether any extent is
+    // removed. Removal can't be expressed by changed extents, so the whole
+    // slice has to be synced afterwards.
+    bool TrimUnwritten(uint64_t offset, std::map<uint64_t, PExtent>* trimmed);
+
+    bool NeedFullSync() const { return needFullSync_; }
+
+    // Return all extents and reset changes
+    VolumeExtentSlice TakeAllExtents();
+
     std::map<uint64_t, PExtent> GetExtentsForTesting() const;
 
+ private:
+    bool MarkWrittenInternal(uint64_t offset, uint64_t len);
+
+    void MarkDirty(uint64_t offset, uint64_t len);
+
  private:
     uint64_t offset_;
     std::map<uint64_t, PExtent> extents_;
+
+    // changed logical ranges since last flush, key is start, value is end
+    std::map<uint64_t, uint64_t> dirtyRanges_;
+
+    // some extents are removed since last flush
+    bool needFullSync_ = false;
 };
 
 }  // namespace client
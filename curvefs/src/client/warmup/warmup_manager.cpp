@@ -49,6 +49,8 @@ namespace curvefs {
 namespace client {
 namespace warmup {
 
+using curve::common::ReadWriteThrottleParams;
+using curve::common::ThrottleParams;
 using curve::common::WriteLockGuard;
 
 #define WARMUP_CHECKINTERVAL_US (1000 * 1000)
@@ -106,6 +108,12 @@ void WarmupManagerS3Impl::UnInit() {
         bgFetchThread_.join();
     }
 
+    // let the tasks blocked by throttle go
+    if (inflightThrottle_ != nullptr) {
+        inflightThrottle_->Stop();
+    }
+    bandwidthThrottle_.Stop();
+
     for (auto& task : inode2FetchDentryPool_) {
         task.second->Stop();
     }
@@ -129,6 +137,13 @@ void WarmupManagerS3Impl::UnInit() {
 
 void WarmupManagerS3Impl::Init(const FuseClientOption& option) {
     WarmupManager::Init(option);
+    inflightThrottle_ = absl::make_unique<WarmupInflightThrottle>(
+        option_.warmupMaxInflightObjects);
+    if (option_.warmupBandwidthBytes != 0) {
+        ReadWriteThrottleParams params;
+        params.bpsRead = ThrottleParams(option_.warmupBandwidthBytes, 0, 0);
+        bandwidthThrottle_.UpdateThrottleParams(params);
+    }
     bgFetchStop_.store(false, std::memory_order_release);
     bgFetchThread_ = Thread(&WarmupManagerS3Impl::BackGroundFetch, this);
     initbgFetchThread_ = true;
@@ -241,30 +256,32 @@ void WarmupManagerS3Impl::FetchDentry(fuse_ino_t key, fuse_ino_t ino,
         }
         return;
     }
+    std::set<fuse_ino_t> files;
+    HandleDentry(key, ino, dentry, symlink_depth, &files);
+    AddWarmupInodes(key, files);
+    VLOG(9) << "FetchDentry end: " << file << ", ino: " << ino;
+}
+
+void WarmupManagerS3Impl::HandleDentry(fuse_ino_t key, fuse_ino_t parent,
+                                       const Dentry& dentry,
+                                       uint32_t symlink_depth,
+                                       std::set<fuse_ino_t>* files) {
     if (FsFileType::TYPE_S3 == dentry.type()) {
-        WriteLockGuard lock(warmupInodesDequeMutex_);
-        auto iterDeque = FindWarmupInodesByKeyLocked(key);
-        if (iterDeque == warmupInodesDeque_.end()) {
-            warmupInodesDeque_.emplace_back(
-                key, std::set<fuse_ino_t>{dentry.inodeid()});
-        } else {
-            iterDeque->AddFileInode(dentry.inodeid());
-        }
-        return;
+        files->emplace(dentry.inodeid());
     } else if (FsFileType::TYPE_DIRECTORY == dentry.type()) {
         auto task = [this, key, dentry, symlink_depth]() {
             FetchChildDentry(key, dentry.inodeid(), symlink_depth);
         };
         AddFetchDentryTask(key, task);
         VLOG(9) << "FetchDentry: " << dentry.inodeid();
-        return;
     } else if (FsFileType::TYPE_SYM_LINK == dentry.type()) {
-        fuse_ino_t parent;
+        fuse_ino_t realParent;
         std::string lastName;
-        if (!GetInodeSubPathParent(ino, std::vector<std::string>{dentry.name()},
-                                   &parent, &lastName, &symlink_depth)) {
+        if (!GetInodeSubPathParent(parent,
+                                   std::vector<std::string>{dentry.name()},
+                                   &realParent, &lastName, &symlink_depth)) {
             LOG_EVERY_N(ERROR, 10000)
-                << "GetInodeSubPathParent fail, file: " << file;
+                << "GetInodeSubPathParent fail, file: " << dentry.name();
             return;
         }
         if (lastName == ROOT_PATH_NAME) {
@@ -273,16 +290,30 @@ void WarmupManagerS3Impl::FetchDentry(fuse_ino_t key, fuse_ino_t ino,
             };
             AddFetchDentryTask(key, task);
         } else {
-            auto task = [this, key, parent, lastName, symlink_depth]() {
-                FetchDentry(key, parent, lastName, symlink_depth);
+            auto task = [this, key, realParent, lastName, symlink_depth]() {
+                FetchDentry(key, realParent, lastName, symlink_depth);
             };
             AddFetchDentryTask(key, task);
         }
     } else {
-        VLOG(3) << "unkown, file: " << file << ", ino: " << ino;
+        VLOG(3) << "unkown, file: " << dentry.name() << ", ino: " << parent;
+    }
+}
+
+void WarmupManagerS3Impl::AddWarmupInodes(fuse_ino_t key,
+                                          const std::set<fuse_ino_t>& files) {
+    if (files.empty()) {
         return;
     }
-    VLOG(9) << "FetchDentry end: " << file << ", ino: " << ino;
+    WriteLockGuard lock(warmupInodesDequeMutex_);
+    auto iterDeque = FindWarmupInodesByKeyLocked(key);
+    if (iterDeque == warmupInodesDeque_.end()) {
+        warmupInodesDeque_.emplace_back(key, files);
+    } else {
+        for (auto file : files) {
+            iterDeque->AddFileInode(file);
+        }
+    }
 }
 
 void WarmupManagerS3Impl::FetchChildDentry(fuse_ino_t key, fuse_ino_t ino,
@@ -296,15 +327,15 @@ void WarmupManagerS3Impl::FetchChildDentry(fuse_ino_t key, fuse_ino_t ino,
                    << ", key=" << key << ", parent=" << ino;
         return;
     }
+    // the listed dentries already carry the file type,
+    // so there is no need to get them one by one
+    std::set<fuse_ino_t> files;
     for (const auto& dentry : dentryList) {
         VLOG(9) << "FetchChildDentry: key:" << key
                 << " dentry: " << dentry.name();
-        std::string lastName = dentry.name();
-        auto task = [this, key, ino, lastName, symlink_depth]() {
-            FetchDentry(key, ino, lastName, symlink_depth);
-        };
-        AddFetchDentryTask(key, task);
+        HandleDentry(key, ino, dentry, symlink_depth, &files);
     }
+    AddWarmupInodes(key, files);
     VLOG(9) << "FetchChildDentry end: key:" << key << " inode: " << ino;
 }
 
@@ -321,6 +352,21 @@ void WarmupManagerS3Impl::FetchDataEnqueue(fuse_ino_t key, fuse_ino_t ino) {
         S3ChunkInfoMapType s3ChunkInfoMap;
         {
             ::curve::common::UniqueLock lgGuard = inodeWrapper->GetUniqueLock();
+            if (inodeWrapper->IsLazyLoadS3ChunkInfo()) {
+                // warmup the whole file, so load all chunks
+                std::set<uint64_t> chunkIndexes;
+                uint64_t chunkSize = s3Adaptor_->GetChunkSize();
+                uint64_t length = inodeWrapper->GetLengthLocked();
+                for (uint64_t index = 0; index * chunkSize < length; index++) {
+                    chunkIndexes.insert(index);
+                }
+                ret = inodeWrapper->LoadS3ChunkInfoLocked(chunkIndexes);
+                if (ret != CURVEFS_ERROR::OK) {
+                    LOG(ERROR) << "load s3chunkinfo fail, ret = " << ret
+                               << ", inodeid = " << ino;
+                    return;
+                }
+            }
             s3ChunkInfoMap = *inodeWrapper->GetChunkInfoMap();
         }
         if (s3ChunkInfoMap.empty()) {
@@ -466,11 +512,14 @@ void WarmupManagerS3Impl::WarmUpAllObjs(
             (void)adapter;
             if (bgFetchStop_.load(std::memory_order_acquire)) {
                 VLOG(9) << "need stop warmup";
+                inflightThrottle_->OnComplete();
+                delete[] context->buf;
                 cond.Signal();
                 return;
             }
             if (context->retCode >= 0) {
                 VLOG(9) << "Get Object success: " << context->key;
+                inflightThrottle_->OnComplete();
                 PutObjectToCache(key, context);
                 metric::CollectMetrics(&warmupS3Metric_.warmupS3Cached,
                                        context->len,
@@ -484,6 +533,7 @@ void WarmupManagerS3Impl::WarmUpAllObjs(
             }
             warmupS3Metric_.warmupS3Cached.eps.count << 1;
             if (++context->retry >= option_.downloadMaxRetryTimes) {
+                inflightThrottle_->OnComplete();
                 if (pendingReq.fetch_sub(1, std::memory_order_seq_cst) == 1) {
                     VLOG(6) << "pendingReq is over";
                     cond.Signal();
@@ -519,6 +569,14 @@ void WarmupManagerS3Impl::WarmUpAllObjs(
                     continue;
                 }
             }
+            // the budget is shared by all warmup tasks,
+            // acquire bandwidth first and then an inflight slot
+            bandwidthThrottle_.Add(true, readLen);
+            if (!inflightThrottle_->OnStart()) {
+                VLOG(9) << "need stop warmup";
+                pendingReq.fetch_sub(1);
+                continue;
+            }
             char* cacheS3 = new char[readLen];
             memset(cacheS3, 0, readLen);
             auto context = std::make_shared<GetObjectAsyncContext>(
@@ -593,7 +651,8 @@ void WarmupManagerS3Impl::ScanCleanWarmupProgress() {
     ReadLockGuard lock(inode2ProgressMutex_);
     for (auto iter = inode2Progress_.begin(); iter != inode2Progress_.end();) {
         if (ProgressDone(iter->first)) {
-            LOG(INFO) << "warmup task: " << iter->first << " done!";
+            LOG(INFO) << "warmup task: " << iter->first
+                      << " done! progress: " << iter->second.ToString();
             iter = inode2Progress_.erase(iter);
         } else {
             ++iter;
@@ -683,7 +742,7 @@ void WarmupManagerS3Impl::PutObjectToCache(
     }
     int ret;
     // update progress
-    iter->second.FinishedPlusOne();
+    iter->second.FinishedPlusOne(context->len);
     switch (iter->second.GetStorageType()) {
         case curvefs::client::common::WarmupStorageType::kWarmupStorageTypeDisk:
             ret = s3Adaptor_->GetDiskCacheManager()->WriteReadDirect(
@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <functional>
@@ -39,6 +40,8 @@
 #include <utility>
 #include <vector>
 
+#include <butil/time.h>
+
 #include "curvefs/src/client/common/common.h"
 #include "curvefs/src/client/dentry_cache_manager.h"
 #include "curvefs/src/client/fuse_common.h"
@@ -51,6 +54,7 @@
 #include "curvefs/src/common/task_thread_pool.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/concurrent/rw_lock.h"
+#include "src/common/throttle.h"
 
 namespace curvefs {
 namespace client {
@@ -104,11 +108,17 @@ class WarmupProgress {
  public:
     explicit WarmupProgress(WarmupStorageType type = curvefs::client::common::
                                 WarmupStorageType::kWarmupStorageTypeUnknown)
-        : total_(0), finished_(0), storageType_(type) {}
+        : total_(0),
+          finished_(0),
+          finishedBytes_(0),
+          startTimeUs_(butil::cpuwide_time_us()),
+          storageType_(type) {}
 
     WarmupProgress(const WarmupProgress& wp)
         : total_(wp.total_),
           finished_(wp.finished_),
+          finishedBytes_(wp.finishedBytes_),
+          startTimeUs_(wp.startTimeUs_),
           storageType_(wp.storageType_) {}
 
     void AddTotal(uint64_t add) {
@@ -119,12 +129,15 @@ class WarmupProgress {
     WarmupProgress& operator=(const WarmupProgress& wp) {
         total_ = wp.total_;
         finished_ = wp.finished_;
+        finishedBytes_ = wp.finishedBytes_;
+        startTimeUs_ = wp.startTimeUs_;
         return *this;
     }
 
-    void FinishedPlusOne() {
+    void FinishedPlusOne(uint64_t bytes = 0) {
         std::lock_guard<std::mutex> lock(finishedMutex_);
         ++finished_;
+        finishedBytes_ += bytes;
     }
 
     uint64_t GetTotal() {
@@ -137,11 +150,28 @@ class WarmupProgress {
         return finished_;
     }
 
+    uint64_t GetFinishedBytes() {
+        std::lock_guard<std::mutex> lock(finishedMutex_);
+        return finishedBytes_;
+    }
+
+    // average download throughput since the task was added, in bytes/s
+    uint64_t GetThroughput() {
+        uint64_t elapsedUs = butil::cpuwide_time_us() - startTimeUs_;
+        if (elapsedUs == 0) {
+            return 0;
+        }
+        return GetFinishedBytes() * 1000000 / elapsedUs;
+    }
+
     std::string ToString() {
+        uint64_t throughput = GetThroughput();
         std::lock_guard<std::mutex> lockT(totalMutex_);
         std::lock_guard<std::mutex> lockF(finishedMutex_);
         return "total:" + std::to_string(total_) +
-               ",finished:" + std::to_string(finished_);
+               ",finished:" + std::to_string(finished_) +
+               ",finishedBytes:" + std::to_string(finishedBytes_) +
+               ",throughput:" + std::to_string(throughput) + "B/s";
     }
 
     WarmupStorageType GetStorageType() { return storageType_; }
@@ -150,10 +180,55 @@ class WarmupProgress {
     uint64_t total_;
     std::mutex totalMutex_;
     uint64_t finished_;
+    uint64_t finishedBytes_;
     std::mutex finishedMutex_;
+    uint64_t startTimeUs_;
     WarmupStorageType storageType_;
 };
 
+/**
+ * @brief Limit the number of objects downloaded by all warmup tasks at the
+ * same time, so that warmup won't occupy all the s3 async requests.
+ */
+class WarmupInflightThrottle {
+ public:
+    explicit WarmupInflightThrottle(uint32_t maxInflight = 0)
+        : maxInflight_(maxInflight), inflight_(0), stop_(false) {}
+
+    // block until there is a free slot, return false if it is stopped
+    bool OnStart() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (maxInflight_ != 0) {
+            cond_.wait(lock,
+                       [this]() { return stop_ || inflight_ < maxInflight_; });
+        }
+        if (stop_) {
+            return false;
+        }
+        ++inflight_;
+        return true;
+    }
+
+    void OnComplete() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        --inflight_;
+        cond_.notify_one();
+    }
+
+    void Stop() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+        cond_.notify_all();
+    }
+
+ private:
+    const uint32_t maxInflight_;
+    uint32_t inflight_;
+    bool stop_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+};
+
 using FuseOpReadFunctionType =
     std::function<CURVEFS_ERROR(fuse_req_t, fuse_ino_t, size_t, off_t,
                                 struct fuse_file_info*, char*, size_t*)>;
@@ -351,6 +426,17 @@ class WarmupManagerS3Impl : public WarmupManager {
     void FetchChildDentry(fuse_ino_t key, fuse_ino_t ino,
                           uint32_t symlink_depth);
 
+    /**
+     * @brief Handle a dentry which is got by GetDentry or ListDentry,
+     * regular files are collected into files, directories and sym links
+     * are added as fetch dentry tasks.
+     */
+    void HandleDentry(fuse_ino_t key, fuse_ino_t parent, const Dentry& dentry,
+                      uint32_t symlink_depth, std::set<fuse_ino_t>* files);
+
+    // add the files need to be warmed up of the warmup task[key]
+    void AddWarmupInodes(fuse_ino_t key, const std::set<fuse_ino_t>& files);
+
     /**
      * @brief
      * Please use it with the lock warmupInodesDequeMutex_
@@ -472,6 +558,12 @@ class WarmupManagerS3Impl : public WarmupManager {
         inode2FetchS3ObjectsPool_;
     mutable RWLock inode2FetchS3ObjectsPoolMutex_;
 
+    // limit objects downloaded by all warmup tasks at the same time
+    std::unique_ptr<WarmupInflightThrottle> inflightThrottle_;
+
+    // limit the download bandwidth of all warmup tasks
+    curve::common::Throttle bandwidthThrottle_;
+
     curvefs::client::metric::WarmupManagerS3Metric warmupS3Metric_;
 };
 
@@ -22,6 +22,8 @@
 
 #include "curvefs/src/common/rpc_stream.h"
 
+#include <errno.h>
+
 #include <memory>
 
 namespace curvefs {
@@ -52,6 +54,7 @@ std::ostream& operator<<(std::ostream& os, const StreamStatus status) {
 }
 
 const std::string StreamConnection::kEOFMessage_ = "__EOF__";  // NOLINT
+const std::string StreamConnection::kErrorMessage_ = "__ERROR__";  // NOLINT
 
 StreamConnection::StreamConnection()
     : streamId_(-1),
@@ -64,7 +67,17 @@ StreamConnection::StreamConnection(brpc::StreamId streamId,
       status_(StreamStatus::STREAM_OK) {}
 
 bool StreamConnection::Write(const butil::IOBuf& buffer) {
-    return brpc::StreamWrite(streamId_, buffer) == 0;
+    while (true) {
+        int rc = brpc::StreamWrite(streamId_, buffer);
+        if (rc != EAGAIN) {
+            return rc == 0;
+        }
+
+        // the peer's buffer is full, wait until it consumes some messages
+        if (brpc::StreamWait(streamId_, nullptr) != 0) {
+            return false;
+        }
+    }
 }
 
 bool StreamConnection::WriteDone() {
@@ -73,6 +86,12 @@ bool StreamConnection::WriteDone() {
     return brpc::StreamWrite(streamId_, buffer) == 0;
 }
 
+bool StreamConnection::WriteError() {
+    butil::IOBuf buffer;
+    buffer.append(GetErrorMessage());
+    return brpc::StreamWrite(streamId_, buffer) == 0;
+}
+
 StreamStatus StreamConnection::WaitAllDataReceived() {
     Wait();
     if (status_ == StreamStatus::STREAM_EOF) {
@@ -89,6 +108,10 @@ std::string StreamConnection::GetEOFMessage() {
     return kEOFMessage_;
 }
 
+std::string StreamConnection::GetErrorMessage() {
+    return kErrorMessage_;
+}
+
 void StreamConnection::SetStatus(StreamStatus status) {
     status_ = status;
 }
@@ -195,12 +218,19 @@ int StreamClient::on_received_messages(brpc::StreamId id,
 
     StreamStatus status = StreamStatus::STREAM_OK;
     std::string eofMessage = connection->GetEOFMessage();
+    std::string errorMessage = connection->GetErrorMessage();
     for (size_t i = 0; i < size; i++) {
         butil::IOBuf* buffer = buffers[i];
         if (buffer->size() == eofMessage.size() &&
             buffer->to_string() == eofMessage) {
             status = StreamStatus::STREAM_EOF;
             break;
+        } else if (buffer->size() == errorMessage.size() &&
+                   buffer->to_string() == errorMessage) {
+            LOG(ERROR) << "on_received_messages: stream (streamId=" << id
+                       << ") failed in server-side";
+            status = StreamStatus::STREAM_ERROR;
+            break;
         } else if (!connection->InvokeReceiveCallback(buffer)) {
             status = StreamStatus::STREAM_ERROR;
             break;
@@ -237,11 +267,12 @@ StreamServer::~StreamServer() {
     }
 }
 
-std::shared_ptr<StreamConnection> StreamServer::Accept(brpc::Controller* cntl) {
+std::shared_ptr<StreamConnection> StreamServer::Accept(brpc::Controller* cntl,
+                                                      int64_t maxBufSize) {
     brpc::StreamId streamId;
     brpc::StreamOptions streamOptions;
     streamOptions.handler = this;
-    streamOptions.max_buf_size = 0;  // unlimited buffer size
+    streamOptions.max_buf_size = maxBufSize;
     if (brpc::StreamAccept(&streamId, *cntl, &streamOptions) != 0) {
         LOG(ERROR) << "Failed to accept stream in server-side";
         return nullptr;
@@ -71,10 +71,14 @@ class StreamConnection {
     StreamConnection(brpc::StreamId streamId,
                      const ReceiveCallback& callback);
 
+    // Blocks while the stream's buffer is full
     bool Write(const butil::IOBuf& buffer);
 
     bool WriteDone();
 
+    // Tells the peer that sender failed and no more data will be sent
+    bool WriteError();
+
     StreamStatus WaitAllDataReceived();
 
     brpc::StreamId GetStreamId();
@@ -82,6 +86,8 @@ class StreamConnection {
  private:
     std::string GetEOFMessage();
 
+    std::string GetErrorMessage();
+
     void SetStatus(StreamStatus status);
 
     bool InvokeReceiveCallback(butil::IOBuf*);
@@ -93,6 +99,8 @@ class StreamConnection {
  private:
     static const std::string kEOFMessage_;
 
+    static const std::string kErrorMessage_;
+
     brpc::StreamId streamId_;
 
     ReceiveCallback callback_;
@@ -139,7 +147,10 @@ class StreamServer : public brpc::StreamInputHandler {
 
     ~StreamServer();
 
-    std::shared_ptr<StreamConnection> Accept(brpc::Controller* cntl);
+    // |maxBufSize| limits the bytes not yet consumed by client, writing to
+    // connection blocks when it's reached, 0 means unlimited
+    std::shared_ptr<StreamConnection> Accept(brpc::Controller* cntl,
+                                             int64_t maxBufSize = 0);
 
  private:
     int on_received_messages(brpc::StreamId id,
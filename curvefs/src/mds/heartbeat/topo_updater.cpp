@@ -225,18 +225,31 @@ void TopoUpdater::UpdatePartitionTopo(
             continue;
         }
 
-        // partition both in heartbeat and in topology
-        bool statusCanChange = CanPartitionStatusChange(
-            partitionInTopo.GetStatus(), it.GetStatus());
+        // request number changes on every heartbeat, update it in memory
+        // without touching the statistic in storage
+        topo_->UpdatePartitionRequestNum(it.GetPartitionId(),
+                                         it.GetRequestNum());
+
+        // partition both in heartbeat and in topology, statistic is still
+        // updated if the status can't change.
+        // A partition split by mds is READONLY in topology only, metaserver
+        // keeps reporting READWRITE for it, which is expected and is not
+        // checked, otherwise it's warned on every heartbeat
+        PartitionStatus status = partitionInTopo.GetStatus();
+        bool splitByMds = status == PartitionStatus::READONLY &&
+                          it.GetStatus() == PartitionStatus::READWRITE;
+        if (!splitByMds && CanPartitionStatusChange(status, it.GetStatus())) {
+            status = it.GetStatus();
+        }
 
         bool statisticChange =
-            partitionInTopo.GetStatus() != it.GetStatus() ||
+            partitionInTopo.GetStatus() != status ||
             partitionInTopo.GetInodeNum() != it.GetInodeNum() ||
             partitionInTopo.GetDentryNum() != it.GetDentryNum() ||
             partitionInTopo.GetIdNext() != it.GetIdNext();
-        if (statusCanChange && statisticChange) {
+        if (statisticChange) {
             ::curvefs::mds::topology::PartitionStatistic statistic;
-            statistic.status = it.GetStatus();
+            statistic.status = status;
             statistic.inodeNum = it.GetInodeNum();
             statistic.dentryNum = it.GetDentryNum();
             statistic.fileType2InodeNum = it.GetFileType2InodeNum();
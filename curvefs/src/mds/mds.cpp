@@ -102,6 +102,12 @@ void MDS::InitTopologyOption(TopologyOption* topologyOption) {
                                &topologyOption->maxCopysetNumInMetaserver);
     conf_->GetValueFatalIfFail("mds.topology.UpdateMetricIntervalSec",
                                &topologyOption->UpdateMetricIntervalSec);
+    conf_->GetValueFatalIfFail("mds.topology.SplitPartitionIntervalSec",
+                               &topologyOption->splitPartitionIntervalSec);
+    conf_->GetValueFatalIfFail("mds.topology.SplitPartitionRequestRate",
+                               &topologyOption->splitPartitionRequestRate);
+    conf_->GetValueFatalIfFail("mds.topology.SplitPartitionInodeNum",
+                               &topologyOption->splitPartitionInodeNum);
 }
 
 void MDS::InitScheduleOption(ScheduleOption* scheduleOption) {
@@ -183,6 +189,7 @@ void MDS::Init() {
     InitTopology(options_.topologyOptions);
     InitTopologyMetricService(options_.topologyOptions);
     InitTopologyManager(options_.topologyOptions);
+    InitPartitionSplitter(options_.topologyOptions);
     InitCoordinator();
     InitHeartbeatManager();
     FsManagerOption fsManagerOption;
@@ -223,6 +230,13 @@ void MDS::InitTopologyManager(const TopologyOption& option) {
     LOG(INFO) << "init topologyManager success.";
 }
 
+void MDS::InitPartitionSplitter(const TopologyOption& option) {
+    partitionSplitter_ =
+        std::make_shared<PartitionSplitter>(topology_, topologyManager_);
+    partitionSplitter_->Init(option);
+    LOG(INFO) << "init partitionSplitter success.";
+}
+
 void MDS::InitTopologyMetricService(const TopologyOption& option) {
     topologyMetricService_ = std::make_shared<TopologyMetricService>(topology_);
     topologyMetricService_->Init(option);
@@ -249,6 +263,7 @@ void MDS::Run() {
 
     LOG_IF(FATAL, topology_->Run()) << "run topology module fail";
     topologyMetricService_->Run();
+    partitionSplitter_->Run();
     coordinator_->Run();
     heartbeatManager_->Run();
     fsManager_->Run();
@@ -298,6 +313,7 @@ void MDS::Stop() {
     heartbeatManager_->Stop();
     coordinator_->Stop();
     topologyMetricService_->Stop();
+    partitionSplitter_->Stop();
     fsManager_->Uninit();
     topology_->Stop();
 }
@@ -33,6 +33,7 @@
 #include "curvefs/src/mds/fs_manager.h"
 #include "curvefs/src/mds/heartbeat/heartbeat_service.h"
 #include "curvefs/src/mds/schedule/coordinator.h"
+#include "curvefs/src/mds/topology/partition_splitter.h"
 #include "curvefs/src/mds/topology/topology.h"
 #include "curvefs/src/mds/topology/topology_config.h"
 #include "curvefs/src/mds/topology/topology_metric.h"
@@ -57,6 +58,7 @@ using ::curvefs::mds::topology::TopologyStorageEtcd;
 using ::curvefs::mds::topology::TopologyStorageCodec;
 using ::curvefs::mds::topology::TopologyServiceImpl;
 using ::curvefs::mds::topology::TopologyMetricService;
+using ::curvefs::mds::topology::PartitionSplitter;
 using ::curvefs::mds::heartbeat::HeartbeatServiceImpl;
 using ::curvefs::mds::heartbeat::HeartbeatOption;
 using ::curve::kvstorage::EtcdClientImp;
@@ -143,6 +145,8 @@ class MDS {
 
     void InitTopologyMetricService(const TopologyOption& option);
 
+    void InitPartitionSplitter(const TopologyOption& option);
+
     void InitHeartbeatManager();
 
     void InitCoordinator();
@@ -168,6 +172,7 @@ class MDS {
     std::shared_ptr<Coordinator> coordinator_;
     std::shared_ptr<HeartbeatManager> heartbeatManager_;
     std::shared_ptr<TopologyMetricService> topologyMetricService_;
+    std::shared_ptr<PartitionSplitter> partitionSplitter_;
     std::shared_ptr<S3Adapter> s3Adapter_;
     MDSOptions options_;
 
@@ -24,6 +24,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <string>
 #include <utility>
 
@@ -53,14 +54,31 @@ SpaceErrCode StoreErrCodeToSpaceErrCode(int code) {
     }
 }
 
+// etcd client supports transactions of at most 3 operations
+constexpr size_t kMaxOpsPerTxn = 3;
+
 }  // namespace
 
-SpaceErrCode BlockGroupStorageImpl::PutBlockGroup(
+SpaceErrCode BlockGroupStorage::PutBlockGroups(
     uint32_t fsId,
-    uint64_t offset,
-    const BlockGroup& blockGroup) {
-    std::string key = EncodeBlockGroupKey(fsId, offset);
-    std::string value;
+    const std::vector<BlockGroup>& blockGroups) {
+    for (const auto& group : blockGroups) {
+        auto err = PutBlockGroup(fsId, group.offset(), group);
+        if (err != SpaceOk) {
+            return err;
+        }
+    }
+
+    return SpaceOk;
+}
+
+SpaceErrCode BlockGroupStorageImpl::EncodeBlockGroup(
+    uint32_t fsId,
+    const BlockGroup& blockGroup,
+    std::string* key,
+    std::string* value) {
+    const uint64_t offset = blockGroup.offset();
+    *key = EncodeBlockGroupKey(fsId, offset);
 
     if (!blockGroup.IsInitialized()) {
         LOG(WARNING) << "Block group is not initialized, fsId: " << fsId
@@ -68,12 +86,27 @@ SpaceErrCode BlockGroupStorageImpl::PutBlockGroup(
         return SpaceErrEncode;
     }
 
-    if (!EncodeProtobufMessage(blockGroup, &value)) {
+    if (!EncodeProtobufMessage(blockGroup, value)) {
         LOG(WARNING) << "Encode block group failed, fsId: " << fsId
                      << ", block group offset: " << offset;
         return SpaceErrEncode;
     }
 
+    return SpaceOk;
+}
+
+SpaceErrCode BlockGroupStorageImpl::PutBlockGroup(
+    uint32_t fsId,
+    uint64_t offset,
+    const BlockGroup& blockGroup) {
+    std::string key;
+    std::string value;
+
+    auto ret = EncodeBlockGroup(fsId, blockGroup, &key, &value);
+    if (ret != SpaceOk) {
+        return ret;
+    }
+
     int err = store_->Put(key, value);
     if (err != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "Put block group failed, fsId: " << fsId
@@ -83,6 +116,52 @@ SpaceErrCode BlockGroupStorageImpl::PutBlockGroup(
     return StoreErrCodeToSpaceErrCode(err);
 }
 
+SpaceErrCode BlockGroupStorageImpl::PutBlockGroups(
+    uint32_t fsId,
+    const std::vector<BlockGroup>& blockGroups) {
+    std::vector<std::string> keys(blockGroups.size());
+    std::vector<std::string> values(blockGroups.size());
+    for (size_t i = 0; i < blockGroups.size(); ++i) {
+        auto ret =
+            EncodeBlockGroup(fsId, blockGroups[i], &keys[i], &values[i]);
+        if (ret != SpaceOk) {
+            return ret;
+        }
+    }
+
+    size_t i = 0;
+    while (i < blockGroups.size()) {
+        const size_t n = std::min(kMaxOpsPerTxn, blockGroups.size() - i);
+        if (n == 1) {
+            return PutBlockGroup(fsId, blockGroups[i].offset(),
+                                 blockGroups[i]);
+        }
+
+        std::vector<Operation> ops;
+        ops.reserve(n);
+        for (size_t j = i; j < i + n; ++j) {
+            ops.push_back(Operation{OpType::OpPut,
+                                    const_cast<char*>(keys[j].c_str()),
+                                    const_cast<char*>(values[j].c_str()),
+                                    static_cast<int>(keys[j].size()),
+                                    static_cast<int>(values[j].size())});
+        }
+
+        int err = store_->TxnN(ops);
+        if (err != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "Put block groups failed, fsId: " << fsId
+                       << ", first block group offset: "
+                       << blockGroups[i].offset() << ", count: " << n
+                       << ", err: " << err;
+            return StoreErrCodeToSpaceErrCode(err);
+        }
+
+        i += n;
+    }
+
+    return SpaceOk;
+}
+
 SpaceErrCode BlockGroupStorageImpl::RemoveBlockGroup(uint32_t fsId,
                                                      uint64_t offset) {
     std::string key = EncodeBlockGroupKey(fsId, offset);
@@ -24,6 +24,7 @@
 #define CURVEFS_SRC_MDS_SPACE_BLOCK_GROUP_STORAGE_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "curvefs/proto/space.pb.h"
@@ -41,6 +42,10 @@ class BlockGroupStorage {
                                        uint64_t offset,
                                        const BlockGroup& blockGroup) = 0;
 
+    virtual SpaceErrCode PutBlockGroups(
+        uint32_t fsId,
+        const std::vector<BlockGroup>& blockGroups);
+
     virtual SpaceErrCode RemoveBlockGroup(uint32_t fsId, uint64_t offset) = 0;
 
     virtual SpaceErrCode ListBlockGroups(
@@ -65,6 +70,15 @@ class BlockGroupStorageImpl final : public BlockGroupStorage {
                                uint64_t offset,
                                const BlockGroup& blockGroup) override;
 
+    /**
+     * @brief Insert block groups into storage, several block groups are put
+     *        by one transaction to reduce round trips
+     * @return if success return SpaceOk, otherwise return error code
+     */
+    SpaceErrCode PutBlockGroups(
+        uint32_t fsId,
+        const std::vector<BlockGroup>& blockGroups) override;
+
     /**
      * @brief Remove a block group from storage
      * @return if success return SpaceOk, otherwise return error code
@@ -77,6 +91,12 @@ class BlockGroupStorageImpl final : public BlockGroupStorage {
     SpaceErrCode ListBlockGroups(uint32_t fsId,
                                  std::vector<BlockGroup>* blockGroups) override;
 
+ private:
+    SpaceErrCode EncodeBlockGroup(uint32_t fsId,
+                                  const BlockGroup& blockGroup,
+                                  std::string* key,
+                                  std::string* value);
+
  private:
     std::shared_ptr<curve::kvstorage::KVStorageClient> store_;
 };
@@ -26,10 +26,14 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "curvefs/proto/common.pb.h"
@@ -108,7 +112,8 @@ std::unique_ptr<VolumeSpace> VolumeSpace::Create(uint32_t fsId,
             VLOG(6) << "VolumeSpace init for fsid=" << fsId
                     << ", blockgroup=" << group.DebugString()
                     << " to allocatedGroups_";
-            space->allocatedGroups_.emplace(offset, std::move(group));
+            space->ShardOf(offset).allocatedGroups.emplace(
+                offset, std::move(group));
         } else if (group.deallocating_size() || group.deallocated_size()) {
             VLOG(6) << "VolumeSpace init for fsid=" << fsId
                     << ", blockgroup=" << group.DebugString()
@@ -119,7 +124,8 @@ std::unique_ptr<VolumeSpace> VolumeSpace::Create(uint32_t fsId,
             VLOG(6) << "VolumeSpace init for fsid=" << fsId
                     << ", blockgroup=" << group.DebugString()
                     << " to availableGroups_";
-            space->availableGroups_.emplace(offset, std::move(group));
+            space->ShardOf(offset).availableGroups.emplace(
+                offset, std::move(group));
         }
     }
 
@@ -128,25 +134,28 @@ std::unique_ptr<VolumeSpace> VolumeSpace::Create(uint32_t fsId,
         allOffsets.insert(off);
     }
 
-    std::unordered_set<uint64_t> cleanGroupOffsets;
-    std::set_difference(
-        allOffsets.begin(), allOffsets.end(), usedGroupOffsets.begin(),
-        usedGroupOffsets.end(),
-        std::inserter(cleanGroupOffsets, cleanGroupOffsets.end()));
+    std::vector<uint64_t> cleanGroupOffsets;
+    std::set_difference(allOffsets.begin(), allOffsets.end(),
+                        usedGroupOffsets.begin(), usedGroupOffsets.end(),
+                        std::back_inserter(cleanGroupOffsets));
 
-    space->cleanGroups_ = std::move(cleanGroupOffsets);
+    for (auto offset : cleanGroupOffsets) {
+        space->ShardOf(offset).cleanGroups.insert(offset);
+    }
 
     space->calcIntervalSec_ = calcIntervalSec;
 
+    const auto counts = space->CountGroups();
+
     LOG(INFO) << "Init volume space success, fsId: " << fsId
               << ", size: " << volumeSize << ", available: " << availableSize
               << ", block size: " << blockSize
               << ", block group size: " << blockGroupSize
               << ", total groups: " << volumeSize / blockGroupSize
-              << ", allocated groups: " << space->allocatedGroups_.size()
-              << ", available groups: " << space->availableGroups_.size()
+              << ", allocated groups: " << counts.allocated
+              << ", available groups: " << counts.available
               << ", deallocating groups: " << space->deallocatingGroups_.size()
-              << ", clean groups: " << space->cleanGroups_.size();
+              << ", clean groups: " << counts.clean;
 
     space->Run();
     return space;
@@ -158,15 +167,44 @@ VolumeSpace::VolumeSpace(uint32_t fsId,
                          FsStorage* fsStorage)
     : fsId_(fsId),
       volume_(std::move(volume)),
+      blockGroupSize_(volume_.blockgroupsize()),
+      bitmapLocation_(volume_.bitmaplocation()),
       storage_(storage),
-      fsStorage_(fsStorage) {}
+      fsStorage_(fsStorage) {
+    shards_.reserve(kShardNum);
+    for (uint32_t i = 0; i < kShardNum; ++i) {
+        shards_.push_back(absl::make_unique<Shard>());
+    }
+}
+
+VolumeSpace::Shard& VolumeSpace::ShardOf(uint64_t blockGroupOffset) const {
+    const uint64_t stripe = blockGroupOffset / blockGroupSize_ /
+                            kGroupsPerStripe;
+    return *shards_[stripe % kShardNum];
+}
+
+uint32_t VolumeSpace::HomeShard(const std::string& owner) const {
+    return std::hash<std::string>()(owner) % kShardNum;
+}
+
+VolumeSpace::GroupCounts VolumeSpace::CountGroups() const {
+    GroupCounts counts;
+    for (const auto& shard : shards_) {
+        LockGuard lk(shard->mtx);
+        counts.allocated += shard->allocatedGroups.size() +
+                            shard->allocatingGroups.size();
+        counts.available += shard->availableGroups.size();
+        counts.clean += shard->cleanGroups.size();
+    }
+
+    return counts;
+}
 
 
 SpaceErrCode VolumeSpace::AllocateBlockGroups(
     uint32_t count,
     const std::string& owner,
     std::vector<BlockGroup>* blockGroups) {
-    LockGuard lk(mtx_);
     auto err = AllocateBlockGroupsInternal(count, owner, blockGroups);
     if (blockGroups->size() < count) {
         LOG(WARNING) << "Allocate block groups not enough, fsId: " << fsId_
@@ -175,23 +213,6 @@ SpaceErrCode VolumeSpace::AllocateBlockGroups(
                      << ", allocated count: " << blockGroups->size();
     }
 
-    if (blockGroups->size() > 0) {
-        for (const auto &group : *blockGroups) {
-            allocatedGroups_.emplace(group.offset(), group);
-            VLOG(9) << "VolumeSpace fsid=" << fsId_
-                    << ", allocate blockgroup=" << group.DebugString()
-                    << " to owner:" << owner;
-        }
-
-        // TODO(@wu-hanqing): if persist fail, we should rollback
-        err = PersistBlockGroups(*blockGroups);
-        if (err != SpaceOk) {
-            LOG(WARNING) << "Mark group allocated failed, fsId: " << fsId_
-                         << ", err: " << SpaceErrCode_Name(err);
-            return err;
-        }
-    }
-
     return err;
 }
 
@@ -199,70 +220,154 @@ SpaceErrCode VolumeSpace::AllocateBlockGroupsInternal(
     uint32_t count,
     const std::string& owner,
     std::vector<BlockGroup>* blockGroups) {
-    bool extend = false;
-    uint32_t allocated = 0;
-
     VLOG(9) << "owner " << owner << " need allocate " << count
             << " block groups";
-    while (allocated < count) {
-        allocated += AllocateFromCleanGroups(count, owner, blockGroups);
-        if (allocated >= count) {
-            return SpaceOk;
+    uint32_t allocated = 0;
+    auto err = AllocateFromShards(count, owner, blockGroups, &allocated);
+    if (err != SpaceOk || allocated >= count) {
+        return err;
+    }
+
+    LockGuard lk(extendMtx_);
+
+    // volume may be extended by others while waiting for the lock
+    err = AllocateFromShards(count, owner, blockGroups, &allocated);
+    if (err != SpaceOk || allocated >= count) {
+        return err;
+    }
+
+    auto ret = ExtendVolume();
+    if (ret != SpaceOk) {
+        LOG(WARNING) << "Fail to extend volume, fsId: " << fsId_
+                     << ", err: " << SpaceErrCode_Name(ret);
+        // don't expose internal error
+        return SpaceErrNoSpace;
+    }
+
+    err = AllocateFromShards(count, owner, blockGroups, &allocated);
+    if (err != SpaceOk || allocated >= count) {
+        return err;
+    }
+
+    VLOG(9) << "only allocate " << allocated << " block groups to owner "
+            << owner;
+    return SpaceErrNoSpace;
+}
+
+SpaceErrCode VolumeSpace::AllocateFromShards(uint32_t count,
+                                             const std::string& owner,
+                                             std::vector<BlockGroup>* groups,
+                                             uint32_t* allocated) {
+    const uint32_t home = HomeShard(owner);
+    const size_t begin = groups->size();
+
+    // clean groups are preferred over available groups, block groups are
+    // only reserved under shard's lock, and persisted all at once after that
+    for (uint32_t i = 0; i < kShardNum && *allocated < count; ++i) {
+        Shard* shard = shards_[(home + i) % kShardNum].get();
+        LockGuard lk(shard->mtx);
+        *allocated += AllocateFromCleanGroups(shard, count - *allocated,
+                                              owner, groups);
+    }
+
+    const size_t cleanEnd = groups->size();
+    for (uint32_t i = 0; i < kShardNum && *allocated < count; ++i) {
+        Shard* shard = shards_[(home + i) % kShardNum].get();
+        LockGuard lk(shard->mtx);
+        *allocated += AllocateFromAvailableGroups(shard, count - *allocated,
+                                                  owner, groups);
+    }
+
+    if (groups->size() == begin) {
+        return SpaceOk;
+    }
+
+    auto err = PersistAllocatingGroups(begin, cleanEnd, groups);
+    if (err != SpaceOk) {
+        *allocated -= groups->size() - begin;
+        groups->resize(begin);
+    }
+
+    return err;
+}
+
+SpaceErrCode VolumeSpace::PersistAllocatingGroups(
+    size_t begin,
+    size_t cleanEnd,
+    std::vector<BlockGroup>* groups) {
+    std::vector<BlockGroup> allocating(groups->begin() + begin, groups->end());
+    auto err = PersistBlockGroups(allocating);
+    if (err == SpaceOk) {
+        for (auto& group : allocating) {
+            Shard& shard = ShardOf(group.offset());
+            LockGuard lk(shard.mtx);
+            shard.allocatingGroups.erase(group.offset());
+            shard.allocatedGroups.emplace(group.offset(), std::move(group));
         }
+        return SpaceOk;
+    }
 
-        allocated +=
-            AllocateFromAvailableGroups(count - allocated, owner, blockGroups);
-        if (allocated >= count) {
-            return SpaceOk;
+    LOG(WARNING) << "Mark group allocated failed, fsId: " << fsId_
+                 << ", err: " << SpaceErrCode_Name(err);
+
+    // give them back, some of them may have been written, so their records
+    // are restored as well, it's best effort and failures are only logged.
+    // nobody else can see these block groups until they're given back, so
+    // their records are restored without holding shard's lock
+    for (size_t i = 0; i < allocating.size(); ++i) {
+        auto& group = allocating[i];
+        const bool fromClean = begin + i < cleanEnd;
+        if (fromClean) {
+            ClearBlockGroup(group);
+        } else {
+            group.clear_owner();
+            PersistBlockGroup(group);
         }
 
-        if (!extend) {
-            extend = true;
-            auto ret = ExtendVolume();
-            if (ret != SpaceOk) {
-                LOG(WARNING) << "Fail to extend volume, fsId: " << fsId_
-                             << ", err: " << SpaceErrCode_Name(ret);
-                // don't expose internal error
-                return SpaceErrNoSpace;
-            }
+        Shard& shard = ShardOf(group.offset());
+        LockGuard lk(shard.mtx);
+        shard.allocatingGroups.erase(group.offset());
+        if (fromClean) {
+            shard.cleanGroups.insert(group.offset());
         } else {
-            VLOG(9) << "only allocate " << count << " block groups to owner "
-                    << owner;
-            break;
+            shard.availableGroups.emplace(group.offset(), std::move(group));
         }
     }
 
-    return SpaceErrNoSpace;
+    return err;
 }
 
-uint32_t VolumeSpace::AllocateFromCleanGroups(uint32_t count,
+uint32_t VolumeSpace::AllocateFromCleanGroups(Shard* shard,
+                                              uint32_t count,
                                               const std::string& owner,
                                               std::vector<BlockGroup>* groups) {
     uint32_t allocated = 0;
-    auto it = cleanGroups_.begin();
-    while (allocated < count && it != cleanGroups_.end()) {
+    auto it = shard->cleanGroups.begin();
+    while (allocated < count && it != shard->cleanGroups.end()) {
         auto offset = *it;
-        it = cleanGroups_.erase(it);
+        it = shard->cleanGroups.erase(it);
 
         ++allocated;
         groups->push_back(BuildBlockGroupFromClean(
-            offset, volume_.blockgroupsize(), volume_.bitmaplocation(), owner));
+            offset, blockGroupSize_, bitmapLocation_, owner));
+        shard->allocatingGroups.insert(offset);
     }
 
     return allocated;
 }
 
 uint32_t VolumeSpace::AllocateFromAvailableGroups(
+    Shard* shard,
     uint32_t count,
     const std::string& owner,
     std::vector<BlockGroup>* groups) {
     VLOG(9) << "VolumeSpace fsid=" << fsId_
             << ", allocate from available groups, count: " << count
             << ", owner: " << owner
-            << ", available size:" << availableGroups_.size();
+            << ", available size:" << shard->availableGroups.size();
     uint32_t allocated = 0;
-    auto it = availableGroups_.begin();
-    while (allocated < count && it != availableGroups_.end()) {
+    auto it = shard->availableGroups.begin();
+    while (allocated < count && it != shard->availableGroups.end()) {
         assert(!it->second.has_owner());
 
         float usePer = 1.0 - static_cast<float>(it->second.available()) /
@@ -279,8 +384,9 @@ uint32_t VolumeSpace::AllocateFromAvailableGroups(
                 << " to owner:" << owner;
         ++allocated;
         it->second.set_owner(owner);
+        shard->allocatingGroups.insert(it->first);
         groups->push_back(std::move(it->second));
-        it = availableGroups_.erase(it);
+        it = shard->availableGroups.erase(it);
     }
 
     return allocated;
@@ -289,62 +395,75 @@ uint32_t VolumeSpace::AllocateFromAvailableGroups(
 SpaceErrCode VolumeSpace::AcquireBlockGroup(uint64_t blockGroupOffset,
                                             const std::string& owner,
                                             BlockGroup* group) {
-    LockGuard lk(mtx_);
+    // block group is persisted with the locks protecting it held, otherwise
+    // a newer record written under the locks may be overwritten by it
+    Shard& shard = ShardOf(blockGroupOffset);
+    SpaceErrCode err = SpaceErrNotFound;
+    if (owner.empty()) {
+        // find in deallocating
+        LockGuard lk(mtx_);
+        auto it = deallocatingGroups_.find(blockGroupOffset);
+        if (it != deallocatingGroups_.end()) {
+            *group = it->second;
+            VLOG(6) << "VolumeSpace fsid=" << fsId_
+                    << ", recieve acquire blockgroup=" << group->DebugString()
+                    << " request from metaserver, current block group is "
+                       "under deallocating";
 
-    auto err = AcquireBlockGroupInternal(blockGroupOffset, owner, group);
-    if (err != SpaceOk) {
+            LockGuard shardlk(shard.mtx);
+            shard.allocatedGroups.emplace(blockGroupOffset, *group);
+            err = PersistAcquiredGroup(*group);
+        }
+    } else {
+        LockGuard lk(shard.mtx);
+        err = AcquireBlockGroupInternal(&shard, blockGroupOffset, owner,
+                                        group);
+        if (err == SpaceOk) {
+            err = PersistAcquiredGroup(*group);
+        }
+    }
+
+    if (err == SpaceErrNotFound || err == SpaceErrConflict) {
         LOG(WARNING) << "Acquire block group failed, fsId: " << fsId_
                      << ", block group offset: " << blockGroupOffset
                      << ", err: " << SpaceErrCode_Name(err);
-        return err;
     }
 
-    allocatedGroups_.emplace(blockGroupOffset, *group);
+    return err;
+}
 
-    err = PersistBlockGroup(*group);
+SpaceErrCode VolumeSpace::PersistAcquiredGroup(const BlockGroup& group) {
+    auto err = PersistBlockGroup(group);
     if (err != SpaceOk) {
         LOG(WARNING) << "Persist block group failed, fsId: " << fsId_
-                     << ", block group offset: " << blockGroupOffset
+                     << ", block group offset: " << group.offset()
                      << ", err: " << SpaceErrCode_Name(err);
     }
 
     return err;
 }
 
-SpaceErrCode VolumeSpace::AcquireBlockGroupInternal(uint64_t blockGroupOffset,
+SpaceErrCode VolumeSpace::AcquireBlockGroupInternal(Shard* shard,
+                                                    uint64_t blockGroupOffset,
                                                     const std::string& owner,
                                                     BlockGroup* group) {
-    if (owner.empty()) {
-        // find in deallocating
-        auto it = deallocatingGroups_.find(blockGroupOffset);
-        if (it == deallocatingGroups_.end()) {
-            return SpaceErrNotFound;
-        }
-
-        *group = it->second;
-        VLOG(6) << "VolumeSpace fsid=" << fsId_
-                << ", recieve acquire blockgroup=" << group->DebugString()
-                << " request from metaserver, current block group is under "
-                   "deallocating";
-        return SpaceOk;
-    }
-
     // find in availables
     {
-        auto it = availableGroups_.find(blockGroupOffset);
-        if (it != availableGroups_.end()) {
+        auto it = shard->availableGroups.find(blockGroupOffset);
+        if (it != shard->availableGroups.end()) {
             assert(!it->second.has_owner());
             *group = std::move(it->second);
             group->set_owner(owner);
-            availableGroups_.erase(it);
+            shard->availableGroups.erase(it);
+            shard->allocatedGroups.emplace(blockGroupOffset, *group);
             return SpaceOk;
         }
     }
 
     // find from allocated
     {
-        auto it = allocatedGroups_.find(blockGroupOffset);
-        if (it != allocatedGroups_.end()) {
+        auto it = shard->allocatedGroups.find(blockGroupOffset);
+        if (it != shard->allocatedGroups.end()) {
             assert(it->second.has_owner());
             if (it->second.owner() == owner) {
                 *group = it->second;
@@ -355,6 +474,11 @@ SpaceErrCode VolumeSpace::AcquireBlockGroupInternal(uint64_t blockGroupOffset,
         }
     }
 
+    // it's being allocated to some client
+    if (shard->allocatingGroups.count(blockGroupOffset) != 0) {
+        return SpaceErrConflict;
+    }
+
     // this shouldn't happen, because currently only delete inode needs acquire
     // block group and in this case, block group must not be emtpy
     {
@@ -362,11 +486,13 @@ SpaceErrCode VolumeSpace::AcquireBlockGroupInternal(uint64_t blockGroupOffset,
                      << ", block group offset: " << blockGroupOffset
                      << ", owner: " << owner;
 
-        if (cleanGroups_.count(blockGroupOffset) != 0) {
+        auto it = shard->cleanGroups.find(blockGroupOffset);
+        if (it != shard->cleanGroups.end()) {
             *group = BuildBlockGroupFromClean(blockGroupOffset,
-                                              volume_.blockgroupsize(),
-                                              volume_.bitmaplocation(), owner);
-            allocatedGroups_.emplace(blockGroupOffset, *group);
+                                              blockGroupSize_,
+                                              bitmapLocation_, owner);
+            shard->cleanGroups.erase(it);
+            shard->allocatedGroups.emplace(blockGroupOffset, *group);
             return SpaceOk;
         }
     }
@@ -374,32 +500,54 @@ SpaceErrCode VolumeSpace::AcquireBlockGroupInternal(uint64_t blockGroupOffset,
     return SpaceErrNotFound;
 }
 
-#define RELEASE_TO_AVAILABLE_GROUPS(GROUP)                                     \
-    do {                                                                       \
-        auto copy = GROUP;                                                     \
-        copy.clear_owner();                                                    \
-        auto err = PersistBlockGroup(copy);                                    \
-        if (err != SpaceOk) {                                                  \
-            LOG(WARNING) << "Persist block group failed, fsId: " << fsId_      \
-                         << ", block group offset: " << GROUP.offset()         \
-                         << ", err: " << SpaceErrCode_Name(err);               \
-            return err;                                                        \
-        }                                                                      \
-        VLOG(6) << "VolumeSpace return block group for fsid=" << fsId_         \
-                << " to availableGroups:" << GROUP.DebugString();              \
-        availableGroups_.emplace(GROUP.offset(), std::move(copy));             \
-    } while (0)
+SpaceErrCode VolumeSpace::ReleaseBlockGroup(Shard* shard,
+                                            const BlockGroup& group) {
+    // space is total available
+    if (group.available() == group.size()) {
+        auto err = ClearBlockGroup(group);
+        if (err != SpaceOk) {
+            LOG(WARNING) << "Clear block group failed, fsId: " << fsId_
+                         << ", block group offset: " << group.offset();
+            return err;
+        }
 
+        shard->cleanGroups.insert(group.offset());
+        VLOG(6) << "VolumeSpace fsid=" << fsId_
+                << " return block group to cleanGroups:"
+                << group.DebugString();
+        return SpaceOk;
+    }
+
+    return ReleaseToAvailableGroups(shard, group);
+}
+
+SpaceErrCode VolumeSpace::ReleaseToAvailableGroups(Shard* shard,
+                                                   const BlockGroup& group) {
+    auto copy = group;
+    copy.clear_owner();
+    auto err = PersistBlockGroup(copy);
+    if (err != SpaceOk) {
+        LOG(WARNING) << "Persist block group failed, fsId: " << fsId_
+                     << ", block group offset: " << group.offset()
+                     << ", err: " << SpaceErrCode_Name(err);
+        return err;
+    }
+
+    VLOG(6) << "VolumeSpace return block group for fsid=" << fsId_
+            << " to availableGroups:" << group.DebugString();
+    shard->availableGroups.emplace(group.offset(), std::move(copy));
+    return SpaceOk;
+}
 
 SpaceErrCode VolumeSpace::ReleaseBlockGroups(
     const std::vector<BlockGroup>& blockGroups) {
-    LockGuard lk(mtx_);
-
     for (auto& group : blockGroups) {
         VLOG(3) << "VolumeSpace fsid=" << fsId_
                 << ", need release block group:" << group.DebugString();
-        auto it = allocatedGroups_.find(group.offset());
-        if (it != allocatedGroups_.end()) {
+        Shard& shard = ShardOf(group.offset());
+        LockGuard lk(shard.mtx);
+        auto it = shard.allocatedGroups.find(group.offset());
+        if (it != shard.allocatedGroups.end()) {
             if (it->second.owner() != group.owner()) {
                 LOG(WARNING)
                     << "Owner is not identical, block group may "
@@ -410,24 +558,12 @@ SpaceErrCode VolumeSpace::ReleaseBlockGroups(
                 return SpaceErrConflict;
             }
 
-            // space is total available
-            if (group.available() == group.size()) {
-                auto err = ClearBlockGroup(group);
-                if (err != SpaceOk) {
-                    LOG(WARNING) << "Clear block group failed, fsId: " << fsId_
-                                 << ", block group offset: " << group.offset();
-                    return err;
-                }
-
-                cleanGroups_.insert(group.offset());
-                VLOG(6) << "VolumeSpace fsid=" << fsId_
-                        << " return block group to cleanGroups:"
-                        << group.DebugString();
-            } else {
-                RELEASE_TO_AVAILABLE_GROUPS(group);
+            auto err = ReleaseBlockGroup(&shard, group);
+            if (err != SpaceOk) {
+                return err;
             }
 
-            allocatedGroups_.erase(group.offset());
+            shard.allocatedGroups.erase(it);
             VLOG(6) << "VolumeSpace fsid=" << fsId_
                     << " erase block group from allocatedGroups:"
                     << group.DebugString();
@@ -435,7 +571,7 @@ SpaceErrCode VolumeSpace::ReleaseBlockGroups(
         }
         LOG(WARNING) << "VolumeSpace fsid=" << fsId_
                      << " could not get release block gorup:"
-                     << group.DebugString() << " in allocatedGroups_";
+                     << group.DebugString() << " in allocatedGroups";
         // and if it's not allocated, this request must be a retry request
     }
 
@@ -443,21 +579,26 @@ SpaceErrCode VolumeSpace::ReleaseBlockGroups(
 }
 
 SpaceErrCode VolumeSpace::ReleaseBlockGroups(const std::string &owner) {
-    LockGuard lk(mtx_);
-
     LOG(INFO) << "Release all block groups for " << owner << ", fsid=" << fsId_;
-    auto iter = allocatedGroups_.begin();
-    while (iter != allocatedGroups_.end()) {
-        auto &group = iter->second;
-        if (group.owner() != owner) {
-            VLOG(9) << "VolumeSpace fsid=" << fsId_ << " expect owner:" << owner
-                    << ", current block group:" << group.DebugString();
-            iter++;
-            continue;
-        }
+    for (auto& shard : shards_) {
+        LockGuard lk(shard->mtx);
+        auto iter = shard->allocatedGroups.begin();
+        while (iter != shard->allocatedGroups.end()) {
+            auto &group = iter->second;
+            if (group.owner() != owner) {
+                VLOG(9) << "VolumeSpace fsid=" << fsId_
+                        << " expect owner:" << owner
+                        << ", current block group:" << group.DebugString();
+                iter++;
+                continue;
+            }
 
-        RELEASE_TO_AVAILABLE_GROUPS(group);
-        iter = allocatedGroups_.erase(iter);
+            auto err = ReleaseToAvailableGroups(shard.get(), group);
+            if (err != SpaceOk) {
+                return err;
+            }
+            iter = shard->allocatedGroups.erase(iter);
+        }
     }
 
     return SpaceOk;
@@ -469,17 +610,13 @@ SpaceErrCode VolumeSpace::PersistBlockGroup(const BlockGroup& group) {
 
 SpaceErrCode VolumeSpace::PersistBlockGroups(
     const std::vector<BlockGroup>& blockGroups) {
-    SpaceErrCode err = SpaceOk;
-    for (const auto& group : blockGroups) {
-        err = PersistBlockGroup(group);
+    auto err = storage_->PutBlockGroups(fsId_, blockGroups);
 
-        // TODO(wuhanqing): handle error, and rollback if necessary
-        if (err != SpaceOk) {
-            LOG(ERROR) << "Put block group failed, fsId: " << fsId_
-                       << ", offset: " << group.offset()
-                       << ", err: " << SpaceErrCode_Name(err);
-            return err;
-        }
+    // TODO(wuhanqing): handle error, and rollback if necessary
+    if (err != SpaceOk) {
+        LOG(ERROR) << "Put block groups failed, fsId: " << fsId_
+                   << ", count: " << blockGroups.size()
+                   << ", err: " << SpaceErrCode_Name(err);
     }
 
     return err;
@@ -500,25 +637,30 @@ SpaceErrCode VolumeSpace::RemoveAllBlockGroups() {
     LOG(INFO) << "Going to remove all block groups from backend storage, fsId: "
               << fsId_;
 
-    LockGuard lk(mtx_);
-    for (auto& group : allocatedGroups_) {
-        // TODO(wuhanqing): clear all block groups once by prefix
-        auto err = ClearBlockGroup(group.second);
-        if (err != SpaceOk && err != SpaceErrNotFound) {
-            return err;
+    for (auto& shard : shards_) {
+        LockGuard lk(shard->mtx);
+        for (auto& group : shard->allocatedGroups) {
+            // TODO(wuhanqing): clear all block groups once by prefix
+            auto err = ClearBlockGroup(group.second);
+            if (err != SpaceOk && err != SpaceErrNotFound) {
+                return err;
+            }
         }
-    }
 
-    for (auto& group : availableGroups_) {
-        auto err = ClearBlockGroup(group.second);
-        if (err != SpaceOk && err != SpaceErrNotFound) {
-            return err;
+        for (auto& group : shard->availableGroups) {
+            auto err = ClearBlockGroup(group.second);
+            if (err != SpaceOk && err != SpaceErrNotFound) {
+                return err;
+            }
         }
     }
 
-    allocatedGroups_.clear();
-    availableGroups_.clear();
-    cleanGroups_.clear();
+    for (auto& shard : shards_) {
+        LockGuard lk(shard->mtx);
+        shard->allocatedGroups.clear();
+        shard->availableGroups.clear();
+        shard->cleanGroups.clear();
+    }
 
     return SpaceOk;
 }
@@ -543,9 +685,10 @@ bool VolumeSpace::UpdateFsInfo(uint64_t origin, uint64_t extended) {
 }
 
 void VolumeSpace::AddCleanGroups(uint64_t origin, uint64_t extended) {
-    for (auto offset = origin; offset < extended;
-         offset += volume_.blockgroupsize()) {
-        cleanGroups_.insert(offset);
+    for (auto offset = origin; offset < extended; offset += blockGroupSize_) {
+        Shard& shard = ShardOf(offset);
+        LockGuard lk(shard.mtx);
+        shard.cleanGroups.insert(offset);
     }
 }
 
@@ -567,10 +710,9 @@ void VolumeSpace::CalBlockGroupAvailableForDeAllocate() {
         assert(iter->second.deallocated_size() > 0);
 
         LOG(INFO)
-            << "VolumeSpace move deallocatingGroups_ to availableGroups_, "
+            << "VolumeSpace move deallocatingGroups_ to availableGroups, "
                "fsId="
-            << fsId_ << ", block group offset=" << iter->first
-            << ", available size=" << availableGroups_.size();
+            << fsId_ << ", block group offset=" << iter->first;
 
         iter->second.clear_deallocated();
         auto err = PersistBlockGroup(iter->second);
@@ -582,38 +724,39 @@ void VolumeSpace::CalBlockGroupAvailableForDeAllocate() {
         }
 
         iter->second.set_available(iter->second.size());
-        availableGroups_.emplace(iter->first, std::move(iter->second));
-        VLOG(9) << "VolumeSpace move deallocatingGroups_ to availableGroups_, "
-                   "fsId="
-                << fsId_ << ", block group offset=" << iter->first
-                << ", available size=" << availableGroups_.size();
+        {
+            Shard& shard = ShardOf(iter->first);
+            LockGuard shardlk(shard.mtx);
+            shard.availableGroups.emplace(iter->first,
+                                          std::move(iter->second));
+        }
         iter = deallocatingGroups_.erase(iter);
         metric_.dealloc << 1;
     }
 
+    // get the keys shared by available groups and summary_
+    std::vector<std::pair<uint64_t, uint64_t>> commonKeys;
+    if (waitDeallocateGroups_.empty() && deallocatingGroups_.empty()) {
+        for (const auto &item : summary_) {
+            Shard& shard = ShardOf(item.first);
+            LockGuard shardlk(shard.mtx);
+            if (shard.availableGroups.count(item.first)) {
+                commonKeys.push_back(item);
+            }
+        }
+    }
+
     // check whether the cal conditions are met
-    if (!waitDeallocateGroups_.empty() || !deallocatingGroups_.empty() ||
-        availableGroups_.empty() || summary_.empty()) {
+    if (commonKeys.empty()) {
         VLOG(3) << "VolumeSpace wait for cal, "
                      "waitDeallocateGroups_ size="
                   << waitDeallocateGroups_.size()
                   << ",deallocatingGroups_ size=" << deallocatingGroups_.size()
-                  << ",availableGroups_ size=" << availableGroups_.size()
-                  << ", allocatedGroups_ size=" << allocatedGroups_.size()
-                  << ", cleanGroups_ size=" << cleanGroups_.size()
                   << ",summary_ size=" << summary_.size()
                   << ", fsid=" << fsId_;
         return;
     }
 
-    // get the keys shared by availableGroups_ and summary_
-    std::vector<std::pair<uint64_t, uint64_t>> commonKeys;
-    for (const auto &item : summary_) {
-        if (availableGroups_.count(item.first)) {
-            commonKeys.push_back(item);
-        }
-    }
-
     // sort
     std::sort(commonKeys.begin(), commonKeys.end(),
               [](const std::pair<uint64_t, uint64_t> &a,
@@ -626,14 +769,21 @@ void VolumeSpace::CalBlockGroupAvailableForDeAllocate() {
     LOG(INFO) << "VolumeSpace cal blockgroup=" << selectKey << ",fsid=" << fsId_
               << " wait for deallocate";
 
-    // move key from availableGroups_ to waitDeallocateGroups_
+    // move key from available groups to waitDeallocateGroups_
     BlockGroup selectGroup;
-    auto it = availableGroups_.find(selectKey);
-    if (it != availableGroups_.end()) {
+    {
+        Shard& shard = ShardOf(selectKey);
+        LockGuard shardlk(shard.mtx);
+        auto it = shard.availableGroups.find(selectKey);
+        if (it == shard.availableGroups.end()) {
+            // allocated to some client after checked
+            return;
+        }
+
         assert(!it->second.has_owner());
         selectGroup = std::move(it->second);
         selectGroup.clear_owner();
-        availableGroups_.erase(it);
+        shard.availableGroups.erase(it);
     }
     assert(waitDeallocateGroups_.count(selectKey) == 0);
     waitDeallocateGroups_.emplace(selectKey, std::move(selectGroup));
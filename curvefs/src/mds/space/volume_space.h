@@ -28,10 +28,11 @@
 #include <gtest/gtest_prod.h>
 
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #include "curvefs/proto/common.pb.h"
@@ -142,23 +143,54 @@ class VolumeSpace final : public AbstractVolumeSpace {
     void Stop();
 
  private:
+    struct Shard;
+
     SpaceErrCode AllocateBlockGroupsInternal(
         uint32_t count,
         const std::string& owner,
         std::vector<BlockGroup>* blockGroups);
 
-    uint32_t AllocateFromAvailableGroups(uint32_t count,
+    // allocate from all shards until |*allocated| reaches |count|, starting
+    // with the home shard of |owner|, block groups are persisted in one
+    // request after all shards are unlocked
+    SpaceErrCode AllocateFromShards(uint32_t count,
+                                    const std::string& owner,
+                                    std::vector<BlockGroup>* groups,
+                                    uint32_t* allocated);
+
+    // persist block groups reserved since |begin|, those before |cleanEnd|
+    // come from clean groups. they're moved to allocated groups if
+    // succeeded, otherwise returned to clean or available groups, must be
+    // called without shard's lock held
+    SpaceErrCode PersistAllocatingGroups(size_t begin,
+                                         size_t cleanEnd,
+                                         std::vector<BlockGroup>* groups);
+
+    uint32_t AllocateFromAvailableGroups(Shard* shard,
+                                         uint32_t count,
                                          const std::string& owner,
                                          std::vector<BlockGroup>* groups);
 
-    uint32_t AllocateFromCleanGroups(uint32_t count,
+    uint32_t AllocateFromCleanGroups(Shard* shard,
+                                     uint32_t count,
                                      const std::string& owner,
                                      std::vector<BlockGroup>* groups);
 
-    SpaceErrCode AcquireBlockGroupInternal(uint64_t blockGroupOffset,
+    SpaceErrCode PersistAcquiredGroup(const BlockGroup& group);
+
+    SpaceErrCode AcquireBlockGroupInternal(Shard* shard,
+                                           uint64_t blockGroupOffset,
                                            const std::string& owner,
                                            BlockGroup* group);
 
+    // return block group to clean groups if its space is total available,
+    // otherwise return it to available groups
+    SpaceErrCode ReleaseBlockGroup(Shard* shard, const BlockGroup& group);
+
+    SpaceErrCode ReleaseToAvailableGroups(Shard* shard,
+                                          const BlockGroup& group);
+
+    // must be called with |extendMtx_| held
     SpaceErrCode ExtendVolume();
 
     bool UpdateFsInfo(uint64_t origin, uint64_t extended);
@@ -197,8 +229,6 @@ class VolumeSpace final : public AbstractVolumeSpace {
     const uint32_t fsId_;
     Volume volume_;
 
-    mutable bthread::Mutex mtx_;
-
     // block groups are divided into three types
     // 1. allocated
     //    these block groups are now owned by clients(curve-fuse or
@@ -223,15 +253,57 @@ class VolumeSpace final : public AbstractVolumeSpace {
     //    these block groups are being deallocated by metaservers, and they can
     //    not allocate to clients.
     //    these block groups are not persisted into storage.
+    //
+    // allocated, available and clean block groups are partitioned into
+    // shards, each shard has its own lock, so requests on different shards
+    // don't wait for each other. A shard consists of stripes of
+    // kGroupsPerStripe consecutive block groups, and a client allocates
+    // from the shard picked by its owner name first, so it receives
+    // physically adjacent block groups.
+    struct Shard {
+        bthread::Mutex mtx;
+
+        // key is block group offset
+        std::unordered_map<uint64_t, BlockGroup> allocatedGroups;
+
+        // offsets of block groups reserved by allocation but not persisted
+        // yet, they're invisible to release and acquire until then
+        std::set<uint64_t> allocatingGroups;
+
+        // key is block group offset
+        std::map<uint64_t, BlockGroup> availableGroups;
+
+        // stores clean block groups' offset
+        std::set<uint64_t> cleanGroups;
+    };
 
-    // key is block group offset
-    std::unordered_map<uint64_t, BlockGroup> allocatedGroups_;
+    static constexpr uint32_t kShardNum = 16;
+    static constexpr uint32_t kGroupsPerStripe = 8;
 
-    // key is block group offset
-    std::unordered_map<uint64_t, BlockGroup> availableGroups_;
+    Shard& ShardOf(uint64_t blockGroupOffset) const;
+
+    // the shard that |owner| allocates from first
+    uint32_t HomeShard(const std::string& owner) const;
+
+    struct GroupCounts {
+        size_t allocated = 0;
+        size_t available = 0;
+        size_t clean = 0;
+    };
 
-    // stores clean block groups' offset
-    std::unordered_set<uint64_t> cleanGroups_;
+    GroupCounts CountGroups() const;
+
+    const uint64_t blockGroupSize_;
+    const BitmapLocation bitmapLocation_;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // serialize volume extension, |volume_| is only changed under it
+    bthread::Mutex extendMtx_;
+
+    // protect waitDeallocate and deallocating block groups, lock order is
+    // |mtx_| -> |statmtx_| -> shard's lock
+    mutable bthread::Mutex mtx_;
 
     // key is block group offset
     std::unordered_map<uint64_t, BlockGroup> waitDeallocateGroups_;
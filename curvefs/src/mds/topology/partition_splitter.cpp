@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#include "curvefs/src/mds/topology/partition_splitter.h"
+
+#include <glog/logging.h>
+
+#include <chrono>  //NOLINT
+#include <list>
+#include <vector>
+
+namespace curvefs {
+namespace mds {
+namespace topology {
+
+void PartitionSplitter::Init(const TopologyOption &option) {
+    option_ = option;
+}
+
+void PartitionSplitter::Run() {
+    if (option_.splitPartitionIntervalSec == 0) {
+        LOG(INFO) << "partition splitter is disabled";
+        return;
+    }
+
+    if (isStop_.exchange(false)) {
+        backEndThread_ =
+            curve::common::Thread(&PartitionSplitter::BackEndFunc, this);
+    }
+}
+
+void PartitionSplitter::Stop() {
+    if (!isStop_.exchange(true)) {
+        LOG(INFO) << "stop PartitionSplitter...";
+        sleeper_.interrupt();
+        backEndThread_.join();
+        LOG(INFO) << "stop PartitionSplitter ok.";
+    }
+}
+
+bool PartitionSplitter::IsHotPartition(const Partition &partition) const {
+    if (partition.GetStatus() != PartitionStatus::READWRITE) {
+        return false;
+    }
+
+    if (option_.splitPartitionRequestRate != 0 &&
+        partition.GetRequestRate() > option_.splitPartitionRequestRate) {
+        return true;
+    }
+
+    return option_.splitPartitionInodeNum != 0 &&
+           partition.GetInodeNum() > option_.splitPartitionInodeNum;
+}
+
+int PartitionSplitter::SplitHotPartitions() {
+    std::list<Partition> hotPartitions;
+    for (const auto poolId : topo_->GetPoolInCluster()) {
+        auto partitions = topo_->GetPartitionInfosInPool(
+            poolId, [this](const Partition &partition) {
+                return IsHotPartition(partition);
+            });
+        hotPartitions.splice(hotPartitions.end(), partitions);
+    }
+
+    int splitNum = 0;
+    for (const auto &partition : hotPartitions) {
+        PartitionInfo newPartition;
+        TopoStatusCode ret = topologyManager_->SplitPartition(
+            partition.GetPartitionId(), &newPartition);
+        if (ret != TopoStatusCode::TOPO_OK) {
+            LOG(WARNING) << "split hot partition fail, partitionId = "
+                         << partition.GetPartitionId()
+                         << ", requestRate = " << partition.GetRequestRate()
+                         << ", inodeNum = " << partition.GetInodeNum()
+                         << ", ret = " << TopoStatusCode_Name(ret);
+            continue;
+        }
+        splitNum++;
+    }
+    return splitNum;
+}
+
+void PartitionSplitter::BackEndFunc() {
+    while (sleeper_.wait_for(
+        std::chrono::seconds(option_.splitPartitionIntervalSec))) {
+        SplitHotPartitions();
+    }
+}
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace curvefs
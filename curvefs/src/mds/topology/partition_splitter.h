@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#ifndef CURVEFS_SRC_MDS_TOPOLOGY_PARTITION_SPLITTER_H_
+#define CURVEFS_SRC_MDS_TOPOLOGY_PARTITION_SPLITTER_H_
+
+#include <memory>
+
+#include "curvefs/src/mds/topology/topology.h"
+#include "curvefs/src/mds/topology/topology_config.h"
+#include "curvefs/src/mds/topology/topology_manager.h"
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/interruptible_sleeper.h"
+
+namespace curvefs {
+namespace mds {
+namespace topology {
+
+using ::curve::common::InterruptibleSleeper;
+
+// Find partitions that serve too many requests or hold too many inodes
+// from the statistics reported by metaserver heartbeats, and split each
+// of them by creating a new partition on the least loaded copyset.
+class PartitionSplitter {
+ public:
+    PartitionSplitter(std::shared_ptr<Topology> topo,
+                      std::shared_ptr<TopologyManager> topologyManager)
+        : topo_(topo), topologyManager_(topologyManager), isStop_(true) {}
+    ~PartitionSplitter() { Stop(); }
+
+    void Init(const TopologyOption &option);
+
+    void Run();
+
+    void Stop();
+
+    /**
+     * @brief split all hot partitions in cluster
+     *
+     * @return the number of partitions split
+     */
+    int SplitHotPartitions();
+
+ private:
+    bool IsHotPartition(const Partition &partition) const;
+
+    void BackEndFunc();
+
+ private:
+    std::shared_ptr<Topology> topo_;
+    std::shared_ptr<TopologyManager> topologyManager_;
+
+    curve::common::Thread backEndThread_;
+    curve::common::Atomic<bool> isStop_;
+    InterruptibleSleeper sleeper_;
+
+    TopologyOption option_;
+};
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_MDS_TOPOLOGY_PARTITION_SPLITTER_H_
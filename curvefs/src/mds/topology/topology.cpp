@@ -37,6 +37,7 @@ namespace mds {
 namespace topology {
 
 using ::curve::common::UUIDGenerator;
+using ::curve::common::TimeUtility;
 
 PoolIdType TopologyImpl::AllocatePoolId() { return idGenerator_->GenPoolId(); }
 
@@ -624,7 +625,12 @@ TopologyImpl::UpdatePartitionStatistic(uint32_t partitionId,
     auto it = partitionMap_.find(partitionId);
     if (it != partitionMap_.end()) {
         Partition temp = it->second;
-        temp.SetStatus(statistic.status);
+        // partition never goes back to READWRITE, it may be set READONLY by
+        // splitting after the heartbeat was checked
+        if (statistic.status != PartitionStatus::READWRITE ||
+            temp.GetStatus() == PartitionStatus::READWRITE) {
+            temp.SetStatus(statistic.status);
+        }
         temp.SetInodeNum(statistic.inodeNum);
         temp.SetDentryNum(statistic.dentryNum);
         temp.SetFileType2InodeNum(statistic.fileType2InodeNum);
@@ -656,6 +662,20 @@ TopoStatusCode TopologyImpl::UpdatePartitionStatus(PartitionIdType partitionId,
     }
 }
 
+// request statistic changes on every heartbeat, it's kept in memory only
+TopoStatusCode TopologyImpl::UpdatePartitionRequestNum(
+    PartitionIdType partitionId, uint64_t requestNum) {
+    WriteLockGuard wlockPartition(partitionMutex_);
+    auto it = partitionMap_.find(partitionId);
+    if (it != partitionMap_.end()) {
+        it->second.UpdateRequestRate(requestNum,
+                                     TimeUtility::GetTimeofDayMs());
+        return TopoStatusCode::TOPO_OK;
+    } else {
+        return TopoStatusCode::TOPO_PARTITION_NOT_FOUND;
+    }
+}
+
 bool TopologyImpl::GetPartition(PartitionIdType partitionId, Partition *out) {
     ReadLockGuard rlockPartition(partitionMutex_);
     auto it = partitionMap_.find(partitionId);
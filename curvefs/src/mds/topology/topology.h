@@ -136,6 +136,8 @@ class Topology {
         std::vector<PartitionTxId> txIds) = 0;
     virtual TopoStatusCode UpdatePartitionStatus(PartitionIdType partitionId,
                                                  PartitionStatus status) = 0;
+    virtual TopoStatusCode UpdatePartitionRequestNum(
+        PartitionIdType partitionId, uint64_t requestNum) = 0;
 
     virtual TopoStatusCode SetCopySetAvalFlag(const CopySetKey &key,
                                               bool aval) = 0;
@@ -362,6 +364,8 @@ class TopologyImpl : public Topology {
         std::vector<PartitionTxId> txIds) override;
     TopoStatusCode UpdatePartitionStatus(PartitionIdType partitionId,
         PartitionStatus status) override;
+    TopoStatusCode UpdatePartitionRequestNum(PartitionIdType partitionId,
+                                             uint64_t requestNum) override;
 
     PoolIdType FindPool(const std::string &poolName) const override;
     ZoneIdType FindZone(const std::string &zoneName,
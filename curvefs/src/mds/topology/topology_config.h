@@ -42,6 +42,12 @@ struct TopologyOption {
     uint32_t maxCopysetNumInMetaserver;
     // time interval for updating topology metric
     uint32_t UpdateMetricIntervalSec;
+    // time interval for checking hot partitions, 0 means never split
+    uint32_t splitPartitionIntervalSec;
+    // split partition whose inode creating rate exceeds it, 0 means no limit
+    uint64_t splitPartitionRequestRate;
+    // split partition whose inode number exceeds it, 0 means no limit
+    uint64_t splitPartitionInodeNum;
 
     TopologyOption()
         : topologyUpdateToRepoSec(0),
@@ -49,7 +55,10 @@ struct TopologyOption {
           idNumberInPartition(1048576),
           createPartitionNumber(12),
           maxCopysetNumInMetaserver(100),
-          UpdateMetricIntervalSec(60) {}
+          UpdateMetricIntervalSec(60),
+          splitPartitionIntervalSec(0),
+          splitPartitionRequestRate(0),
+          splitPartitionInodeNum(0) {}
 };
 
 }  // namespace topology
@@ -308,6 +308,16 @@ common::PartitionInfo Partition::ToPartitionInfo() {
     return info;
 }
 
+void Partition::UpdateRequestRate(uint64_t requestNum, uint64_t nowMs) {
+    if (requestStatTimeMs_ != 0 && nowMs > requestStatTimeMs_ &&
+        requestNum >= requestNum_) {
+        requestRate_ = (requestNum - requestNum_) * 1000 /
+                       (nowMs - requestStatTimeMs_);
+    }
+    requestNum_ = requestNum;
+    requestStatTimeMs_ = nowMs;
+}
+
 bool MemcacheCluster::ParseFromString(const std::string &value) {
     MemcacheClusterInfo data;
     bool ret = data.ParseFromString(value);
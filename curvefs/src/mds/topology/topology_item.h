@@ -639,7 +639,10 @@ class Partition {
           txId_(0),
           status_(PartitionStatus::READWRITE),
           inodeNum_(0),
-          dentryNum_(0) {
+          dentryNum_(0),
+          requestNum_(0),
+          requestRate_(0),
+          requestStatTimeMs_(0) {
         InitFileType2InodeNum();
     }
 
@@ -655,7 +658,10 @@ class Partition {
           txId_(0),
           status_(PartitionStatus::READWRITE),
           inodeNum_(0),
-          dentryNum_(0) {
+          dentryNum_(0),
+          requestNum_(0),
+          requestRate_(0),
+          requestStatTimeMs_(0) {
         InitFileType2InodeNum();
     }
 
@@ -671,6 +677,9 @@ class Partition {
           status_(v.status_),
           inodeNum_(v.inodeNum_),
           dentryNum_(v.dentryNum_),
+          requestNum_(v.requestNum_),
+          requestRate_(v.requestRate_),
+          requestStatTimeMs_(v.requestStatTimeMs_),
           fileType2InodeNum_(v.fileType2InodeNum_) {}
 
     Partition &operator=(const Partition &v) {
@@ -688,6 +697,9 @@ class Partition {
         status_ = v.status_;
         inodeNum_ = v.inodeNum_;
         dentryNum_ = v.dentryNum_;
+        requestNum_ = v.requestNum_;
+        requestRate_ = v.requestRate_;
+        requestStatTimeMs_ = v.requestStatTimeMs_;
         fileType2InodeNum_ = v.fileType2InodeNum_;
         return *this;
     }
@@ -703,6 +715,9 @@ class Partition {
         status_ = v.status();
         inodeNum_ = v.has_inodenum() ? v.inodenum() : 0;
         dentryNum_ = v.has_dentrynum() ? v.dentrynum() : 0;
+        requestNum_ = v.has_requestnum() ? v.requestnum() : 0;
+        requestRate_ = 0;
+        requestStatTimeMs_ = 0;
         for (auto const& i : v.filetype2inodenum()) {
             fileType2InodeNum_.emplace(static_cast<FileType>(i.first),
                                        i.second);
@@ -778,6 +793,27 @@ class Partition {
 
     void SetDentryNum(uint64_t dentryNum) { dentryNum_ = dentryNum; }
 
+    uint64_t GetRequestNum() const { return requestNum_; }
+
+    void SetRequestNum(uint64_t requestNum) { requestNum_ = requestNum; }
+
+    // inode creating requests per second between the last two heartbeats
+    uint64_t GetRequestRate() const { return requestRate_; }
+
+    void SetRequestRate(uint64_t requestRate) { requestRate_ = requestRate; }
+
+    /**
+     * @brief update request rate with request number reported by heartbeat,
+     *        every replica counts the requests it applies since it started,
+     *        so the number may go back when the reporting leader changes,
+     *        and the rate is kept in that case
+     *
+     * @param[in] requestNum inode creating requests applied by the leader
+     *            replica since it started
+     * @param[in] nowMs current time in milliseconds
+     */
+    void UpdateRequestRate(uint64_t requestNum, uint64_t nowMs);
+
     ::curve::common::RWLock &GetRWLockRef() const { return mutex_; }
 
     bool SerializeToString(std::string *value) const;
@@ -814,6 +850,10 @@ class Partition {
     common::PartitionStatus status_;
     uint64_t inodeNum_;
     uint64_t dentryNum_;
+    // request statistic, only in memory
+    uint64_t requestNum_;
+    uint64_t requestRate_;
+    uint64_t requestStatTimeMs_;
     std::unordered_map<FileType, uint64_t> fileType2InodeNum_;
     mutable ::curve::common::RWLock mutex_;
 };
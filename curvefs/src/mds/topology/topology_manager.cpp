@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <chrono>  //NOLINT
 #include <list>
+#include <map>
 #include <set>
 #include <string>
 #include <thread>  //NOLINT
@@ -752,6 +753,94 @@ void TopologyManager::CreatePartitions(const CreatePartitionRequest *request,
     }
 }
 
+TopoStatusCode TopologyManager::SplitPartition(PartitionIdType partitionId,
+                                               PartitionInfo *newPartition) {
+    Partition partition;
+    if (!topology_->GetPartition(partitionId, &partition)) {
+        LOG(WARNING) << "SplitPartition, partition not found, partitionId = "
+                     << partitionId;
+        return TopoStatusCode::TOPO_PARTITION_NOT_FOUND;
+    }
+
+    if (partition.GetStatus() != PartitionStatus::READWRITE) {
+        LOG(WARNING) << "SplitPartition, partition is not READWRITE"
+                     << ", partitionId = " << partitionId;
+        return TopoStatusCode::TOPO_INVALID_PARAM;
+    }
+
+    FsIdType fsId = partition.GetFsId();
+    NameLockGuard lock(createPartitionMutex_, std::to_string(fsId));
+
+    // request rate of copysets, the copyset of the hot partition is excluded
+    CopySetKey hotKey(partition.GetPoolId(), partition.GetCopySetId());
+    std::vector<CopySetInfo> copysetVec = topology_->GetAvailableCopysetList();
+    std::map<CopySetKey, uint64_t> copysetLoad;
+    for (const auto &copyset : copysetVec) {
+        copysetLoad[copyset.GetCopySetKey()] = 0;
+    }
+    std::set<PoolIdType> pools;
+    for (const auto &copyset : copysetVec) {
+        pools.insert(copyset.GetPoolId());
+    }
+    for (const auto poolId : pools) {
+        for (const auto &p : topology_->GetPartitionInfosInPool(poolId)) {
+            auto iter = copysetLoad.find(
+                CopySetKey(p.GetPoolId(), p.GetCopySetId()));
+            if (iter != copysetLoad.end()) {
+                iter->second += p.GetRequestRate();
+            }
+        }
+    }
+
+    const CopySetInfo *target = nullptr;
+    uint64_t targetLoad = 0;
+    for (const auto &copyset : copysetVec) {
+        if (copyset.GetCopySetKey() == hotKey) {
+            continue;
+        }
+        uint64_t load = copysetLoad[copyset.GetCopySetKey()];
+        if (nullptr == target || load < targetLoad ||
+            (load == targetLoad &&
+             copyset.GetPartitionNum() < target->GetPartitionNum())) {
+            target = &copyset;
+            targetLoad = load;
+        }
+    }
+
+    if (nullptr == target) {
+        LOG(WARNING) << "SplitPartition, no available copyset other than "
+                     << "the one of partition " << partitionId;
+        return TopoStatusCode::TOPO_GET_AVAILABLE_COPYSET_ERROR;
+    }
+
+    TopoStatusCode ret = CreatePartitionOnCopyset(fsId, *target, newPartition);
+    if (ret != TopoStatusCode::TOPO_OK) {
+        LOG(ERROR) << "SplitPartition, create partition fail, fsId = " << fsId
+                   << ", partitionId = " << partitionId
+                   << ", ret = " << TopoStatusCode_Name(ret);
+        return ret;
+    }
+
+    // the new partition is ready, stop allocating inodes on the hot one
+    ret = topology_->UpdatePartitionStatus(partitionId,
+                                           PartitionStatus::READONLY);
+    if (ret != TopoStatusCode::TOPO_OK) {
+        LOG(ERROR) << "SplitPartition, update partition status fail"
+                   << ", partitionId = " << partitionId
+                   << ", ret = " << TopoStatusCode_Name(ret);
+        return ret;
+    }
+
+    LOG(INFO) << "SplitPartition success, fsId = " << fsId
+              << ", partitionId = " << partitionId
+              << ", requestRate = " << partition.GetRequestRate()
+              << ", inodeNum = " << partition.GetInodeNum()
+              << ", new partitionId = " << newPartition->partitionid()
+              << ", on copyset (" << newPartition->poolid() << ", "
+              << newPartition->copysetid() << ")";
+    return TopoStatusCode::TOPO_OK;
+}
+
 TopoStatusCode TopologyManager::DeletePartition(uint32_t partitionId) {
     DeletePartitionRequest request;
     DeletePartitionResponse response;
@@ -963,6 +1052,10 @@ void TopologyManager::GetMetaServerListInCopysets(
                     return;
                 }
             }
+            if (info.GetLeader() !=
+                static_cast<MetaServerIdType>(UNINITIALIZE_ID)) {
+                serverInfo->set_leaderid(info.GetLeader());
+            }
         } else {
             LOG(ERROR) << "GetCopyset failed when GetMetaServerListInCopysets.";
             response->set_statuscode(TopoStatusCode::TOPO_COPYSET_NOT_FOUND);
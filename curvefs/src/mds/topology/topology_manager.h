@@ -117,6 +117,20 @@ class TopologyManager {
 
     virtual TopoStatusCode DeletePartition(uint32_t partitionId);
 
+    /**
+     * @brief split a hot partition, create a new partition for the fs on the
+     *        least loaded copyset and mark the hot one READONLY, so that
+     *        new inodes go to the new partition. inodes and dentries already
+     *        in the hot partition stay where they are.
+     *
+     * @param[in] partitionId the hot partition
+     * @param[out] newPartition the partition created
+     *
+     * @return TOPO_OK if success, otherwise error code
+     */
+    virtual TopoStatusCode SplitPartition(PartitionIdType partitionId,
+                                          PartitionInfo *newPartition);
+
     virtual TopoStatusCode CommitTxId(const std::vector<PartitionTxId>& txIds);
 
     virtual void CommitTx(const CommitTxRequest *request,
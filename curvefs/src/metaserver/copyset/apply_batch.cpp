@@ -0,0 +1,177 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-10
+ */
+
+#include "curvefs/src/metaserver/copyset/apply_batch.h"
+
+#include <glog/logging.h>
+
+#include <mutex>
+
+#include "curvefs/src/metaserver/copyset/copyset_node.h"
+
+namespace curvefs {
+namespace metaserver {
+namespace copyset {
+
+void DeferredClosure::Run() {
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!released_) {
+            ran_ = true;
+            return;
+        }
+    }
+
+    RunAndDelete();
+}
+
+void DeferredClosure::Release() {
+    bool ran = false;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        released_ = true;
+        ran = ran_;
+    }
+
+    if (ran) {
+        RunAndDelete();
+    }
+}
+
+void DeferredClosure::RunAndDelete() {
+    std::unique_ptr<DeferredClosure> selfGuard(this);
+    done_->Run();
+}
+
+void ApplyBatch::Add(MetaOperator* op, int64_t index,
+                     google::protobuf::Closure* done, uint64_t startTimeUs) {
+    items_.push_back({op, index, done, startTimeUs});
+}
+
+void ApplyBatch::AddFromLog(MetaOperator* op, uint64_t startTimeUs) {
+    items_.push_back({op, 0, nullptr, startTimeUs});
+}
+
+OperatorType ApplyBatch::GetOperatorType() const {
+    CHECK(!items_.empty());
+    return items_.front().op->GetOperatorType();
+}
+
+void ApplyBatch::Apply() {
+    auto* metaStore = node_->GetMetaStore();
+    const bool batched = items_.size() > 1 && metaStore->BeginApplyBatch();
+
+    std::vector<DeferredClosure*> deferred;
+    for (const auto& item : items_) {
+        if (nullptr == item.done) {
+            item.op->OnApplyFromLog(item.startTimeUs);
+            continue;
+        }
+
+        google::protobuf::Closure* done = item.done;
+        if (batched) {
+            deferred.push_back(new DeferredClosure(done));
+            done = deferred.back();
+        }
+        item.op->OnApply(item.index, done, item.startTimeUs);
+    }
+
+    if (batched && !metaStore->CommitApplyBatch()) {
+        // modifications of the whole batch are lost, fail the operators just
+        // like a storage error of a single operator
+        LOG(ERROR) << "Commit apply batch failed, copyset: " << node_->Name()
+                   << ", batch size: " << items_.size();
+        for (const auto& item : items_) {
+            if (nullptr != item.done) {
+                item.op->OnFailed(MetaStatusCode::STORAGE_INTERNAL_ERROR);
+            }
+        }
+    }
+
+    for (auto* done : deferred) {
+        done->Release();
+    }
+    items_.clear();
+}
+
+bool ApplyBatch::CanApplyInBatch(OperatorType type) {
+    switch (type) {
+        case OperatorType::CreateDentry:
+        case OperatorType::DeleteDentry:
+        case OperatorType::CreateInode:
+        case OperatorType::UpdateInode:
+        case OperatorType::DeleteInode:
+        case OperatorType::CreateRootInode:
+        case OperatorType::CreateManageInode:
+        case OperatorType::CreatePartition:
+        case OperatorType::DeletePartition:
+        case OperatorType::PrepareRenameTx:
+        case OperatorType::UpdateVolumeExtent:
+        case OperatorType::UpdateDeallocatableBlockGroup:
+        case OperatorType::BatchUpdateInodeAttr:
+            return true;
+        // GetOrModifyS3ChunkInfo may return an iterator which is used for
+        // streaming after the operator is applied, so it's applied alone
+        default:
+            return false;
+    }
+}
+
+void ApplyBatchGroup::Add(MetaOperator* op, int64_t index,
+                          google::protobuf::Closure* done,
+                          uint64_t startTimeUs) {
+    const auto hashCode = op->HashCode();
+    GetBatch(hashCode)->Add(op, index, done, startTimeUs);
+    PushIfFull(hashCode);
+}
+
+void ApplyBatchGroup::AddFromLog(MetaOperator* op, uint64_t startTimeUs) {
+    const auto hashCode = op->HashCode();
+    GetBatch(hashCode)->AddFromLog(op, startTimeUs);
+    PushIfFull(hashCode);
+}
+
+void ApplyBatchGroup::PushAll() {
+    for (const auto& batch : batches_) {
+        push_(batch.second);
+    }
+    batches_.clear();
+}
+
+ApplyBatch* ApplyBatchGroup::GetBatch(uint64_t hashCode) {
+    auto& batch = batches_[hashCode];
+    if (nullptr == batch) {
+        batch = std::make_shared<ApplyBatch>(node_, hashCode);
+    }
+    return batch.get();
+}
+
+void ApplyBatchGroup::PushIfFull(uint64_t hashCode) {
+    auto it = batches_.find(hashCode);
+    if (it->second->Size() >= maxBatchSize_) {
+        push_(it->second);
+        batches_.erase(it);
+    }
+}
+
+}  // namespace copyset
+}  // namespace metaserver
+}  // namespace curvefs
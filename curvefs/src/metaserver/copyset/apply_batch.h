@@ -0,0 +1,150 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-10
+ */
+
+#ifndef CURVEFS_SRC_METASERVER_COPYSET_APPLY_BATCH_H_
+#define CURVEFS_SRC_METASERVER_COPYSET_APPLY_BATCH_H_
+
+#include <google/protobuf/stubs/callback.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "curvefs/src/metaserver/copyset/meta_operator.h"
+#include "curvefs/src/metaserver/copyset/operator_type.h"
+
+namespace curvefs {
+namespace metaserver {
+namespace copyset {
+
+class CopysetNode;
+
+// Hold the operator's closure until the batch is committed, if the closure
+// is run before that, the real closure is run when releasing
+class DeferredClosure : public google::protobuf::Closure {
+ public:
+    explicit DeferredClosure(google::protobuf::Closure* done) : done_(done) {}
+
+    void Run() override;
+
+    void Release();
+
+ private:
+    void RunAndDelete();
+
+ private:
+    google::protobuf::Closure* done_;
+    std::mutex mtx_;
+    bool ran_ = false;
+    bool released_ = false;
+};
+
+// Consecutive write operators with the same hash code in one raft apply
+// round, they are applied in order by one apply queue task and all their
+// modifications are committed to storage at once.
+//
+// Operators' closures are deferred until the batch is committed, so that
+// a client never observes a response whose modification isn't visible to
+// lease reads yet.
+class ApplyBatch {
+ public:
+    ApplyBatch(CopysetNode* node, uint64_t hashCode)
+        : node_(node), hashCode_(hashCode) {}
+
+    // Add an operator proposed by current node, |done| is the raft closure
+    void Add(MetaOperator* op, int64_t index, google::protobuf::Closure* done,
+             uint64_t startTimeUs);
+
+    // Add an operator decoded from raft log, the batch takes its ownership
+    void AddFromLog(MetaOperator* op, uint64_t startTimeUs);
+
+    size_t Size() const { return items_.size(); }
+
+    uint64_t HashCode() const { return hashCode_; }
+
+    // All operators in a batch are write operators, so the type of first
+    // one is used to schedule the batch
+    OperatorType GetOperatorType() const;
+
+    // Apply all operators in order, if the batch can't be committed,
+    // operators proposed by current node fail with STORAGE_INTERNAL_ERROR
+    void Apply();
+
+    // Whether operator of |type| can be applied in a batch
+    static bool CanApplyInBatch(OperatorType type);
+
+ private:
+    struct Item {
+        MetaOperator* op;
+        int64_t index;
+        google::protobuf::Closure* done;
+        uint64_t startTimeUs;
+    };
+
+    CopysetNode* node_;
+    uint64_t hashCode_;
+    std::vector<Item> items_;
+};
+
+// Group operators of one raft apply round into batches by hash code, a batch
+// is pushed once it's full, and all pending batches are pushed before an
+// operator which can't be batched, so that operators with the same hash code
+// are still applied in log order.
+class ApplyBatchGroup {
+ public:
+    using PushFunc = std::function<void(const std::shared_ptr<ApplyBatch>&)>;
+
+    ApplyBatchGroup(CopysetNode* node, uint32_t maxBatchSize, PushFunc push)
+        : node_(node), maxBatchSize_(maxBatchSize), push_(std::move(push)) {}
+
+    // Whether operator of |type| is added into a batch rather than applied
+    // alone, batching is disabled if max batch size is less than 2
+    bool CanBatch(OperatorType type) const {
+        return maxBatchSize_ > 1 && ApplyBatch::CanApplyInBatch(type);
+    }
+
+    void Add(MetaOperator* op, int64_t index, google::protobuf::Closure* done,
+             uint64_t startTimeUs);
+
+    void AddFromLog(MetaOperator* op, uint64_t startTimeUs);
+
+    void PushAll();
+
+ private:
+    ApplyBatch* GetBatch(uint64_t hashCode);
+
+    void PushIfFull(uint64_t hashCode);
+
+ private:
+    CopysetNode* node_;
+    uint32_t maxBatchSize_;
+    PushFunc push_;
+    std::unordered_map<uint64_t, std::shared_ptr<ApplyBatch>> batches_;
+};
+
+}  // namespace copyset
+}  // namespace metaserver
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_METASERVER_COPYSET_APPLY_BATCH_H_
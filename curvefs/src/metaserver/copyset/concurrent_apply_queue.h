@@ -108,6 +108,20 @@ class CURVE_CACHELINE_ALIGNMENT ApplyQueue {
         return true;
     }
 
+    /**
+     * PushToWriteQueue: push task to write queue regardless of its type,
+     * so it's executed after all write tasks pushed before with the same key
+     * @param[in] key: used to hash task to specified queue
+     * @param[in] f: task
+     * @param[in] args: param to excute task
+     */
+    template <class F, class... Args>
+    bool PushToWriteQueue(uint64_t key, F&& f, Args&&... args) {
+        wapplyMap_[Hash(key, wconcurrentsize_)]->tq.Push(
+                std::forward<F>(f), std::forward<Args>(args)...);
+        return true;
+    }
+
     /**
      * Flush: finish all task in write threads
      */
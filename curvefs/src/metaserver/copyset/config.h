@@ -55,6 +55,18 @@ struct CopysetNodeOptions {
     // Default: true
     bool enbaleLeaseRead;
 
+    // enable follower read
+    // If true, read requests received by a follower are served locally after
+    // it has applied the committed index fetched from leader (read index),
+    // otherwise they are redirected to leader.
+    // Default: false
+    bool enableFollowerRead;
+
+    // the maximum time in milliseconds a follower read waits for local
+    // apply to catch up with the read index before redirecting to leader
+    // Default: 500
+    uint32_t followerReadTimeoutMs;
+
     // the number of concurrent recovery loads of copyset
     // Default: 1
     uint32_t loadConcurrency;
@@ -82,6 +94,11 @@ struct CopysetNodeOptions {
     // apply queue options
     ApplyOption applyQueueOption;
 
+    // maximum number of write operators with the same hash code which are
+    // committed to storage at once in one raft apply round, 1 means disable
+    // Default: 32
+    uint32_t applyBatchSize;
+
     // filesystem adaptor
     curve::fs::LocalFileSystem* localFileSystem;
 
@@ -99,11 +116,14 @@ inline CopysetNodeOptions::CopysetNodeOptions()
       ip(),
       port(-1),
       enbaleLeaseRead(true),
+      enableFollowerRead(false),
+      followerReadTimeoutMs(500),
       loadConcurrency(1),
       checkRetryTimes(3),
       finishLoadMargin(2000),
       checkLoadMarginIntervalMs(1000),
       applyQueueOption(),
+      applyBatchSize(32),
       localFileSystem(nullptr),
       trashOptions(),
       raftNodeOptions() {}
@@ -28,6 +28,7 @@
 #include <glog/logging.h>
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -38,6 +39,7 @@
 #include "absl/memory/memory.h"
 #include "absl/utility/utility.h"
 #include "curvefs/src/metaserver/storage/storage.h"
+#include "curvefs/src/metaserver/copyset/apply_batch.h"
 #include "curvefs/src/metaserver/copyset/copyset_node_manager.h"
 #include "curvefs/src/metaserver/copyset/meta_operator_closure.h"
 #include "curvefs/src/metaserver/copyset/metric.h"
@@ -92,7 +94,9 @@ CopysetNode::CopysetNode(PoolId poolId, CopysetId copysetId,
       confChangeMtx_(),
       ongoingConfChange_(),
       metric_(absl::make_unique<OperatorMetric>(poolId_, copysetId_)),
-      isLoading_(false) {}
+      isLoading_(false),
+      scheduledIndex_(0),
+      scheduledWaiters_(0) {}
 
 CopysetNode::~CopysetNode() {
     Stop();
@@ -256,6 +260,56 @@ bool CopysetNode::IsLeaseExpired(const braft::LeaderLeaseStatus &lease_status) c
     return lease_status.state == braft::LEASE_EXPIRED;
 }
 
+bool CopysetNode::GetReadIndex(int64_t* readIndex) {
+    braft::LeaderLeaseStatus leaseStatus;
+    GetLeaderLeaseStatus(&leaseStatus);
+    if (!IsLeaseLeader(leaseStatus)) {
+        return false;
+    }
+
+    // entries committed before the lease is checked are all covered, and
+    // committed index never decreases, so it's safe to read status later
+    braft::NodeStatus status;
+    GetStatus(&status);
+    *readIndex = status.committed_index;
+    return true;
+}
+
+bool CopysetNode::WaitScheduledIndex(int64_t index) {
+    if (scheduledIndex_.load() >= index) {
+        return true;
+    }
+
+    uint64_t deadlineUs = TimeUtility::GetTimeofDayUs() +
+                          options_.followerReadTimeoutMs * 1000ull;
+    std::unique_lock<Mutex> lk(scheduledMtx_);
+    scheduledWaiters_.fetch_add(1);
+    auto waitersGuard =
+        absl::MakeCleanup([this]() { scheduledWaiters_.fetch_sub(1); });
+    while (scheduledIndex_.load() < index) {
+        uint64_t nowUs = TimeUtility::GetTimeofDayUs();
+        if (nowUs >= deadlineUs) {
+            return false;
+        }
+        scheduledCond_.wait_for(lk, deadlineUs - nowUs);
+    }
+
+    return true;
+}
+
+void CopysetNode::UpdateScheduledIndex(int64_t index) {
+    int64_t curIndex = scheduledIndex_.load();
+    while (index > curIndex &&
+           !scheduledIndex_.compare_exchange_weak(curIndex, index)) {
+    }
+
+    // only wake up waiters when there are follower reads in progress
+    if (scheduledWaiters_.load() > 0) {
+        std::lock_guard<Mutex> lk(scheduledMtx_);
+        scheduledCond_.notify_all();
+    }
+}
+
 bool CopysetNode::GetLeaderStatus(braft::NodeStatus* leaderStatus) {
     braft::NodeStatus status;
     raftNode_->get_status(&status);
@@ -273,25 +327,52 @@ bool CopysetNode::GetLeaderStatus(braft::NodeStatus* leaderStatus) {
     return FetchLeaderStatus(status.leader_id, leaderStatus);
 }
 
+namespace {
+
+void PushApplyBatch(ApplyQueue* applyQueue,
+                    const std::shared_ptr<ApplyBatch>& batch) {
+    butil::Timer timer;
+    timer.start();
+    applyQueue->Push(batch->HashCode(), batch->GetOperatorType(),
+                     [batch]() { batch->Apply(); });
+    timer.stop();
+    g_concurrent_apply_wait_latency << timer.u_elapsed();
+}
+
+}  // namespace
+
 void CopysetNode::on_apply(braft::Iterator& iter) {
+    ApplyBatchGroup batches(
+        this, options_.applyBatchSize,
+        [this](const std::shared_ptr<ApplyBatch>& batch) {
+            PushApplyBatch(applyQueue_.get(), batch);
+        });
+
+    int64_t lastIndex = 0;
     for (; iter.valid(); iter.next()) {
         braft::AsyncClosureGuard doneGuard(iter.done());
+        lastIndex = iter.index();
 
         if (iter.done()) {
             MetaOperatorClosure* metaClosure =
                 dynamic_cast<MetaOperatorClosure*>(iter.done());
             CHECK(metaClosure != nullptr) << "dynamic cast failed";
-            metaClosure->GetOperator()->timerPropose.stop();
-            g_oprequest_propose_latency
-                << metaClosure->GetOperator()->timerPropose.u_elapsed();
+            auto* op = metaClosure->GetOperator();
+            op->timerPropose.stop();
+            g_oprequest_propose_latency << op->timerPropose.u_elapsed();
+            if (batches.CanBatch(op->GetOperatorType())) {
+                batches.Add(op, iter.index(), doneGuard.release(),
+                            TimeUtility::GetTimeofDayUs());
+                continue;
+            }
+
+            batches.PushAll();
             butil::Timer timer;
             timer.start();
             auto task =
-                std::bind(&MetaOperator::OnApply, metaClosure->GetOperator(),
-                          iter.index(), doneGuard.release(),
-                          TimeUtility::GetTimeofDayUs());
-            applyQueue_->Push(metaClosure->GetOperator()->HashCode(),
-                              metaClosure->GetOperator()->GetOperatorType(),
+                std::bind(&MetaOperator::OnApply, op, iter.index(),
+                          doneGuard.release(), TimeUtility::GetTimeofDayUs());
+            applyQueue_->Push(op->HashCode(), op->GetOperatorType(),
                               std::move(task));
             timer.stop();
             g_concurrent_apply_wait_latency << timer.u_elapsed();
@@ -299,10 +380,17 @@ void CopysetNode::on_apply(braft::Iterator& iter) {
             // parse request from raft-log
             auto metaOperator = RaftLogCodec::Decode(this, iter.data());
             CHECK(metaOperator != nullptr) << "Decode raft log failed";
-            butil::Timer timer;
-            timer.start();
             auto hashcode = metaOperator->HashCode();
             auto type = metaOperator->GetOperatorType();
+            if (batches.CanBatch(type)) {
+                batches.AddFromLog(metaOperator.release(),
+                                   TimeUtility::GetTimeofDayUs());
+                continue;
+            }
+
+            batches.PushAll();
+            butil::Timer timer;
+            timer.start();
             auto task =
                 std::bind(&MetaOperator::OnApplyFromLog, metaOperator.release(),
                           TimeUtility::GetTimeofDayUs());
@@ -311,6 +399,9 @@ void CopysetNode::on_apply(braft::Iterator& iter) {
             g_concurrent_apply_from_log_wait_latency << timer.u_elapsed();
         }
     }
+
+    batches.PushAll();
+    UpdateScheduledIndex(lastIndex);
 }
 
 void CopysetNode::on_shutdown() {
@@ -456,6 +547,7 @@ int CopysetNode::on_snapshot_load(braft::SnapshotReader* reader) {
               << reader->get_path()
               << "' success, update load snapshot index from " << prevIndex
               << " to " << latestLoadSnapshotIndex_;
+    UpdateScheduledIndex(latestLoadSnapshotIndex_);
 
     return 0;
 }
@@ -523,6 +615,9 @@ void CopysetNode::on_configuration_committed(const braft::Configuration& conf,
               << peerId_.to_string() << ", new conf: " << conf
               << ", old conf: " << oldconf << ", index: " << index
               << ", epoch: " << epoch_.load(std::memory_order_relaxed);
+
+    // configuration entries are not passed to on_apply
+    UpdateScheduledIndex(index);
 }
 
 void CopysetNode::on_stop_following(const braft::LeaderChangeContext& ctx) {
@@ -616,6 +711,47 @@ bool CopysetNode::FetchLeaderStatus(const braft::PeerId& leaderId,
     return true;
 }
 
+bool CopysetNode::FetchReadIndex(int64_t* readIndex) {
+    braft::PeerId leaderId = GetLeaderId();
+    if (leaderId.is_empty()) {
+        return false;
+    }
+
+    brpc::Controller cntl;
+    cntl.set_timeout_ms(options_.followerReadTimeoutMs);
+    brpc::Channel channel;
+    if (channel.Init(leaderId.addr, nullptr) != 0) {
+        LOG(WARNING) << "Init channel to leader failed, leader address: "
+                     << leaderId.addr << ", copyset: " << name_;
+        return false;
+    }
+
+    ReadIndexRequest request;
+    ReadIndexResponse response;
+    request.set_poolid(poolId_);
+    request.set_copysetid(copysetId_);
+
+    CopysetService_Stub stub(&channel);
+    stub.GetReadIndex(&cntl, &request, &response, nullptr);
+    if (cntl.Failed()) {
+        LOG(WARNING) << "Get read index failed, leader address: "
+                     << leaderId.addr << ", error: " << cntl.ErrorText()
+                     << ", copyset: " << name_;
+        return false;
+    }
+
+    if (response.status() != COPYSET_OP_STATUS::COPYSET_OP_STATUS_SUCCESS ||
+        !response.has_readindex()) {
+        VLOG(3) << "Get read index failed, leader address: " << leaderId.addr
+                << ", response: " << response.ShortDebugString()
+                << ", copyset: " << name_;
+        return false;
+    }
+
+    *readIndex = response.readindex();
+    return true;
+}
+
 void CopysetNode::ListPeers(std::vector<Peer>* peers) const {
     std::vector<braft::PeerId> tmpPeers;
 
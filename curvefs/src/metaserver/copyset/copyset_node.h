@@ -103,6 +103,8 @@ class CopysetNode : public braft::StateMachine {
 
     MetaStore* GetMetaStore() const;
 
+    CopysetNodeManager* GetCopysetNodeManager() const;
+
     virtual uint64_t GetConfEpoch() const;
 
     std::string GetCopysetDataDir() const;
@@ -128,6 +130,28 @@ class CopysetNode : public braft::StateMachine {
      */
     virtual void GetLeaderLeaseStatus(braft::LeaderLeaseStatus *status);
 
+    /**
+     * @brief Get read index of current lease leader, all requests committed
+     *        before are visible once the read index has been applied
+     * @return true if success, false if current node isn't lease leader
+     */
+    bool GetReadIndex(int64_t* readIndex);
+
+    /**
+     * @brief Fetch read index from leader for follower read
+     */
+    virtual bool FetchReadIndex(int64_t* readIndex);
+
+    /**
+     * @brief Wait until log entries up to |index| have been pushed to apply
+     *        queue, so a task pushed after that with the same hash code will
+     *        see all their modifications
+     * @return true if success, false if timeout
+     */
+    virtual bool WaitScheduledIndex(int64_t index);
+
+    bool IsFollowerReadEnabled() const;
+
     virtual void ListPeers(std::vector<Peer>* peers) const;
 
     ApplyQueue* GetApplyQueue() const;
@@ -213,6 +237,8 @@ class CopysetNode : public braft::StateMachine {
     bool FetchLeaderStatus(const braft::PeerId& peerId,
                            braft::NodeStatus* leaderStatus);
 
+    void UpdateScheduledIndex(int64_t index);
+
     bool AggregateBlockStatInfo(
         const std::shared_ptr<Partition> &partition,
         std::map<uint32_t, BlockGroupStatInfo> *blockStatInfoMap,
@@ -267,6 +293,12 @@ class CopysetNode : public braft::StateMachine {
     std::unique_ptr<OperatorMetric> metric_;
 
     std::atomic<bool> isLoading_;
+
+    // last log index that has been pushed to apply queue
+    std::atomic<int64_t> scheduledIndex_;
+    std::atomic<int32_t> scheduledWaiters_;
+    Mutex scheduledMtx_;
+    CondVar scheduledCond_;
 };
 
 inline void CopysetNode::Propose(const braft::Task& task) {
@@ -291,6 +323,10 @@ inline PeerId CopysetNode::GetLeaderId() const {
 
 inline MetaStore* CopysetNode::GetMetaStore() const { return metaStore_.get(); }
 
+inline CopysetNodeManager* CopysetNode::GetCopysetNodeManager() const {
+    return nodeManager_;
+}
+
 inline uint64_t CopysetNode::GetConfEpoch() const {
     std::lock_guard<Mutex> lock(confMtx_);
     return epoch_.load(std::memory_order_relaxed);
@@ -312,6 +348,10 @@ inline void CopysetNode::GetLeaderLeaseStatus(braft::LeaderLeaseStatus *status)
     raftNode_->get_leader_lease_status(status);
 }
 
+inline bool CopysetNode::IsFollowerReadEnabled() const {
+    return options_.enableFollowerRead;
+}
+
 inline ApplyQueue* CopysetNode::GetApplyQueue() const {
     return applyQueue_.get();
 }
@@ -50,6 +50,11 @@ class CopysetServiceImpl : public CopysetService {
                            CopysetsStatusResponse* response,
                            google::protobuf::Closure* done) override;
 
+    void GetReadIndex(google::protobuf::RpcController* controller,
+                      const ReadIndexRequest* request,
+                      ReadIndexResponse* response,
+                      google::protobuf::Closure* done) override;
+
  private:
     COPYSET_OP_STATUS CreateOneCopyset(
         const CreateCopysetRequest::Copyset& copyset);
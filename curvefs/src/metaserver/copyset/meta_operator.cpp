@@ -24,13 +24,17 @@
 
 #include <brpc/closure_guard.h>
 #include <brpc/controller.h>
+#include <bthread/bthread.h>
+#include <gflags/gflags.h>
 
 #include <algorithm>
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "curvefs/proto/metaserver.pb.h"
 #include "curvefs/src/common/rpc_stream.h"
+#include "curvefs/src/metaserver/copyset/copyset_node_manager.h"
 #include "curvefs/src/metaserver/copyset/meta_operator_closure.h"
 #include "curvefs/src/metaserver/copyset/raft_log_codec.h"
 #include "curvefs/src/metaserver/metastore.h"
@@ -38,7 +42,11 @@
 #include "src/common/timeutility.h"
 
 static bvar::LatencyRecorder
-    g_concurrent_fast_apply_wait_latency("concurrent_fast_apply_wait");
+    g_follower_read_wait_latency("follower_read_wait");
+
+DEFINE_int64(list_dentry_stream_max_buf_size, 4 * 1024 * 1024,
+             "max bytes of streamed dentries not yet consumed by client, "
+             "sending is blocked when it's reached, 0 means unlimited");
 
 
 namespace curvefs {
@@ -60,6 +68,13 @@ void MetaOperator::Propose() {
 
     // check if current node is leader
     if (!IsLeaderTerm()) {
+        // follower read: read from current FSM after catching up with leader
+        if (CanBypassPropose() && node_->IsFollowerReadEnabled() &&
+            FollowerReadTask()) {
+            doneGuard.release();
+            return;
+        }
+
         RedirectRequest();
         return;
     }
@@ -118,15 +133,30 @@ bool MetaOperator::ProposeTask() {
 }
 
 void MetaOperator::FastApplyTask() {
+    // all acknowledged requests have been applied on lease leader, so read
+    // directly from current FSM instead of queueing behind other requests
+    OnApply(node_->GetAppliedIndex(), new MetaOperatorClosure(this),
+            TimeUtility::GetTimeofDayUs());
+}
+
+bool MetaOperator::FollowerReadTask() {
     butil::Timer timer;
     timer.start();
+    int64_t readIndex = 0;
+    if (!node_->FetchReadIndex(&readIndex) ||
+        !node_->WaitScheduledIndex(readIndex)) {
+        return false;
+    }
+    timer.stop();
+    g_follower_read_wait_latency << timer.u_elapsed();
+
+    // modifications before read index are applied by write queue, so push
+    // to write queue with the same hash code to see them
     auto task =
-        std::bind(&MetaOperator::OnApply, this, node_->GetAppliedIndex(),
+        std::bind(&MetaOperator::OnApply, this, readIndex,
                   new MetaOperatorClosure(this), TimeUtility::GetTimeofDayUs());
-    node_->GetApplyQueue()->Push(HashCode(),
-                                 GetOperatorType(), std::move(task));
-    timer.stop();
-    g_concurrent_fast_apply_wait_latency << timer.u_elapsed();
+    node_->GetApplyQueue()->PushToWriteQueue(HashCode(), std::move(task));
+    return true;
 }
 
 #define OPERATOR_CAN_BY_PASS_PROPOSE(TYPE)                                     \
@@ -172,7 +202,6 @@ OPERATOR_CAN_BY_PASS_PROPOSE(GetVolumeExtent);
     }
 
 OPERATOR_ON_APPLY(GetDentry);
-OPERATOR_ON_APPLY(ListDentry);
 OPERATOR_ON_APPLY(CreateDentry);
 OPERATOR_ON_APPLY(DeleteDentry);
 OPERATOR_ON_APPLY(GetInode);
@@ -188,6 +217,7 @@ OPERATOR_ON_APPLY(DeletePartition);
 OPERATOR_ON_APPLY(PrepareRenameTx);
 OPERATOR_ON_APPLY(UpdateVolumeExtent);
 OPERATOR_ON_APPLY(UpdateDeallocatableBlockGroup);
+OPERATOR_ON_APPLY(BatchUpdateInodeAttr);
 
 #undef OPERATOR_ON_APPLY
 
@@ -291,6 +321,117 @@ void GetVolumeExtentOperator::OnApply(int64_t index,
     }
 }
 
+namespace {
+
+struct ListDentryStreamTask {
+    // keeps metastore alive while sending
+    std::shared_ptr<CopysetNode> node;
+    std::shared_ptr<StreamConnection> connection;
+    ListDentryRequest request;
+    std::string last;
+};
+
+void* SendDentryByStream(void* arg) {
+    std::unique_ptr<ListDentryStreamTask> task(
+        static_cast<ListDentryStreamTask *>(arg));
+    auto *metaStore = task->node->GetMetaStore();
+    auto *request = &task->request;
+
+    // every page is listed by a new seek after last sent entry, so locks
+    // are only held while listing a page instead of the whole directory
+    auto listPage = [metaStore, request](const std::string &last,
+                                         DentryVec *page) -> MetaStatusCode {
+        ListDentryResponse pageResponse;
+        request->set_last(last);
+        auto rc = metaStore->ListDentry(request, &pageResponse);
+        page->mutable_dentrys()->Swap(pageResponse.mutable_dentrys());
+        return rc;
+    };
+
+    auto st = StreamingSendDentry(task->connection.get(), request->count(),
+                                  task->last, listPage);
+    if (st != MetaStatusCode::OK) {
+        LOG(ERROR) << "Send dentries by stream failed, fsId = "
+                   << request->fsid()
+                   << ", dirInodeId = " << request->dirinodeid()
+                   << ", status = " << MetaStatusCode_Name(st);
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+void ListDentryOperator::OnApply(int64_t index,
+                                 google::protobuf::Closure *done,
+                                 uint64_t startTimeUs) {
+    brpc::ClosureGuard doneGuard(done);
+    const auto *request = static_cast<const ListDentryRequest *>(request_);
+    auto *response = static_cast<ListDentryResponse *>(response_);
+    auto *metaStore = node_->GetMetaStore();
+
+    uint64_t timeUs = TimeUtility::GetTimeofDayUs();
+    node_->GetMetric()->WaitInQueueLatency(OperatorType::ListDentry,
+                                           timeUs - startTimeUs);
+    auto st = metaStore->ListDentry(request, response);
+    node_->GetMetric()->ExecuteLatency(OperatorType::ListDentry,
+                                       TimeUtility::GetTimeofDayUs() - timeUs);
+    node_->GetMetric()->OnOperatorComplete(
+        OperatorType::ListDentry, TimeUtility::GetTimeofDayUs() - startTimeUs,
+        st == MetaStatusCode::OK);
+    if (st != MetaStatusCode::OK) {
+        return;
+    }
+
+    node_->UpdateAppliedIndex(index);
+    response->set_appliedindex(
+        std::max<uint64_t>(index, node_->GetAppliedIndex()));
+
+    // nothing left if the first page isn't full
+    if (!request->streaming() || request->count() == 0 ||
+        static_cast<uint32_t>(response->dentrys_size()) < request->count()) {
+        return;
+    }
+
+    // the copyset is held by sender until all pages are sent, if it's
+    // being removed, the first page is returned without streaming
+    auto sharedNode = node_->GetCopysetNodeManager()->GetSharedCopysetNode(
+        node_->GetPoolId(), node_->GetCopysetId());
+    if (sharedNode == nullptr) {
+        return;
+    }
+
+    auto *cntl = static_cast<brpc::Controller *>(cntl_);
+    auto connection = metaStore->GetStreamServer()->Accept(
+        cntl, FLAGS_list_dentry_stream_max_buf_size);
+    if (connection == nullptr) {
+        LOG(ERROR) << "Accept streaming connection failed";
+        response->set_statuscode(MetaStatusCode::RPC_STREAM_ERROR);
+        return;
+    }
+
+    // request, response and this operator are freed once done is run
+    std::unique_ptr<ListDentryStreamTask> task(new ListDentryStreamTask());
+    task->node = std::move(sharedNode);
+    task->connection = std::move(connection);
+    task->request = *request;
+    task->last = response->dentrys().rbegin()->name();
+    response->set_streaming(true);
+
+    // run done, client receives the first page and starts to consume stream
+    done->Run();
+    doneGuard.release();
+
+    // sending blocks while client falls behind, so it's done in background
+    // instead of apply queue, otherwise the whole partition is stalled
+    bthread_t tid;
+    auto *arg = task.release();
+    if (bthread_start_background(&tid, nullptr, SendDentryByStream, arg) !=
+        0) {
+        LOG(ERROR) << "Start bthread to send dentries by stream failed";
+        SendDentryByStream(arg);
+    }
+}
+
 #define OPERATOR_ON_APPLY_FROM_LOG(TYPE)                                       \
     void TYPE##Operator::OnApplyFromLog(uint64_t startTimeUs) {                \
         std::unique_ptr<TYPE##Operator> selfGuard(this);                       \
@@ -314,6 +455,7 @@ OPERATOR_ON_APPLY_FROM_LOG(DeletePartition);
 OPERATOR_ON_APPLY_FROM_LOG(PrepareRenameTx);
 OPERATOR_ON_APPLY_FROM_LOG(UpdateVolumeExtent);
 OPERATOR_ON_APPLY_FROM_LOG(UpdateDeallocatableBlockGroup);
+OPERATOR_ON_APPLY_FROM_LOG(BatchUpdateInodeAttr);
 
 #undef OPERATOR_ON_APPLY_FROM_LOG
 
@@ -373,6 +515,7 @@ OPERATOR_REDIRECT(PrepareRenameTx);
 OPERATOR_REDIRECT(GetVolumeExtent);
 OPERATOR_REDIRECT(UpdateVolumeExtent);
 OPERATOR_REDIRECT(UpdateDeallocatableBlockGroup);
+OPERATOR_REDIRECT(BatchUpdateInodeAttr);
 
 #undef OPERATOR_REDIRECT
 
@@ -400,6 +543,7 @@ OPERATOR_ON_FAILED(PrepareRenameTx);
 OPERATOR_ON_FAILED(GetVolumeExtent);
 OPERATOR_ON_FAILED(UpdateVolumeExtent);
 OPERATOR_ON_FAILED(UpdateDeallocatableBlockGroup);
+OPERATOR_ON_FAILED(BatchUpdateInodeAttr);
 
 #undef OPERATOR_ON_FAILED
 
@@ -426,6 +570,7 @@ OPERATOR_HASH_CODE(DeletePartition);
 OPERATOR_HASH_CODE(GetVolumeExtent);
 OPERATOR_HASH_CODE(UpdateVolumeExtent);
 OPERATOR_HASH_CODE(UpdateDeallocatableBlockGroup);
+OPERATOR_HASH_CODE(BatchUpdateInodeAttr);
 
 
 #undef OPERATOR_HASH_CODE
@@ -465,6 +610,7 @@ OPERATOR_TYPE(DeletePartition);
 OPERATOR_TYPE(GetVolumeExtent);
 OPERATOR_TYPE(UpdateVolumeExtent);
 OPERATOR_TYPE(UpdateDeallocatableBlockGroup);
+OPERATOR_TYPE(BatchUpdateInodeAttr);
 
 #undef OPERATOR_TYPE
 
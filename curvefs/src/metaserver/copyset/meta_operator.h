@@ -106,6 +106,9 @@ class MetaOperator {
     virtual OperatorType GetOperatorType() const = 0;
 
  private:
+    // fails operators whose apply batch can't be committed
+    friend class ApplyBatch;
+
     /**
      * @brief Check whether current copyset node is leader
      */
@@ -119,10 +122,18 @@ class MetaOperator {
     bool ProposeTask();
 
     /**
-     * @brief Directly push operator to concurrently module
+     * @brief Directly apply operator in current thread on lease leader
      */
     void FastApplyTask();
 
+    /**
+     * @brief Apply readonly operator on follower after it has caught up with
+     *        read index of leader
+     * @return true if operator is pushed to apply queue, otherwise the
+     *         request should be redirected to leader
+     */
+    bool FollowerReadTask();
+
  private:
     /**
      * @brief Redirect request if current node is not leader
@@ -556,6 +567,25 @@ class UpdateDeallocatableBlockGroupOperator : public MetaOperator {
     void OnFailed(MetaStatusCode code) override;
 };
 
+class BatchUpdateInodeAttrOperator : public MetaOperator {
+ public:
+    using MetaOperator::MetaOperator;
+
+    void OnApply(int64_t index, google::protobuf::Closure *done,
+                 uint64_t startTimeUs) override;
+
+    void OnApplyFromLog(uint64_t startTimeUs) override;
+
+    uint64_t HashCode() const override;
+
+    OperatorType GetOperatorType() const override;
+
+ private:
+    void Redirect() override;
+
+    void OnFailed(MetaStatusCode code) override;
+};
+
 }  // namespace copyset
 }  // namespace metaserver
 }  // namespace curvefs
@@ -169,6 +169,10 @@ std::unique_ptr<MetaOperator> RaftLogCodec::Decode(CopysetNode* node,
             return ParseFromRaftLog<UpdateDeallocatableBlockGroupOperator,
                                     UpdateDeallocatableBlockGroupRequest>(
                 node, type, meta);
+        case OperatorType::BatchUpdateInodeAttr:
+            return ParseFromRaftLog<BatchUpdateInodeAttrOperator,
+                                    BatchUpdateInodeAttrRequest>(
+                node, type, meta);
         // Add new case before `OperatorType::OperatorTypeMax`
         case OperatorType::OperatorTypeMax:
             break;
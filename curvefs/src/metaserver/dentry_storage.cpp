@@ -28,6 +28,7 @@
 
 #include "src/common/string_util.h"
 #include "curvefs/src/metaserver/dentry_storage.h"
+#include "curvefs/src/metaserver/storage/key_migration.h"
 
 namespace curvefs {
 namespace metaserver {
@@ -361,9 +362,9 @@ MetaStatusCode DentryStorage::List(const Dentry& dentry,
     uint64_t parentInodeId = dentry.parentinodeid();
     std::string name = dentry.name();
     Prefix4SameParentDentry prefix(fsId, parentInodeId);
-    std::string sprefix = conv_.SerializeToString(prefix);  // "1:1:"
+    std::string sprefix = conv_.SerializeToString(prefix);
     Key4Dentry key(fsId, parentInodeId, name);
-    std::string lower = conv_.SerializeToString(key);  // "1:1:", "1:1:/a/b/c"
+    std::string lower = conv_.SerializeToString(key);
 
     // 3. iterator key/value pair one by one
     auto iterator = kvStorage_->SSeek(table4Dentry_, lower);
@@ -504,5 +505,21 @@ MetaStatusCode DentryStorage::Clear() {
     return MetaStatusCode::OK;
 }
 
+MetaStatusCode DentryStorage::MigrateKeys() {
+    WriteLockGuard lg(rwLock_);
+    uint64_t migrated = 0;
+    Status s = storage::MigrateKeys<Key4Dentry, DentryVec>(
+        kvStorage_.get(), table4Dentry_, true, &migrated);
+    if (!s.ok()) {
+        LOG(ERROR) << "DentryStorage migrate keys failed, status = "
+                   << s.ToString();
+        return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+    }
+
+    LOG(INFO) << "DentryStorage migrate keys success, dentry vector: "
+              << migrated;
+    return MetaStatusCode::OK;
+}
+
 }  // namespace metaserver
 }  // namespace curvefs
@@ -135,6 +135,9 @@ class DentryStorage {
 
     MetaStatusCode Clear();
 
+    // rewrite dentry keys to the encoding selected by storage_binary_key
+    MetaStatusCode MigrateKeys();
+
  private:
     std::string DentryKey(const Dentry& entry);
 
@@ -379,16 +379,10 @@ MetaStatusCode InodeManager::UpdateInode(const UpdateInodeRequest& request) {
 
     // update extent in request
     if (request.has_volumeextents()) {
-        const auto fsId = old.fsid();
-        const auto inodeId = old.inodeid();
-        for (const auto &slice : request.volumeextents().slices()) {
-            auto rc = UpdateVolumeExtentSliceLocked(fsId, inodeId, slice);
-            if (rc != MetaStatusCode::OK) {
-                LOG(ERROR) << "UpdateVolumeExtent failed, err: "
-                           << MetaStatusCode_Name(rc) << ", fsId: " << fsId
-                           << ", inodeId: " << inodeId;
-                return rc;
-            }
+        auto rc = UpdateVolumeExtentLocked(old.fsid(), old.inodeid(),
+                                           request.volumeextents());
+        if (rc != MetaStatusCode::OK) {
+            return rc;
         }
     }
 
@@ -401,7 +395,8 @@ MetaStatusCode InodeManager::GetOrModifyS3ChunkInfo(
     const S3ChunkInfoMap& map2add,
     const S3ChunkInfoMap& map2del,
     bool returnS3ChunkInfoMap,
-    std::shared_ptr<Iterator>* iterator4InodeS3Meta) {
+    std::shared_ptr<Iterator>* iterator4InodeS3Meta,
+    const std::vector<uint64_t>& chunkIndexes) {
     VLOG(6) << "GetOrModifyS3ChunkInfo, fsId: " << fsId
             << ", inodeId: " << inodeId;
 
@@ -449,8 +444,13 @@ MetaStatusCode InodeManager::GetOrModifyS3ChunkInfo(
 
     // return if needed
     if (returnS3ChunkInfoMap) {
-        *iterator4InodeS3Meta = inodeStorage_->GetInodeS3ChunkInfoList(
-            fsId, inodeId);
+        if (chunkIndexes.empty()) {
+            *iterator4InodeS3Meta = inodeStorage_->GetInodeS3ChunkInfoList(
+                fsId, inodeId);
+        } else {
+            *iterator4InodeS3Meta = inodeStorage_->GetInodeS3ChunkInfoList(
+                fsId, inodeId, chunkIndexes);
+        }
         if ((*iterator4InodeS3Meta)->Status() != 0) {
             return MetaStatusCode::STORAGE_INTERNAL_ERROR;
         }
@@ -558,6 +558,10 @@ bool InodeManager::GetInodeIdList(std::list<uint64_t>* inodeIdList) {
     return inodeStorage_->GetAllInodeId(inodeIdList);
 }
 
+uint64_t InodeManager::GetS3ChunkInfoCount(uint32_t fsId, uint64_t inodeId) {
+    return inodeStorage_->GetS3ChunkInfoCount(fsId, inodeId);
+}
+
 MetaStatusCode InodeManager::UpdateVolumeExtentSliceLocked(
     uint32_t fsId,
     uint64_t inodeId,
@@ -581,14 +585,23 @@ MetaStatusCode InodeManager::UpdateVolumeExtent(
     const VolumeExtentSliceList &extents) {
     VLOG(6) << "UpdateInodeExtent, fsId: " << fsId << ", inodeId: " << inodeId;
     NameLockGuard guard(inodeLock_, GetInodeLockName(fsId, inodeId));
+    return UpdateVolumeExtentLocked(fsId, inodeId, extents);
+}
 
-    MetaStatusCode st = MetaStatusCode::UNKNOWN_ERROR;
+MetaStatusCode InodeManager::UpdateVolumeExtentLocked(
+    uint32_t fsId,
+    uint64_t inodeId,
+    const VolumeExtentSliceList &extents) {
     for (const auto &slice : extents.slices()) {
-        st = UpdateVolumeExtentSliceLocked(fsId, inodeId, slice);
+        auto st = extents.delta()
+                      ? inodeStorage_->MergeVolumeExtentSlice(fsId, inodeId,
+                                                              slice)
+                      : UpdateVolumeExtentSliceLocked(fsId, inodeId, slice);
         if (st != MetaStatusCode::OK) {
             LOG(ERROR) << "UpdateVolumeExtent failed, err: "
                        << MetaStatusCode_Name(st) << ", fsId: " << fsId
-                       << ", inodeId: " << inodeId;
+                       << ", inodeId: " << inodeId
+                       << ", delta: " << extents.delta();
             return st;
         }
     }
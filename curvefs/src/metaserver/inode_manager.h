@@ -96,7 +96,8 @@ class InodeManager {
         const S3ChunkInfoMap& map2add,
         const S3ChunkInfoMap& map2del,
         bool returnS3ChunkInfoMap,
-        std::shared_ptr<Iterator>* iterator4InodeS3Meta);
+        std::shared_ptr<Iterator>* iterator4InodeS3Meta,
+        const std::vector<uint64_t>& chunkIndexes = {});
 
     MetaStatusCode PaddingInodeS3ChunkInfo(int32_t fsId,
                                            uint64_t inodeId,
@@ -113,6 +114,8 @@ class InodeManager {
 
     bool GetInodeIdList(std::list<uint64_t>* inodeIdList);
 
+    uint64_t GetS3ChunkInfoCount(uint32_t fsId, uint64_t inodeId);
+
     // Update one or more volume extent slice
     MetaStatusCode UpdateVolumeExtent(uint32_t fsId,
                                       uint64_t inodeId,
@@ -145,6 +148,12 @@ class InodeManager {
         uint64_t inodeId,
         const VolumeExtentSlice &slice);
 
+    // Replace or merge slices according to whether |extents| is a delta
+    MetaStatusCode UpdateVolumeExtentLocked(
+        uint32_t fsId,
+        uint64_t inodeId,
+        const VolumeExtentSliceList &extents);
+
  private:
     std::shared_ptr<InodeStorage> inodeStorage_;
     std::shared_ptr<Trash> trash_;
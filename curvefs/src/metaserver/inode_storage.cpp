@@ -27,8 +27,11 @@
 #include <memory>
 #include <vector>
 #include <algorithm>
+#include <iterator>
+#include <map>
 #include <set>
 
+#include "absl/strings/escaping.h"
 #include "src/common/concurrent/rw_lock.h"
 #include "src/common/string_util.h"
 #include "curvefs/proto/metaserver.pb.h"
@@ -36,6 +39,7 @@
 #include "curvefs/src/metaserver/storage/status.h"
 #include "curvefs/src/metaserver/inode_storage.h"
 #include "curvefs/src/metaserver/storage/converter.h"
+#include "curvefs/src/metaserver/storage/key_migration.h"
 #include "curvefs/src/metaserver/common/types.h"
 
 namespace curvefs {
@@ -46,6 +50,7 @@ using ::curve::common::WriteLockGuard;
 using ::curve::common::StringStartWith;
 using ::curvefs::metaserver::storage::Status;
 using ::curvefs::metaserver::storage::KVStorage;
+using ::curvefs::metaserver::storage::MergeIterator;
 using ::curvefs::metaserver::storage::Key4S3ChunkInfoList;
 using ::curvefs::metaserver::storage::Key4VolumeExtentSlice;
 using ::curvefs::metaserver::storage::Prefix4InodeVolumeExtent;
@@ -210,12 +215,12 @@ MetaStatusCode InodeStorage::Update(const Inode &inode, bool inodeDeallocate) {
         return MetaStatusCode::STORAGE_INTERNAL_ERROR;
     }
 
-    std::string step = "update inode " + key.SerializeToString();
+    std::string step = "update inode " + absl::BytesToHexString(skey);
 
     Status s = txn->HSet(table4Inode_, skey, inode);
     if (s.ok()) {
         s = txn->HSet(table4DeallocatableInode_, skey, value);
-        step = "add inode " + key.SerializeToString() +
+        step = "add inode " + absl::BytesToHexString(skey) +
                " to inode deallocatable list";
     }
 
@@ -223,12 +228,12 @@ MetaStatusCode InodeStorage::Update(const Inode &inode, bool inodeDeallocate) {
         LOG(ERROR) << "txn is failed in " << step;
         if (!txn->Rollback().ok()) {
             LOG(ERROR) << "rollback transaction failed, inode="
-                       << key.SerializeToString();
+                       << absl::BytesToHexString(skey);
             return  MetaStatusCode::STORAGE_INTERNAL_ERROR;
         }
     } else if (!txn->Commit().ok()) {
         LOG(ERROR) << "commit transaction failed, inode="
-                   << key.SerializeToString();
+                   << absl::BytesToHexString(skey);
         return MetaStatusCode::STORAGE_INTERNAL_ERROR;
     }
 
@@ -260,6 +265,11 @@ bool InodeStorage::GetAllInodeId(std::list<uint64_t>* ids) {
     return true;
 }
 
+uint64_t InodeStorage::GetS3ChunkInfoCount(uint32_t fsId, uint64_t inodeId) {
+    ReadLockGuard lg(rwLock_);
+    return GetInodeS3MetaSize(fsId, inodeId);
+}
+
 size_t InodeStorage::Size() {
     ReadLockGuard lg(rwLock_);
     return nInode_;
@@ -309,6 +319,56 @@ MetaStatusCode InodeStorage::Clear() {
     return MetaStatusCode::OK;
 }
 
+MetaStatusCode InodeStorage::MigrateKeys() {
+    WriteLockGuard lg(rwLock_);
+    uint64_t nInode = 0;
+    uint64_t nDeallocatableInode = 0;
+    uint64_t nS3ChunkInfo = 0;
+    uint64_t nVolumeExtent = 0;
+    uint64_t nInodeAuxInfo = 0;
+    uint64_t nDeallocatableBlockGroup = 0;
+    KVStorage* storage = kvStorage_.get();
+
+    Status s = storage::MigrateKeys<Key4Inode, Inode>(
+        storage, table4Inode_, false, &nInode);
+    if (s.ok()) {
+        s = storage::MigrateKeys<Key4Inode, google::protobuf::Empty>(
+            storage, table4DeallocatableInode_, false, &nDeallocatableInode);
+    }
+    if (s.ok()) {
+        s = storage::MigrateKeys<Key4S3ChunkInfoList, S3ChunkInfoList>(
+            storage, table4S3ChunkInfo_, true, &nS3ChunkInfo);
+    }
+    if (s.ok()) {
+        s = storage::MigrateKeys<Key4VolumeExtentSlice, VolumeExtentSlice>(
+            storage, table4VolumeExtent_, true, &nVolumeExtent);
+    }
+    if (s.ok()) {
+        s = storage::MigrateKeys<Key4InodeAuxInfo, InodeAuxInfo>(
+            storage, table4InodeAuxInfo_, false, &nInodeAuxInfo);
+    }
+    if (s.ok()) {
+        s = storage::MigrateKeys<Key4DeallocatableBlockGroup,
+                                 DeallocatableBlockGroup>(
+            storage, table4DeallocatableBlockGroup_, false,
+            &nDeallocatableBlockGroup);
+    }
+
+    if (!s.ok()) {
+        LOG(ERROR) << "InodeStorage migrate keys failed, status = "
+                   << s.ToString();
+        return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+    }
+
+    LOG(INFO) << "InodeStorage migrate keys success, inode: " << nInode
+              << ", deallocatable inode: " << nDeallocatableInode
+              << ", s3chunkinfo: " << nS3ChunkInfo
+              << ", volume extent: " << nVolumeExtent
+              << ", inode aux info: " << nInodeAuxInfo
+              << ", deallocatable block group: " << nDeallocatableBlockGroup;
+    return MetaStatusCode::OK;
+}
+
 MetaStatusCode InodeStorage::UpdateInodeS3MetaSize(Transaction txn,
                                                    uint32_t fsId,
                                                    uint64_t inodeId,
@@ -410,7 +470,8 @@ MetaStatusCode InodeStorage::DelS3ChunkInfoList(
     std::string sprefix = conv_.SerializeToString(prefix);
     auto iterator = txn->SSeek(table4S3ChunkInfo_, sprefix);
     if (iterator->Status() != 0) {
-        LOG(ERROR) << "Get iterator failed, prefix=" << sprefix;
+        LOG(ERROR) << "Get iterator failed, prefix="
+                   << absl::BytesToHexString(sprefix);
         return MetaStatusCode::STORAGE_INTERNAL_ERROR;
     }
 
@@ -435,14 +496,16 @@ MetaStatusCode InodeStorage::DelS3ChunkInfoList(
             continue;
         } else {
             LOG(ERROR) << "wrong delete list range (" << delFirstChunkId
-                       << "," << delLastChunkId << "), skey=" << skey;
+                       << "," << delLastChunkId
+                       << "), skey=" << absl::BytesToHexString(skey);
             return MetaStatusCode::STORAGE_INTERNAL_ERROR;
         }
     }
 
     for (const auto& skey : key2del) {
         if (!txn->SDel(table4S3ChunkInfo_, skey).ok()) {
-            LOG(ERROR) << "Delete key failed, skey=" << skey;
+            LOG(ERROR) << "Delete key failed, skey="
+                       << absl::BytesToHexString(skey);
             return MetaStatusCode::STORAGE_INTERNAL_ERROR;
         }
     }
@@ -546,6 +609,20 @@ std::shared_ptr<Iterator> InodeStorage::GetInodeS3ChunkInfoList(
     return kvStorage_->SSeek(table4S3ChunkInfo_, sprefix);
 }
 
+std::shared_ptr<Iterator> InodeStorage::GetInodeS3ChunkInfoList(
+    uint32_t fsId, uint64_t inodeId,
+    const std::vector<uint64_t>& chunkIndexes) {
+    ReadLockGuard lg(rwLock_);
+    MergeIterator::ChildrenType children;
+    children.reserve(chunkIndexes.size());
+    for (const auto& chunkIndex : chunkIndexes) {
+        Prefix4ChunkIndexS3ChunkInfoList prefix(fsId, inodeId, chunkIndex);
+        std::string sprefix = conv_.SerializeToString(prefix);
+        children.push_back(kvStorage_->SSeek(table4S3ChunkInfo_, sprefix));
+    }
+    return std::make_shared<MergeIterator>(children);
+}
+
 std::shared_ptr<Iterator> InodeStorage::GetAllS3ChunkInfoList() {
     ReadLockGuard lg(rwLock_);
     return kvStorage_->SGetAll(table4S3ChunkInfo_);
@@ -570,6 +647,98 @@ MetaStatusCode InodeStorage::UpdateVolumeExtentSlice(
                    : MetaStatusCode::STORAGE_INTERNAL_ERROR;
 }
 
+namespace {
+
+// Merge extents of |delta| into |slice|, extents in |delta| take precedence
+// over the overlapped parts of existing extents.
+void MergeVolumeExtents(const VolumeExtentSlice& delta,
+                        VolumeExtentSlice* slice) {
+    std::map<uint64_t, VolumeExtent> extents;
+    for (const auto& ext : slice->extents()) {
+        extents.emplace(ext.fsoffset(), ext);
+    }
+
+    // keep [offset, end) part of |ext|
+    auto cut = [](const VolumeExtent& ext, uint64_t offset, uint64_t end) {
+        VolumeExtent part(ext);
+        part.set_fsoffset(offset);
+        part.set_volumeoffset(ext.volumeoffset() + (offset - ext.fsoffset()));
+        part.set_length(end - offset);
+        return part;
+    };
+
+    for (const auto& ext : delta.extents()) {
+        const uint64_t start = ext.fsoffset();
+        const uint64_t end = ext.fsoffset() + ext.length();
+
+        auto it = extents.lower_bound(start);
+        if (it != extents.begin()) {
+            auto prev = std::prev(it);
+            const uint64_t prevEnd =
+                prev->second.fsoffset() + prev->second.length();
+            if (prevEnd > start) {
+                if (prevEnd > end) {
+                    extents.emplace(end, cut(prev->second, end, prevEnd));
+                }
+                prev->second.set_length(start - prev->first);
+            }
+        }
+
+        while (it != extents.end() && it->first < end) {
+            const uint64_t curEnd = it->first + it->second.length();
+            if (curEnd > end) {
+                auto tail = cut(it->second, end, curEnd);
+                extents.erase(it);
+                extents.emplace(end, std::move(tail));
+                break;
+            }
+            it = extents.erase(it);
+        }
+
+        extents.emplace(start, ext);
+    }
+
+    slice->clear_extents();
+    VolumeExtent* prev = nullptr;
+    for (const auto& ext : extents) {
+        const auto& cur = ext.second;
+        if (prev != nullptr && prev->isused() == cur.isused() &&
+            prev->fsoffset() + prev->length() == cur.fsoffset() &&
+            prev->volumeoffset() + prev->length() == cur.volumeoffset()) {
+            prev->set_length(prev->length() + cur.length());
+            continue;
+        }
+
+        prev = slice->add_extents();
+        *prev = cur;
+    }
+}
+
+}  // namespace
+
+MetaStatusCode InodeStorage::MergeVolumeExtentSlice(
+    uint32_t fsId,
+    uint64_t inodeId,
+    const VolumeExtentSlice& delta) {
+    WriteLockGuard guard(rwLock_);
+    auto key = conv_.SerializeToString(
+        Key4VolumeExtentSlice{fsId, inodeId, delta.offset()});
+
+    VolumeExtentSlice slice;
+    auto st = kvStorage_->SGet(table4VolumeExtent_, key, &slice);
+    if (st.IsNotFound()) {
+        slice.set_offset(delta.offset());
+    } else if (!st.ok()) {
+        return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+    }
+
+    MergeVolumeExtents(delta, &slice);
+    st = kvStorage_->SSet(table4VolumeExtent_, key, slice);
+
+    return st.ok() ? MetaStatusCode::OK
+                   : MetaStatusCode::STORAGE_INTERNAL_ERROR;
+}
+
 MetaStatusCode
 InodeStorage::GetAllVolumeExtent(uint32_t fsId, uint64_t inodeId,
                                  VolumeExtentSliceList *extents) {
@@ -662,7 +831,8 @@ MetaStatusCode InodeStorage::UpdateDeallocatableBlockGroup(
         auto s = txn->HGet(table4DeallocatableBlockGroup_, skey, &out);
 
         if (!s.ok() && !s.IsNotFound()) {
-            step = "get deallocatable group skey=" + skey + " failed";
+            step = "get deallocatable group skey=" +
+                   absl::BytesToHexString(skey) + " failed";
             st = MetaStatusCode::STORAGE_INTERNAL_ERROR;
             break;
         }
@@ -681,7 +851,8 @@ MetaStatusCode InodeStorage::UpdateDeallocatableBlockGroup(
 
         s = txn->HSet(table4DeallocatableBlockGroup_, skey, out);
         if (!s.ok()) {
-            step = "update deallocatable group skey=" + skey + " failed";
+            step = "update deallocatable group skey=" +
+                   absl::BytesToHexString(skey) + " failed";
             st = MetaStatusCode::STORAGE_INTERNAL_ERROR;
             break;
         }
@@ -112,6 +112,9 @@ class InodeStorage {
 
     bool GetAllInodeId(std::list<uint64_t>* ids);
 
+    // Number of s3chunkinfo of inode, it reflects how fragmented it is
+    uint64_t GetS3ChunkInfoCount(uint32_t fsId, uint64_t inodeId);
+
     // NOTE: the return size is accurate under normal cluster status,
     // but under abnormal status, the return size maybe less than
     // the real value for delete the unexist inode multi-times.
@@ -121,6 +124,10 @@ class InodeStorage {
 
     MetaStatusCode Clear();
 
+    // rewrite keys of all tables to the encoding selected by
+    // storage_binary_key
+    MetaStatusCode MigrateKeys();
+
     // s3chunkinfo
     MetaStatusCode ModifyInodeS3ChunkInfoList(uint32_t fsId,
                                               uint64_t inodeId,
@@ -136,6 +143,12 @@ class InodeStorage {
     std::shared_ptr<Iterator> GetInodeS3ChunkInfoList(uint32_t fsId,
                                                       uint64_t inodeId);
 
+    // only iterate s3chunkinfo list of the specified chunk indexes
+    std::shared_ptr<Iterator> GetInodeS3ChunkInfoList(
+        uint32_t fsId,
+        uint64_t inodeId,
+        const std::vector<uint64_t>& chunkIndexes);
+
     std::shared_ptr<Iterator> GetAllS3ChunkInfoList();
 
     // volume extent
@@ -145,6 +158,11 @@ class InodeStorage {
                                            uint64_t inodeId,
                                            const VolumeExtentSlice& slice);
 
+    // Merge extents of |delta| into the stored slice with the same offset
+    MetaStatusCode MergeVolumeExtentSlice(uint32_t fsId,
+                                          uint64_t inodeId,
+                                          const VolumeExtentSlice& delta);
+
     MetaStatusCode GetAllVolumeExtent(uint32_t fsId,
                                       uint64_t inodeId,
                                       VolumeExtentSliceList* extents);
@@ -37,6 +37,7 @@
 #include "curvefs/src/metaserver/s3compact_manager.h"
 #include "curvefs/src/metaserver/trash_manager.h"
 #include "curvefs/src/metaserver/storage/storage.h"
+#include "curvefs/src/metaserver/storage/converter.h"
 #include "curvefs/src/metaserver/storage/rocksdb_perf.h"
 #include "curvefs/src/metaserver/mds/fsinfo_manager.h"
 #include "src/common/crc32.h"
@@ -138,6 +139,10 @@ void InitS3Option(const std::shared_ptr<Configuration>& conf,
     LOG_IF(FATAL, !conf->GetUInt64Value("s3.batchsize", &s3Opt->batchSize));
     LOG_IF(FATAL, !conf->GetBoolValue("s3.enableBatchDelete",
                                       &s3Opt->enableBatchDelete));
+    LOG_IF(WARNING, !conf->GetUInt64Value("s3.deleteRequestsPerSec",
+                                          &s3Opt->deleteRequestsPerSec))
+        << "Not found `s3.deleteRequestsPerSec` in conf, use default value `"
+        << s3Opt->deleteRequestsPerSec << '`';
 }
 
 void Metaserver::InitPartitionOption(std::shared_ptr<S3ClientAdaptor> s3Adaptor,
@@ -148,6 +153,12 @@ void Metaserver::InitPartitionOption(std::shared_ptr<S3ClientAdaptor> s3Adaptor,
     LOG_IF(FATAL,
            !conf_->GetUInt32Value("partition.clean.inodeDeletePeriodMs",
                                   &partitionCleanOption->inodeDeletePeriodMs));
+    LOG_IF(WARNING,
+           !conf_->GetUInt32Value("partition.clean.deleteBatchInodeNum",
+                                  &partitionCleanOption->deleteBatchInodeNum))
+        << "Not found `partition.clean.deleteBatchInodeNum` in conf, "
+           "use default value `"
+        << partitionCleanOption->deleteBatchInodeNum << '`';
     partitionCleanOption->s3Adaptor = s3Adaptor;
     partitionCleanOption->mdsClient = mdsClient;
 }
@@ -629,6 +640,16 @@ void Metaserver::InitStorage() {
                                          &options.maxDiskQuotaBytes));
     LOG_IF(FATAL, !conf_->GetBoolValue("storage.memory.compression",
                                        &options.compression));
+    LOG_IF(WARNING, !conf_->GetUInt32Value(
+                        "storage.memory.max_delta_segments",
+                        &options.maxDeltaSegments))
+        << "Not found `storage.memory.max_delta_segments` in conf, use "
+           "default value `" << options.maxDeltaSegments << '`';
+
+    LOG_IF(WARNING, !conf_->GetBoolValue("storage.binary_key",
+                                         &FLAGS_storage_binary_key))
+        << "Not found `storage.binary_key` in conf, use default value `"
+        << FLAGS_storage_binary_key << '`';
 
     conf_->GetValueFatalIfFail("storage.rocksdb.perf_level",
                                &FLAGS_rocksdb_perf_level);
@@ -670,6 +691,17 @@ void Metaserver::InitCopysetNodeOptions() {
         << "config no copyset.enable_lease_read info, using default value "
         << copysetNodeOptions_.enbaleLeaseRead;
 
+    ret = conf_->GetBoolValue("copyset.enable_follower_read",
+                &copysetNodeOptions_.enableFollowerRead);
+    LOG_IF(WARNING, ret == false)
+        << "config no copyset.enable_follower_read info, using default value "
+        << copysetNodeOptions_.enableFollowerRead;
+    ret = conf_->GetUInt32Value("copyset.follower_read_timeout_ms",
+                &copysetNodeOptions_.followerReadTimeoutMs);
+    LOG_IF(WARNING, ret == false)
+        << "config no copyset.follower_read_timeout_ms info, using default "
+           "value " << copysetNodeOptions_.followerReadTimeoutMs;
+
     LOG_IF(FATAL, !conf_->GetStringValue("copyset.data_uri",
                 &copysetNodeOptions_.dataUri));
     LOG_IF(FATAL, !conf_->GetIntValue("copyset.election_timeout_ms",
@@ -700,6 +732,11 @@ void Metaserver::InitCopysetNodeOptions() {
                 &copysetNodeOptions_.applyQueueOption.rconcurrentsize));
     LOG_IF(FATAL, !conf_->GetIntValue("applyqueue.read_queue_depth",
                 &copysetNodeOptions_.applyQueueOption.rqueuedepth));
+    LOG_IF(WARNING, !conf_->GetUInt32Value("applyqueue.write_batch_size",
+                &copysetNodeOptions_.applyBatchSize))
+        << "Not found `applyqueue.write_batch_size` in conf, "
+           "use default value `"
+        << copysetNodeOptions_.applyBatchSize << '`';
     LOG_IF(FATAL, !conf_->GetStringValue("copyset.trash.uri",
                 &copysetNodeOptions_.trashOptions.trashUri));
     LOG_IF(FATAL, !conf_->GetUInt32Value("copyset.trash.expired_aftersec",
@@ -44,6 +44,7 @@ using ::curvefs::metaserver::copyset::CreateInodeOperator;
 using ::curvefs::metaserver::copyset::CreateRootInodeOperator;
 using ::curvefs::metaserver::copyset::CreateManageInodeOperator;
 using ::curvefs::metaserver::copyset::UpdateInodeOperator;
+using ::curvefs::metaserver::copyset::BatchUpdateInodeAttrOperator;
 using ::curvefs::metaserver::copyset::GetOrModifyS3ChunkInfoOperator;
 using ::curvefs::metaserver::copyset::DeleteInodeOperator;
 using ::curvefs::metaserver::copyset::UpdateInodeS3VersionOperator;
@@ -224,6 +225,17 @@ void MetaServerServiceImpl::UpdateInode(
                                            request->copysetid());
 }
 
+void MetaServerServiceImpl::BatchUpdateInodeAttr(
+    ::google::protobuf::RpcController* controller,
+    const ::curvefs::metaserver::BatchUpdateInodeAttrRequest* request,
+    ::curvefs::metaserver::BatchUpdateInodeAttrResponse* response,
+    ::google::protobuf::Closure* done) {
+    OperatorHelper helper(copysetNodeManager_, inflightThrottle_);
+    helper.operator()<BatchUpdateInodeAttrOperator>(
+        controller, request, response, done, request->poolid(),
+        request->copysetid());
+}
+
 void MetaServerServiceImpl::GetOrModifyS3ChunkInfo(
     ::google::protobuf::RpcController* controller,
     const ::curvefs::metaserver::GetOrModifyS3ChunkInfoRequest* request,
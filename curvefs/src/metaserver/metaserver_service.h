@@ -88,6 +88,11 @@ class MetaServerServiceImpl : public MetaServerService {
                      const ::curvefs::metaserver::UpdateInodeRequest* request,
                      ::curvefs::metaserver::UpdateInodeResponse* response,
                      ::google::protobuf::Closure* done) override;
+    void BatchUpdateInodeAttr(
+        ::google::protobuf::RpcController* controller,
+        const ::curvefs::metaserver::BatchUpdateInodeAttrRequest* request,
+        ::curvefs::metaserver::BatchUpdateInodeAttrResponse* response,
+        ::google::protobuf::Closure* done) override;
     void GetOrModifyS3ChunkInfo(
         ::google::protobuf::RpcController* controller,
         const ::curvefs::metaserver::GetOrModifyS3ChunkInfoRequest* request,
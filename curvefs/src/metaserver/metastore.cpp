@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
+#include "absl/strings/escaping.h"
 #include "absl/types/optional.h"
 #include "curvefs/proto/metaserver.pb.h"
 #include "curvefs/src/metaserver/copyset/copyset_node.h"
@@ -136,6 +137,19 @@ bool MetaStoreImpl::Load(const std::string &pathname) {
         return false;
     }
 
+    // storage keys before kDumpFileV4 are encoded in legacy text format,
+    // rewrite them if the snapshot was saved in the other encoding
+    bool binaryKey = version >= storage::kDumpFileV4;
+    if (binaryKey != FLAGS_storage_binary_key) {
+        for (auto &part : partitionMap_) {
+            if (!part.second->MigrateKeys()) {
+                LOG(ERROR) << "Failed to migrate keys, partition: "
+                           << part.first;
+                return false;
+            }
+        }
+    }
+
     startCompacts();
     return true;
 }
@@ -174,29 +188,33 @@ bool MetaStoreImpl::Save(const std::string &dir,
         return false;
     }
 
-    // checkpoint storage
+    // checkpoint storage, the snapshot is done once data is saved
     butil::Timer timer;
     timer.start();
-    std::vector<std::string> files;
-    succ = kvStorage_->Checkpoint(dir, &files);
-    if (!succ) {
-        done->SetError(MetaStatusCode::SAVE_META_FAIL);
-        return false;
-    }
-
-    timer.stop();
-    g_storage_checkpoint_latency << timer.u_elapsed();
-
-    // add files to snapshot writer
-    // file is a relative path under the given directory
-    auto *writer = done->GetSnapshotWriter();
-    writer->add_file(kMetaDataFilename);
-
-    for (const auto &f : files) {
-        writer->add_file(f);
-    }
-
-    done->SetSuccess();
+    doneGuard.release();
+    kvStorage_->CheckpointBackground(
+        dir, [done, timer](bool saved,
+                           const std::vector<std::string>& files) mutable {
+            brpc::ClosureGuard doneGuard(done);
+            if (!saved) {
+                done->SetError(MetaStatusCode::SAVE_META_FAIL);
+                return;
+            }
+
+            timer.stop();
+            g_storage_checkpoint_latency << timer.u_elapsed();
+
+            // add files to snapshot writer
+            // file is a relative path under the given directory
+            auto *writer = done->GetSnapshotWriter();
+            writer->add_file(kMetaDataFilename);
+
+            for (const auto &f : files) {
+                writer->add_file(f);
+            }
+
+            done->SetSuccess();
+        });
     return true;
 }
 
@@ -315,6 +333,7 @@ bool MetaStoreImpl::GetPartitionInfoList(
     if (ret == 0) {
         for (const auto &it : partitionMap_) {
             PartitionInfo partitionInfo = it.second->GetPartitionInfo();
+            partitionInfo.set_requestnum(it.second->GetRequestNum());
             partitionInfoList->push_back(std::move(partitionInfo));
         }
         rwLock_.Unlock();
@@ -505,6 +524,7 @@ MetaStatusCode MetaStoreImpl::CreateInode(const CreateInodeRequest *request,
     std::shared_ptr<Partition> partition;
     GET_PARTITION_OR_RETURN(partition);
 
+    partition->CountRequest();
     MetaStatusCode status =
         partition->CreateInode(param, response->mutable_inode());
     response->set_statuscode(status);
@@ -609,7 +629,8 @@ MetaStatusCode MetaStoreImpl::GetInode(const GetInodeRequest *request,
     // NOTE: the following two cases we should padding inode's s3chunkinfo:
     // (1): for RPC requests which unsupport streaming
     // (2): inode's s3chunkinfo is small enough
-    if (rc == MetaStatusCode::OK) {
+    // and client which loads s3chunkinfo on demand never needs padding.
+    if (rc == MetaStatusCode::OK && !request->skips3chunkinfo()) {
         uint64_t limit = 0;
         if (request->supportstreaming()) {
             limit = kvStorage_->GetStorageOptions().s3MetaLimitSizeInsideInode;
@@ -698,6 +719,29 @@ MetaStatusCode MetaStoreImpl::UpdateInode(const UpdateInodeRequest *request,
     return status;
 }
 
+MetaStatusCode MetaStoreImpl::BatchUpdateInodeAttr(
+    const BatchUpdateInodeAttrRequest *request,
+    BatchUpdateInodeAttrResponse *response) {
+    ReadLockGuard readLockGuard(rwLock_);
+    VLOG(9) << "BatchUpdateInodeAttr, partitionId: " << request->partitionid()
+            << ", size: " << request->update_size();
+    std::shared_ptr<Partition> partition;
+    GET_PARTITION_OR_RETURN(partition);
+
+    for (const auto &update : request->update()) {
+        MetaStatusCode status = partition->UpdateInode(update);
+        if (status != MetaStatusCode::OK) {
+            LOG(WARNING) << "BatchUpdateInodeAttr update inode failed"
+                         << ", inodeId: " << update.inodeid()
+                         << ", status: " << MetaStatusCode_Name(status);
+        }
+        response->add_updatestatus(status);
+    }
+
+    response->set_statuscode(MetaStatusCode::OK);
+    return MetaStatusCode::OK;
+}
+
 MetaStatusCode MetaStoreImpl::GetOrModifyS3ChunkInfo(
     const GetOrModifyS3ChunkInfoRequest *request,
     GetOrModifyS3ChunkInfoResponse *response,
@@ -709,9 +753,11 @@ MetaStatusCode MetaStoreImpl::GetOrModifyS3ChunkInfo(
 
     uint32_t fsId = request->fsid();
     uint64_t inodeId = request->inodeid();
+    std::vector<uint64_t> chunkIndexes(request->chunkindexes().begin(),
+                                       request->chunkindexes().end());
     rc = partition->GetOrModifyS3ChunkInfo(
         fsId, inodeId, request->s3chunkinfoadd(), request->s3chunkinforemove(),
-        request->returns3chunkinfomap(), iterator);
+        request->returns3chunkinfomap(), iterator, chunkIndexes);
     if (rc == MetaStatusCode::OK && !request->supportstreaming() &&
         request->returns3chunkinfomap()) {
         rc = partition->PaddingInodeS3ChunkInfo(
@@ -743,7 +789,7 @@ MetaStatusCode MetaStoreImpl::SendS3ChunkInfoByStream(
             return MetaStatusCode::PARSE_FROM_STRING_FAILED;
         }
 
-        VLOG(9) << "Key4S3ChunkInfoList=" << skey;
+        VLOG(9) << "Key4S3ChunkInfoList=" << absl::BytesToHexString(skey);
 
         PrepareStreamBuffer(&buffer, key.chunkIndex, iterator->Value());
         if (!connection->Write(buffer)) {
@@ -818,6 +864,25 @@ MetaStatusCode MetaStoreImpl::UpdateDeallocatableBlockGroup(
     return st;
 }
 
+bool MetaStoreImpl::BeginApplyBatch() {
+    ReadLockGuard guard(rwLock_);
+    return kvStorage_ != nullptr && kvStorage_->BeginBatch();
+}
+
+bool MetaStoreImpl::CommitApplyBatch() {
+    ReadLockGuard guard(rwLock_);
+    if (kvStorage_ == nullptr) {
+        return false;
+    }
+
+    auto s = kvStorage_->CommitBatch();
+    if (!s.ok()) {
+        LOG(ERROR) << "Commit apply batch failed, status = " << s.ToString();
+        return false;
+    }
+    return true;
+}
+
 bool MetaStoreImpl::InitStorage() {
     if (storageOptions_.type == "memory") {
         kvStorage_ = std::make_shared<MemoryStorage>(storageOptions_);
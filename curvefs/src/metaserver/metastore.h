@@ -173,6 +173,10 @@ class MetaStore {
     virtual MetaStatusCode UpdateInode(const UpdateInodeRequest* request,
                                        UpdateInodeResponse* response) = 0;
 
+    virtual MetaStatusCode BatchUpdateInodeAttr(
+        const BatchUpdateInodeAttrRequest* request,
+        BatchUpdateInodeAttrResponse* response) = 0;
+
     virtual MetaStatusCode GetOrModifyS3ChunkInfo(
         const GetOrModifyS3ChunkInfoRequest* request,
         GetOrModifyS3ChunkInfoResponse* response,
@@ -193,6 +197,13 @@ class MetaStore {
     virtual MetaStatusCode UpdateDeallocatableBlockGroup(
         const UpdateDeallocatableBlockGroupRequest *request,
         UpdateDeallocatableBlockGroupResponse *response) = 0;
+
+    // Buffer modifications of following operators applied by current thread
+    // and commit them at once in CommitApplyBatch(), return false if the
+    // underlying storage doesn't support it
+    virtual bool BeginApplyBatch() { return false; }
+
+    virtual bool CommitApplyBatch() { return true; }
 };
 
 class MetaStoreImpl : public MetaStore {
@@ -263,6 +274,13 @@ class MetaStoreImpl : public MetaStore {
     MetaStatusCode UpdateInode(const UpdateInodeRequest* request,
                                UpdateInodeResponse* response) override;
 
+    // Apply each update in |request| in order, the status of every update
+    // is returned in |response|, and the whole batch is considered success
+    // as long as the partition exists
+    MetaStatusCode BatchUpdateInodeAttr(
+        const BatchUpdateInodeAttrRequest* request,
+        BatchUpdateInodeAttrResponse* response) override;
+
     std::shared_ptr<Partition> GetPartition(uint32_t partitionId);
 
     MetaStatusCode GetOrModifyS3ChunkInfo(
@@ -286,6 +304,10 @@ class MetaStoreImpl : public MetaStore {
         const UpdateDeallocatableBlockGroupRequest *request,
         UpdateDeallocatableBlockGroupResponse *response) override;
 
+    bool BeginApplyBatch() override;
+
+    bool CommitApplyBatch() override;
+
  private:
     FRIEND_TEST(MetastoreTest, partition);
     FRIEND_TEST(MetastoreTest, test_inode);
@@ -26,6 +26,7 @@
 #include <unordered_map>
 #include <utility>
 
+#include "absl/strings/escaping.h"
 #include "curvefs/proto/common.pb.h"
 #include "curvefs/proto/metaserver.pb.h"
 #include "curvefs/src/metaserver/metastore_fstream.h"
@@ -220,8 +221,8 @@ bool MetaStoreFStream::LoadVolumeExtentList(uint32_t partitionId,
     VolumeExtentSlice slice;
 
     if (!sliceKey.ParseFromString(key)) {
-        LOG(ERROR) << "Fail to decode Key4VolumeExtentSlice, key: `" << key
-                   << "`";
+        LOG(ERROR) << "Fail to decode Key4VolumeExtentSlice, key: `"
+                   << absl::BytesToHexString(key) << "`";
         return false;
     }
 
@@ -286,10 +286,12 @@ MetaStatusCode Partition::GetOrModifyS3ChunkInfo(
     const S3ChunkInfoMap& map2add,
     const S3ChunkInfoMap& map2del,
     bool returnS3ChunkInfoMap,
-    std::shared_ptr<Iterator>* iterator) {
+    std::shared_ptr<Iterator>* iterator,
+    const std::vector<uint64_t>& chunkIndexes) {
     PRECHECK(fsId, inodeId);
     return inodeManager_->GetOrModifyS3ChunkInfo(
-        fsId, inodeId, map2add, map2del, returnS3ChunkInfoMap, iterator);
+        fsId, inodeId, map2add, map2del, returnS3ChunkInfoMap, iterator,
+        chunkIndexes);
 }
 
 MetaStatusCode Partition::PaddingInodeS3ChunkInfo(int32_t fsId,
@@ -393,6 +395,20 @@ bool Partition::Clear() {
     return true;
 }
 
+bool Partition::MigrateKeys() {
+    if (inodeStorage_->MigrateKeys() != MetaStatusCode::OK) {
+        LOG(ERROR) << "Migrate keys of inode storage failed";
+        return false;
+    } else if (dentryStorage_->MigrateKeys() != MetaStatusCode::OK) {
+        LOG(ERROR) << "Migrate keys of dentry storage failed";
+        return false;
+    }
+
+    LOG(INFO) << "Migrate keys of partition "
+              << partitionInfo_.partitionid() << " success";
+    return true;
+}
+
 uint64_t Partition::GetNewInodeId() {
     if (partitionInfo_.nextid() > partitionInfo_.end()) {
         partitionInfo_.set_status(PartitionStatus::READONLY);
@@ -22,6 +22,7 @@
 
 #ifndef CURVEFS_SRC_METASERVER_PARTITION_H_
 #define CURVEFS_SRC_METASERVER_PARTITION_H_
+#include <atomic>
 #include <list>
 #include <memory>
 #include <string>
@@ -104,7 +105,9 @@ class Partition {
                                           const S3ChunkInfoMap& map2add,
                                           const S3ChunkInfoMap& map2del,
                                           bool returnS3ChunkInfoMap,
-                                          std::shared_ptr<Iterator>* iterator);
+                                          std::shared_ptr<Iterator>* iterator,
+                                          const std::vector<uint64_t>&
+                                              chunkIndexes = {});
 
     MetaStatusCode PaddingInodeS3ChunkInfo(int32_t fsId,
                                            uint64_t inodeId,
@@ -156,6 +159,17 @@ class Partition {
 
     PartitionInfo GetPartitionInfo();
 
+    // count inode creating requests applied by this partition, mds takes
+    // the increase between heartbeats as the load of the partition, other
+    // requests don't move new inodes away, so they're not counted
+    void CountRequest() {
+        requestNum_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t GetRequestNum() const {
+        return requestNum_.load(std::memory_order_relaxed);
+    }
+
     // get new inode id in partition range.
     // if no available inode id in this partiton ,return UINT64_MAX
     uint64_t GetNewInodeId();
@@ -196,6 +210,9 @@ class Partition {
 
     bool Clear();
 
+    // rewrite storage keys to the encoding selected by storage_binary_key
+    bool MigrateKeys();
+
     void SetManageFlag(bool flag) { partitionInfo_.set_manageflag(flag); }
 
     bool GetManageFlag() {
@@ -218,6 +235,8 @@ class Partition {
     std::shared_ptr<TxManager> txManager_;
 
     PartitionInfo partitionInfo_;
+
+    std::atomic<uint64_t> requestNum_{0};
 };
 }  // namespace metaserver
 }  // namespace curvefs
@@ -36,6 +36,7 @@ using ::curvefs::client::rpcclient::MdsClientImpl;
 struct PartitionCleanOption {
     uint32_t scanPeriodSec;
     uint32_t inodeDeletePeriodMs;
+    uint32_t deleteBatchInodeNum = 100;
     std::shared_ptr<S3ClientAdaptor> s3Adaptor;
     std::shared_ptr<MdsClient> mdsClient;
 };
@@ -60,6 +61,7 @@ class PartitionCleanManager {
     void Init(const PartitionCleanOption& option) {
         scanPeriodSec_ = option.scanPeriodSec;
         inodeDeletePeriodMs_ = option.inodeDeletePeriodMs;
+        deleteBatchInodeNum_ = option.deleteBatchInodeNum;
         S3ClientAdaptor_ = option.s3Adaptor;
         mdsClient_ = option.mdsClient;
         partitionCleanerCount.expose_as("partition_clean_manager_", "cleaner");
@@ -84,6 +86,7 @@ class PartitionCleanManager {
     std::shared_ptr<MdsClient> mdsClient_;
     uint32_t scanPeriodSec_;
     uint32_t inodeDeletePeriodMs_;
+    uint32_t deleteBatchInodeNum_;
     Atomic<bool> isStop_;
     Thread thread_;
     InterruptibleSleeper sleeper_;
@@ -21,6 +21,8 @@
  */
 
 #include <list>
+#include <utility>
+
 #include "curvefs/src/metaserver/partition_cleaner.h"
 #include "curvefs/src/metaserver/mds/fsinfo_manager.h"
 #include "curvefs/src/metaserver/copyset/meta_operator.h"
@@ -41,6 +43,20 @@ bool PartitionCleaner::ScanPartition() {
         return false;
     }
 
+    // s3 data of inodes are deleted in batches, other inodes have no data
+    // to clean and are deleted directly
+    std::list<Inode> batchInodes;
+    auto flushBatch = [this, &batchInodes]() {
+        MetaStatusCode ret = CleanDataAndDeleteInodes(batchInodes);
+        if (ret != MetaStatusCode::OK) {
+            LOG(WARNING) << "ScanPartition clean inodes fail, fsId = "
+                         << partition_->GetFsId()
+                         << ", inode num = " << batchInodes.size()
+                         << ", ret = " << MetaStatusCode_Name(ret);
+        }
+        batchInodes.clear();
+    };
+
     for (auto inodeId : InodeIdList) {
         if (isStop_ || !copysetNode_->IsLeaderTerm()) {
             return false;
@@ -55,6 +71,14 @@ bool PartitionCleaner::ScanPartition() {
             continue;
         }
 
+        if (FsFileType::TYPE_S3 == inode.type()) {
+            batchInodes.emplace_back(std::move(inode));
+            if (batchInodes.size() >= deleteBatchInodeNum_) {
+                flushBatch();
+            }
+            continue;
+        }
+
         ret = CleanDataAndDeleteInode(inode);
         if (ret != MetaStatusCode::OK) {
             LOG(WARNING) << "ScanPartition clean inode fail, inode = "
@@ -64,6 +88,13 @@ bool PartitionCleaner::ScanPartition() {
         usleep(inodeDeletePeriodMs_);
     }
 
+    if (!batchInodes.empty()) {
+        if (isStop_ || !copysetNode_->IsLeaderTerm()) {
+            return false;
+        }
+        flushBatch();
+    }
+
     uint32_t partitionId = partition_->GetPartitionId();
     if (partition_->EmptyInodeStorage()) {
         LOG(INFO) << "Inode num is 0, delete partition from metastore"
@@ -83,35 +114,29 @@ bool PartitionCleaner::ScanPartition() {
     return false;
 }
 
+bool PartitionCleaner::ReinitS3Adaptor(uint32_t fsId) {
+    // get s3info from mds
+    FsInfo fsInfo;
+    if (!FsInfoManager::GetInstance().GetFsInfo(fsId, &fsInfo)) {
+        LOG(ERROR) << "PartitionCleaner get fsinfo failed, fsId = " << fsId;
+        return false;
+    }
+
+    const auto& s3Info = fsInfo.detail().s3info();
+    S3ClientAdaptorOption clientAdaptorOption;
+    s3Adaptor_->GetS3ClientAdaptorOption(&clientAdaptorOption);
+    clientAdaptorOption.blockSize = s3Info.blocksize();
+    clientAdaptorOption.chunkSize = s3Info.chunksize();
+    clientAdaptorOption.objectPrefix = s3Info.objectprefix();
+    s3Adaptor_->Reinit(clientAdaptorOption, s3Info.ak(), s3Info.sk(),
+        s3Info.endpoint(), s3Info.bucketname());
+    return true;
+}
+
 MetaStatusCode PartitionCleaner::CleanDataAndDeleteInode(const Inode& inode) {
     // TODO(cw123) : consider FsFileType::TYPE_FILE
     if (FsFileType::TYPE_S3 == inode.type()) {
-         // get s3info from mds
-         FsInfo fsInfo;
-         auto ret =
-             FsInfoManager::GetInstance().GetFsInfo(inode.fsid(), &fsInfo);
-         if (!ret) {
-             LOG(ERROR) << "PartitionCleaner get fsinfo failed, fsId = "
-                        << inode.fsid();
-             return MetaStatusCode::S3_DELETE_ERR;
-         }
-
-        const auto& s3Info = fsInfo.detail().s3info();
-        // reinit s3 adaptor
-        S3ClientAdaptorOption clientAdaptorOption;
-        s3Adaptor_->GetS3ClientAdaptorOption(&clientAdaptorOption);
-        clientAdaptorOption.blockSize = s3Info.blocksize();
-        clientAdaptorOption.chunkSize = s3Info.chunksize();
-        clientAdaptorOption.objectPrefix = s3Info.objectprefix();
-        s3Adaptor_->Reinit(clientAdaptorOption, s3Info.ak(), s3Info.sk(),
-            s3Info.endpoint(), s3Info.bucketname());
-        int retVal = s3Adaptor_->Delete(inode);
-        if (retVal != 0) {
-            LOG(ERROR) << "S3ClientAdaptor delete s3 data failed"
-                       << ", ret = " << retVal << ", fsId = " << inode.fsid()
-                       << ", inodeId = " << inode.inodeid();
-            return MetaStatusCode::S3_DELETE_ERR;
-        }
+        return CleanDataAndDeleteInodes({inode});
     }
 
     // send request to copyset to delete inode
@@ -125,6 +150,43 @@ MetaStatusCode PartitionCleaner::CleanDataAndDeleteInode(const Inode& inode) {
     return MetaStatusCode::OK;
 }
 
+MetaStatusCode PartitionCleaner::CleanDataAndDeleteInodes(
+    const std::list<Inode>& inodes) {
+    if (inodes.empty()) {
+        return MetaStatusCode::OK;
+    }
+
+    uint32_t fsId = inodes.front().fsid();
+    if (!ReinitS3Adaptor(fsId)) {
+        return MetaStatusCode::S3_DELETE_ERR;
+    }
+
+    int retVal = s3Adaptor_->DeleteInodes(inodes);
+    if (retVal != 0) {
+        LOG(ERROR) << "S3ClientAdaptor delete s3 data failed"
+                   << ", ret = " << retVal << ", fsId = " << fsId
+                   << ", inode num = " << inodes.size();
+        return MetaStatusCode::S3_DELETE_ERR;
+    }
+
+    // send request to copyset to delete inodes, keep going on failure so
+    // that one bad inode does not block the rest, it is retried in the
+    // next scan
+    MetaStatusCode result = MetaStatusCode::OK;
+    for (const auto& inode : inodes) {
+        MetaStatusCode ret = DeleteInode(inode);
+        if (ret != MetaStatusCode::OK && ret != MetaStatusCode::NOT_FOUND) {
+            LOG(ERROR) << "Delete Inode fail, fsId = " << inode.fsid()
+                       << ", inodeId = " << inode.inodeid()
+                       << ", ret = " << MetaStatusCode_Name(ret);
+            result = ret;
+            continue;
+        }
+        usleep(inodeDeletePeriodMs_);
+    }
+    return result;
+}
+
 MetaStatusCode PartitionCleaner::DeleteInode(const Inode& inode) {
     DeleteInodeRequest request;
     request.set_poolid(partition_->GetPoolId());
@@ -23,6 +23,7 @@
 #ifndef CURVEFS_SRC_METASERVER_PARTITION_CLEANER_H_
 #define CURVEFS_SRC_METASERVER_PARTITION_CLEANER_H_
 
+#include <list>
 #include <memory>
 #include <unordered_map>
 
@@ -52,6 +53,10 @@ class PartitionCleaner {
         inodeDeletePeriodMs_ = periodMs;
     }
 
+    void SetDeleteBatchInodeNum(uint32_t num) {
+        deleteBatchInodeNum_ = num;
+    }
+
     void SetS3Aapter(std::shared_ptr<S3ClientAdaptor> s3Adaptor) {
         s3Adaptor_ = s3Adaptor;
     }
@@ -66,6 +71,9 @@ class PartitionCleaner {
 
     bool ScanPartition();
     MetaStatusCode CleanDataAndDeleteInode(const Inode &inode);
+    // delete s3 data of |inodes| in one batch, then delete the inodes,
+    // all of them must belong to the fs of this partition
+    MetaStatusCode CleanDataAndDeleteInodes(const std::list<Inode> &inodes);
     MetaStatusCode DeleteInode(const Inode& inode);
     MetaStatusCode DeletePartition();
     uint32_t GetPartitionId() {
@@ -76,6 +84,9 @@ class PartitionCleaner {
 
     bool IsStop() { return isStop_; }
 
+ private:
+    bool ReinitS3Adaptor(uint32_t fsId);
+
  private:
     std::shared_ptr<Partition> partition_;
     copyset::CopysetNode *copysetNode_;
@@ -83,6 +94,7 @@ class PartitionCleaner {
     std::shared_ptr<MdsClient> mdsClient_;
     bool isStop_;
     uint32_t inodeDeletePeriodMs_;
+    uint32_t deleteBatchInodeNum_ = 100;
 };
 
 class PartitionCleanerClosure : public google::protobuf::Closure {
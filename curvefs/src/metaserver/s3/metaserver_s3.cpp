@@ -37,6 +37,13 @@ void S3ClientImpl::Init(const curve::common::S3AdapterOption& option) {
 
 void S3ClientImpl::Reinit(const std::string& ak, const std::string& sk,
     const std::string& endpoint, const std::string& bucketName) {
+    // trash and partition cleaner reinit the client before deleting every
+    // batch of inodes, recreating the aws client is expensive and
+    // unnecessary if the batch belongs to the same fs as the previous one
+    if (option_.ak == ak && option_.sk == sk &&
+        option_.s3Address == endpoint && option_.bucketName == bucketName) {
+        return;
+    }
     option_.ak = ak;
     option_.sk = sk;
     option_.s3Address = endpoint;
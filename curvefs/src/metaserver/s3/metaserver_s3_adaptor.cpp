@@ -35,6 +35,7 @@ void S3ClientAdaptorImpl::Init(const S3ClientAdaptorOption &option,
     enableBatchDelete_ = option.enableBatchDelete;
     objectPrefix_ = option.objectPrefix;
     client_ = client;
+    UpdateDeleteThrottle(option.deleteRequestsPerSec);
 }
 
 void S3ClientAdaptorImpl::Reinit(const S3ClientAdaptorOption& option,
@@ -45,9 +46,22 @@ void S3ClientAdaptorImpl::Reinit(const S3ClientAdaptorOption& option,
     batchSize_ = option.batchSize;
     enableBatchDelete_ = option.enableBatchDelete;
     objectPrefix_ = option.objectPrefix;
+    UpdateDeleteThrottle(option.deleteRequestsPerSec);
     client_->Reinit(ak, sk, endpoint, bucketName);
 }
 
+void S3ClientAdaptorImpl::UpdateDeleteThrottle(uint64_t deleteRequestsPerSec) {
+    if (deleteRequestsPerSec == deleteRequestsPerSec_) {
+        return;
+    }
+
+    curve::common::ReadWriteThrottleParams params;
+    params.iopsTotal =
+        curve::common::ThrottleParams(deleteRequestsPerSec, 0, 0);
+    deleteThrottle_.UpdateThrottleParams(params);
+    deleteRequestsPerSec_ = deleteRequestsPerSec;
+}
+
 int S3ClientAdaptorImpl::Delete(const Inode &inode) {
     if (enableBatchDelete_) {
         return DeleteInodeByDeleteBatchChunk(inode);
@@ -56,6 +70,31 @@ int S3ClientAdaptorImpl::Delete(const Inode &inode) {
     }
 }
 
+int S3ClientAdaptorImpl::DeleteInodes(const std::list<Inode>& inodes) {
+    if (!enableBatchDelete_) {
+        int ret = 0;
+        for (const auto& inode : inodes) {
+            if (DeleteInodeByDeleteSingleChunk(inode) != 0) {
+                ret = -1;
+            }
+        }
+        return ret;
+    }
+
+    std::list<std::string> objList;
+    for (const auto& inode : inodes) {
+        for (const auto& item : inode.s3chunkinfomap()) {
+            GenObjNameListForChunkInfoList(inode.fsid(), inode.inodeid(),
+                                           item.second, &objList);
+        }
+    }
+
+    int ret = DeleteObjectsInBatch(&objList);
+    LOG(INFO) << "delete data of " << inodes.size()
+              << " inodes, ret = " << ret;
+    return ret;
+}
+
 int S3ClientAdaptorImpl::DeleteInodeByDeleteSingleChunk(const Inode &inode) {
     // const S3ChunkInfoList& s3ChunkInfolist = inode.s3chunkinfolist();
     auto s3ChunkInfoMap = inode.s3chunkinfomap();
@@ -101,7 +140,12 @@ int S3ClientAdaptorImpl::DeleteChunk(uint64_t fsId, uint64_t inodeId,
         // divide chunks to blocks, and delete these blocks
         std::string objectName = curvefs::common::s3util::GenObjName(
             chunkId, blockIndex, compaction, fsId, inodeId, objectPrefix_);
+        deleteThrottle_.Add(false, 0);
+        deleteRequests_ << 1;
         int delStat = client_->Delete(objectName);
+        if (delStat >= 0) {
+            deletedObjects_ << 1;
+        }
         if (delStat < 0) {
             // fail
             LOG(ERROR) << "delete object fail. object: " << objectName;
@@ -122,22 +166,20 @@ int S3ClientAdaptorImpl::DeleteChunk(uint64_t fsId, uint64_t inodeId,
 }
 
 int S3ClientAdaptorImpl::DeleteInodeByDeleteBatchChunk(const Inode &inode) {
-    auto s3ChunkInfoMap = inode.s3chunkinfomap();
     LOG(INFO) << "delete data, inode id: " << inode.inodeid()
               << ", len:" << inode.length();
-    int returnCode = 0;
-    auto iter = s3ChunkInfoMap.begin();
-    while (iter != s3ChunkInfoMap.end()) {
-        int ret =
-            DeleteS3ChunkInfoList(inode.fsid(), inode.inodeid(), iter->second);
-        if (ret != 0) {
-            LOG(ERROR) << "delete chunk failed, ret = " << ret
-                       << " , chunk index is " << iter->first;
-            returnCode = -1;
-            iter++;
-        } else {
-            iter = s3ChunkInfoMap.erase(iter);
-        }
+    // objects of all chunk indexes are deleted together, so that every
+    // request except the last one carries a full batch
+    std::list<std::string> objList;
+    for (const auto& item : inode.s3chunkinfomap()) {
+        GenObjNameListForChunkInfoList(inode.fsid(), inode.inodeid(),
+                                       item.second, &objList);
+    }
+
+    int returnCode = DeleteObjectsInBatch(&objList);
+    if (returnCode != 0) {
+        LOG(ERROR) << "delete chunk failed, fsId = " << inode.fsid()
+                   << ", inodeId = " << inode.inodeid();
     }
     LOG(INFO) << "delete data, inode id: " << inode.inodeid()
               << ", len:" << inode.length() << " , ret = " << returnCode;
@@ -145,25 +187,23 @@ int S3ClientAdaptorImpl::DeleteInodeByDeleteBatchChunk(const Inode &inode) {
     return returnCode;
 }
 
-int S3ClientAdaptorImpl::DeleteS3ChunkInfoList(
-    uint32_t fsId, uint64_t inodeId, const S3ChunkInfoList &s3ChunkInfolist) {
-    std::list<std::string> objList;
-
-    GenObjNameListForChunkInfoList(fsId, inodeId, s3ChunkInfolist, &objList);
-
-    while (objList.size() != 0) {
+int S3ClientAdaptorImpl::DeleteObjectsInBatch(
+    std::list<std::string> *objList) {
+    while (objList->size() != 0) {
         std::list<std::string> tempObjList;
-        auto begin = objList.begin();
-        auto end = objList.begin();
-        std::advance(end, std::min(batchSize_, objList.size()));
-        tempObjList.splice(tempObjList.begin(), objList, begin, end);
+        auto begin = objList->begin();
+        auto end = objList->begin();
+        std::advance(end, std::min(batchSize_, objList->size()));
+        tempObjList.splice(tempObjList.begin(), *objList, begin, end);
+        deleteThrottle_.Add(false, 0);
+        deleteRequests_ << 1;
         int ret = client_->DeleteBatch(tempObjList);
         if (ret != 0) {
-            LOG(ERROR) << "DeleteS3ChunkInfoList failed, fsId = " << fsId
-                       << ", inodeId =  " << inodeId
-                       << ", status code = " << ret;
+            LOG(ERROR) << "DeleteObjectsInBatch failed, first object = "
+                       << tempObjList.front() << ", status code = " << ret;
             return -1;
         }
+        deletedObjects_ << tempObjList.size();
     }
 
     return 0;
@@ -214,6 +254,7 @@ void S3ClientAdaptorImpl::GetS3ClientAdaptorOption(
     option->batchSize = batchSize_;
     option->enableBatchDelete = enableBatchDelete_;
     option->objectPrefix = objectPrefix_;
+    option->deleteRequestsPerSec = deleteRequestsPerSec_;
 }
 
 }  // namespace metaserver
@@ -23,10 +23,13 @@
 #ifndef CURVEFS_SRC_METASERVER_S3_METASERVER_S3_ADAPTOR_H_
 #define CURVEFS_SRC_METASERVER_S3_METASERVER_S3_ADAPTOR_H_
 
+#include <bvar/bvar.h>
+
 #include <string>
 #include <list>
 #include "curvefs/proto/metaserver.pb.h"
 #include "curvefs/src/metaserver/s3/metaserver_s3.h"
+#include "src/common/throttle.h"
 
 namespace curvefs {
 namespace metaserver {
@@ -37,6 +40,8 @@ struct S3ClientAdaptorOption {
     uint64_t batchSize;
     uint32_t objectPrefix;
     bool enableBatchDelete;
+    // max number of delete requests sent to s3 per second, 0 means no limit
+    uint64_t deleteRequestsPerSec = 0;
 };
 
 class S3ClientAdaptor {
@@ -69,6 +74,18 @@ class S3ClientAdaptor {
      */
     virtual int Delete(const Inode& inode) = 0;
 
+    /**
+     * @brief delete data of inodes which belong to one fs from s3
+     * @param inodes
+     * @return int
+     *  0   : delete sucess
+     *  -1  : delete fail
+     * @details
+     * if batch delete is enabled, objects of all inodes are merged into
+     * full batches, so lots of small files need only a few requests
+     */
+    virtual int DeleteInodes(const std::list<Inode>& inodes) = 0;
+
     /**
      * @brief get S3ClientAdaptorOption
      * 
@@ -80,7 +97,11 @@ class S3ClientAdaptor {
 
 class S3ClientAdaptorImpl : public S3ClientAdaptor {
  public:
-    S3ClientAdaptorImpl() {}
+    S3ClientAdaptorImpl()
+        : deletedObjects_("metaserver_s3_deleted_objects"),
+          deleteRequests_("metaserver_s3_delete_requests"),
+          deletedObjectsPerSec_("metaserver_s3_deleted_objects_per_second",
+                                &deletedObjects_) {}
     ~S3ClientAdaptorImpl() {
         if (client_ != nullptr) {
             delete client_;
@@ -111,6 +132,8 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
      */
     int Delete(const Inode& inode) override;
 
+    int DeleteInodes(const std::list<Inode>& inodes) override;
+
     /**
      * @brief get S3ClientAdaptorOption
      * 
@@ -134,8 +157,9 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
 
     int DeleteInodeByDeleteBatchChunk(const Inode& inode);
 
-    int DeleteS3ChunkInfoList(uint32_t fsId, uint64_t inodeId,
-                              const S3ChunkInfoList& s3ChunkInfolist);
+    int DeleteObjectsInBatch(std::list<std::string>* objList);
+
+    void UpdateDeleteThrottle(uint64_t deleteRequestsPerSec);
 
     void GenObjNameListForChunkInfoList(uint32_t fsId, uint64_t inodeId,
                                         const S3ChunkInfoList& s3ChunkInfolist,
@@ -151,6 +175,15 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
     uint64_t batchSize_;
     uint32_t objectPrefix_;
     bool enableBatchDelete_;
+    uint64_t deleteRequestsPerSec_ = 0;
+
+    // limit the delete requests, so that cleaning a large trash doesn't
+    // exhaust the request budget of the s3 bucket
+    curve::common::Throttle deleteThrottle_;
+
+    bvar::Adder<uint64_t> deletedObjects_;
+    bvar::Adder<uint64_t> deleteRequests_;
+    bvar::PerSecond<bvar::Adder<uint64_t>> deletedObjectsPerSec_;
 };
 }  // namespace metaserver
 }  // namespace curvefs
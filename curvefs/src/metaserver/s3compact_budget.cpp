@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#include "curvefs/src/metaserver/s3compact_budget.h"
+
+#include <glog/logging.h>
+
+namespace curvefs {
+namespace metaserver {
+
+using curve::common::ReadWriteThrottleParams;
+using curve::common::ThrottleParams;
+
+S3CompactBudget::S3CompactBudget(uint64_t memoryLimit,
+                                 uint64_t bandwidthLimit)
+    : memoryLimit_(memoryLimit),
+      bandwidthLimited_(bandwidthLimit != 0),
+      memoryInUse_(0),
+      stopped_(false) {
+    if (bandwidthLimited_) {
+        ReadWriteThrottleParams params;
+        params.bpsTotal = ThrottleParams(bandwidthLimit, 0, 0);
+        throttle_.UpdateThrottleParams(params);
+    }
+}
+
+bool S3CompactBudget::AcquireMemory(uint64_t bytes) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    if (memoryLimit_ != 0) {
+        cond_.wait(lock, [&]() {
+            return stopped_ || memoryInUse_ == 0 ||
+                   memoryInUse_ + bytes <= memoryLimit_;
+        });
+    }
+
+    if (stopped_) {
+        return false;
+    }
+
+    memoryInUse_ += bytes;
+    return true;
+}
+
+bool S3CompactBudget::TryAcquireMemory(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (stopped_ ||
+        (memoryLimit_ != 0 && memoryInUse_ + bytes > memoryLimit_)) {
+        return false;
+    }
+
+    memoryInUse_ += bytes;
+    return true;
+}
+
+void S3CompactBudget::ReleaseMemory(uint64_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        CHECK_GE(memoryInUse_, bytes);
+        memoryInUse_ -= bytes;
+    }
+
+    cond_.notify_all();
+}
+
+void S3CompactBudget::ConsumeBandwidth(bool isRead, uint64_t bytes) {
+    if (bandwidthLimited_) {
+        throttle_.Add(isRead, bytes);
+    }
+}
+
+void S3CompactBudget::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopped_ = true;
+    }
+
+    cond_.notify_all();
+}
+
+uint64_t S3CompactBudget::MemoryInUse() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return memoryInUse_;
+}
+
+}  // namespace metaserver
+}  // namespace curvefs
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#ifndef CURVEFS_SRC_METASERVER_S3COMPACT_BUDGET_H_
+#define CURVEFS_SRC_METASERVER_S3COMPACT_BUDGET_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "src/common/throttle.h"
+
+namespace curvefs {
+namespace metaserver {
+
+// Memory and s3 bandwidth shared by all s3 compaction workers, so that
+// adding workers speeds up compaction without hurting foreground traffic
+class S3CompactBudget {
+ public:
+    // 0 means unlimited
+    S3CompactBudget(uint64_t memoryLimit, uint64_t bandwidthLimit);
+
+    // Reserve |bytes| of memory, block until others release enough.
+    // A request larger than the limit is granted when nothing else is
+    // reserved. Return false if the budget is stopped.
+    bool AcquireMemory(uint64_t bytes);
+
+    // Reserve |bytes| of memory only if it's available right now
+    bool TryAcquireMemory(uint64_t bytes);
+
+    void ReleaseMemory(uint64_t bytes);
+
+    // Block until |bytes| of s3 read or write is allowed
+    void ConsumeBandwidth(bool isRead, uint64_t bytes);
+
+    // Wake up all waiters of memory
+    void Stop();
+
+    uint64_t MemoryInUse();
+
+ private:
+    const uint64_t memoryLimit_;
+    const bool bandwidthLimited_;
+
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    uint64_t memoryInUse_;
+    bool stopped_;
+
+    curve::common::Throttle throttle_;
+};
+
+}  // namespace metaserver
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_METASERVER_S3COMPACT_BUDGET_H_
@@ -23,16 +23,19 @@
 #include "curvefs/src/metaserver/s3compact_inode.h"
 
 #include <algorithm>
+#include <chrono>
 #include <deque>
 #include <list>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
+#include "curvefs/src/metaserver/s3compact_budget.h"
 #include "curvefs/src/common/s3util.h"
 #include "curvefs/src/metaserver/copyset/copyset_node_manager.h"
 #include "curvefs/src/metaserver/copyset/meta_operator.h"
@@ -242,72 +245,182 @@ void CompactInodeJob::GenS3ReadRequests(
     newChunkInfo->newCompaction = newCompaction;
 }
 
-int CompactInodeJob::ReadFullChunk(
-    const struct S3CompactCtx& ctx, const std::list<struct Node>& validList,
-    std::string* fullChunk, struct S3NewChunkInfo* newChunkInfo) {
+int CompactInodeJob::ReadObject(const struct S3CompactCtx& ctx,
+                                const std::string& objName,
+                                std::string* buf) {
+    const Aws::String aws_key(objName.c_str(), objName.size());
+    const auto maxRetry = opts_->s3ReadMaxRetry;
+    const auto retryInterval = opts_->s3ReadRetryInterval;
+    for (uint64_t retry = 0; retry <= maxRetry; retry++) {
+        // why we need retry
+        // if you enable client's diskcache,
+        // metadata may be newer than data in s3
+        // which means you cannot read data from s3
+        // we have to wait data to be flushed to s3
+        int ret = ctx.s3adapter->GetObject(aws_key, buf);
+        if (ret == 0) {
+            if (opts_->budget != nullptr) {
+                opts_->budget->ConsumeBandwidth(true, buf->size());
+            }
+            return 0;
+        }
+
+        LOG(WARNING) << "s3compact: get s3 obj " << objName << " failed";
+        if (retry == maxRetry) break;  // no chance
+        LOG(WARNING) << "s3compact: will retry after " << retryInterval
+                     << " seconds, current retry time:" << retry + 1;
+        std::this_thread::sleep_for(std::chrono::seconds(retryInterval));
+    }
+    return -1;
+}
+
+int CompactInodeJob::MergeChunk(const struct S3CompactCtx& ctx,
+                                const std::list<struct Node>& validList,
+                                struct S3NewChunkInfo* newChunkInfo,
+                                uint64_t* chunkLen,
+                                std::vector<std::string>* objsAdded) {
     std::vector<struct S3Request> s3reqs;
-    std::vector<std::string> readContent;
-    // generate s3request first
+    // generate s3request first, they are in order of offset
     GenS3ReadRequests(ctx, validList, &s3reqs, newChunkInfo);
     VLOG(9) << "s3compact: s3 request generated";
+    *chunkLen = 0;
     for (const auto& s3req : s3reqs) {
         VLOG(9) << "index:" << s3req.reqIndex << ", zero:" << s3req.zero
                 << ", s3objname:" << s3req.objName << ", off:" << s3req.off
                 << ", len:" << s3req.len;
+        *chunkLen += s3req.len;
     }
-    readContent.resize(s3reqs.size());
-    std::unordered_map<std::string, std::vector<struct S3Request*>> objReqs;
-    for (auto& req : s3reqs) {
-        if (req.zero) {
-            objReqs["zero"].emplace_back(&req);
-        } else {
-            objReqs[req.objName].emplace_back(&req);
-        }
+
+    // one source block and one new block
+    const uint64_t memory = 2 * ctx.blockSize;
+    if (opts_->budget != nullptr && !opts_->budget->AcquireMemory(memory)) {
+        return -1;
     }
-    // process zero first and will not fail
-    if (objReqs.find("zero") != objReqs.end()) {
-        for (const auto& req : objReqs["zero"]) {
-            readContent[req->reqIndex] = std::string(req->len, '\0');
+    auto release = absl::MakeCleanup([&]() {
+        if (opts_->budget != nullptr) {
+            opts_->budget->ReleaseMemory(memory);
+        }
+    });
+
+    const auto& blockSize = ctx.blockSize;
+    const auto& newOff = newChunkInfo->newOff;
+    const uint64_t end = newOff + *chunkLen;
+    const uint64_t offRoundDown = newOff / ctx.chunkSize * ctx.chunkSize;
+    uint64_t index = (newOff - offRoundDown) / blockSize;
+    uint64_t pos = newOff;
+    uint64_t blockEnd = std::min(end, offRoundDown + (index + 1) * blockSize);
+    std::string block;
+    block.reserve(blockEnd - pos);
+
+    auto writeBlock = [&]() {
+        std::string objName = curvefs::common::s3util::GenObjName(
+            newChunkInfo->newChunkId, index, newChunkInfo->newCompaction,
+            ctx.fsId, ctx.inodeId, ctx.objectPrefix);
+        VLOG(9) << "s3compact: put " << objName << ", [" << pos - block.size()
+                << "-" << pos - 1 << "]";
+        if (opts_->budget != nullptr) {
+            opts_->budget->ConsumeBandwidth(false, block.size());
         }
-        objReqs.erase("zero");
-    }
-    // read and process objs one by one
-    uint64_t retry = 0;
-    for (auto it = objReqs.begin(); it != objReqs.end(); it++) {
-        std::string buf;
-        const std::string& objName = it->first;
-        const auto& reqs = it->second;
         const Aws::String aws_key(objName.c_str(), objName.size());
-        const auto maxRetry = opts_->s3ReadMaxRetry;
-        const auto retryInterval = opts_->s3ReadRetryInterval;
-        while (retry <= maxRetry) {
-            // why we need retry
-            // if you enable client's diskcache,
-            // metadata may be newer than data in s3
-            // which means you cannot read data from s3
-            // we have to wait data to be flushed to s3
-            int ret = ctx.s3adapter->GetObject(aws_key, &buf);
-            if (ret != 0) {
-                LOG(WARNING)
-                    << "s3compact: get s3 obj " << objName << " failed";
-                if (retry == maxRetry) return -1;  // no chance
-                retry++;
-                LOG(WARNING) << "s3compact: will retry after " << retryInterval
-                             << " seconds, current retry time:" << retry;
-                std::this_thread::sleep_for(
-                    std::chrono::seconds(retryInterval));
-                continue;
+        int ret = ctx.s3adapter->PutObject(aws_key, block);
+        if (ret != 0) {
+            LOG(WARNING) << "s3compact: put s3 object " << objName
+                         << " failed";
+            return ret;
+        }
+        objsAdded->emplace_back(std::move(objName));
+        block.clear();
+        index++;
+        blockEnd = std::min(end, offRoundDown + (index + 1) * blockSize);
+        return 0;
+    };
+
+    // requests of different objects may interleave (A, B, A), objects which
+    // are referenced again are cached while there is spare memory budget,
+    // otherwise only the last read object is kept
+    std::unordered_map<std::string, size_t> lastUse;
+    for (size_t i = 0; i < s3reqs.size(); ++i) {
+        if (!s3reqs[i].zero) {
+            lastUse[s3reqs[i].objName] = i;
+        }
+    }
+
+    std::unordered_map<std::string, std::string> cached;
+    uint64_t cachedBytes = 0;
+    auto reserve = [&](uint64_t bytes) -> bool {
+        if (opts_->budget != nullptr) {
+            if (!opts_->budget->TryAcquireMemory(bytes)) {
+                return false;
             }
-            for (const auto& req : reqs) {
-                readContent[req->reqIndex] = buf.substr(req->off, req->len);
+        } else if (cachedBytes + bytes > ctx.chunkSize) {
+            return false;
+        }
+        cachedBytes += bytes;
+        return true;
+    };
+    auto unreserve = [&](uint64_t bytes) {
+        cachedBytes -= bytes;
+        if (opts_->budget != nullptr) {
+            opts_->budget->ReleaseMemory(bytes);
+        }
+    };
+    auto releaseCached = absl::MakeCleanup([&]() { unreserve(cachedBytes); });
+
+    std::string srcName;
+    std::string src;
+    for (size_t i = 0; i < s3reqs.size(); ++i) {
+        const auto& req = s3reqs[i];
+        const std::string* data = &src;
+        auto cachedIt = cached.end();
+        if (!req.zero) {
+            cachedIt = cached.find(req.objName);
+            if (cachedIt != cached.end()) {
+                data = &cachedIt->second;
+            } else if (req.objName != srcName) {
+                srcName.clear();
+                if (ReadObject(ctx, req.objName, &src) != 0) {
+                    return -1;
+                }
+                srcName = req.objName;
             }
-            break;
         }
-    }
+        if (!req.zero && data->size() < req.off + req.len) {
+            LOG(WARNING) << "s3compact: s3 obj " << req.objName
+                         << " is shorter than expected, size: "
+                         << data->size() << ", off: " << req.off
+                         << ", len: " << req.len;
+            return -1;
+        }
+
+        uint64_t copied = 0;
+        while (copied < req.len) {
+            uint64_t n = std::min(req.len - copied, blockEnd - pos);
+            if (req.zero) {
+                block.append(n, '\0');
+            } else {
+                block.append(*data, req.off + copied, n);
+            }
+            copied += n;
+            pos += n;
+            if (pos == blockEnd && writeBlock() != 0) {
+                return -1;
+            }
+        }
+
+        if (req.zero) {
+            continue;
+        }
 
-    // merge all read content
-    for (auto content : readContent) {
-        (*fullChunk) += std::move(content);
+        if (lastUse[req.objName] == i) {
+            if (cachedIt != cached.end()) {
+                unreserve(cachedIt->second.size());
+                cached.erase(cachedIt);
+            }
+        } else if (cachedIt == cached.end() && reserve(src.size())) {
+            cached.emplace(req.objName, std::move(src));
+            src.clear();
+            srcName.clear();
+        }
     }
 
     return 0;
@@ -337,41 +450,6 @@ MetaStatusCode CompactInodeJob::UpdateInode(
     return response.statuscode();
 }
 
-int CompactInodeJob::WriteFullChunk(
-    const struct S3CompactCtx& ctx, const struct S3NewChunkInfo& newChunkInfo,
-    const std::string& fullChunk, std::vector<std::string>* objsAdded) {
-    uint64_t chunkLen = fullChunk.length();
-    const auto& blockSize = ctx.blockSize;
-    const auto& chunkSize = ctx.chunkSize;
-    const auto& newOff = newChunkInfo.newOff;
-    uint64_t offRoundDown = newOff / chunkSize * chunkSize;
-    uint64_t startIndex = (newOff - newOff / chunkSize * chunkSize) / blockSize;
-    for (uint64_t index = startIndex;
-         index * blockSize + offRoundDown < newOff + chunkLen; index += 1) {
-        std::string objName = curvefs::common::s3util::GenObjName(
-            newChunkInfo.newChunkId, index, newChunkInfo.newCompaction,
-            ctx.fsId, ctx.inodeId, ctx.objectPrefix);
-        const Aws::String aws_key(objName.c_str(), objName.size());
-        int ret;
-        uint64_t s3objBegin =
-            std::max(newOff, offRoundDown + index * blockSize);
-        uint64_t s3objEnd = std::min(
-            newOff + chunkLen - 1, offRoundDown + (index + 1) * blockSize - 1);
-        VLOG(9) << "s3compact: put " << objName << ", [" << s3objBegin << "-"
-                << s3objEnd << "]";
-        ret = ctx.s3adapter->PutObject(
-            aws_key,
-            fullChunk.substr(s3objBegin - newOff, s3objEnd - s3objBegin + 1));
-        if (ret != 0) {
-            LOG(WARNING) << "s3compact: put s3 object " << objName << " failed";
-            return ret;
-        } else {
-            objsAdded->emplace_back(std::move(objName));
-        }
-    }
-    return 0;
-}
-
 bool CompactInodeJob::CompactPrecheck(const struct S3CompactTask& task,
                                              Inode* inode) {
     // am i copysetnode leader?
@@ -477,32 +555,24 @@ void CompactInodeJob::CompactChunk(
         s3ChunkInfoRemove->insert({index, s3chunkinfolist});
         return;
     }
-    // 1.2  first read full chunk
+    // 1.2 merge valid ranges into objs with newChunkid and newCompaction
     struct S3NewChunkInfo newChunkInfo;
-    std::string fullChunk;
-    int ret = ReadFullChunk(compactCtx, validList, &fullChunk, &newChunkInfo);
-    if (ret != 0) {
-        LOG(WARNING) << "s3compact: ReadFullChunk failed, index " << index;
-        opts_->s3infoCache->InvalidateS3Info(
-            compactCtx.fsId);  // maybe s3info changed?
-        return;
-    }
-    VLOG(6) << "s3compact: finish read full chunk, size: " << fullChunk.size();
-    VLOG(6) << "s3compact: new s3chunk info will be id:"
-            << newChunkInfo.newChunkId << ", off:" << newChunkInfo.newOff
-            << ", compaction:" << newChunkInfo.newCompaction;
-    // 1.3 then write objs with newChunkid and newCompaction
+    uint64_t chunkLen = 0;
     std::vector<std::string> objsAdded;
-    ret = WriteFullChunk(compactCtx, newChunkInfo, fullChunk, &objsAdded);
+    int ret = MergeChunk(compactCtx, validList, &newChunkInfo, &chunkLen,
+                         &objsAdded);
     if (ret != 0) {
-        LOG(WARNING) << "s3compact: WriteFullChunk failed, index " << index;
+        LOG(WARNING) << "s3compact: MergeChunk failed, index " << index;
         opts_->s3infoCache->InvalidateS3Info(
             compactCtx.fsId);  // maybe s3info changed?
         DeleteObjs(objsAdded, compactCtx.s3adapter);
         return;
     }
-    VLOG(6) << "s3compact: finish write full chunk";
-    // 1.4 record add/delete
+    VLOG(6) << "s3compact: finish merge chunk, size: " << chunkLen
+            << ", new s3chunk info id:" << newChunkInfo.newChunkId
+            << ", off:" << newChunkInfo.newOff
+            << ", compaction:" << newChunkInfo.newCompaction;
+    // 1.3 record add/delete
     objsAddedMap->emplace(index, std::move(objsAdded));
     // to add
     S3ChunkInfoList toAddList;
@@ -510,8 +580,8 @@ void CompactInodeJob::CompactChunk(
     toAdd.set_chunkid(newChunkInfo.newChunkId);
     toAdd.set_compaction(newChunkInfo.newCompaction);
     toAdd.set_offset(newChunkInfo.newOff);
-    toAdd.set_len(fullChunk.length());
-    toAdd.set_size(fullChunk.length());
+    toAdd.set_len(chunkLen);
+    toAdd.set_size(chunkLen);
     toAdd.set_zero(false);
     *toAddList.add_s3chunks() = std::move(toAdd);
     s3ChunkInfoAdd->insert({index, std::move(toAddList)});
@@ -182,18 +182,19 @@ class CompactInodeJob {
                            const std::list<struct Node>& validList,
                            std::vector<struct S3Request>* reqs,
                            struct S3NewChunkInfo* newChunkInfo);
-    int ReadFullChunk(const struct S3CompactCtx& ctx,
-                      const std::list<struct Node>& validList,
-                      std::string* fullChunk,
-                      struct S3NewChunkInfo* newChunkInfo);
+    int ReadObject(const struct S3CompactCtx& ctx, const std::string& objName,
+                   std::string* buf);
+    // Read valid ranges of a chunk and write them as new objects block by
+    // block, one source and one new block are kept in memory, and source
+    // objects referenced again are cached if the memory budget allows
+    int MergeChunk(const struct S3CompactCtx& ctx,
+                   const std::list<struct Node>& validList,
+                   struct S3NewChunkInfo* newChunkInfo, uint64_t* chunkLen,
+                   std::vector<std::string>* objsAdded);
     virtual MetaStatusCode UpdateInode(
         CopysetNode* copysetNode, const PartitionInfo& pinfo, uint64_t inodeId,
         ::google::protobuf::Map<uint64_t, S3ChunkInfoList>&& s3ChunkInfoAdd,
         ::google::protobuf::Map<uint64_t, S3ChunkInfoList>&& s3ChunkInfoRemove);
-    int WriteFullChunk(const struct S3CompactCtx& ctx,
-                       const struct S3NewChunkInfo& newChunkInfo,
-                       const std::string& fullChunk,
-                       std::vector<std::string>* objsAdded);
     void CompactChunk(
         const struct S3CompactCtx& compactCtx, uint64_t index,
         const Inode& inode,
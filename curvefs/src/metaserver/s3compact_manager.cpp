@@ -116,6 +116,9 @@ void S3CompactWorkQueueOption::Init(std::shared_ptr<Configuration> conf) {
     conf->GetValueFatalIfFail("s3compactwq.s3_read_max_retry", &s3ReadMaxRetry);
     conf->GetValueFatalIfFail("s3compactwq.s3_read_retry_interval",
                               &s3ReadRetryInterval);
+    conf->GetValueFatalIfFail("s3compactwq.max_memory_mb", &maxMemoryMB);
+    conf->GetValueFatalIfFail("s3compactwq.max_bandwidth_mb",
+                              &maxBandwidthMB);
 }
 
 void S3CompactManager::Init(std::shared_ptr<Configuration> conf) {
@@ -135,9 +138,13 @@ void S3CompactManager::Init(std::shared_ptr<Configuration> conf) {
         s3adapterManager_ =
             absl::make_unique<S3AdapterManager>(opts_.threadNum, opts_.s3opts);
         s3adapterManager_->Init();
+        budget_ = absl::make_unique<S3CompactBudget>(
+            opts_.maxMemoryMB * 1024 * 1024,
+            opts_.maxBandwidthMB * 1024 * 1024);
 
         workerOptions_.s3adapterManager = s3adapterManager_.get();
         workerOptions_.s3infoCache = s3infoCache_.get();
+        workerOptions_.budget = budget_.get();
         workerOptions_.maxChunksPerCompact = opts_.maxChunksPerCompact;
         workerOptions_.fragmentThreshold = opts_.fragmentThreshold;
         workerOptions_.s3ReadMaxRetry = opts_.s3ReadMaxRetry;
@@ -204,6 +211,7 @@ void S3CompactManager::Stop() {
     }
 
     workerContext_.cond.notify_all();
+    budget_->Stop();
     for (auto& worker : workers_) {
         worker->Stop();
     }
@@ -31,6 +31,7 @@
 
 #include "curvefs/proto/common.pb.h"
 #include "curvefs/src/metaserver/s3compact.h"
+#include "curvefs/src/metaserver/s3compact_budget.h"
 #include "curvefs/src/metaserver/s3infocache.h"
 #include "src/common/configuration.h"
 #include "src/common/interruptible_sleeper.h"
@@ -80,6 +81,9 @@ struct S3CompactWorkQueueOption {
     uint64_t s3infocacheSize;
     uint64_t s3ReadMaxRetry;
     uint64_t s3ReadRetryInterval;
+    // shared by all workers, 0 means unlimited
+    uint64_t maxMemoryMB;
+    uint64_t maxBandwidthMB;
 
     void Init(std::shared_ptr<Configuration> conf);
 };
@@ -89,6 +93,7 @@ class S3CompactManager {
     S3CompactWorkQueueOption opts_;
     std::unique_ptr<S3InfoCache> s3infoCache_;
     std::unique_ptr<S3AdapterManager> s3adapterManager_;
+    std::unique_ptr<S3CompactBudget> budget_;
 
     S3CompactWorkerContext workerContext_;
     S3CompactWorkerOptions workerOptions_;
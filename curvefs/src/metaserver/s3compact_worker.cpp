@@ -28,6 +28,7 @@
 #include <chrono>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 
 #include "absl/cleanup/cleanup.h"
@@ -120,7 +121,9 @@ bool S3CompactWorker::CompactInodes(const std::list<uint64_t>& inodes,
     const auto fsId = s3Compact_->partitionInfo.fsid();
     const auto pid = s3Compact_->partitionInfo.partitionid();
 
-    for (auto ino : inodes) {
+    std::list<uint64_t> ordered(inodes);
+    SortByFragmentation(&ordered);
+    for (auto ino : ordered) {
         if (!sleeper.wait_for(std::chrono::milliseconds(options_->sleepMS))) {
             return false;
         }
@@ -156,6 +159,20 @@ bool S3CompactWorker::CompactInodes(const std::list<uint64_t>& inodes,
     return true;
 }
 
+void S3CompactWorker::SortByFragmentation(std::list<uint64_t>* inodes) {
+    const auto fsId = s3Compact_->partitionInfo.fsid();
+    const auto& inodeManager = s3Compact_->inodeManager;
+    std::unordered_map<uint64_t, uint64_t> fragments;
+    fragments.reserve(inodes->size());
+    for (auto ino : *inodes) {
+        fragments[ino] = inodeManager->GetS3ChunkInfoCount(fsId, ino);
+    }
+
+    inodes->sort([&fragments](uint64_t lhs, uint64_t rhs) {
+        return fragments[lhs] > fragments[rhs];
+    });
+}
+
 void S3CompactWorker::CompactWorker() {
     common::SetThreadName("s3compact");
 
@@ -42,6 +42,7 @@ class CopysetNode;
 }  // namespace copyset
 
 class S3AdapterManager;
+class S3CompactBudget;
 class S3CompactManager;
 class S3CompactWorker;
 class S3InfoCache;
@@ -60,6 +61,8 @@ struct S3CompactWorkerContext {
 struct S3CompactWorkerOptions {
     S3AdapterManager* s3adapterManager;
     S3InfoCache* s3infoCache;
+    // shared by all workers, nullptr means unlimited
+    S3CompactBudget* budget = nullptr;
 
     uint64_t maxChunksPerCompact;
     uint64_t fragmentThreshold;
@@ -95,6 +98,10 @@ class S3CompactWorker {
     bool CompactInodes(const std::list<uint64_t>& inodes,
                        copyset::CopysetNode* node);
 
+    // Sort inodes by number of s3chunkinfo in descending order, so the
+    // most fragmented inodes are compacted first
+    void SortByFragmentation(std::list<uint64_t>* inodes);
+
     void CleanupCompact(bool again);
 
  private:
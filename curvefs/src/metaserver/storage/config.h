@@ -47,6 +47,10 @@ struct StorageOptions {
     // only memory storage interested the below config item
     bool compression;
 
+    // memory storage rebuilds a full base segment at checkpoint once
+    // this many delta segments are chained after the base
+    uint32_t maxDeltaSegments = 16;
+
     // only rocksdb storage interested the below config item
     uint64_t statsDumpPeriodSec;
 
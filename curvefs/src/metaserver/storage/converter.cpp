@@ -21,6 +21,7 @@
  */
 
 #include <inttypes.h>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include <cstring>
@@ -36,6 +37,9 @@
 #include "src/common/string_util.h"
 #include "curvefs/src/metaserver/storage/converter.h"
 
+DEFINE_bool(storage_binary_key, false,
+            "encode storage keys in binary instead of the legacy text format");
+
 namespace curvefs {
 namespace metaserver {
 namespace storage {
@@ -105,6 +109,111 @@ std::string NameGenerator::Format(KEY_TYPE type, uint32_t partitionId) {
         absl::string_view(buf, sizeof(buf)));
 }
 
+namespace {
+
+// Keys are encoded as: 1 byte key type followed by fixed-width big-endian
+// integers (and a variable-length tail for dentry name), so the byte-wise
+// order of keys is the same as the numeric order of their fields.
+class KeyEncoder {
+ public:
+    KeyEncoder(KEY_TYPE type, size_t length) {
+        buffer_.reserve(length);
+        buffer_.push_back(static_cast<char>(type));
+    }
+
+    KeyEncoder& PutFixed32(uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            buffer_.push_back(static_cast<char>((value >> shift) & 0xff));
+        }
+        return *this;
+    }
+
+    KeyEncoder& PutFixed64(uint64_t value) {
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            buffer_.push_back(static_cast<char>((value >> shift) & 0xff));
+        }
+        return *this;
+    }
+
+    KeyEncoder& PutBytes(const std::string& value) {
+        buffer_.append(value);
+        return *this;
+    }
+
+    std::string Finish() { return std::move(buffer_); }
+
+ private:
+    std::string buffer_;
+};
+
+class KeyDecoder {
+ public:
+    explicit KeyDecoder(const std::string& key)
+        : data_(reinterpret_cast<const unsigned char*>(key.data())),
+          left_(key.size()) {}
+
+    bool GetType(KEY_TYPE type) {
+        if (left_ < 1 || data_[0] != type) {
+            return false;
+        }
+        Advance(1);
+        return true;
+    }
+
+    bool GetFixed32(uint32_t* value) {
+        if (left_ < sizeof(uint32_t)) {
+            return false;
+        }
+        *value = 0;
+        for (size_t i = 0; i < sizeof(uint32_t); i++) {
+            *value = (*value << 8) | data_[i];
+        }
+        Advance(sizeof(uint32_t));
+        return true;
+    }
+
+    bool GetFixed64(uint64_t* value) {
+        if (left_ < sizeof(uint64_t)) {
+            return false;
+        }
+        *value = 0;
+        for (size_t i = 0; i < sizeof(uint64_t); i++) {
+            *value = (*value << 8) | data_[i];
+        }
+        Advance(sizeof(uint64_t));
+        return true;
+    }
+
+    void GetRemaining(std::string* value) {
+        value->assign(reinterpret_cast<const char*>(data_), left_);
+        Advance(left_);
+    }
+
+    bool Done() const { return left_ == 0; }
+
+ private:
+    void Advance(size_t n) {
+        data_ += n;
+        left_ -= n;
+    }
+
+ private:
+    const unsigned char* data_;
+    size_t left_;
+};
+
+constexpr size_t kTypeLength = 1;
+constexpr size_t kFsIdLength = sizeof(uint32_t);
+constexpr size_t kUint64Length = sizeof(uint64_t);
+constexpr size_t kInodeKeyLength = kTypeLength + kFsIdLength + kUint64Length;
+
+}  // namespace
+
+bool IsLegacyKey(const std::string& key) {
+    // legacy keys start with the key type in decimal text, e.g. "1:..."
+    return !key.empty() && key[0] >= '0' && key[0] <= '9';
+}
+
 Key4Inode::Key4Inode()
     : fsId(0), inodeId(0) {}
 
@@ -119,24 +228,46 @@ bool Key4Inode::operator==(const Key4Inode& rhs) {
 }
 
 std::string Key4Inode::SerializeToString() const {
-    return absl::StrCat(keyType_, ":", fsId, ":", inodeId);
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, ":", fsId, ":", inodeId);
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength)
+        .PutFixed32(fsId)
+        .PutFixed64(inodeId)
+        .Finish();
 }
 
 bool Key4Inode::ParseFromString(const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    return items.size() == 3 && CompareType(items[0], keyType_) &&
-        StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        return items.size() == 3 && CompareType(items[0], keyType_) &&
+            StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.GetFixed32(&fsId) &&
+           decoder.GetFixed64(&inodeId) && decoder.Done();
 }
 
 std::string Prefix4AllInode::SerializeToString() const {
-    return absl::StrCat(keyType_, ":");
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, ":");
+    }
+
+    return KeyEncoder(keyType_, kTypeLength).Finish();
 }
 
 bool Prefix4AllInode::ParseFromString(const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    return items.size() == 1 && CompareType(items[0], keyType_);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        return items.size() == 1 && CompareType(items[0], keyType_);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.Done();
 }
 
 const size_t Key4S3ChunkInfoList::kMaxUint64Length_ =
@@ -164,20 +295,41 @@ Key4S3ChunkInfoList::Key4S3ChunkInfoList(uint32_t fsId,
       size(size) {}
 
 std::string Key4S3ChunkInfoList::SerializeToString() const {
-    return absl::StrCat(keyType_, ":", fsId, ":", inodeId, ":",
-        chunkIndex, ":", absl::StrFormat("%020" PRIu64"", firstChunkId), ":",
-        absl::StrFormat("%020" PRIu64"", lastChunkId), ":", size);
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(
+            keyType_, ":", fsId, ":", inodeId, ":", chunkIndex, ":",
+            absl::StrFormat("%020" PRIu64"", firstChunkId), ":",
+            absl::StrFormat("%020" PRIu64"", lastChunkId), ":", size);
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength + 4 * kUint64Length)
+        .PutFixed32(fsId)
+        .PutFixed64(inodeId)
+        .PutFixed64(chunkIndex)
+        .PutFixed64(firstChunkId)
+        .PutFixed64(lastChunkId)
+        .PutFixed64(size)
+        .Finish();
 }
 
 bool Key4S3ChunkInfoList::ParseFromString(const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    return items.size() == 7 && CompareType(items[0], keyType_) &&
-        StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId) &&
-        StringToUll(items[3], &chunkIndex) &&
-        StringToUll(items[4], &firstChunkId) &&
-        StringToUll(items[5], &lastChunkId) &&
-        StringToUll(items[6], &size);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        return items.size() == 7 && CompareType(items[0], keyType_) &&
+            StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId) &&
+            StringToUll(items[3], &chunkIndex) &&
+            StringToUll(items[4], &firstChunkId) &&
+            StringToUll(items[5], &lastChunkId) &&
+            StringToUll(items[6], &size);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.GetFixed32(&fsId) &&
+           decoder.GetFixed64(&inodeId) && decoder.GetFixed64(&chunkIndex) &&
+           decoder.GetFixed64(&firstChunkId) &&
+           decoder.GetFixed64(&lastChunkId) && decoder.GetFixed64(&size) &&
+           decoder.Done();
 }
 
 Prefix4ChunkIndexS3ChunkInfoList::Prefix4ChunkIndexS3ChunkInfoList()
@@ -190,17 +342,32 @@ Prefix4ChunkIndexS3ChunkInfoList::Prefix4ChunkIndexS3ChunkInfoList(
     : fsId(fsId), inodeId(inodeId), chunkIndex(chunkIndex) {}
 
 std::string Prefix4ChunkIndexS3ChunkInfoList::SerializeToString() const {
-    return absl::StrCat(keyType_, ":", fsId, ":", inodeId, ":",
-        chunkIndex, ":");
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, ":", fsId, ":", inodeId, ":",
+            chunkIndex, ":");
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength + kUint64Length)
+        .PutFixed32(fsId)
+        .PutFixed64(inodeId)
+        .PutFixed64(chunkIndex)
+        .Finish();
 }
 
 bool Prefix4ChunkIndexS3ChunkInfoList::ParseFromString(
     const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    return items.size() == 4 && CompareType(items[0], keyType_) &&
-        StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId) &&
-        StringToUll(items[3], &chunkIndex);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        return items.size() == 4 && CompareType(items[0], keyType_) &&
+            StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId) &&
+            StringToUll(items[3], &chunkIndex);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.GetFixed32(&fsId) &&
+           decoder.GetFixed64(&inodeId) && decoder.GetFixed64(&chunkIndex) &&
+           decoder.Done();
 }
 
 Prefix4InodeS3ChunkInfoList::Prefix4InodeS3ChunkInfoList()
@@ -211,24 +378,46 @@ Prefix4InodeS3ChunkInfoList::Prefix4InodeS3ChunkInfoList(uint32_t fsId,
     : fsId(fsId), inodeId(inodeId) {}
 
 std::string Prefix4InodeS3ChunkInfoList::SerializeToString() const {
-    return absl::StrCat(keyType_, ":", fsId, ":", inodeId, ":");
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, ":", fsId, ":", inodeId, ":");
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength)
+        .PutFixed32(fsId)
+        .PutFixed64(inodeId)
+        .Finish();
 }
 
 bool Prefix4InodeS3ChunkInfoList::ParseFromString(const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    return items.size() == 3 && CompareType(items[0], keyType_) &&
-        StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        return items.size() == 3 && CompareType(items[0], keyType_) &&
+            StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.GetFixed32(&fsId) &&
+           decoder.GetFixed64(&inodeId) && decoder.Done();
 }
 
 std::string Prefix4AllS3ChunkInfoList::SerializeToString() const {
-    return absl::StrCat(kTypeS3ChunkInfo, ":");
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, ":");
+    }
+
+    return KeyEncoder(keyType_, kTypeLength).Finish();
 }
 
 bool Prefix4AllS3ChunkInfoList::ParseFromString(const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    return items.size() == 1 && CompareType(items[0], keyType_);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        return items.size() == 1 && CompareType(items[0], keyType_);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.Done();
 }
 
 Key4Dentry::Key4Dentry(uint32_t fsId,
@@ -237,29 +426,47 @@ Key4Dentry::Key4Dentry(uint32_t fsId,
     : fsId(fsId), parentInodeId(parentInodeId), name(name) {}
 
 std::string Key4Dentry::SerializeToString() const {
-    return absl::StrCat(keyType_, kDelimiter, fsId,
-                        kDelimiter, parentInodeId,
-                        kDelimiter, name);
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, kDelimiter, fsId,
+                            kDelimiter, parentInodeId,
+                            kDelimiter, name);
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength + name.size())
+        .PutFixed32(fsId)
+        .PutFixed64(parentInodeId)
+        .PutBytes(name)
+        .Finish();
 }
 
 bool Key4Dentry::ParseFromString(const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    if (items.size() < 3 ||
-        !CompareType(items[0], keyType_) ||
-        !StringToUl(items[1], &fsId) ||
-        !StringToUll(items[2], &parentInodeId)) {
-        return false;
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        if (items.size() < 3 ||
+            !CompareType(items[0], keyType_) ||
+            !StringToUl(items[1], &fsId) ||
+            !StringToUll(items[2], &parentInodeId)) {
+            return false;
+        }
+
+        size_t prefixLength = items[0].size() +
+                              items[1].size() +
+                              items[2].size() +
+                              3 * strlen(kDelimiter);
+        if (value.size() < prefixLength) {
+            return false;
+        }
+        name = value.substr(prefixLength);
+        return true;
     }
 
-    size_t prefixLength = items[0].size() +
-                          items[1].size() +
-                          items[2].size() +
-                          3 * strlen(kDelimiter);
-    if (value.size() < prefixLength) {
+    KeyDecoder decoder(value);
+    if (!decoder.GetType(keyType_) || !decoder.GetFixed32(&fsId) ||
+        !decoder.GetFixed64(&parentInodeId)) {
         return false;
     }
-    name = value.substr(prefixLength);
+    decoder.GetRemaining(&name);
     return true;
 }
 
@@ -268,26 +475,49 @@ Prefix4SameParentDentry::Prefix4SameParentDentry(uint32_t fsId,
     : fsId(fsId), parentInodeId(parentInodeId) {}
 
 std::string Prefix4SameParentDentry::SerializeToString() const {
-    return absl::StrCat(keyType_, kDelimiter, fsId,
-                        kDelimiter, parentInodeId,
-                        kDelimiter);
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, kDelimiter, fsId,
+                            kDelimiter, parentInodeId,
+                            kDelimiter);
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength)
+        .PutFixed32(fsId)
+        .PutFixed64(parentInodeId)
+        .Finish();
 }
 
 bool Prefix4SameParentDentry::ParseFromString(const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    return items.size() == 3 && CompareType(items[0], keyType_) &&
-           StringToUl(items[1], &fsId) && StringToUll(items[2], &parentInodeId);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        return items.size() == 3 && CompareType(items[0], keyType_) &&
+               StringToUl(items[1], &fsId) &&
+               StringToUll(items[2], &parentInodeId);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.GetFixed32(&fsId) &&
+           decoder.GetFixed64(&parentInodeId) && decoder.Done();
 }
 
 std::string Prefix4AllDentry::SerializeToString() const {
-    return absl::StrCat(keyType_, ":");
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, ":");
+    }
+
+    return KeyEncoder(keyType_, kTypeLength).Finish();
 }
 
 bool Prefix4AllDentry::ParseFromString(const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    return items.size() == 1 && CompareType(items[0], keyType_);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        return items.size() == 1 && CompareType(items[0], keyType_);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.Done();
 }
 
 Key4VolumeExtentSlice::Key4VolumeExtentSlice(uint32_t fsId,
@@ -296,19 +526,32 @@ Key4VolumeExtentSlice::Key4VolumeExtentSlice(uint32_t fsId,
     : fsId_(fsId), inodeId_(inodeId), offset_(offset) {}
 
 std::string Key4VolumeExtentSlice::SerializeToString() const {
-    return absl::StrCat(keyType_, kDelimiter, fsId_, kDelimiter, inodeId_,
-                        kDelimiter, offset_);
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, kDelimiter, fsId_, kDelimiter,
+                            inodeId_, kDelimiter, offset_);
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength + kUint64Length)
+        .PutFixed32(fsId_)
+        .PutFixed64(inodeId_)
+        .PutFixed64(offset_)
+        .Finish();
 }
 
 bool Key4VolumeExtentSlice::ParseFromString(const std::string& value) {
-    // TODO(wuhanqing): reduce unnecessary creation of temporary strings,
-    //                  but, currently, `absl::from_chars` only support floating
-    //                  point
-    std::vector<std::string> items;
-    SplitString(value, kDelimiter, &items);
-    return items.size() == 4 && CompareType(items[0], keyType_) &&
-           StringToUl(items[1], &fsId_) && StringToUll(items[2], &inodeId_) &&
-           StringToUll(items[3], &offset_);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, kDelimiter, &items);
+        return items.size() == 4 && CompareType(items[0], keyType_) &&
+               StringToUl(items[1], &fsId_) &&
+               StringToUll(items[2], &inodeId_) &&
+               StringToUll(items[3], &offset_);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.GetFixed32(&fsId_) &&
+           decoder.GetFixed64(&inodeId_) && decoder.GetFixed64(&offset_) &&
+           decoder.Done();
 }
 
 Prefix4InodeVolumeExtent::Prefix4InodeVolumeExtent(uint32_t fsId,
@@ -316,25 +559,47 @@ Prefix4InodeVolumeExtent::Prefix4InodeVolumeExtent(uint32_t fsId,
     : fsId_(fsId), inodeId_(inodeId) {}
 
 std::string Prefix4InodeVolumeExtent::SerializeToString() const {
-    return absl::StrCat(keyType_, kDelimiter, fsId_, kDelimiter, inodeId_,
-                        kDelimiter);
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, kDelimiter, fsId_, kDelimiter,
+                            inodeId_, kDelimiter);
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength)
+        .PutFixed32(fsId_)
+        .PutFixed64(inodeId_)
+        .Finish();
 }
 
 bool Prefix4InodeVolumeExtent::ParseFromString(const std::string &value) {
-    std::vector<std::string> items;
-    SplitString(value, kDelimiter, &items);
-    return items.size() == 3 && CompareType(items[0], keyType_) &&
-           StringToUl(items[1], &fsId_) && StringToUll(items[2], &inodeId_);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, kDelimiter, &items);
+        return items.size() == 3 && CompareType(items[0], keyType_) &&
+               StringToUl(items[1], &fsId_) && StringToUll(items[2], &inodeId_);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.GetFixed32(&fsId_) &&
+           decoder.GetFixed64(&inodeId_) && decoder.Done();
 }
 
 std::string Prefix4AllVolumeExtent::SerializeToString() const {
-    return absl::StrCat(keyType_, kDelimiter);
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, kDelimiter);
+    }
+
+    return KeyEncoder(keyType_, kTypeLength).Finish();
 }
 
 bool Prefix4AllVolumeExtent::ParseFromString(const std::string &value) {
-    std::vector<std::string> items;
-    SplitString(value, kDelimiter, &items);
-    return items.size() == 1 && CompareType(items[0], keyType_);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, kDelimiter, &items);
+        return items.size() == 1 && CompareType(items[0], keyType_);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.Done();
 }
 
 Key4InodeAuxInfo::Key4InodeAuxInfo(uint32_t fsId,
@@ -342,36 +607,73 @@ Key4InodeAuxInfo::Key4InodeAuxInfo(uint32_t fsId,
     : fsId(fsId), inodeId(inodeId) {}
 
 std::string Key4InodeAuxInfo::SerializeToString() const {
-    return absl::StrCat(keyType_, kDelimiter, fsId, kDelimiter, inodeId);
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, kDelimiter, fsId, kDelimiter, inodeId);
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength)
+        .PutFixed32(fsId)
+        .PutFixed64(inodeId)
+        .Finish();
 }
 
 bool Key4InodeAuxInfo::ParseFromString(const std::string& value) {
-    std::vector<std::string> items;
-    SplitString(value, kDelimiter, &items);
-    return items.size() == 3 && CompareType(items[0], keyType_) &&
-           StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, kDelimiter, &items);
+        return items.size() == 3 && CompareType(items[0], keyType_) &&
+               StringToUl(items[1], &fsId) && StringToUll(items[2], &inodeId);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.GetFixed32(&fsId) &&
+           decoder.GetFixed64(&inodeId) && decoder.Done();
 }
 
 std::string Key4DeallocatableBlockGroup::SerializeToString() const {
-    return absl::StrCat(keyType_, kDelimiter, fsId, kDelimiter, volumeOffset);
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, kDelimiter, fsId, kDelimiter,
+                            volumeOffset);
+    }
+
+    return KeyEncoder(keyType_, kInodeKeyLength)
+        .PutFixed32(fsId)
+        .PutFixed64(volumeOffset)
+        .Finish();
 }
 
 bool Key4DeallocatableBlockGroup::ParseFromString(const std::string &value) {
-    std::vector<std::string> items;
-    SplitString(value, kDelimiter, &items);
-    return items.size() == 3 && CompareType(items[0], keyType_) &&
-           StringToUl(items[1], &fsId) && StringToUll(items[2], &volumeOffset);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, kDelimiter, &items);
+        return items.size() == 3 && CompareType(items[0], keyType_) &&
+               StringToUl(items[1], &fsId) &&
+               StringToUll(items[2], &volumeOffset);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.GetFixed32(&fsId) &&
+           decoder.GetFixed64(&volumeOffset) && decoder.Done();
 }
 
 std::string Prefix4AllDeallocatableBlockGroup::SerializeToString() const {
-    return absl::StrCat(keyType_, ":");
+    if (!FLAGS_storage_binary_key) {
+        return absl::StrCat(keyType_, ":");
+    }
+
+    return KeyEncoder(keyType_, kTypeLength).Finish();
 }
 
 bool Prefix4AllDeallocatableBlockGroup::ParseFromString(
     const std::string &value) {
-    std::vector<std::string> items;
-    SplitString(value, ":", &items);
-    return items.size() == 1 && CompareType(items[0], keyType_);
+    if (IsLegacyKey(value)) {
+        std::vector<std::string> items;
+        SplitString(value, ":", &items);
+        return items.size() == 1 && CompareType(items[0], keyType_);
+    }
+
+    KeyDecoder decoder(value);
+    return decoder.GetType(keyType_) && decoder.Done();
 }
 
 std::string Converter::SerializeToString(const StorageKey& key) {
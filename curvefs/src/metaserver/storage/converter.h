@@ -24,12 +24,15 @@
 #define CURVEFS_SRC_METASERVER_STORAGE_CONVERTER_H_
 
 
+#include <gflags/gflags.h>
 #include <google/protobuf/message.h>
 #include <string>
 #include <type_traits>
 
 #include "curvefs/src/metaserver/storage/common.h"
 
+DECLARE_bool(storage_binary_key);
+
 namespace curvefs {
 namespace metaserver {
 
@@ -95,23 +98,41 @@ class StorageKey {
 };
 
 /* rules for key serialization:
- *   Key4Inode                        : kTypeInode:fsId:inodeId
- *   Prefix4AllInode                  : kTypeInode:
- *   Key4S3ChunkInfoList              : kTypeS3ChunkInfo:fsId:inodeId:chunkIndex:firstChunkId:lastChunkId  // NOLINT
- *   Prefix4ChunkIndexS3ChunkInfoList : kTypeS3ChunkInfo:fsId:inodeId:chunkIndex:  // NOLINT
- *   Prefix4InodeS3ChunkInfoList      : kTypeS3ChunkInfo:fsId:inodeId:
- *   Prefix4AllS3ChunkInfoList        : kTypeS3ChunkInfo:
- *   Key4Dentry                       : kTypeDentry:parentInodeId:name
- *   Prefix4SameParentDentry          : kTypeDentry:parentInodeId:
- *   Prefix4AllDentry                 : kTypeDentry:
- *   Key4VolumeExtentSlice            : kTypeExtent:fsId:inodeId:sliceOffset
- *   Prefix4InodeVolumeExtent         : kTypeExtent:fsId:inodeId:
- *   Prefix4AllVolumeExtent           : kTypeExtent:
- *   Key4InodeAuxInfo                 : kTypeInodeAuxInfo:fsId:inodeId
- *   Key4DeallocatableBlockGroup      : kTypeBlockGroup:fsId:volumeOffset
- *   Prefix4AllDeallocatableBlockGroup: kTypeBlockGroup:
+ *   Key4Inode                        : kTypeInode fsId inodeId
+ *   Prefix4AllInode                  : kTypeInode
+ *   Key4S3ChunkInfoList              : kTypeS3ChunkInfo fsId inodeId chunkIndex firstChunkId lastChunkId size  // NOLINT
+ *   Prefix4ChunkIndexS3ChunkInfoList : kTypeS3ChunkInfo fsId inodeId chunkIndex  // NOLINT
+ *   Prefix4InodeS3ChunkInfoList      : kTypeS3ChunkInfo fsId inodeId
+ *   Prefix4AllS3ChunkInfoList        : kTypeS3ChunkInfo
+ *   Key4Dentry                       : kTypeDentry fsId parentInodeId name
+ *   Prefix4SameParentDentry          : kTypeDentry fsId parentInodeId
+ *   Prefix4AllDentry                 : kTypeDentry
+ *   Key4VolumeExtentSlice            : kTypeExtent fsId inodeId sliceOffset
+ *   Prefix4InodeVolumeExtent         : kTypeExtent fsId inodeId
+ *   Prefix4AllVolumeExtent           : kTypeExtent
+ *   Key4InodeAuxInfo                 : kTypeInodeAuxInfo fsId inodeId
+ *   Key4DeallocatableBlockGroup      : kTypeBlockGroup fsId volumeOffset
+ *   Prefix4AllDeallocatableBlockGroup: kTypeBlockGroup
+ *
+ * key type is one byte, fsId is 4 bytes and other integers are 8 bytes,
+ * all integers are encoded in big-endian, so the keys sort in the same
+ * order as their fields for range scans.
+ *
+ * The binary encoding is only used when FLAGS_storage_binary_key is set,
+ * otherwise keys are encoded in the legacy format, which is decimal text
+ * joined by ':', e.g. "1:fsId:inodeId". ParseFromString() accepts both
+ * encodings, so that keys can be migrated from one to the other,
+ * see IsLegacyKey() and MigrateKeys().
  */
 
+// Whether the key is encoded in the legacy text format
+bool IsLegacyKey(const std::string& key);
+
+// Whether the key is encoded as FLAGS_storage_binary_key selects
+inline bool IsCurrentEncodingKey(const std::string& key) {
+    return IsLegacyKey(key) != FLAGS_storage_binary_key;
+}
+
 class Key4Inode : public StorageKey {
  public:
     Key4Inode();
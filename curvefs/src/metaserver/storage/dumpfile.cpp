@@ -37,6 +37,7 @@
 #include "src/fs/ext4_filesystem_impl.h"
 #include "curvefs/src/common/process.h"
 #include "curvefs/src/metaserver/storage/iterator.h"
+#include "curvefs/src/metaserver/storage/converter.h"
 #include "curvefs/src/metaserver/storage/dumpfile.h"
 
 namespace curvefs {
@@ -67,7 +68,10 @@ using ::curve::common::CRC32;
 
 const std::string DumpFile::kCurvefs_ = "CURVEFS";  // NOLINT
 const uint32_t DumpFile::kEOF_ = 0;
-const uint8_t DumpFile::kVersion_ = kDumpFileV3;
+// the highest version can be loaded, files are saved in kDumpFileV4 only
+// when storage keys are encoded in binary, because older metaservers can't
+// load it
+const uint8_t DumpFile::kVersion_ = kDumpFileV4;
 
 const uint32_t DumpFile::kMaxStringLength_ = 1024 * 1024 * 1024;  // 1GB
 
@@ -130,7 +134,7 @@ DumpFile::DumpFile(const std::string& pathname)
       fd_(-1),
       fs_(Ext4FileSystemImpl::getInstance()),
       loadStatus_(DUMPFILE_LOAD_STATUS::INCOMPLETE),
-      version_(kVersion_) {}
+      version_(FLAGS_storage_binary_key ? kDumpFileV4 : kDumpFileV3) {}
 
 DumpFile::DumpFile(const std::string& pathname, uint8_t version)
     : pathname_(pathname),
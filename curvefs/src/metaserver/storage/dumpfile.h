@@ -87,6 +87,11 @@ enum DumpFileVersion : uint8_t {
     // kDumpFileV2 (because they're not inserted into rocksdb), other metadata
     // is saved by rocksdb
     kDumpFileV3 = 3,
+    // Version 4 is the same as kDumpFileV3, but storage keys in rocksdb are
+    // encoded in fixed-width big-endian binary instead of decimal text,
+    // it's only saved when `storage_binary_key` is enabled, and keys are
+    // migrated after recover if the snapshot was saved in the other encoding
+    kDumpFileV4 = 4,
 };
 
 std::ostream& operator<<(std::ostream& os, DUMPFILE_ERROR code);
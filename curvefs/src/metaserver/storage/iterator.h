@@ -94,6 +94,14 @@ class MergeIterator : public Iterator {
 
     std::string Value() override { return current_->Value(); }
 
+    const ValueType *RawValue() const override {
+        return current_->RawValue();
+    }
+
+    bool ParseFromValue(ValueType *value) override {
+        return current_->ParseFromValue(value);
+    }
+
     int Status() override {
         for (const auto &child : children_) {
             if (child->Status() != 0) {
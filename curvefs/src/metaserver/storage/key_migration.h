@@ -0,0 +1,154 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: Curve
+ * Created Date: 2022-11-08
+ */
+
+#ifndef CURVEFS_SRC_METASERVER_STORAGE_KEY_MIGRATION_H_
+#define CURVEFS_SRC_METASERVER_STORAGE_KEY_MIGRATION_H_
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/escaping.h"
+#include "curvefs/src/metaserver/storage/converter.h"
+#include "curvefs/src/metaserver/storage/status.h"
+#include "curvefs/src/metaserver/storage/storage.h"
+
+namespace curvefs {
+namespace metaserver {
+namespace storage {
+
+namespace internal {
+
+inline Status MigrateGet(StorageTransaction* txn, bool ordered,
+                         const std::string& name, const std::string& key,
+                         ValueType* value) {
+    return ordered ? txn->SGet(name, key, value) : txn->HGet(name, key, value);
+}
+
+inline Status MigrateSet(StorageTransaction* txn, bool ordered,
+                         const std::string& name, const std::string& key,
+                         const ValueType& value) {
+    return ordered ? txn->SSet(name, key, value) : txn->HSet(name, key, value);
+}
+
+inline Status MigrateDel(StorageTransaction* txn, bool ordered,
+                         const std::string& name, const std::string& key) {
+    return ordered ? txn->SDel(name, key) : txn->HDel(name, key);
+}
+
+inline Status CommitOrRollback(StorageTransaction* txn, Status s) {
+    if (!s.ok()) {
+        txn->Rollback();
+        return s;
+    }
+    return txn->Commit();
+}
+
+}  // namespace internal
+
+// Rewrite all keys of table |name| which are not in the encoding selected by
+// FLAGS_storage_binary_key, values are left untouched. Keys are rewritten in
+// batches of |batchSize| per transaction, and the migration is idempotent,
+// so it can simply be redone if it was interrupted.
+//
+// Keys to rewrite are collected before any write, because iterators of
+// memory storage walk the live container.
+template <typename KeyType, typename EntryType>
+Status MigrateKeys(KVStorage* storage, const std::string& name,
+                   bool ordered, uint64_t* migrated,
+                   uint32_t batchSize = 1024) {
+    *migrated = 0;
+    std::vector<std::pair<std::string, std::string>> keys;
+    {
+        auto iterator =
+            ordered ? storage->SGetAll(name) : storage->HGetAll(name);
+        if (iterator->Status() != 0) {
+            return Status::InternalError();
+        }
+
+        for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+            std::string skey = iterator->Key();
+            if (IsCurrentEncodingKey(skey)) {
+                continue;
+            }
+
+            KeyType key;
+            if (!key.ParseFromString(skey)) {
+                LOG(ERROR) << "Parse key failed, table = "
+                           << absl::BytesToHexString(name)
+                           << ", key = " << absl::BytesToHexString(skey);
+                return Status::ParsedFailed();
+            }
+            keys.emplace_back(std::move(skey), key.SerializeToString());
+        }
+
+        if (iterator->Status() != 0) {
+            return Status::InternalError();
+        }
+    }
+
+    for (size_t i = 0; i < keys.size(); i += batchSize) {
+        auto txn = storage->BeginTransaction();
+        if (nullptr == txn) {
+            return Status::InternalError();
+        }
+
+        Status s;
+        size_t end = std::min(keys.size(), i + batchSize);
+        for (size_t j = i; s.ok() && j < end; j++) {
+            EntryType entry;
+            s = internal::MigrateGet(txn.get(), ordered, name, keys[j].first,
+                                     &entry);
+            if (s.ok()) {
+                s = internal::MigrateSet(txn.get(), ordered, name,
+                                         keys[j].second, entry);
+            }
+            if (s.ok()) {
+                s = internal::MigrateDel(txn.get(), ordered, name,
+                                         keys[j].first);
+            }
+            if (!s.ok()) {
+                LOG(ERROR) << "Migrate key failed, table = "
+                           << absl::BytesToHexString(name) << ", key = "
+                           << absl::BytesToHexString(keys[j].first)
+                           << ", status = " << s.ToString();
+            }
+        }
+
+        s = internal::CommitOrRollback(txn.get(), s);
+        if (!s.ok()) {
+            return s;
+        }
+        *migrated += end - i;
+    }
+
+    return Status::OK();
+}
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_METASERVER_STORAGE_KEY_MIGRATION_H_
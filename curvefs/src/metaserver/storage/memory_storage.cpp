@@ -20,11 +20,28 @@
  * Author: Jingli Chen (Wine93)
  */
 
+#include <fcntl.h>
 #include <glog/logging.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
 #include <string>
 #include <memory>
 
+#include "absl/cleanup/cleanup.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "src/fs/ext4_filesystem_impl.h"
+#include "curvefs/src/metaserver/storage/dumpfile.h"
 #include "curvefs/src/metaserver/storage/utils.h"
 #include "curvefs/src/metaserver/storage/memory_storage.h"
 
@@ -42,9 +59,350 @@ using OrderedContainerType =
     MemoryStorage::OrderedContainerType;
 using OrderedSeralizedContainerType =
     MemoryStorage::OrderedSeralizedContainerType;
+using ::curve::common::StringToUll;
+using ::curve::fs::Ext4FileSystemImpl;
+
+namespace {
+
+const char* const kMemoryCheckpointPath = "memory_checkpoint";
+const char* const kBaseSegmentPrefix = "base_";
+const char* const kDeltaSegmentPrefix = "delta_";
+
+enum RecordOp : char {
+    kRecordSet = 's',
+    kRecordDel = 'd',
+    kRecordClear = 'c',
+};
+
+struct Record {
+    char op;
+    bool ordered;
+    std::string name;
+    std::string type;  // message type of value, empty if compressed
+    std::string key;
+    std::string value;
+};
+
+/*
+ * segment record format:
+ *
+ *   key:
+ *   +------+-------------+------+-------------+------+-----+
+ *   | kind | name_length | name | type_length | type | key |
+ *   +------+-------------+------+-------------+------+-----+
+ *      kind:    's' (ordered table) or 'h' (unordered table)
+ *      *length: decimal text followed by ':'
+ *
+ *   value:
+ *   +----+------------------+
+ *   | op | serialized value |
+ *   +----+------------------+
+ *      op: 's' (set), 'd' (delete) or 'c' (clear table), only set record
+ *          carries the serialized value
+ *
+ * neither key nor value is empty, which is the EOF of dumpfile
+ */
+std::string EncodeRecordKey(bool ordered, const std::string& name,
+                            const std::string& type, const std::string& key) {
+    return absl::StrCat(ordered ? "s" : "h", name.size(), ":", name,
+                        type.size(), ":", type, key);
+}
+
+std::string EncodeRecordValue(char op, const std::string& value = "") {
+    return absl::StrCat(std::string(1, op), value);
+}
+
+bool DecodeLengthPrefixed(const std::string& in, size_t* pos,
+                          std::string* out) {
+    auto sep = in.find(':', *pos);
+    uint64_t length = 0;
+    if (sep == std::string::npos ||
+        !StringToUll(in.substr(*pos, sep - *pos), &length) ||
+        length > in.size() - sep - 1) {
+        return false;
+    }
+    *out = in.substr(sep + 1, length);
+    *pos = sep + 1 + length;
+    return true;
+}
+
+bool DecodeRecord(const std::string& rkey, const std::string& rvalue,
+                  Record* record) {
+    if (rkey.empty() || rvalue.empty()) {
+        return false;
+    }
+
+    size_t pos = 1;
+    record->ordered = (rkey[0] == 's');
+    if (!DecodeLengthPrefixed(rkey, &pos, &record->name) ||
+        !DecodeLengthPrefixed(rkey, &pos, &record->type)) {
+        return false;
+    }
+    record->key = rkey.substr(pos);
+    record->op = rvalue[0];
+    record->value = rvalue.substr(1);
+    return true;
+}
+
+std::string SegmentName(const char* prefix, uint64_t seq) {
+    std::ostringstream oss;
+    oss << prefix << std::setw(20) << std::setfill('0') << seq;
+    return oss.str();
+}
+
+bool ParseSegmentName(const std::string& name, bool* isBase, uint64_t* seq) {
+    const std::string base(kBaseSegmentPrefix);
+    const std::string delta(kDeltaSegmentPrefix);
+    if (StringStartWith(name, base)) {
+        *isBase = true;
+        return StringToUll(name.substr(base.size()), seq);
+    } else if (StringStartWith(name, delta)) {
+        *isBase = false;
+        return StringToUll(name.substr(delta.size()), seq);
+    }
+    return false;
+}
+
+bool EncodeValue(const ValueWrapper& wrapper, std::string* type,
+                 std::string* value) {
+    *type = wrapper.Message()->GetTypeName();
+    return wrapper.Message()->SerializeToString(value);
+}
+
+bool EncodeValue(const ArenaValue& svalue, std::string* type,
+                 std::string* value) {
+    type->clear();
+    value->assign(svalue.Data(), svalue.Size());
+    return true;
+}
+
+// Table names usually end with a binary partition id, such names are hex
+// encoded in metric names
+std::string TableMetricPrefix(const std::string& name) {
+    const bool printable =
+        std::all_of(name.begin(), name.end(), [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+        });
+    return absl::StrCat("metaserver_memory_storage_table_",
+                        printable ? name : absl::BytesToHexString(name));
+}
+
+void ExposeTableMetric(const std::string& name, ArenaHolder* container) {
+    container->ExposeMetric(TableMetricPrefix(name));
+}
+
+void ExposeTableMetric(const std::string& /*name*/, void* /*container*/) {}
+
+// Tables with compression own an arena, ordinary tables don't
+SlabArena* ContainerArena(ArenaHolder* container) {
+    return container->Arena();
+}
+
+SlabArena* ContainerArena(void* /*container*/) {
+    return nullptr;
+}
+
+bool DecodeValue(const std::string& type, const std::string& rvalue,
+                 SlabArena* /*arena*/, ValueWrapper* wrapper) {
+    const auto* descriptor =
+        google::protobuf::DescriptorPool::generated_pool()
+            ->FindMessageTypeByName(type);
+    if (nullptr == descriptor) {
+        return false;
+    }
+
+    const auto* prototype =
+        google::protobuf::MessageFactory::generated_factory()->GetPrototype(
+            descriptor);
+    if (nullptr == prototype) {
+        return false;
+    }
+
+    std::unique_ptr<ValueType> message(prototype->New());
+    if (!message->ParseFromString(rvalue)) {
+        return false;
+    }
+    ValueWrapper(std::move(message)).Swap(*wrapper);
+    return true;
+}
+
+bool DecodeValue(const std::string& /*type*/, const std::string& rvalue,
+                 SlabArena* arena, ArenaValue* svalue) {
+    ArenaValue(arena, rvalue).Swap(*svalue);
+    return true;
+}
+
+template <typename ContainerType>
+Status LookupInContainer(const std::shared_ptr<ContainerType>& container,
+                         const std::string& key, std::string* type,
+                         std::string* value) {
+    auto iter = container->find(key);
+    if (iter == container->end()) {
+        return Status::NotFound();
+    }
+    if (!EncodeValue(iter->second, type, value)) {
+        return Status::SerializedFailed();
+    }
+    return Status::OK();
+}
+
+template <typename ContainerType>
+Status ApplyToContainer(const std::shared_ptr<ContainerType>& container,
+                        const Record& record) {
+    switch (record.op) {
+        case kRecordSet: {
+            typename ContainerType::mapped_type value;
+            if (!DecodeValue(record.type, record.value,
+                             ContainerArena(container.get()), &value)) {
+                return Status::ParsedFailed();
+            }
+            using std::swap;
+            swap((*container)[record.key], value);
+            return Status::OK();
+        }
+        case kRecordDel:
+            container->erase(record.key);
+            return Status::OK();
+        case kRecordClear:
+            container->clear();
+            return Status::OK();
+        default:
+            return Status::ParsedFailed();
+    }
+}
+
+// Traverse a table, its keys are encoded as set records
+class TableRecordIterator : public Iterator {
+ public:
+    TableRecordIterator(const std::string& name, bool ordered,
+                        std::shared_ptr<Iterator> iterator)
+        : name_(name), ordered_(ordered), iterator_(std::move(iterator)) {}
+
+    uint64_t Size() override { return iterator_->Size(); }
+
+    bool Valid() override { return iterator_->Valid(); }
+
+    void SeekToFirst() override { iterator_->SeekToFirst(); }
+
+    void Next() override { iterator_->Next(); }
+
+    std::string Key() override {
+        const ValueType* message = iterator_->RawValue();
+        return EncodeRecordKey(
+            ordered_, name_, message == nullptr ? "" : message->GetTypeName(),
+            iterator_->Key());
+    }
+
+    std::string Value() override {
+        return EncodeRecordValue(kRecordSet, iterator_->Value());
+    }
+
+    int Status() override { return iterator_->Status(); }
+
+ private:
+    std::string name_;
+    bool ordered_;
+    std::shared_ptr<Iterator> iterator_;
+};
+
+template <template <typename> class IteratorType, typename DictType>
+void AppendTableIterators(const DictType& dict, bool ordered,
+                          MergeIterator::ChildrenType* children) {
+    using ContainerType = typename DictType::mapped_type::element_type;
+    for (const auto& item : dict) {
+        auto iterator =
+            std::make_shared<IteratorType<ContainerType>>(item.second, "");
+        children->push_back(std::make_shared<TableRecordIterator>(
+            item.first, ordered, std::move(iterator)));
+    }
+}
+
+bool SaveSegment(const std::string& pathname,
+                 std::shared_ptr<Iterator> iterator) {
+    DumpFile dumpfile(pathname);
+    if (dumpfile.Open() != DUMPFILE_ERROR::OK) {
+        LOG(ERROR) << "Open segment file failed, path: " << pathname;
+        return false;
+    }
+
+    auto defer = absl::MakeCleanup([&dumpfile]() { dumpfile.Close(); });
+    auto rc = dumpfile.Save(iterator);
+    if (rc != DUMPFILE_ERROR::OK || iterator->Status() != 0) {
+        LOG(ERROR) << "Save segment file failed, path: " << pathname
+                   << ", retCode = " << rc;
+        return false;
+    }
+    return true;
+}
+
+// Save segment by a forked process, |child| is run once it's forked
+bool SaveSegmentBackground(const std::string& pathname,
+                           std::shared_ptr<Iterator> iterator,
+                           DumpFileClosure* child) {
+    DumpFile dumpfile(pathname);
+    if (dumpfile.Open() != DUMPFILE_ERROR::OK) {
+        LOG(ERROR) << "Open segment file failed, path: " << pathname;
+        child->Runned();
+        return false;
+    }
+
+    auto defer = absl::MakeCleanup([&dumpfile]() { dumpfile.Close(); });
+    auto rc = dumpfile.SaveBackground(iterator, child);
+    if (rc != DUMPFILE_ERROR::OK) {
+        LOG(ERROR) << "Save segment file in background failed, path: "
+                   << pathname << ", retCode = " << rc;
+        return false;
+    }
+    return true;
+}
+
+bool CopySegment(const std::string& src, const std::string& dst) {
+    const int kBufferSize = 1024 * 1024;
+    auto fs = Ext4FileSystemImpl::getInstance();
+    int in = fs->Open(src, O_RDONLY);
+    if (in < 0) {
+        return false;
+    }
+    auto closeIn = absl::MakeCleanup([&fs, in]() { fs->Close(in); });
+
+    struct stat info;
+    if (fs->Fstat(in, &info) != 0) {
+        return false;
+    }
+
+    int out = fs->Open(dst, O_WRONLY | O_CREAT | O_TRUNC);
+    if (out < 0) {
+        return false;
+    }
+    auto closeOut = absl::MakeCleanup([&fs, out]() { fs->Close(out); });
+
+    std::unique_ptr<char[]> buffer(new char[kBufferSize]);
+    uint64_t offset = 0;
+    const uint64_t size = info.st_size;
+    while (offset < size) {
+        int length = static_cast<int>(
+            std::min<uint64_t>(kBufferSize, size - offset));
+        if (fs->Read(in, buffer.get(), offset, length) != length ||
+            fs->Write(out, buffer.get(), offset, length) != length) {
+            return false;
+        }
+        offset += length;
+    }
+    return fs->Fsync(out) == 0;
+}
+
+}  // namespace
 
 MemoryStorage::MemoryStorage(StorageOptions options)
-    : options_(options) {}
+    : options_(options),
+      tracking_(false),
+      nextSegmentSeq_(0),
+      baseRecords_(0),
+      deltaRecords_(0) {}
+
+MemoryStorage::~MemoryStorage() {
+    WaitCheckpointDone();
+}
 
 STORAGE_TYPE MemoryStorage::Type() {
     return STORAGE_TYPE::MEMORY_STORAGE;
@@ -76,6 +434,7 @@ bool MemoryStorage::Close() {
             return iter->second;                                        \
         }                                                               \
         auto ret = dict->emplace(NAME, std::make_shared<TYPE##Type>()); \
+        ExposeTableMetric(NAME, ret.first->second.get());               \
         return ret.first->second;                                       \
     }                                                                   \
 }()
@@ -101,7 +460,9 @@ do {                                             \
         return Status::NotFound();               \
     }                                            \
                                                  \
-    if (!VALUE->ParseFromString(iter->second)) { \
+    const auto& svalue = iter->second;           \
+    if (!VALUE->ParseFromArray(svalue.Data(),    \
+                               svalue.Size())) { \
         return Status::ParsedFailed();           \
     }                                            \
     return Status::OK();                         \
@@ -115,18 +476,16 @@ do {                                             \
         return Status::OK();                        \
     } while (0)
 
-#define SET_SERALIZED(TYPE, NAME, KEY, VALUE)   \
-do {                                            \
-    auto container = GET_CONTAINER(TYPE, NAME); \
-    std::string svalue;                         \
-    if (!VALUE.SerializeToString(&svalue)) {    \
-        return Status::SerializedFailed();      \
-    }                                           \
-    auto ret = container->emplace(KEY, svalue); \
-    if (!ret.second) {                          \
-        ret.first->second = svalue;             \
-    }                                           \
-    return Status::OK();                        \
+#define SET_SERALIZED(TYPE, NAME, KEY, VALUE)                        \
+do {                                                                 \
+    auto container = GET_CONTAINER(TYPE, NAME);                      \
+    const size_t size = VALUE.ByteSizeLong();                        \
+    ArenaValue svalue(container->Arena(), size);                     \
+    if (!VALUE.SerializeToArray(svalue.MutableData(), size)) {       \
+        return Status::SerializedFailed();                           \
+    }                                                                \
+    (*container)[KEY].Swap(svalue);                                  \
+    return Status::OK();                                             \
 } while (0)
 
 
@@ -182,6 +541,7 @@ Status MemoryStorage::HGet(const std::string& name,
 Status MemoryStorage::HSet(const std::string& name,
                            const std::string& key,
                            const ValueType& value) {
+    TrackChange(name, false, &key);
     if (options_.compression) {
         SET_SERALIZED(UnorderedSeralizedContainer, name, key, value);
         return Status::OK();
@@ -191,6 +551,7 @@ Status MemoryStorage::HSet(const std::string& name,
 
 Status MemoryStorage::HDel(const std::string& name,
                            const std::string& key) {
+    TrackChange(name, false, &key);
     if (options_.compression) {
         DEL(UnorderedSeralizedContainer, name, key);
         return Status::OK();
@@ -215,6 +576,7 @@ size_t MemoryStorage::HSize(const std::string& name) {
 }
 
 Status MemoryStorage::HClear(const std::string& name) {
+    TrackChange(name, false, nullptr);
     if (options_.compression) {
         CLEAR(UnorderedSeralizedContainer, name);
         return Status::OK();
@@ -235,6 +597,7 @@ Status MemoryStorage::SGet(const std::string& name,
 Status MemoryStorage::SSet(const std::string& name,
                            const std::string& key,
                            const ValueType& value) {
+    TrackChange(name, true, &key);
     if (options_.compression) {
         SET_SERALIZED(OrderedSeralizedContainer, name, key, value);
         return Status::OK();
@@ -243,6 +606,7 @@ Status MemoryStorage::SSet(const std::string& name,
 }
 
 Status MemoryStorage::SDel(const std::string& name, const std::string& key) {
+    TrackChange(name, true, &key);
     if (options_.compression) {
         DEL(OrderedSeralizedContainer, name, key);
         return Status::OK();
@@ -276,6 +640,7 @@ size_t MemoryStorage::SSize(const std::string& name) {
 }
 
 Status MemoryStorage::SClear(const std::string& name) {
+    TrackChange(name, true, nullptr);
     if (options_.compression) {
         CLEAR(OrderedSeralizedContainer, name);
         return Status::OK();
@@ -299,18 +664,388 @@ StorageOptions MemoryStorage::GetStorageOptions() const {
     return options_;
 }
 
+void MemoryStorage::TrackChange(const std::string& name, bool ordered,
+                                const std::string* key) {
+    if (!tracking_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk(changesMtx_);
+    auto& table = changes_[name];
+    table.ordered = ordered;
+    if (nullptr == key) {
+        table.cleared = true;
+        table.keys.clear();
+    } else {
+        table.keys.insert(*key);
+    }
+}
+
+Status MemoryStorage::LookupRecord(const std::string& name, bool ordered,
+                                   const std::string& key, std::string* type,
+                                   std::string* value) {
+    if (options_.compression) {
+        return ordered
+            ? LookupInContainer(
+                  GET_CONTAINER(OrderedSeralizedContainer, name), key, type,
+                  value)
+            : LookupInContainer(
+                  GET_CONTAINER(UnorderedSeralizedContainer, name), key, type,
+                  value);
+    }
+    return ordered
+        ? LookupInContainer(GET_CONTAINER(OrderedContainer, name), key, type,
+                            value)
+        : LookupInContainer(GET_CONTAINER(UnorderedContainer, name), key, type,
+                            value);
+}
+
+Status MemoryStorage::ApplyRecord(const std::string& rkey,
+                                  const std::string& rvalue) {
+    Record record;
+    if (!DecodeRecord(rkey, rvalue, &record)) {
+        return Status::ParsedFailed();
+    }
+
+    // the record is saved with compression but the storage isn't
+    // compressed now, the message type of value is unknown
+    if (record.op == kRecordSet && !options_.compression &&
+        record.type.empty()) {
+        return Status::ParsedFailed();
+    }
+
+    const auto& name = record.name;
+    if (options_.compression) {
+        return record.ordered
+            ? ApplyToContainer(GET_CONTAINER(OrderedSeralizedContainer, name),
+                               record)
+            : ApplyToContainer(
+                  GET_CONTAINER(UnorderedSeralizedContainer, name), record);
+    }
+    return record.ordered
+        ? ApplyToContainer(GET_CONTAINER(OrderedContainer, name), record)
+        : ApplyToContainer(GET_CONTAINER(UnorderedContainer, name), record);
+}
+
+std::shared_ptr<Iterator> MemoryStorage::BaseSegmentIterator() {
+    MergeIterator::ChildrenType children;
+    ReadLockGuard readLockGuard(rwLock_);
+    if (options_.compression) {
+        AppendTableIterators<UnorderedSeralizedContainerIterator>(
+            UnorderedSeralizedContainerDict_, false, &children);
+        AppendTableIterators<OrderedSeralizedContainerIterator>(
+            OrderedSeralizedContainerDict_, true, &children);
+    } else {
+        AppendTableIterators<UnorderedContainerIterator>(
+            UnorderedContainerDict_, false, &children);
+        AppendTableIterators<OrderedContainerIterator>(
+            OrderedContainerDict_, true, &children);
+    }
+    return std::make_shared<MergeIterator>(children);
+}
+
+bool MemoryStorage::DeltaSegmentRecords(const ChangesType& changes,
+                                        RecordsType* records) {
+    for (const auto& item : changes) {
+        const auto& name = item.first;
+        const auto& table = item.second;
+        if (table.cleared) {
+            records->emplace_back(EncodeRecordKey(table.ordered, name, "", ""),
+                                  EncodeRecordValue(kRecordClear));
+        }
+
+        // the latest value of a modified key is saved, or it's deleted
+        std::string type, value;
+        for (const auto& key : table.keys) {
+            auto s = LookupRecord(name, table.ordered, key, &type, &value);
+            if (s.ok()) {
+                records->emplace_back(
+                    EncodeRecordKey(table.ordered, name, type, key),
+                    EncodeRecordValue(kRecordSet, value));
+            } else if (s.IsNotFound()) {
+                records->emplace_back(
+                    EncodeRecordKey(table.ordered, name, "", key),
+                    EncodeRecordValue(kRecordDel));
+            } else {
+                LOG(ERROR) << "Lookup modified key failed, table = " << name
+                           << ", status = " << s.ToString();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool MemoryStorage::LoadSegment(const std::string& pathname,
+                                uint64_t* nRecords) {
+    DumpFile dumpfile(pathname);
+    if (dumpfile.Open() != DUMPFILE_ERROR::OK) {
+        LOG(ERROR) << "Open segment file failed, path: " << pathname;
+        return false;
+    }
+
+    auto defer = absl::MakeCleanup([&dumpfile]() { dumpfile.Close(); });
+    auto iter = dumpfile.Load();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        auto s = ApplyRecord(iter->Key(), iter->Value());
+        if (!s.ok()) {
+            LOG(ERROR) << "Apply segment record failed, path: " << pathname
+                       << ", status = " << s.ToString();
+            return false;
+        }
+        (*nRecords)++;
+    }
+
+    if (dumpfile.GetLoadStatus() != DUMPFILE_LOAD_STATUS::COMPLETE) {
+        LOG(ERROR) << "Load segment file failed, path: " << pathname
+                   << ", status = " << dumpfile.GetLoadStatus();
+        return false;
+    }
+    return true;
+}
+
+bool MemoryStorage::LinkSegments(const std::string& from,
+                                 const std::string& to) {
+    auto fs = Ext4FileSystemImpl::getInstance();
+    if (!fs->DirExists(to) && fs->Mkdir(to) != 0) {
+        LOG(ERROR) << "Failed to create directory `" << to << "`";
+        return false;
+    }
+
+    // segments are immutable once saved, so they can be shared
+    for (const auto& segment : segments_) {
+        std::string src = from + "/" + segment;
+        std::string dst = to + "/" + segment;
+        if (::link(src.c_str(), dst.c_str()) == 0) {
+            continue;
+        }
+        if (errno != EXDEV) {
+            LOG(ERROR) << "Failed to link `" << src << "` to `" << dst
+                       << "`, " << strerror(errno);
+            return false;
+        }
+        // they're on different filesystems
+        if (!CopySegment(src, dst)) {
+            LOG(ERROR) << "Failed to copy `" << src << "` to `" << dst << "`";
+            return false;
+        }
+    }
+    return true;
+}
+
 bool MemoryStorage::Checkpoint(const std::string& dir,
                                std::vector<std::string>* files) {
-    (void)dir;
-    (void)files;
-    LOG(WARNING) << "Not supported";
-    return false;
+    bool succ = false;
+    CheckpointBackground(
+        dir, [&succ, files](bool saved, const std::vector<std::string>& f) {
+            succ = saved;
+            *files = f;
+        });
+    WaitCheckpointDone();
+    return succ;
+}
+
+void MemoryStorage::CheckpointBackground(const std::string& dir,
+                                         CheckpointDone done) {
+    // the chain is updated by the last checkpoint
+    WaitCheckpointDone();
+
+    auto fs = Ext4FileSystemImpl::getInstance();
+    const std::string chainDir =
+        options_.dataDir + "/" + kMemoryCheckpointPath;
+    if (!fs->DirExists(chainDir) && fs->Mkdir(chainDir) != 0) {
+        LOG(ERROR) << "Failed to create directory `" << chainDir << "`";
+        done(false, {});
+        return;
+    }
+
+    ChangesType changes;
+    {
+        std::lock_guard<std::mutex> lk(changesMtx_);
+        changes.swap(changes_);
+        tracking_.store(true, std::memory_order_relaxed);
+    }
+
+    uint64_t nChanges = 0;
+    for (const auto& item : changes) {
+        nChanges += item.second.keys.size() + (item.second.cleared ? 1 : 0);
+    }
+
+    // rebase if the chain is too long, or deltas are larger than the base
+    const bool rebase = segments_.empty() ||
+                        segments_.size() > options_.maxDeltaSegments ||
+                        deltaRecords_ + nChanges > baseRecords_;
+
+    if (!rebase && nChanges == 0) {
+        FinishCheckpoint(true, false, "", 0, dir, done);
+        return;
+    }
+
+    const std::string segment =
+        SegmentName(rebase ? kBaseSegmentPrefix : kDeltaSegmentPrefix,
+                    nextSegmentSeq_++);
+    const std::string pathname = chainDir + "/" + segment;
+    if (rebase) {
+        auto iterator = BaseSegmentIterator();
+        const uint64_t nRecords = iterator->Size();
+        auto child = std::make_shared<DumpFileClosure>();
+        saver_ = std::thread([=]() {
+            bool saved = SaveSegmentBackground(pathname, iterator, child.get());
+            FinishCheckpoint(saved, true, segment, nRecords, dir, done);
+        });
+        // tables can be modified once the process is forked
+        child->WaitRunned();
+        return;
+    }
+
+    auto records = std::make_shared<RecordsType>();
+    if (!DeltaSegmentRecords(changes, records.get())) {
+        FinishCheckpoint(false, false, segment, 0, dir, done);
+        return;
+    }
+    saver_ = std::thread([=]() {
+        auto iterator =
+            std::make_shared<ContainerIterator<RecordsType>>(records);
+        bool saved = SaveSegment(pathname, iterator);
+        FinishCheckpoint(saved, false, segment, records->size(), dir, done);
+    });
+}
+
+void MemoryStorage::FinishCheckpoint(bool saved, bool rebase,
+                                     const std::string& segment,
+                                     uint64_t nRecords, const std::string& dir,
+                                     const CheckpointDone& done) {
+    auto fs = Ext4FileSystemImpl::getInstance();
+    const std::string chainDir =
+        options_.dataDir + "/" + kMemoryCheckpointPath;
+    if (!saved) {
+        // tracked changes are dropped, save a new base next time
+        fs->Delete(chainDir + "/" + segment);
+        segments_.clear();
+        done(false, {});
+        return;
+    }
+
+    if (!segment.empty()) {
+        if (rebase) {
+            std::vector<std::string> olds;
+            fs->List(chainDir, &olds);
+            for (const auto& old : olds) {
+                if (old != segment) {
+                    fs->Delete(chainDir + "/" + old);
+                }
+            }
+            segments_ = {segment};
+            baseRecords_ = nRecords;
+            deltaRecords_ = 0;
+        } else {
+            segments_.push_back(segment);
+            deltaRecords_ += nRecords;
+        }
+
+        LOG(INFO) << "Saved " << (rebase ? "base" : "delta") << " segment `"
+                  << chainDir << "/" << segment << "`, records: " << nRecords;
+    }
+
+    if (!LinkSegments(chainDir, dir + "/" + kMemoryCheckpointPath)) {
+        done(false, {});
+        return;
+    }
+
+    std::vector<std::string> files;
+    files.reserve(segments_.size());
+    for (const auto& name : segments_) {
+        files.push_back(std::string(kMemoryCheckpointPath) + "/" + name);
+    }
+    done(true, files);
+}
+
+void MemoryStorage::WaitCheckpointDone() {
+    if (saver_.joinable()) {
+        saver_.join();
+    }
 }
 
 bool MemoryStorage::Recover(const std::string& dir) {
-    (void)dir;
-    LOG(WARNING) << "Not supported";
-    return false;
+    LOG(INFO) << "Recovering storage from `" << dir << "`";
+    WaitCheckpointDone();
+
+    auto fs = Ext4FileSystemImpl::getInstance();
+    const std::string from = dir + "/" + kMemoryCheckpointPath;
+    std::vector<std::string> names;
+    if (fs->List(from, &names) != 0) {
+        LOG(ERROR) << "Failed to list segments at `" << from << "`";
+        return false;
+    }
+
+    // the chain starts from the latest base segment
+    bool isBase = false;
+    bool hasBase = false;
+    uint64_t seq = 0;
+    uint64_t baseSeq = 0;
+    std::map<uint64_t, std::string> segments;
+    for (const auto& name : names) {
+        if (!ParseSegmentName(name, &isBase, &seq)) {
+            continue;
+        }
+        segments.emplace(seq, name);
+        if (isBase && (!hasBase || seq > baseSeq)) {
+            hasBase = true;
+            baseSeq = seq;
+        }
+    }
+
+    if (!hasBase) {
+        LOG(ERROR) << "Base segment not found at `" << from << "`";
+        return false;
+    }
+
+    {
+        WriteLockGuard writeLockGuard(rwLock_);
+        UnorderedContainerDict_.clear();
+        UnorderedSeralizedContainerDict_.clear();
+        OrderedContainerDict_.clear();
+        OrderedSeralizedContainerDict_.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lk(changesMtx_);
+        changes_.clear();
+        tracking_.store(false, std::memory_order_relaxed);
+    }
+
+    segments_.clear();
+    baseRecords_ = 0;
+    deltaRecords_ = 0;
+    for (auto iter = segments.find(baseSeq); iter != segments.end(); ++iter) {
+        uint64_t nRecords = 0;
+        if (!LoadSegment(from + "/" + iter->second, &nRecords)) {
+            segments_.clear();
+            return false;
+        }
+        segments_.push_back(iter->second);
+        (iter->first == baseSeq ? baseRecords_ : deltaRecords_) += nRecords;
+        nextSegmentSeq_ = iter->first + 1;
+    }
+
+    // adopt the recovered chain, so next checkpoint only saves changes
+    // after it, or a new base is saved if the chain can't be adopted
+    const std::string chainDir =
+        options_.dataDir + "/" + kMemoryCheckpointPath;
+    if ((fs->DirExists(chainDir) && fs->Delete(chainDir) != 0) ||
+        !LinkSegments(from, chainDir)) {
+        LOG(WARNING) << "Failed to adopt recovered segments, a new base "
+                        "segment will be saved at next checkpoint";
+        segments_.clear();
+    } else {
+        std::lock_guard<std::mutex> lk(changesMtx_);
+        tracking_.store(true, std::memory_order_relaxed);
+    }
+
+    LOG(INFO) << "Recovered memory storage from `" << dir
+              << "`, segments: " << segments_.size()
+              << ", base records: " << baseRecords_
+              << ", delta records: " << deltaRecords_;
+    return true;
 }
 
 }  // namespace storage
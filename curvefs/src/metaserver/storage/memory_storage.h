@@ -23,10 +23,14 @@
 #ifndef CURVEFS_SRC_METASERVER_STORAGE_MEMORY_STORAGE_H_
 #define CURVEFS_SRC_METASERVER_STORAGE_MEMORY_STORAGE_H_
 
+#include <atomic>
 #include <string>
 #include <memory>
 #include <utility>
 #include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "absl/container/btree_map.h"
@@ -36,6 +40,7 @@
 #include "curvefs/src/metaserver/storage/common.h"
 #include "curvefs/src/metaserver/storage/storage.h"
 #include "curvefs/src/metaserver/storage/iterator.h"
+#include "curvefs/src/metaserver/storage/slab_arena.h"
 #include "curvefs/src/metaserver/storage/value_wrapper.h"
 
 namespace curvefs {
@@ -55,18 +60,21 @@ class MemoryStorage : public KVStorage, public StorageTransaction {
     using UnorderedContainerType =
         std::unordered_map<std::string, ValueWrapper>;
 
+    // with compression, values are kept serialized in the table's arena
     using UnorderedSeralizedContainerType =
-        std::unordered_map<std::string, std::string>;
+        ArenaContainer<std::unordered_map<std::string, ArenaValue>>;
 
     using OrderedContainerType =
         absl::btree_map<std::string, ValueWrapper>;
 
     using OrderedSeralizedContainerType =
-        absl::btree_map<std::string, std::string>;
+        ArenaContainer<absl::btree_map<std::string, ArenaValue>>;
 
  public:
     explicit MemoryStorage(StorageOptions options);
 
+    ~MemoryStorage() override;
+
     STORAGE_TYPE Type() override;
 
     bool Open() override;
@@ -118,15 +126,83 @@ class MemoryStorage : public KVStorage, public StorageTransaction {
 
     Status Rollback() override;
 
+    // Checkpoint is incremental: keys modified since the last checkpoint
+    // are saved as a delta segment chained after a base segment which holds
+    // all keys, a new base is saved once the chain grows too long.
+    // Segments are kept under the storage's data directory and hard linked
+    // (or copied if it's on another filesystem) into |dir|, so the
+    // checkpoint is self-contained.
     bool Checkpoint(const std::string& dir,
                     std::vector<std::string>* files) override;
 
+    // Segments are written by a background thread. The base segment is
+    // saved by a forked process which holds a copy-on-write view of all
+    // tables, and a delta segment holds the modified values which are
+    // copied before returning.
+    void CheckpointBackground(const std::string& dir,
+                              CheckpointDone done) override;
+
+    // Replace all tables with the base and delta segments under |dir|
     bool Recover(const std::string& dir) override;
 
+ private:
+    struct TableChanges {
+        bool ordered = false;
+        bool cleared = false;
+        std::unordered_set<std::string> keys;
+    };
+
+    using ChangesType = std::unordered_map<std::string, TableChanges>;
+
+    // Record a modified key of table |name|, or the table is cleared
+    // if |key| is nullptr
+    void TrackChange(const std::string& name, bool ordered,
+                     const std::string* key);
+
+    using RecordsType = std::vector<std::pair<std::string, std::string>>;
+
+    std::shared_ptr<Iterator> BaseSegmentIterator();
+
+    bool DeltaSegmentRecords(const ChangesType& changes,
+                             RecordsType* records);
+
+    // Run in background thread, add the saved segment to the chain and
+    // link the chain into |dir|
+    void FinishCheckpoint(bool saved, bool rebase, const std::string& segment,
+                          uint64_t nRecords, const std::string& dir,
+                          const CheckpointDone& done);
+
+    // Wait for the segment being saved in background
+    void WaitCheckpointDone();
+
+    bool LoadSegment(const std::string& pathname, uint64_t* nRecords);
+
+    Status LookupRecord(const std::string& name, bool ordered,
+                        const std::string& key, std::string* type,
+                        std::string* value);
+
+    Status ApplyRecord(const std::string& rkey, const std::string& rvalue);
+
+    bool LinkSegments(const std::string& from, const std::string& to);
+
  private:
     RWLock rwLock_;
     StorageOptions options_;
 
+    std::mutex changesMtx_;
+    ChangesType changes_;
+    // changes are only useful after a base segment is saved
+    std::atomic<bool> tracking_;
+
+    // segments of the current checkpoint chain, base segment comes first
+    std::vector<std::string> segments_;
+    uint64_t nextSegmentSeq_;
+    uint64_t baseRecords_;
+    uint64_t deltaRecords_;
+    // saves the segment of last checkpoint, the chain above is only
+    // touched by it until it's joined
+    std::thread saver_;
+
     std::unordered_map<std::string,
                        std::shared_ptr<UnorderedContainerType>>
         UnorderedContainerDict_;
@@ -241,11 +317,12 @@ public MemoryStorageIterator<ContainerType> {
     }
 
     std::string Value() override {
-        return this->current_->second;
+        return this->current_->second.ToString();
     }
 
     bool ParseFromValue(ValueType* value) override {
-        if (!value->ParseFromString(this->current_->second)) {
+        const auto& svalue = this->current_->second;
+        if (!value->ParseFromArray(svalue.Data(), svalue.Size())) {
             return false;
         }
         return true;
@@ -292,11 +369,12 @@ public MemoryStorageIterator<ContainerType> {
     }
 
     std::string Value() override {
-        return this->current_->second;
+        return this->current_->second.ToString();
     }
 
     bool ParseFromValue(ValueType* value) override {
-        if (!value->ParseFromString(this->current_->second)) {
+        const auto& svalue = this->current_->second;
+        if (!value->ParseFromArray(svalue.Data(), svalue.Size())) {
             return false;
         }
         return true;
@@ -44,6 +44,11 @@ DEFINE_int64(rocksdb_block_cache_capacity,
              8ULL << 30,
              "Total block cache capacity for all rocksdb instances");
 
+DEFINE_int32(rocksdb_block_cache_num_shard_bits,
+             6,
+             "Block cache is sharded into 2^num_shard_bits shards by hash "
+             "of key to reduce lock contention");
+
 DEFINE_int64(rocksdb_write_buffer_manager_capacity,
              6ULL << 30,
              "Total writer buffer capacity for all rocksdb instances");
@@ -98,6 +103,25 @@ DEFINE_int32(rocksdb_ordered_cf_max_write_buffer_number,
              2,
              "Number of writer buffer for ordered column family");
 
+DEFINE_int64(rocksdb_inode_cf_write_buffer_size,
+             64ULL << 20,
+             "Writer buffer size for inode column family");
+
+DEFINE_int64(rocksdb_dentry_cf_write_buffer_size,
+             64ULL << 20,
+             "Writer buffer size for dentry column family");
+
+DEFINE_int64(rocksdb_s3chunkinfo_cf_write_buffer_size,
+             64ULL << 20,
+             "Writer buffer size for s3chunkinfo column family");
+
+// inode, dentry and s3chunkinfo column families can't be opened by older
+// versions, so it's disabled until all metaservers are upgraded
+DEFINE_bool(rocksdb_separate_column_families,
+            false,
+            "Store inode, dentry and s3chunkinfo tables in their own column "
+            "families");
+
 DEFINE_int32(rocksdb_max_write_buffer_size_to_maintain,
              20ULL << 20,
              "The target number of write history bytes to hold in memory");
@@ -113,12 +137,16 @@ std::shared_ptr<rocksdb::WriteBufferManager> rocksdbWriteBufferManager;
 std::shared_ptr<MetricEventListener> metricEventListener;
 
 const char* const kOrderedColumnFamilyName = "ordered_column_family";
+const char* const kInodeColumnFamilyName = "inode_column_family";
+const char* const kDentryColumnFamilyName = "dentry_column_family";
+const char* const kS3ChunkInfoColumnFamilyName = "s3chunkinfo_column_family";
 
 void CreateBlockCacheAndWriterBufferManager() {
     static std::once_flag createBlockCache;
     std::call_once(createBlockCache, []() {
         rocksdbBlockCache = rocksdb::NewLRUCache(
-            FLAGS_rocksdb_block_cache_capacity, 1, false, 0.9);
+            FLAGS_rocksdb_block_cache_capacity,
+            FLAGS_rocksdb_block_cache_num_shard_bits, false, 0.9);
     });
 
     static std::once_flag createWriterBufferManager;
@@ -170,6 +198,7 @@ void InitRocksdbOptions(
     tableOptions.block_size = 16ULL << 10;  // 16KiB
     tableOptions.block_cache = rocksdbBlockCache;
     tableOptions.cache_index_and_filter_blocks = true;
+    tableOptions.cache_index_and_filter_blocks_with_high_priority = true;
     tableOptions.pin_l0_filter_and_index_blocks_in_cache = true;
     tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
 
@@ -208,10 +237,49 @@ void InitRocksdbOptions(
     unorderedCfOptions.max_write_buffer_number =
         FLAGS_rocksdb_unordered_cf_max_write_buffer_number;
 
+    // inode table is accessed by point lookups, so whole key bloom filter
+    // is also built for memtable, and data blocks are indexed by hash
+    rocksdb::BlockBasedTableOptions inodeTableOptions = tableOptions;
+    inodeTableOptions.data_block_index_type =
+        rocksdb::BlockBasedTableOptions::kDataBlockBinaryAndHash;
+    rocksdb::ColumnFamilyOptions inodeCfOptions = unorderedCfOptions;
+    inodeCfOptions.write_buffer_size = FLAGS_rocksdb_inode_cf_write_buffer_size;
+    inodeCfOptions.memtable_whole_key_filtering = true;
+    inodeCfOptions.table_factory.reset(
+        rocksdb::NewBlockBasedTableFactory(inodeTableOptions));
+
+    // dentry table is mostly listed by parent inode, the prefix is extended
+    // to `fsId + parentInodeId` so that bloom filter works for listing
+    rocksdb::ColumnFamilyOptions dentryCfOptions = orderedCfOptions;
+    dentryCfOptions.write_buffer_size =
+        FLAGS_rocksdb_dentry_cf_write_buffer_size;
+    dentryCfOptions.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(
+        RocksDBStorage::GetPrefixSeekLength(kDentryColumnFamily)));
+
+    // s3chunkinfo table is only scanned by `fsId + inodeId` (and chunk
+    // index), whole key filter is useless for it
+    rocksdb::BlockBasedTableOptions s3ChunkInfoTableOptions = tableOptions;
+    s3ChunkInfoTableOptions.whole_key_filtering = false;
+    rocksdb::ColumnFamilyOptions s3ChunkInfoCfOptions = orderedCfOptions;
+    s3ChunkInfoCfOptions.write_buffer_size =
+        FLAGS_rocksdb_s3chunkinfo_cf_write_buffer_size;
+    s3ChunkInfoCfOptions.prefix_extractor.reset(
+        rocksdb::NewFixedPrefixTransform(
+            RocksDBStorage::GetPrefixSeekLength(kS3ChunkInfoColumnFamily)));
+    s3ChunkInfoCfOptions.table_factory.reset(
+        rocksdb::NewBlockBasedTableFactory(s3ChunkInfoTableOptions));
+
+    // NOTE: the order must be consistent with `ColumnFamilyIndex`
     columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
         rocksdb::kDefaultColumnFamilyName, unorderedCfOptions});
     columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
         kOrderedColumnFamilyName, orderedCfOptions});
+    columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
+        kInodeColumnFamilyName, inodeCfOptions});
+    columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
+        kDentryColumnFamilyName, dentryCfOptions});
+    columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
+        kS3ChunkInfoColumnFamilyName, s3ChunkInfoCfOptions});
 }
 
 void ParseRocksdbOptions(curve::common::Configuration* conf) {
@@ -219,6 +287,10 @@ void ParseRocksdbOptions(curve::common::Configuration* conf) {
     dummy.Load(conf, "rocksdb_block_cache_capacity",
                "storage.rocksdb.block_cache_capacity",
                &FLAGS_rocksdb_block_cache_capacity, /*fatalIfMissing*/ false);
+    dummy.Load(conf, "rocksdb_block_cache_num_shard_bits",
+               "storage.rocksdb.block_cache_num_shard_bits",
+               &FLAGS_rocksdb_block_cache_num_shard_bits,
+               /*fatalIfMissing*/ false);
     dummy.Load(conf, "rocksdb_write_buffer_manager_capacity",
                "storage.rocksdb.write_buffer_manager_capacity",
                &FLAGS_rocksdb_write_buffer_manager_capacity,
@@ -260,6 +332,22 @@ void ParseRocksdbOptions(curve::common::Configuration* conf) {
                "storage.rocksdb.ordered_max_write_buffer_number",
                &FLAGS_rocksdb_ordered_cf_max_write_buffer_number,
                /*fatalIfMissing*/ false);
+    dummy.Load(conf, "rocksdb_inode_cf_write_buffer_size",
+               "storage.rocksdb.inode_write_buffer_size",
+               &FLAGS_rocksdb_inode_cf_write_buffer_size,
+               /*fatalIfMissing*/ false);
+    dummy.Load(conf, "rocksdb_dentry_cf_write_buffer_size",
+               "storage.rocksdb.dentry_write_buffer_size",
+               &FLAGS_rocksdb_dentry_cf_write_buffer_size,
+               /*fatalIfMissing*/ false);
+    dummy.Load(conf, "rocksdb_s3chunkinfo_cf_write_buffer_size",
+               "storage.rocksdb.s3chunkinfo_write_buffer_size",
+               &FLAGS_rocksdb_s3chunkinfo_cf_write_buffer_size,
+               /*fatalIfMissing*/ false);
+    dummy.Load(conf, "rocksdb_separate_column_families",
+               "storage.rocksdb.separate_column_families",
+               &FLAGS_rocksdb_separate_column_families,
+               /*fatalIfMissing*/ false);
     dummy.Load(conf, "rocksdb_max_write_buffer_size_to_maintain",
                "storage.rocksdb.max_write_buffer_size_to_maintain",
                &FLAGS_rocksdb_max_write_buffer_size_to_maintain,
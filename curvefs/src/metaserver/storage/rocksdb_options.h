@@ -23,6 +23,8 @@
 #ifndef CURVEFS_SRC_METASERVER_STORAGE_ROCKSDB_OPTIONS_H_
 #define CURVEFS_SRC_METASERVER_STORAGE_ROCKSDB_OPTIONS_H_
 
+#include <gflags/gflags.h>
+
 #include <vector>
 
 #include "rocksdb/db.h"
@@ -38,6 +40,19 @@ namespace curvefs {
 namespace metaserver {
 namespace storage {
 
+DECLARE_bool(rocksdb_separate_column_families);
+
+// Index of column families built by InitRocksdbOptions(), inode, dentry and
+// s3chunkinfo tables have their own column families if they're in use, and
+// other tables are stored in ordered or unordered column family
+enum ColumnFamilyIndex : size_t {
+    kUnorderedColumnFamily = 0,
+    kOrderedColumnFamily = 1,
+    kInodeColumnFamily = 2,
+    kDentryColumnFamily = 3,
+    kS3ChunkInfoColumnFamily = 4,
+};
+
 // Parse rocksdb related options from conf
 void ParseRocksdbOptions(curve::common::Configuration* conf);
 
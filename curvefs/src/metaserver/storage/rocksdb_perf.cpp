@@ -20,10 +20,16 @@
  * Author: Jingli Chen (Wine93)
  */
 
+#include <bvar/bvar.h>
 #include <glog/logging.h>
 
-#include <ostream>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <mutex>
 #include <iostream>
+#include <ostream>
+#include <sstream>
 
 #include "butil/fast_rand.h"
 #include "src/common/timeutility.h"
@@ -100,6 +106,72 @@ std::ostream& operator<<(std::ostream& os, OPERATOR_TYPE type) {
     return os;
 }
 
+namespace {
+
+// Perf context of all operations with the same type, it's only collected
+// when rocksdb perf level is enabled
+struct PerfMetric {
+    explicit PerfMetric(const std::string& prefix)
+        : latency(prefix),
+          blockReadCount(prefix, "block_read_count"),
+          blockReadBytes(prefix, "block_read_bytes"),
+          blockCacheHitCount(prefix, "block_cache_hit_count"),
+          bloomMemtableHitCount(prefix, "bloom_memtable_hit_count"),
+          bloomMemtableMissCount(prefix, "bloom_memtable_miss_count"),
+          bloomSstHitCount(prefix, "bloom_sst_hit_count"),
+          bloomSstMissCount(prefix, "bloom_sst_miss_count"),
+          internalKeySkippedCount(prefix, "internal_key_skipped_count"),
+          internalDeleteSkippedCount(prefix,
+                                     "internal_delete_skipped_count") {}
+
+    void Collect(uint64_t latencyUs, const rocksdb::PerfContext& ctx) {
+        latency << latencyUs;
+        blockReadCount << ctx.block_read_count;
+        blockReadBytes << ctx.block_read_byte;
+        blockCacheHitCount << ctx.block_cache_hit_count;
+        bloomMemtableHitCount << ctx.bloom_memtable_hit_count;
+        bloomMemtableMissCount << ctx.bloom_memtable_miss_count;
+        bloomSstHitCount << ctx.bloom_sst_hit_count;
+        bloomSstMissCount << ctx.bloom_sst_miss_count;
+        internalKeySkippedCount << ctx.internal_key_skipped_count;
+        internalDeleteSkippedCount << ctx.internal_delete_skipped_count;
+    }
+
+    bvar::LatencyRecorder latency;
+    bvar::Adder<uint64_t> blockReadCount;
+    bvar::Adder<uint64_t> blockReadBytes;
+    bvar::Adder<uint64_t> blockCacheHitCount;
+    bvar::Adder<uint64_t> bloomMemtableHitCount;
+    bvar::Adder<uint64_t> bloomMemtableMissCount;
+    bvar::Adder<uint64_t> bloomSstHitCount;
+    bvar::Adder<uint64_t> bloomSstMissCount;
+    bvar::Adder<uint64_t> internalKeySkippedCount;
+    bvar::Adder<uint64_t> internalDeleteSkippedCount;
+};
+
+const size_t kMaxOperatorType = OP_ROLLBACK_TRANSACTION + 1;
+
+std::unique_ptr<PerfMetric> perfMetrics[kMaxOperatorType];
+
+// e.g: rocksdb_perf_iterator_seek_to_first
+PerfMetric* GetPerfMetric(OPERATOR_TYPE type) {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        for (size_t i = OP_GET; i < kMaxOperatorType; i++) {
+            std::ostringstream oss;
+            oss << static_cast<OPERATOR_TYPE>(i);
+            std::string name = oss.str();
+            std::transform(name.begin(), name.end(), name.begin(),
+                           ::tolower);
+            perfMetrics[i].reset(new PerfMetric("rocksdb_perf_" + name));
+        }
+    });
+
+    return type < kMaxOperatorType ? perfMetrics[type].get() : nullptr;
+}
+
+}  // namespace
+
 rocksdb::PerfLevel RocksDBPerfGuard::ToPerfLevel(uint32_t level) {
     switch (level) {
         case 0:
@@ -138,6 +210,11 @@ RocksDBPerfGuard::~RocksDBPerfGuard() {
     uint64_t now = TimeUtility::GetTimeofDayUs();
     uint64_t latencyUs = now - startTimeUs_;
     rocksdb::SetPerfLevel(rocksdb::PerfLevel::kDisable);
+    PerfMetric* metric = GetPerfMetric(opType_);
+    if (metric != nullptr) {
+        metric->Collect(latencyUs, *rocksdb::get_perf_context());
+    }
+
     if (latencyUs <= FLAGS_rocksdb_perf_slow_us &&
         FLAGS_rocksdb_perf_sampling_ratio <= butil::fast_rand_double()) {
         return;
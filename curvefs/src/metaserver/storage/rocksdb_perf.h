@@ -70,6 +70,9 @@ enum OPERATOR_TYPE : unsigned char {
     OP_ROLLBACK_TRANSACTION = 14,
 };
 
+// Collect rocksdb perf context of an operation into metrics of its type,
+// e.g. `rocksdb_perf_get_block_cache_hit_count`, and log it if the operation
+// is slow or sampled
 class RocksDBPerfGuard {
  public:
     explicit RocksDBPerfGuard(OPERATOR_TYPE opType);
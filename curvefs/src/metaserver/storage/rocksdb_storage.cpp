@@ -22,6 +22,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <ostream>
 #include <iostream>
 #include <unordered_map>
@@ -44,6 +45,25 @@ using ::curve::common::TimeUtility;
 
 const std::string RocksDBStorage::kDelimiter_ = ":";  // NOLINT
 
+namespace {
+
+// The write batch started by BeginBatch() in current thread
+struct BatchContext {
+    const RocksDBStorage* storage = nullptr;
+    ROCKSDB_NAMESPACE::Transaction* txn = nullptr;
+};
+
+thread_local BatchContext batchContext;
+
+// Length of `key type + fsId + inodeId` at the beginning of dentry and
+// s3chunkinfo keys, see also converter.cpp
+const size_t kInodeKeyLength = 1 + sizeof(uint32_t) + sizeof(uint64_t);
+
+// Number of keys written in one batch when migrating column family
+const size_t kMigrateBatchSize = 1024;
+
+}  // namespace
+
 Status ToStorageStatus(const ROCKSDB_NAMESPACE::Status& s) {
     if (s.ok()) {
         return Status::OK();
@@ -65,6 +85,16 @@ size_t RocksDBStorage::GetKeyPrefixLength() {
     return length;
 }
 
+size_t RocksDBStorage::GetPrefixSeekLength(ColumnFamilyIndex index) {
+    switch (index) {
+        case kDentryColumnFamily:
+        case kS3ChunkInfoColumnFamily:
+            return GetKeyPrefixLength() + kDelimiter_.size() + kInodeKeyLength;
+        default:
+            return GetKeyPrefixLength();
+    }
+}
+
 //  RocksDBStorage
 RocksDBStorage::RocksDBStorage()
     : InTransaction_(false) {
@@ -85,6 +115,7 @@ RocksDBStorage::RocksDBStorage(const RocksDBStorage& storage,
       db_(storage.db_),
       txnDB_(storage.txnDB_),
       handles_(storage.handles_),
+      separateColumnFamilies_(storage.separateColumnFamilies_),
       InTransaction_(true),
       txn_(txn),
       dbOptions_(storage.dbOptions_),
@@ -115,9 +146,24 @@ bool RocksDBStorage::Open() {
         }
     }
 
+    // once the database has separate column families, they're always opened
+    // even if disabled, as rocksdb requires opening all column families
+    separateColumnFamilies_ = FLAGS_rocksdb_separate_column_families;
+    if (!separateColumnFamilies_ && HasSeparateColumnFamilies()) {
+        LOG(WARNING) << "Database at `" << options_.dataDir
+                     << "` already has separate column families for inode, "
+                        "dentry and s3chunkinfo tables, keep using them";
+        separateColumnFamilies_ = true;
+    }
+
+    std::vector<ColumnFamilyDescriptor> columnFamilies = dbCfDescriptors_;
+    if (!separateColumnFamilies_) {
+        columnFamilies.resize(kInodeColumnFamily);
+    }
+
     ROCKSDB_NAMESPACE::Status s =
         TransactionDB::Open(dbOptions_, dbTransOptions_, options_.dataDir,
-                            dbCfDescriptors_, &handles_, &txnDB_);
+                            columnFamilies, &handles_, &txnDB_);
     if (!s.ok()) {
         LOG(ERROR) << "Open rocksdb database at `" << options_.dataDir
                    << "` failed, status = " << s.ToString();
@@ -130,6 +176,100 @@ bool RocksDBStorage::Open() {
     return true;
 }
 
+bool RocksDBStorage::HasSeparateColumnFamilies() const {
+    std::vector<std::string> existing;
+    auto s = DB::ListColumnFamilies(dbOptions_, options_.dataDir, &existing);
+    if (!s.ok()) {
+        // database doesn't exist yet
+        return false;
+    }
+
+    const auto& name = dbCfDescriptors_[kInodeColumnFamily].name;
+    return std::find(existing.begin(), existing.end(), name) !=
+           existing.end();
+}
+
+bool RocksDBStorage::MigrateColumnFamily(ColumnFamilyIndex from,
+                                         ColumnFamilyIndex to,
+                                         const std::string& prefix) {
+    std::string upper = prefix;
+    upper.back()++;
+    rocksdb::Slice upperBound(upper);
+    rocksdb::ReadOptions readOptions;
+    readOptions.total_order_seek = true;
+    readOptions.iterate_upper_bound = &upperBound;
+
+    auto fromHandle = GetColumnFamilyHandle(from);
+    auto toHandle = GetColumnFamilyHandle(to);
+    std::unique_ptr<rocksdb::Iterator> iter(
+        db_->NewIterator(readOptions, fromHandle));
+
+    // internal key: ordered:name:0:key
+    const bool ordered = from == kOrderedColumnFamily;
+    const size_t nameOffset = 1 + kDelimiter_.size();
+    const size_t nameLength = GetKeyPrefixLength() - 2 * nameOffset;
+
+    uint64_t count = 0;
+    rocksdb::WriteBatch batch;
+    ROCKSDB_NAMESPACE::Status s;
+    for (iter->Seek(prefix); iter->Valid(); iter->Next()) {
+        auto key = iter->key();
+        if (key.size() <= GetKeyPrefixLength() ||
+            key[GetKeyPrefixLength()] != kDelimiter_[0] ||
+            GetColumnFamilyIndex(std::string(key.data() + nameOffset,
+                                             nameLength),
+                                 ordered) != to) {
+            continue;
+        }
+
+        batch.Put(toHandle, iter->key(), iter->value());
+        batch.Delete(fromHandle, iter->key());
+        if (++count % kMigrateBatchSize == 0) {
+            s = db_->Write(dbWriteOptions_, &batch);
+            if (!s.ok()) {
+                break;
+            }
+            batch.Clear();
+        }
+    }
+
+    if (s.ok()) {
+        s = iter->status();
+    }
+    if (s.ok() && batch.Count() > 0) {
+        s = db_->Write(dbWriteOptions_, &batch);
+    }
+    if (!s.ok()) {
+        LOG(ERROR) << "Migrate column family failed, prefix = " << prefix
+                   << ", status = " << s.ToString();
+        return false;
+    }
+
+    LOG_IF(INFO, count > 0) << "Migrated " << count << " keys with prefix `"
+                            << prefix << "` to column family "
+                            << toHandle->GetName();
+    return true;
+}
+
+bool RocksDBStorage::MigrateLegacyColumnFamilies() {
+    if (!separateColumnFamilies_) {
+        return true;
+    }
+
+    auto prefix = [](bool ordered, KEY_TYPE type) -> std::string {
+        std::ostringstream oss;
+        oss << ordered << kDelimiter_ << static_cast<int>(type) << kDelimiter_;
+        return oss.str();
+    };
+
+    return MigrateColumnFamily(kUnorderedColumnFamily, kInodeColumnFamily,
+                               prefix(false, kTypeInode)) &&
+           MigrateColumnFamily(kOrderedColumnFamily, kDentryColumnFamily,
+                               prefix(true, kTypeDentry)) &&
+           MigrateColumnFamily(kOrderedColumnFamily, kS3ChunkInfoColumnFamily,
+                               prefix(true, kTypeS3ChunkInfo));
+}
+
 bool RocksDBStorage::Close() {
     if (!inited_) {
         return true;
@@ -162,8 +302,28 @@ bool RocksDBStorage::Close() {
     return true;
 }
 
-inline ColumnFamilyHandle* RocksDBStorage::GetColumnFamilyHandle(bool ordered) {
-    return ordered ? handles_[1] : handles_[0];
+ColumnFamilyIndex RocksDBStorage::GetColumnFamilyIndex(
+    const std::string& name, bool ordered) const {
+    // table name is generated by NameGenerator, e.g: `1:xxxx`
+    static const size_t tableNameLength = NameGenerator::GetFixedLength();
+    if (separateColumnFamilies_ && name.size() == tableNameLength &&
+        name[1] == kDelimiter_[0]) {
+        const int type = name[0] - '0';
+        if (!ordered && type == kTypeInode) {
+            return kInodeColumnFamily;
+        } else if (ordered && type == kTypeDentry) {
+            return kDentryColumnFamily;
+        } else if (ordered && type == kTypeS3ChunkInfo) {
+            return kS3ChunkInfoColumnFamily;
+        }
+    }
+
+    return ordered ? kOrderedColumnFamily : kUnorderedColumnFamily;
+}
+
+ColumnFamilyHandle* RocksDBStorage::GetColumnFamilyHandle(
+    ColumnFamilyIndex index) {
+    return handles_[index];
 }
 
 /* NOTE:
@@ -198,6 +358,15 @@ std::string RocksDBStorage::ToUserKey(const std::string& ikey) {
     return ikey.substr(GetKeyPrefixLength() + kDelimiter_.size());
 }
 
+Transaction* RocksDBStorage::CurrentTransaction() const {
+    if (InTransaction_) {
+        return txn_;
+    } else if (batchContext.storage == this) {
+        return batchContext.txn;
+    }
+    return nullptr;
+}
+
 Status RocksDBStorage::Get(const std::string& name,
                            const std::string& key,
                            ValueType* value,
@@ -209,10 +378,11 @@ Status RocksDBStorage::Get(const std::string& name,
     ROCKSDB_NAMESPACE::Status s;
     std::string svalue;
     std::string ikey = ToInternalKey(name, key, ordered);
-    auto handle = GetColumnFamilyHandle(ordered);
+    auto handle = GetColumnFamilyHandle(GetColumnFamilyIndex(name, ordered));
+    auto txn = CurrentTransaction();
     {
         RocksDBPerfGuard guard(OP_GET);
-        s = InTransaction_ ? txn_->Get(dbReadOptions_, handle, ikey, &svalue) :
+        s = nullptr != txn ? txn->Get(dbReadOptions_, handle, ikey, &svalue) :
                              db_->Get(dbReadOptions_, handle, ikey, &svalue);
     }
     if (s.ok() && !value->ParseFromString(svalue)) {
@@ -232,11 +402,12 @@ Status RocksDBStorage::Set(const std::string& name,
         return Status::SerializedFailed();
     }
 
-    auto handle = GetColumnFamilyHandle(ordered);
+    auto handle = GetColumnFamilyHandle(GetColumnFamilyIndex(name, ordered));
     std::string ikey = ToInternalKey(name, key, ordered);
+    auto txn = CurrentTransaction();
     RocksDBPerfGuard guard(OP_PUT);
-    ROCKSDB_NAMESPACE::Status s = InTransaction_ ?
-        txn_->Put(handle, ikey, svalue) :
+    ROCKSDB_NAMESPACE::Status s = nullptr != txn ?
+        txn->Put(handle, ikey, svalue) :
         db_->Put(dbWriteOptions_, handle, ikey, svalue);
     return ToStorageStatus(s);
 }
@@ -249,10 +420,11 @@ Status RocksDBStorage::Del(const std::string& name,
     }
 
     std::string ikey = ToInternalKey(name, key, ordered);
-    auto handle = GetColumnFamilyHandle(ordered);
+    auto handle = GetColumnFamilyHandle(GetColumnFamilyIndex(name, ordered));
+    auto txn = CurrentTransaction();
     RocksDBPerfGuard guard(OP_DELETE);
-    ROCKSDB_NAMESPACE::Status s = InTransaction_ ?
-        txn_->Delete(handle, ikey) :
+    ROCKSDB_NAMESPACE::Status s = nullptr != txn ?
+        txn->Delete(handle, ikey) :
         db_->Delete(dbWriteOptions_, handle, ikey);
     return ToStorageStatus(s);
 }
@@ -262,7 +434,7 @@ std::shared_ptr<Iterator> RocksDBStorage::Seek(const std::string& name,
     int status = inited_ ? 0 : -1;
     std::string ikey = ToInternalKey(name, prefix, true);
     return std::make_shared<RocksDBStorageIterator>(
-        this, ikey, 0, status, true);
+        this, ikey, 0, status, GetColumnFamilyIndex(name, true));
 }
 
 std::shared_ptr<Iterator> RocksDBStorage::GetAll(const std::string& name,
@@ -270,7 +442,7 @@ std::shared_ptr<Iterator> RocksDBStorage::GetAll(const std::string& name,
     int status = inited_ ? 0 : -1;
     std::string ikey = ToInternalKey(name, "", ordered);
     return std::make_shared<RocksDBStorageIterator>(
-        this, std::move(ikey), 0, status, ordered);
+        this, std::move(ikey), 0, status, GetColumnFamilyIndex(name, ordered));
 }
 
 size_t RocksDBStorage::Size(const std::string& name, bool ordered) {
@@ -293,13 +465,23 @@ Status RocksDBStorage::Clear(const std::string& name, bool ordered) {
         return Status::NotSupported();
     }
 
+    // delete range can't go through a transaction, so the pending batch
+    // is committed first to keep the order of modifications
+    bool inBatch = batchContext.storage == this;
+    if (inBatch) {
+        Status st = CommitBatch();
+        if (!st.ok()) {
+            return st;
+        }
+    }
+
     // TODO(all): Maybe we should let `Clear` just do nothing, because it's only
     // called when recover state machine from raft snapshot, and in this case,
     // out implementation is close and remove current database, and reopen from
     // database's checkpoint in raft snapshot
     // But, currently, many unittest cases depend it
 
-    auto handle = GetColumnFamilyHandle(ordered);
+    auto handle = GetColumnFamilyHandle(GetColumnFamilyIndex(name, ordered));
     std::string lower = ToInternalName(name, ordered, true);
     std::string upper = ToInternalName(name, ordered, false);
     RocksDBPerfGuard guard(OP_DELETE_RANGE);
@@ -307,11 +489,23 @@ Status RocksDBStorage::Clear(const std::string& name, bool ordered) {
         dbWriteOptions_, handle, lower, upper);
     LOG(INFO) << "Clear(), tablename = " << name << ", ordered = " << ordered
               << ", lower key = " << lower << ", upper key = " << upper;
+    if (inBatch && !BeginBatch()) {
+        LOG(WARNING) << "Begin batch again after Clear() failed, following "
+                     << "modifications are applied directly";
+    }
     return ToStorageStatus(s);
 }
 
 std::shared_ptr<StorageTransaction> RocksDBStorage::BeginTransaction() {
     RocksDBPerfGuard guard(OP_BEGIN_TRANSACTION);
+    if (batchContext.storage == this) {
+        batchContext.txn->SetSavePoint();
+        auto storage = std::make_shared<RocksDBStorage>(*this,
+                                                        batchContext.txn);
+        storage->inBatch_ = true;
+        return storage;
+    }
+
     ROCKSDB_NAMESPACE::Transaction* txn =
         txnDB_->BeginTransaction(dbWriteOptions_);
     if (nullptr == txn) {
@@ -326,6 +520,11 @@ Status RocksDBStorage::Commit() {
     }
 
     RocksDBPerfGuard guard(OP_COMMIT_TRANSACTION);
+    if (inBatch_) {
+        // modifications will be committed along with the batch
+        return ToStorageStatus(txn_->PopSavePoint());
+    }
+
     ROCKSDB_NAMESPACE::Status s = txn_->Commit();
     if (!s.ok()) {
         LOG(ERROR) << "RocksDBStorage commit transaction failed"
@@ -341,6 +540,15 @@ Status RocksDBStorage::Rollback()  {
     }
 
     RocksDBPerfGuard guard(OP_ROLLBACK_TRANSACTION);
+    if (inBatch_) {
+        ROCKSDB_NAMESPACE::Status s = txn_->RollbackToSavePoint();
+        if (!s.ok()) {
+            LOG(ERROR) << "RocksDBStorage rollback to savepoint failed"
+                       << ", status=" << s.ToString();
+        }
+        return ToStorageStatus(s);
+    }
+
     ROCKSDB_NAMESPACE::Status s = txn_->Rollback();
     if (!s.ok()) {
         LOG(ERROR) << "RocksDBStorage rollback transaction failed"
@@ -350,6 +558,43 @@ Status RocksDBStorage::Rollback()  {
     return ToStorageStatus(s);
 }
 
+bool RocksDBStorage::BeginBatch() {
+    if (!inited_ || InTransaction_ || batchContext.storage != nullptr) {
+        return false;
+    }
+
+    RocksDBPerfGuard guard(OP_BEGIN_TRANSACTION);
+    ROCKSDB_NAMESPACE::Transaction* txn =
+        txnDB_->BeginTransaction(dbWriteOptions_);
+    if (nullptr == txn) {
+        return false;
+    }
+
+    batchContext.storage = this;
+    batchContext.txn = txn;
+    return true;
+}
+
+Status RocksDBStorage::CommitBatch() {
+    // the batch may be committed ahead by Clear() and not begun again,
+    // modifications after that are already applied directly
+    if (batchContext.storage != this) {
+        return Status::OK();
+    }
+
+    std::unique_ptr<ROCKSDB_NAMESPACE::Transaction> txn(batchContext.txn);
+    batchContext.storage = nullptr;
+    batchContext.txn = nullptr;
+
+    RocksDBPerfGuard guard(OP_COMMIT_TRANSACTION);
+    ROCKSDB_NAMESPACE::Status s = txn->Commit();
+    if (!s.ok()) {
+        LOG(ERROR) << "RocksDBStorage commit batch failed"
+                   << ", status=" << s.ToString();
+    }
+    return ToStorageStatus(s);
+}
+
 StorageOptions RocksDBStorage::GetStorageOptions() const {
     return options_;
 }
@@ -406,9 +651,27 @@ bool DuplicateRocksdbCheckpoint(const std::string& from,
 
     InitRocksdbOptions(&dbOptions, &columnFamilies, /*createIfMissing*/ false);
 
+    // checkpoint may be created before some column families are added, and
+    // they can't be created in read only mode
+    std::vector<std::string> existing;
+    auto status = rocksdb::DB::ListColumnFamilies(dbOptions, from, &existing);
+    if (!status.ok()) {
+        LOG(ERROR) << "Failed to list column families of checkpoint, error: "
+                   << status.ToString();
+        return false;
+    }
+
+    columnFamilies.erase(
+        std::remove_if(columnFamilies.begin(), columnFamilies.end(),
+                       [&existing](const rocksdb::ColumnFamilyDescriptor& cf) {
+                           return std::find(existing.begin(), existing.end(),
+                                            cf.name) == existing.end();
+                       }),
+        columnFamilies.end());
+
     std::vector<rocksdb::ColumnFamilyHandle*> cfHandles;
 
-    auto status = rocksdb::DB::OpenForReadOnly(
+    status = rocksdb::DB::OpenForReadOnly(
         dbOptions, from, columnFamilies, &cfHandles, &db,
         /* error_if_wal_file_exists */ true);
 
@@ -495,6 +758,12 @@ bool RocksDBStorage::Recover(const std::string& dir) {
         return false;
     }
 
+    succ = MigrateLegacyColumnFamilies();
+    if (!succ) {
+        LOG(ERROR) << "Failed to migrate legacy column families";
+        return false;
+    }
+
     LOG(INFO) << "Recovered rocksdb from `" << dir << "`";
     return true;
 }
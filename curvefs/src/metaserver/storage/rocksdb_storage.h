@@ -43,6 +43,7 @@
 #include "curvefs/src/metaserver/storage/utils.h"
 #include "curvefs/src/metaserver/storage/storage.h"
 #include "curvefs/src/metaserver/storage/rocksdb_perf.h"
+#include "curvefs/src/metaserver/storage/rocksdb_options.h"
 #include "curvefs/src/metaserver/storage/rocksdb_storage.h"
 
 namespace curvefs {
@@ -126,16 +127,31 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
 
     Status Rollback() override;
 
+    // A batch is a rocksdb transaction bound to the calling thread, every
+    // Get/Set/Del/iterator of this storage in that thread goes through it,
+    // and transactions begun inside a batch are savepoints of it.
+    bool BeginBatch() override;
+
+    Status CommitBatch() override;
+
     bool Checkpoint(const std::string& dir,
                     std::vector<std::string>* files) override;
 
     bool Recover(const std::string& dir) override;
 
  private:
-    ColumnFamilyHandle* GetColumnFamilyHandle(bool ordered);
+    // Return the column family which stores table |name|
+    ColumnFamilyIndex GetColumnFamilyIndex(const std::string& name,
+                                           bool ordered) const;
+
+    ColumnFamilyHandle* GetColumnFamilyHandle(ColumnFamilyIndex index);
 
     static size_t GetKeyPrefixLength();
 
+    // Return the length of prefix extracted by column family's prefix
+    // extractor, seeking by a shorter prefix must be total order
+    static size_t GetPrefixSeekLength(ColumnFamilyIndex index);
+
     static std::string ToInternalName(const std::string& name,
                                       bool ordered,
                                       bool start);
@@ -146,6 +162,10 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
 
     std::string ToUserKey(const std::string& ikey);
 
+    // Return the transaction which current operation should go through:
+    // the transaction itself, the batch of calling thread, or nullptr
+    Transaction* CurrentTransaction() const;
+
     Status Get(const std::string& name,
                const std::string& key,
                ValueType* value,
@@ -184,6 +204,22 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
 
     void InitDbOptions();
 
+    // Whether the database at data directory already has the inode, dentry
+    // and s3chunkinfo column families
+    bool HasSeparateColumnFamilies() const;
+
+    // Move tables which have their own column family out of ordered and
+    // unordered column families, the database may be recovered from a
+    // checkpoint which was created before these column families exist.
+    // It's one-way, older versions can't open the database afterwards as
+    // they don't know the new column families, so it's done only if
+    // these column families are in use.
+    bool MigrateLegacyColumnFamilies();
+
+    bool MigrateColumnFamily(ColumnFamilyIndex from,
+                             ColumnFamilyIndex to,
+                             const std::string& prefix);
+
  private:
     bool inited_ = false;
     StorageOptions options_;
@@ -192,6 +228,10 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
     std::vector<ColumnFamilyHandle*> handles_;
     static const std::string kDelimiter_;
 
+    // inode, dentry and s3chunkinfo tables are stored in their own column
+    // families, it's decided when opening the database
+    bool separateColumnFamilies_ = false;
+
     // open a clean database or recovery from a checkpoint
     bool cleanOpen_ = true;
 
@@ -199,6 +239,9 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
     bool InTransaction_;
     Transaction* txn_ = nullptr;
 
+    // transaction is a savepoint of the batch |txn_|
+    bool inBatch_ = false;
+
     // db options
     rocksdb::DBOptions dbOptions_;
     rocksdb::TransactionDBOptions dbTransOptions_;
@@ -278,19 +321,22 @@ class RocksDBStorageIterator : public Iterator {
                            std::string prefix,
                            size_t size,
                            int status,
-                           bool ordered)
+                           ColumnFamilyIndex cfIndex)
         : storage_(storage),
           prefix_(std::move(prefix)),
           size_(size),
           status_(status),
           prefixChecking_(true),
-          ordered_(ordered),
+          cfIndex_(cfIndex),
+          txn_(storage->CurrentTransaction()),
           iter_(nullptr) {
         RocksDBPerfGuard guard(OP_GET_SNAPSHOT);
         if (status_ == 0) {
             readOptions_ = storage_->dbReadOptions_;
-            if (storage_->InTransaction_) {
-                readOptions_.snapshot = storage_->txn_->GetSnapshot();
+            readOptions_.total_order_seek =
+                prefix_.size() < RocksDBStorage::GetPrefixSeekLength(cfIndex_);
+            if (nullptr != txn_) {
+                readOptions_.snapshot = txn_->GetSnapshot();
             } else {
                 readOptions_.snapshot = storage_->db_->GetSnapshot();
             }
@@ -300,8 +346,8 @@ class RocksDBStorageIterator : public Iterator {
     ~RocksDBStorageIterator() {
         RocksDBPerfGuard guard(OP_CLEAR_SNAPSHOT);
         if (status_ == 0) {
-            if (storage_->InTransaction_) {
-                storage_->txn_->ClearSnapshot();
+            if (nullptr != txn_) {
+                txn_->ClearSnapshot();
             } else {
                 storage_->db_->ReleaseSnapshot(readOptions_.snapshot);
             }
@@ -324,11 +370,11 @@ class RocksDBStorageIterator : public Iterator {
     }
 
     void SeekToFirst() {
-        auto handler = storage_->GetColumnFamilyHandle(ordered_);
+        auto handler = storage_->GetColumnFamilyHandle(cfIndex_);
         {
             RocksDBPerfGuard guard(OP_GET_ITERATOR);
-            if (storage_->InTransaction_) {
-                iter_.reset(storage_->txn_->GetIterator(readOptions_, handler));
+            if (nullptr != txn_) {
+                iter_.reset(txn_->GetIterator(readOptions_, handler));
             } else {
                 iter_.reset(storage_->db_->NewIterator(readOptions_, handler));
             }
@@ -379,7 +425,8 @@ class RocksDBStorageIterator : public Iterator {
     uint64_t size_;
     int status_;
     bool prefixChecking_;
-    bool ordered_;
+    ColumnFamilyIndex cfIndex_;
+    Transaction* txn_;
     std::unique_ptr<rocksdb::Iterator> iter_;
     rocksdb::ReadOptions readOptions_;
 };
@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#include "curvefs/src/metaserver/storage/slab_arena.h"
+
+#include <bvar/bvar.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace curvefs {
+namespace metaserver {
+namespace storage {
+
+namespace {
+
+// memory allocated by arenas of all tables
+bvar::Adder<int64_t> g_arena_memory_bytes(
+    "metaserver_memory_storage_arena_bytes");
+
+}  // namespace
+
+constexpr size_t SlabArena::kAlignment;
+constexpr size_t SlabArena::kMaxSlotSize;
+constexpr size_t SlabArena::kNumClasses;
+constexpr size_t SlabArena::kMinSlabSize;
+constexpr size_t SlabArena::kMaxSlabSize;
+
+SlabArena::~SlabArena() {
+    AddMemoryUsage(-static_cast<int64_t>(MemoryUsage()));
+}
+
+char* SlabArena::Allocate(size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    const size_t slotSize = SlotSize(size);
+    if (slotSize > kMaxSlotSize) {
+        AddMemoryUsage(size);
+        usedBytes_.fetch_add(size, std::memory_order_relaxed);
+        return new char[size];
+    }
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    slotBytes_ += slotSize;
+    usedBytes_.fetch_add(slotSize, std::memory_order_relaxed);
+    FreeSlot*& head = freeLists_[slotSize / kAlignment - 1];
+    if (head != nullptr) {
+        FreeSlot* slot = head;
+        head = slot->next;
+        return reinterpret_cast<char*>(slot);
+    }
+    return AllocateFromSlab(slotSize);
+}
+
+void SlabArena::Deallocate(char* ptr, size_t size) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    const size_t slotSize = SlotSize(size);
+    if (slotSize > kMaxSlotSize) {
+        delete[] ptr;
+        AddMemoryUsage(-static_cast<int64_t>(size));
+        usedBytes_.fetch_sub(size, std::memory_order_relaxed);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    FreeSlot*& head = freeLists_[slotSize / kAlignment - 1];
+    FreeSlot* slot = reinterpret_cast<FreeSlot*>(ptr);
+    slot->next = head;
+    head = slot;
+    usedBytes_.fetch_sub(slotSize, std::memory_order_relaxed);
+    slotBytes_ -= slotSize;
+    if (slotBytes_ == 0) {
+        ReleaseSlabs();
+    }
+}
+
+char* SlabArena::AllocateFromSlab(size_t slotSize) {
+    if (cursor_ == nullptr ||
+        static_cast<size_t>(limit_ - cursor_) < slotSize) {
+        // the tail of current slab is wasted, it's less than a slot
+        slabs_.emplace_back(new char[nextSlabSize_]);
+        cursor_ = slabs_.back().get();
+        limit_ = cursor_ + nextSlabSize_;
+        AddMemoryUsage(nextSlabSize_);
+        nextSlabSize_ = std::min(nextSlabSize_ * 2, kMaxSlabSize);
+    }
+
+    char* ptr = cursor_;
+    cursor_ += slotSize;
+    return ptr;
+}
+
+void SlabArena::ReleaseSlabs() {
+    if (slabs_.empty()) {
+        return;
+    }
+
+    int64_t slabBytes = 0;
+    size_t slabSize = kMinSlabSize;
+    for (size_t i = 0; i < slabs_.size(); i++) {
+        slabBytes += slabSize;
+        slabSize = std::min(slabSize * 2, kMaxSlabSize);
+    }
+
+    slabs_.clear();
+    std::fill(std::begin(freeLists_), std::end(freeLists_), nullptr);
+    cursor_ = nullptr;
+    limit_ = nullptr;
+    nextSlabSize_ = kMinSlabSize;
+    AddMemoryUsage(-slabBytes);
+}
+
+void SlabArena::AddMemoryUsage(int64_t bytes) {
+    memoryUsage_.fetch_add(bytes, std::memory_order_relaxed);
+    g_arena_memory_bytes << bytes;
+}
+
+ArenaValue::ArenaValue(SlabArena* arena, const std::string& value)
+    : ArenaValue(arena, value.size()) {
+    if (size_ > 0) {
+        std::memcpy(data_, value.data(), size_);
+    }
+}
+
+ArenaValue::ArenaValue(SlabArena* arena, size_t size)
+    : arena_(arena), size_(size) {
+    data_ = arena_->Allocate(size_);
+}
+
+void ArenaValue::Reset() {
+    if (arena_ != nullptr) {
+        arena_->Deallocate(data_, size_);
+    }
+    arena_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace curvefs
@@ -0,0 +1,197 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#ifndef CURVEFS_SRC_METASERVER_STORAGE_SLAB_ARENA_H_
+#define CURVEFS_SRC_METASERVER_STORAGE_SLAB_ARENA_H_
+
+#include <bvar/bvar.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace curvefs {
+namespace metaserver {
+namespace storage {
+
+// Allocate serialized values of a table from large slabs instead of one
+// heap allocation per value. Small values are rounded up to size classes
+// of 16 bytes, freed slots are kept in per-class free lists and reused by
+// later values of the same class. Values larger than the largest class
+// are allocated from heap directly.
+class SlabArena {
+ public:
+    SlabArena() = default;
+
+    ~SlabArena();
+
+    SlabArena(const SlabArena&) = delete;
+    SlabArena& operator=(const SlabArena&) = delete;
+
+    char* Allocate(size_t size);
+
+    // |size| must be the same as the one passed to Allocate()
+    void Deallocate(char* ptr, size_t size);
+
+    // Bytes allocated from system, including free slots
+    uint64_t MemoryUsage() const {
+        return memoryUsage_.load(std::memory_order_relaxed);
+    }
+
+    // Bytes of values which are still alive
+    uint64_t UsedBytes() const {
+        return usedBytes_.load(std::memory_order_relaxed);
+    }
+
+ private:
+    static constexpr size_t kAlignment = 16;
+    static constexpr size_t kMaxSlotSize = 1024;
+    static constexpr size_t kNumClasses = kMaxSlotSize / kAlignment;
+    static constexpr size_t kMinSlabSize = 4 * 1024;
+    static constexpr size_t kMaxSlabSize = 256 * 1024;
+
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    static size_t SlotSize(size_t size) {
+        return (size + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    char* AllocateFromSlab(size_t slotSize);
+
+    // Release all slabs once no value is alive, so a cleared table
+    // gives its memory back
+    void ReleaseSlabs();
+
+    void AddMemoryUsage(int64_t bytes);
+
+ private:
+    std::mutex mtx_;
+    FreeSlot* freeLists_[kNumClasses] = {};
+    std::vector<std::unique_ptr<char[]>> slabs_;
+    char* cursor_ = nullptr;
+    char* limit_ = nullptr;
+    size_t nextSlabSize_ = kMinSlabSize;
+    // bytes of alive slots, values larger than kMaxSlotSize are excluded
+    uint64_t slotBytes_ = 0;
+    std::atomic<uint64_t> memoryUsage_{0};
+    std::atomic<uint64_t> usedBytes_{0};
+};
+
+// A serialized value whose bytes are allocated from a SlabArena, it's
+// move-only and gives the bytes back to the arena when destroyed
+class ArenaValue {
+ public:
+    ArenaValue() = default;
+
+    ArenaValue(SlabArena* arena, const std::string& value);
+
+    // Allocate |size| bytes, they are filled by the caller via MutableData()
+    ArenaValue(SlabArena* arena, size_t size);
+
+    ~ArenaValue() { Reset(); }
+
+    ArenaValue(const ArenaValue&) = delete;
+    ArenaValue& operator=(const ArenaValue&) = delete;
+
+    ArenaValue(ArenaValue&& other) noexcept { Swap(other); }
+
+    ArenaValue& operator=(ArenaValue&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            Swap(other);
+        }
+        return *this;
+    }
+
+    void Swap(ArenaValue& other) noexcept {
+        using std::swap;
+        swap(arena_, other.arena_);
+        swap(data_, other.data_);
+        swap(size_, other.size_);
+    }
+
+    const char* Data() const { return data_; }
+
+    char* MutableData() { return data_; }
+
+    size_t Size() const { return size_; }
+
+    std::string ToString() const { return std::string(data_, size_); }
+
+    friend void swap(ArenaValue& lhs, ArenaValue& rhs) noexcept {
+        return lhs.Swap(rhs);
+    }
+
+ private:
+    void Reset();
+
+ private:
+    SlabArena* arena_ = nullptr;
+    char* data_ = nullptr;
+    uint32_t size_ = 0;
+};
+
+// Owner of a table's arena. Containers inherit it before the map type,
+// so the arena is destroyed after all values of the table.
+class ArenaHolder {
+ public:
+    SlabArena* Arena() { return &arena_; }
+
+    const SlabArena* Arena() const { return &arena_; }
+
+    // Expose memory usage and used bytes of the arena with |prefix|, they're
+    // hidden when the table is destroyed
+    void ExposeMetric(const std::string& prefix) {
+        memoryUsage_.reset(new bvar::PassiveStatus<uint64_t>(
+            prefix, "arena_memory_usage", &GetMemoryUsage, &arena_));
+        usedBytes_.reset(new bvar::PassiveStatus<uint64_t>(
+            prefix, "arena_used_bytes", &GetUsedBytes, &arena_));
+    }
+
+ private:
+    static uint64_t GetMemoryUsage(void* arena) {
+        return static_cast<SlabArena*>(arena)->MemoryUsage();
+    }
+
+    static uint64_t GetUsedBytes(void* arena) {
+        return static_cast<SlabArena*>(arena)->UsedBytes();
+    }
+
+ private:
+    SlabArena arena_;
+    std::unique_ptr<bvar::PassiveStatus<uint64_t>> memoryUsage_;
+    std::unique_ptr<bvar::PassiveStatus<uint64_t>> usedBytes_;
+};
+
+template <typename MapType>
+class ArenaContainer : public ArenaHolder, public MapType {};
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_METASERVER_STORAGE_SLAB_ARENA_H_
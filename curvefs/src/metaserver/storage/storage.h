@@ -23,6 +23,7 @@
 #ifndef CURVEFS_SRC_METASERVER_STORAGE_STORAGE_H_
 #define CURVEFS_SRC_METASERVER_STORAGE_STORAGE_H_
 
+#include <functional>
 #include <string>
 #include <memory>
 #include <vector>
@@ -105,11 +106,35 @@ class KVStorage : public BaseStorage {
 
     virtual std::shared_ptr<StorageTransaction> BeginTransaction() = 0;
 
+    // Start a write batch bound to the calling thread, all following
+    // modifications issued by this thread (including transactions) are
+    // buffered and become visible to other threads only after CommitBatch().
+    // Return false if the storage doesn't support it, in which case the
+    // modifications are applied immediately as usual.
+    virtual bool BeginBatch() { return false; }
+
+    // Commit the write batch started by BeginBatch() in the calling thread,
+    // it's ok if there is no pending batch in the calling thread
+    virtual Status CommitBatch() { return Status::OK(); }
+
     // Save storage's data into the destination directory, and return relative
     // filenames of current checkpoint under the directory
     virtual bool Checkpoint(const std::string& dir,
                             std::vector<std::string>* files) = 0;
 
+    using CheckpointDone =
+        std::function<void(bool succ, const std::vector<std::string>& files)>;
+
+    // Same as Checkpoint(), but data may be saved in background. It returns
+    // once a consistent view of storage is taken, and |done| is called with
+    // the result when the checkpoint is completed, maybe in another thread.
+    virtual void CheckpointBackground(const std::string& dir,
+                                      CheckpointDone done) {
+        std::vector<std::string> files;
+        bool succ = Checkpoint(dir, &files);
+        done(succ, files);
+    }
+
     // Recover storage from a given directory
     virtual bool Recover(const std::string& dir) = 0;
 };
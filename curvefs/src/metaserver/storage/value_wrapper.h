@@ -42,6 +42,9 @@ class ValueWrapper {
         value_->CopyFrom(value);
     }
 
+    explicit ValueWrapper(std::unique_ptr<ValueType> value)
+        : value_(std::move(value)) {}
+
     void Swap(ValueWrapper& other) noexcept {
         using std::swap;
         swap(value_, other.value_);
@@ -58,5 +58,56 @@ MetaStatusCode StreamingSendVolumeExtent(StreamConnection* connection,
     return MetaStatusCode::OK;
 }
 
+MetaStatusCode StreamingSendDentry(StreamConnection* connection,
+                                   uint32_t pageSize, std::string last,
+                                   const ListDentryPageFunc& listPage) {
+    uint64_t sent = 0;
+    while (true) {
+        DentryVec page;
+        auto st = listPage(last, &page);
+        if (st != MetaStatusCode::OK) {
+            LOG(ERROR) << "List dentry page failed, last = " << last
+                       << ", sent = " << sent
+                       << ", status = " << MetaStatusCode_Name(st);
+            connection->WriteError();
+            return st;
+        }
+
+        if (page.dentrys_size() == 0) {
+            break;
+        }
+
+        butil::IOBuf data;
+        butil::IOBufAsZeroCopyOutputStream wrapper(&data);
+        if (!page.SerializeToZeroCopyStream(&wrapper)) {
+            LOG(ERROR) << "Serialize dentry page failed, last = " << last;
+            connection->WriteError();
+            return MetaStatusCode::PARAM_ERROR;
+        }
+
+        // blocks if client can't keep up with us
+        if (!connection->Write(data)) {
+            LOG(ERROR) << "Stream write failed, last = " << last
+                       << ", sent = " << sent;
+            connection->WriteError();
+            return MetaStatusCode::RPC_STREAM_ERROR;
+        }
+
+        sent += page.dentrys_size();
+        if (static_cast<uint32_t>(page.dentrys_size()) < pageSize) {
+            break;
+        }
+        last = page.dentrys().rbegin()->name();
+    }
+
+    VLOG(9) << "StreamingSendDentry, sent " << sent << " dentries";
+    if (!connection->WriteDone()) {
+        LOG(ERROR) << "Stream write done failed in server side";
+        return MetaStatusCode::RPC_STREAM_ERROR;
+    }
+
+    return MetaStatusCode::OK;
+}
+
 }  // namespace metaserver
 }  // namespace curvefs
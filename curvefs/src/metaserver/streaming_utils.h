@@ -23,6 +23,9 @@
 #ifndef CURVEFS_SRC_METASERVER_STREAMING_UTILS_H_
 #define CURVEFS_SRC_METASERVER_STREAMING_UTILS_H_
 
+#include <functional>
+#include <string>
+
 #include "curvefs/proto/metaserver.pb.h"
 #include "curvefs/src/common/rpc_stream.h"
 
@@ -34,6 +37,16 @@ using ::curvefs::common::StreamConnection;
 MetaStatusCode StreamingSendVolumeExtent(StreamConnection* connection,
                                          const VolumeExtentSliceList& extents);
 
+// List the page of dentries after |last|
+using ListDentryPageFunc =
+    std::function<MetaStatusCode(const std::string& last, DentryVec* page)>;
+
+// Send all dentries after |last| by stream, one message per page of
+// |pageSize| entries, until a page isn't full
+MetaStatusCode StreamingSendDentry(StreamConnection* connection,
+                                   uint32_t pageSize, std::string last,
+                                   const ListDentryPageFunc& listPage);
+
 }  // namespace metaserver
 }  // namespace curvefs
 
@@ -21,6 +21,12 @@
  */
 
 #include "curvefs/src/metaserver/trash.h"
+
+#include <bvar/bvar.h>
+
+#include <iterator>
+#include <utility>
+
 #include "src/common/timeutility.h"
 #include "curvefs/proto/mds.pb.h"
 
@@ -32,9 +38,25 @@ namespace metaserver {
 using ::curvefs::mds::FsInfo;
 using ::curvefs::mds::FSStatusCode;
 
+namespace {
+
+// items waiting in the trash of all partitions
+bvar::Adder<int64_t> g_trash_backlog("metaserver_trash_backlog");
+
+}  // namespace
+
 void TrashOption::InitTrashOptionFromConf(std::shared_ptr<Configuration> conf) {
     conf->GetValueFatalIfFail("trash.scanPeriodSec", &scanPeriodSec);
     conf->GetValueFatalIfFail("trash.expiredAfterSec", &expiredAfterSec);
+    LOG_IF(WARNING, !conf->GetUInt32Value("trash.deleteBatchInodeNum",
+                                          &deleteBatchInodeNum))
+        << "Not found `trash.deleteBatchInodeNum` in conf, use default value `"
+        << deleteBatchInodeNum << '`';
+}
+
+TrashImpl::~TrashImpl() {
+    LockGuard lg(itemsMutex_);
+    g_trash_backlog << -static_cast<int64_t>(trashItems_.size());
 }
 
 void TrashImpl::Init(const TrashOption &option) {
@@ -55,6 +77,7 @@ void TrashImpl::Add(uint32_t fsId, uint64_t inodeId, uint32_t dtime) {
         return;
     }
     trashItems_.push_back(item);
+    g_trash_backlog << 1;
     VLOG(6) << "Add Trash Item success, item.fsId = " << item.fsId
             << ", item.inodeId = " << item.inodeId
             << ", item.dtime = " << item.dtime;
@@ -68,34 +91,101 @@ void TrashImpl::ScanTrash() {
         trashItems_.swap(temp);
     }
 
+    // expired items whose inodes have s3 data, data of these inodes are
+    // deleted together when the batch is full or the fs changes
+    std::list<TrashItem> batch;
+    std::list<Inode> batchInodes;
+    std::list<TrashItem> retained;
     for (auto it = temp.begin(); it != temp.end();) {
         if (isStop_) {
+            g_trash_backlog << -static_cast<int64_t>(
+                temp.size() + batch.size() + retained.size());
             return;
         }
-        if (NeedDelete(*it)) {
-            MetaStatusCode ret = DeleteInodeAndData(*it);
-            if (MetaStatusCode::NOT_FOUND == ret) {
-                it = temp.erase(it);
-                continue;
+        if (!NeedDelete(*it)) {
+            it++;
+            continue;
+        }
+
+        Inode inode;
+        MetaStatusCode ret = GetInodeToDelete(*it, &inode);
+        if (MetaStatusCode::NOT_FOUND == ret) {
+            it = temp.erase(it);
+            g_trash_backlog << -1;
+            continue;
+        }
+        if (ret != MetaStatusCode::OK) {
+            LOG(ERROR) << "GetInodeToDelete fail, fsId = " << it->fsId
+                       << ", inodeId = " << it->inodeId
+                       << ", ret = " << MetaStatusCode_Name(ret);
+            it++;
+            continue;
+        }
+
+        if (FsFileType::TYPE_S3 == inode.type()) {
+            if (!batch.empty() && batch.front().fsId != it->fsId) {
+                DeleteBatch(&batch, &batchInodes, &retained);
             }
-            if (ret != MetaStatusCode::OK) {
-                LOG(ERROR) << "DeleteInodeAndData fail, fsId = " << it->fsId
-                           << ", inodeId = " << it->inodeId
-                           << ", ret = " << MetaStatusCode_Name(ret);
-                it++;
-                continue;
+            auto next = std::next(it);
+            batch.splice(batch.end(), temp, it);
+            batchInodes.emplace_back(std::move(inode));
+            it = next;
+            if (batchInodes.size() >= options_.deleteBatchInodeNum) {
+                DeleteBatch(&batch, &batchInodes, &retained);
             }
-            VLOG(6) << "Trash Delete Inode, fsId = " << it->fsId
-                    << ", inodeId = " << it->inodeId;
-            it = temp.erase(it);
-        } else {
+            continue;
+        }
+
+        ret = DeleteInode(*it);
+        if (ret != MetaStatusCode::OK) {
             it++;
+            continue;
         }
+        it = temp.erase(it);
+        g_trash_backlog << -1;
+    }
+
+    if (!batch.empty()) {
+        DeleteBatch(&batch, &batchInodes, &retained);
     }
 
     {
         LockGuard lgItems(itemsMutex_);
         trashItems_.splice(trashItems_.end(), temp);
+        trashItems_.splice(trashItems_.end(), retained);
+    }
+}
+
+void TrashImpl::DeleteBatch(std::list<TrashItem> *batch,
+                            std::list<Inode> *inodes,
+                            std::list<TrashItem> *retained) {
+    uint32_t fsId = batch->front().fsId;
+    MetaStatusCode ret = ReinitS3Adaptor(fsId);
+    if (ret == MetaStatusCode::OK) {
+        int retVal = s3Adaptor_->DeleteInodes(*inodes);
+        if (retVal != 0) {
+            LOG(ERROR) << "S3ClientAdaptor delete s3 data failed"
+                       << ", ret = " << retVal << ", fsId = " << fsId
+                       << ", inode num = " << inodes->size();
+            ret = MetaStatusCode::S3_DELETE_ERR;
+        }
+    }
+    inodes->clear();
+
+    if (ret != MetaStatusCode::OK) {
+        retained->splice(retained->end(), *batch);
+        return;
+    }
+
+    for (auto it = batch->begin(); it != batch->end();) {
+        if (DeleteInode(*it) != MetaStatusCode::OK) {
+            auto next = std::next(it);
+            retained->splice(retained->end(), *batch, it);
+            it = next;
+            continue;
+        }
+        it = batch->erase(it);
+        g_trash_backlog << -1;
     }
 }
 
@@ -165,10 +255,10 @@ uint64_t TrashImpl::GetFsRecycleTimeHour(uint32_t fsId) {
     return recycleTimeHour;
 }
 
-MetaStatusCode TrashImpl::DeleteInodeAndData(const TrashItem &item) {
-    Inode inode;
+MetaStatusCode TrashImpl::GetInodeToDelete(const TrashItem &item,
+                                           Inode *inode) {
     MetaStatusCode ret =
-        inodeStorage_->Get(Key4Inode(item.fsId, item.inodeId), &inode);
+        inodeStorage_->Get(Key4Inode(item.fsId, item.inodeId), inode);
     if (ret != MetaStatusCode::OK) {
         LOG(WARNING) << "GetInode fail, fsId = " << item.fsId
                      << ", inodeId = " << item.inodeId
@@ -176,68 +266,82 @@ MetaStatusCode TrashImpl::DeleteInodeAndData(const TrashItem &item) {
         return ret;
     }
 
-    if (FsFileType::TYPE_FILE == inode.type()) {
+    if (FsFileType::TYPE_FILE == inode->type()) {
         // TODO(xuchaojie) : delete on volume
-    } else if (FsFileType::TYPE_S3 == inode.type()) {
-        // get s3info from mds
-        FsInfo fsInfo;
-        if (fsInfoMap_.find(item.fsId) == fsInfoMap_.end()) {
-            auto ret = mdsClient_->GetFsInfo(item.fsId, &fsInfo);
-            if (ret != FSStatusCode::OK) {
-                if (FSStatusCode::NOT_FOUND == ret) {
-                    LOG(ERROR) << "The fsName not exist, fsId = " << item.fsId;
-                    return MetaStatusCode::S3_DELETE_ERR;
-                } else {
-                    LOG(ERROR)
-                        << "GetFsInfo failed, FSStatusCode = " << ret
-                        << ", FSStatusCode_Name = " << FSStatusCode_Name(ret)
-                        << ", fsId = " << item.fsId;
-                    return MetaStatusCode::S3_DELETE_ERR;
-                }
-            }
-            fsInfoMap_.insert({item.fsId, fsInfo});
-        } else {
-            fsInfo = fsInfoMap_.find(item.fsId)->second;
-        }
-        const auto& s3Info = fsInfo.detail().s3info();
-        // reinit s3 adaptor
-        S3ClientAdaptorOption clientAdaptorOption;
-        s3Adaptor_->GetS3ClientAdaptorOption(&clientAdaptorOption);
-        clientAdaptorOption.blockSize = s3Info.blocksize();
-        clientAdaptorOption.chunkSize = s3Info.chunksize();
-        clientAdaptorOption.objectPrefix = s3Info.objectprefix();
-        s3Adaptor_->Reinit(clientAdaptorOption, s3Info.ak(), s3Info.sk(),
-            s3Info.endpoint(), s3Info.bucketname());
+    } else if (FsFileType::TYPE_S3 == inode->type()) {
         ret = inodeStorage_->PaddingInodeS3ChunkInfo(item.fsId,
-          item.inodeId, inode.mutable_s3chunkinfomap());
+          item.inodeId, inode->mutable_s3chunkinfomap());
         if (ret != MetaStatusCode::OK) {
             LOG(ERROR) << "GetInode chunklist fail, fsId = " << item.fsId
                 << ", inodeId = " << item.inodeId
                 << ", retCode = " << MetaStatusCode_Name(ret);
             return ret;
         }
-        if (inode.s3chunkinfomap().empty()) {
+        if (inode->s3chunkinfomap().empty()) {
             LOG(WARNING) << "GetInode chunklist empty, fsId = " << item.fsId
                 << ", inodeId = " << item.inodeId;
             return MetaStatusCode::NOT_FOUND;
         }
-        VLOG(9) << "DeleteInodeAndData, inode: "
-            << inode.ShortDebugString();
-        int retVal = s3Adaptor_->Delete(inode);
-        if (retVal != 0) {
-            LOG(ERROR) << "S3ClientAdaptor delete s3 data failed"
-                       << ", ret = " << retVal << ", fsId = " << item.fsId
-                       << ", inodeId = " << item.inodeId;
-            return MetaStatusCode::S3_DELETE_ERR;
-        }
+        VLOG(9) << "GetInodeToDelete, inode: "
+            << inode->ShortDebugString();
     }
-    ret = inodeStorage_->Delete(Key4Inode(item.fsId, item.inodeId));
+    return MetaStatusCode::OK;
+}
+
+MetaStatusCode TrashImpl::DeleteInode(const TrashItem &item) {
+    MetaStatusCode ret =
+        inodeStorage_->Delete(Key4Inode(item.fsId, item.inodeId));
     if (ret != MetaStatusCode::OK && ret != MetaStatusCode::NOT_FOUND) {
         LOG(ERROR) << "Delete Inode fail, fsId = " << item.fsId
                    << ", inodeId = " << item.inodeId
                    << ", ret = " << MetaStatusCode_Name(ret);
         return ret;
     }
+    VLOG(6) << "Trash Delete Inode, fsId = " << item.fsId
+            << ", inodeId = " << item.inodeId;
+    return MetaStatusCode::OK;
+}
+
+MetaStatusCode TrashImpl::GetFsInfo(uint32_t fsId, FsInfo *fsInfo) {
+    auto iter = fsInfoMap_.find(fsId);
+    if (iter != fsInfoMap_.end()) {
+        *fsInfo = iter->second;
+        return MetaStatusCode::OK;
+    }
+
+    auto ret = mdsClient_->GetFsInfo(fsId, fsInfo);
+    if (ret != FSStatusCode::OK) {
+        if (FSStatusCode::NOT_FOUND == ret) {
+            LOG(ERROR) << "The fsName not exist, fsId = " << fsId;
+        } else {
+            LOG(ERROR)
+                << "GetFsInfo failed, FSStatusCode = " << ret
+                << ", FSStatusCode_Name = " << FSStatusCode_Name(ret)
+                << ", fsId = " << fsId;
+        }
+        return MetaStatusCode::S3_DELETE_ERR;
+    }
+    fsInfoMap_.insert({fsId, *fsInfo});
+    return MetaStatusCode::OK;
+}
+
+MetaStatusCode TrashImpl::ReinitS3Adaptor(uint32_t fsId) {
+    // get s3info from mds
+    FsInfo fsInfo;
+    MetaStatusCode ret = GetFsInfo(fsId, &fsInfo);
+    if (ret != MetaStatusCode::OK) {
+        return ret;
+    }
+
+    const auto& s3Info = fsInfo.detail().s3info();
+    // reinit s3 adaptor
+    S3ClientAdaptorOption clientAdaptorOption;
+    s3Adaptor_->GetS3ClientAdaptorOption(&clientAdaptorOption);
+    clientAdaptorOption.blockSize = s3Info.blocksize();
+    clientAdaptorOption.chunkSize = s3Info.chunksize();
+    clientAdaptorOption.objectPrefix = s3Info.objectprefix();
+    s3Adaptor_->Reinit(clientAdaptorOption, s3Info.ak(), s3Info.sk(),
+        s3Info.endpoint(), s3Info.bucketname());
     return MetaStatusCode::OK;
 }
 
@@ -60,11 +60,14 @@ struct TrashItem {
 struct TrashOption {
     uint32_t scanPeriodSec;
     uint32_t expiredAfterSec;
+    // max number of inodes whose s3 data are deleted together
+    uint32_t deleteBatchInodeNum;
     std::shared_ptr<S3ClientAdaptor>  s3Adaptor;
     std::shared_ptr<MdsClient> mdsClient;
     TrashOption()
       : scanPeriodSec(0),
         expiredAfterSec(0),
+        deleteBatchInodeNum(100),
         s3Adaptor(nullptr),
         mdsClient(nullptr) {}
 
@@ -94,7 +97,7 @@ class TrashImpl : public Trash {
     explicit TrashImpl(const std::shared_ptr<InodeStorage> &inodeStorage)
       : inodeStorage_(inodeStorage) {}
 
-    ~TrashImpl() {}
+    ~TrashImpl();
 
     void Init(const TrashOption &option) override;
 
@@ -111,7 +114,18 @@ class TrashImpl : public Trash {
  private:
     bool NeedDelete(const TrashItem &item);
 
-    MetaStatusCode DeleteInodeAndData(const TrashItem &item);
+    MetaStatusCode GetInodeToDelete(const TrashItem &item, Inode *inode);
+
+    MetaStatusCode DeleteInode(const TrashItem &item);
+
+    MetaStatusCode GetFsInfo(uint32_t fsId, FsInfo *fsInfo);
+
+    MetaStatusCode ReinitS3Adaptor(uint32_t fsId);
+
+    // delete s3 data of |inodes| which belong to one fs, and then delete
+    // the inodes, items which failed are moved to |retained|
+    void DeleteBatch(std::list<TrashItem> *batch, std::list<Inode> *inodes,
+                     std::list<TrashItem> *retained);
 
     uint64_t GetFsRecycleTimeHour(uint32_t fsId);
 
@@ -267,13 +267,8 @@ void BitmapAllocator::DeAllocToBitmap(const uint64_t off, const uint64_t len) {
 
     // DeAllocToBitmap
     if (alignedRightOff > alignedLeftOff) {
-        auto curOff = alignedLeftOff;
-        while (curOff < alignedRightOff) {
-            auto idx = (curOff - bitmapAreaOffset_) / opt_.sizePerBit;
-            bitmap_.Clear(idx);
-
-            curOff += opt_.sizePerBit;
-        }
+        bitmap_.Clear(ToBitmapIndex(alignedLeftOff),
+                      ToBitmapIndex(alignedRightOff) - 1);
 
         if (unalignedLeftLen != 0) {
             DeAllocToBitmapExtent(off, unalignedLeftLen);
@@ -353,13 +348,10 @@ void BitmapAllocator::MarkUsedForBitmap(const uint64_t off,
 
     // bitmap
     if (alignedRightOff > alignedLeftOff) {
-        auto curOff = alignedLeftOff;
-        while (curOff < alignedRightOff) {
-            auto idx = ToBitmapIndex(curOff);
-            assert(bitmap_.Test(idx) == false);
-            bitmap_.Set(idx);
-            curOff += opt_.sizePerBit;
-        }
+        const auto first = ToBitmapIndex(alignedLeftOff);
+        const auto last = ToBitmapIndex(alignedRightOff) - 1;
+        assert(bitmap_.NextSetBit(first, last) == bitmap_.NO_POS);
+        bitmap_.Set(first, last);
 
         if (unalignedLeftLen != 0) {
             auto idx = ToBitmapIndex(off);
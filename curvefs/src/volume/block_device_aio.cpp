@@ -65,22 +65,14 @@ void AioReadCallBack(CurveAioContext *aio) {
     AioRead *read = reinterpret_cast<AioRead *>(reinterpret_cast<char *>(aio) -
                                                 offsetof(AioRead, aio));
 
-    {
-        std::lock_guard<std::mutex> lock(read->mtx);
-        read->done = true;
-    }
-    read->cond.notify_one();
+    read->Complete();
 }
 
 void AioWriteCallBack(CurveAioContext *aio) {
     AioWrite *write = reinterpret_cast<AioWrite *>(
         reinterpret_cast<char *>(aio) - offsetof(AioWrite, aio));
 
-    {
-        std::lock_guard<std::mutex> lock(write->mtx);
-        write->done = true;
-    }
-    write->cond.notify_one();
+    write->Complete();
 }
 
 void AioWritePaddingReadCallBack(CurveAioContext *aio) {
@@ -92,9 +84,30 @@ void AioWritePaddingReadCallBack(CurveAioContext *aio) {
 
 }  // namespace
 
+void AioBatch::OnComplete() {
+    if (1 != pending_.fetch_sub(1, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    // notify under lock, because batch is destroyed once waiter returns
+    std::lock_guard<std::mutex> lock(mtx_);
+    done_ = true;
+    cond_.notify_one();
+}
+
+void AioBatch::Wait() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cond_.wait(lock, [this]() { return done_; });
+}
+
 AioRead::AioRead(off_t offset, size_t length, char *data, FileClient *dev,
                  int fd)
-    : aio(), offset(offset), length(length), data(data), dev(dev), fd(fd) {}
+    : AioRead(offset, length, data, dev, fd, nullptr) {}
+
+AioRead::AioRead(off_t offset, size_t length, char *data, FileClient *dev,
+                 int fd, AioBatch *batch)
+    : aio(), offset(offset), length(length), data(data), dev(dev), fd(fd),
+      batch(batch) {}
 
 void AioRead::Issue() {
     if (is_aligned(offset, IO_ALIGNED_BLOCK_SIZE) &&
@@ -109,7 +122,7 @@ void AioRead::Issue() {
         int ret = dev->AioRead(fd, &aio);
         if (ret < 0) {
             LOG(ERROR) << "Failed to issue aio read: " << &aio;
-            done = true;
+            Complete();
         }
 
         return;
@@ -134,14 +147,33 @@ void AioRead::Issue() {
     int ret = dev->AioRead(fd, &aio);
     if (ret < 0) {
         LOG(ERROR) << "Failed to issue aio read: " << &aio;
-        done = true;
+        Complete();
     }
 }
 
 ssize_t AioRead::Wait() {
-    std::unique_lock<std::mutex> lock(mtx);
-    cond.wait(lock, [this]() { return done; });
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [this]() { return done; });
+    }
+
+    return Result();
+}
+
+void AioRead::Complete() {
+    if (batch != nullptr) {
+        batch->OnComplete();
+        return;
+    }
 
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+    }
+    cond.notify_one();
+}
+
+ssize_t AioRead::Result() {
     if (static_cast<ssize_t>(aio.ret) != static_cast<ssize_t>(aio.length)) {
         LOG(ERROR) << "AioRead error: " << &aio;
         return -1;
@@ -157,7 +189,12 @@ ssize_t AioRead::Wait() {
 
 AioWrite::AioWrite(off_t offset, size_t length, const char *data,
                    FileClient *dev, int fd)
-    : offset(offset), length(length), data(data), dev(dev), fd(fd) {}
+    : AioWrite(offset, length, data, dev, fd, nullptr) {}
+
+AioWrite::AioWrite(off_t offset, size_t length, const char *data,
+                   FileClient *dev, int fd, AioBatch *batch)
+    : offset(offset), length(length), data(data), dev(dev), fd(fd),
+      batch(batch) {}
 
 void AioWrite::Issue() {
     if (is_aligned(offset, IO_ALIGNED_BLOCK_SIZE) &&
@@ -172,7 +209,7 @@ void AioWrite::Issue() {
         int ret = dev->AioWrite(fd, &aio);
         if (ret < 0) {
             LOG(ERROR) << "Failed to issue aio write: " << &aio;
-            done = true;
+            Complete();
         }
 
         return;
@@ -238,9 +275,28 @@ void AioWrite::Issue() {
 }
 
 ssize_t AioWrite::Wait() {
-    std::unique_lock<std::mutex> lock(mtx);
-    cond.wait(lock, [this]() { return done; });
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [this]() { return done; });
+    }
+
+    return Result();
+}
 
+void AioWrite::Complete() {
+    if (batch != nullptr) {
+        batch->OnComplete();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+    }
+    cond.notify_one();
+}
+
+ssize_t AioWrite::Result() {
     if (static_cast<ssize_t>(aio.ret) != static_cast<ssize_t>(aio.length) ||
         (aux != nullptr && aux->error.load(std::memory_order_acquire))) {
         LOG(ERROR) << "AioWrite error: " << &aio;
@@ -262,11 +318,7 @@ void AioWrite::OnPaddingReadComplete(CurveAioContext *read) {
 
     // padding read error
     if (aux->error.load(std::memory_order_acquire)) {
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            done = true;
-        }
-        cond.notify_one();
+        Complete();
         return;
     }
 
@@ -283,11 +335,7 @@ void AioWrite::OnPaddingReadComplete(CurveAioContext *read) {
     int ret = dev->AioWrite(fd, &aio);
     if (ret < 0) {
         LOG(ERROR) << "Failed to issue aio write: " << &aio;
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            done = true;
-        }
-        cond.notify_one();
+        Complete();
     }
 }
 
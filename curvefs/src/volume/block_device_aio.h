@@ -42,6 +42,29 @@ namespace volume {
 
 using ::curve::client::FileClient;
 
+// Completion of a group of aio requests which are issued together, the
+// waiter is woken up once by the last finished request instead of waiting
+// for each request in turn.
+class AioBatch {
+ public:
+    explicit AioBatch(int count) : pending_(count) {}
+
+    AioBatch(const AioBatch&) = delete;
+    AioBatch& operator=(const AioBatch&) = delete;
+
+    // Called once by each request of the batch when it's finished.
+    void OnComplete();
+
+    // Wait until all requests of the batch are finished.
+    void Wait();
+
+ private:
+    std::atomic<int> pending_;
+    bool done_ = false;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+};
+
 struct AioRead {
     // aio context
     CurveAioContext aio;
@@ -69,8 +92,18 @@ struct AioRead {
     // padding read request if necessary
     std::unique_ptr<Padding> padding;
 
+    // batch this request belongs to, or nullptr if it's waited alone
+    AioBatch* batch = nullptr;
+
     AioRead(off_t offset, size_t length, char* data, FileClient* dev, int fd);
 
+    AioRead(off_t offset,
+            size_t length,
+            char* data,
+            FileClient* dev,
+            int fd,
+            AioBatch* batch);
+
     // Issue the read request.
     void Issue();
 
@@ -78,6 +111,12 @@ struct AioRead {
     // Return read bytes if succeeded, other return values mean an error
     // occurred.
     ssize_t Wait();
+
+    // Return value is the same as Wait(), but request must be finished,
+    // it's used after the batch of this request is finished.
+    ssize_t Result();
+
+    void Complete();
 };
 
 struct AioWrite {
@@ -122,12 +161,22 @@ struct AioWrite {
 
     std::unique_ptr<PaddingAux> aux;
 
+    // batch this request belongs to, or nullptr if it's waited alone
+    AioBatch* batch = nullptr;
+
     AioWrite(off_t offset,
              size_t length,
              const char* data,
              FileClient* dev,
              int fd);
 
+    AioWrite(off_t offset,
+             size_t length,
+             const char* data,
+             FileClient* dev,
+             int fd,
+             AioBatch* batch);
+
     // Issue the write request.
     void Issue();
 
@@ -136,6 +185,12 @@ struct AioWrite {
     // occurred.
     ssize_t Wait();
 
+    // Return value is the same as Wait(), but request must be finished,
+    // it's used after the batch of this request is finished.
+    ssize_t Result();
+
+    void Complete();
+
     void OnPaddingReadComplete(CurveAioContext* read);
 };
 
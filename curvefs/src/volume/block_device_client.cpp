@@ -47,6 +47,66 @@ namespace {
 bvar::LatencyRecorder g_write_latency("block_device_write");
 bvar::LatencyRecorder g_read_latency("block_device_read");
 
+// Merge parts which are contiguous both on device and in memory, so that
+// extents of one request which are allocated next to each other are
+// issued as one device io. It also prevents concurrent read-modify-write
+// of the same aligned block by adjacent unaligned parts.
+template <typename Part>
+std::vector<Part> MergeContiguousParts(const std::vector<Part>& iov) {
+    std::vector<Part> merged;
+    merged.reserve(iov.size());
+
+    for (const auto& io : iov) {
+        if (!merged.empty()) {
+            auto& last = merged.back();
+            if (last.offset + static_cast<off_t>(last.length) == io.offset &&
+                last.data + last.length == io.data) {
+                last.length += io.length;
+                continue;
+            }
+        }
+
+        merged.push_back(io);
+    }
+
+    return merged;
+}
+
+// Issue all parts at once and wait for them together, the caller is woken
+// up by the last finished part
+template <typename Request, typename Part>
+ssize_t SubmitBatch(const std::vector<Part>& iov, FileClient* dev, int fd) {
+    AioBatch batch(iov.size());
+    std::vector<std::unique_ptr<Request>> requests;
+    requests.reserve(iov.size());
+
+    for (const auto& io : iov) {
+        requests.push_back(absl::make_unique<Request>(
+            io.offset, io.length, io.data, dev, fd, &batch));
+    }
+
+    for (const auto& r : requests) {
+        r->Issue();
+    }
+
+    batch.Wait();
+
+    bool error = false;
+    ssize_t total = 0;
+    for (const auto& r : requests) {
+        auto nr = r->Result();
+        if (nr < 0) {
+            error = true;
+            LOG(ERROR) << "Block device io error, offset: " << r->offset
+                       << ", length: " << r->length;
+        } else {
+            total += nr;
+        }
+    }
+
+    return error ? -1 : total;
+}
+
 }  // namespace
 
 BlockDeviceClientImpl::BlockDeviceClientImpl()
@@ -144,30 +204,18 @@ ssize_t BlockDeviceClientImpl::Readv(const std::vector<ReadPart> &iov) {
         return Read(iov[0].data, iov[0].offset, iov[0].length);
     }
 
-    std::vector<std::unique_ptr<AioRead>> requests;
-    requests.reserve(iov.size());
-
-    for (const auto &io : iov) {
-        requests.push_back(absl::make_unique<AioRead>(
-            io.offset, io.length, io.data, fileClient_.get(), fd_));
-
-        requests.back()->Issue();
+    if (fd_ < 0) {
+        return -1;
+    } else if (iov.empty()) {
+        return 0;
     }
 
-    bool error = false;
-    ssize_t total = 0;
-    for (const auto &r : requests) {
-        auto nr = r->Wait();
-        if (nr < 0) {
-            error = true;
-            LOG(ERROR) << "AioRead error, offset: " << r->offset
-                       << ", length: " << r->length;
-        } else {
-            total += nr;
-        }
+    auto merged = MergeContiguousParts(iov);
+    if (merged.size() == 1) {
+        return Read(merged[0].data, merged[0].offset, merged[0].length);
     }
 
-    return error ? -1 : total;
+    return SubmitBatch<AioRead>(merged, fileClient_.get(), fd_);
 }
 
 ssize_t BlockDeviceClientImpl::Write(const char *buf, off_t offset,
@@ -192,30 +240,18 @@ ssize_t BlockDeviceClientImpl::Writev(const std::vector<WritePart> &iov) {
         return Write(iov[0].data, iov[0].offset, iov[0].length);
     }
 
-    std::vector<std::unique_ptr<AioWrite>> requests;
-    requests.reserve(iov.size());
-
-    for (const auto &io : iov) {
-        requests.push_back(absl::make_unique<AioWrite>(
-            io.offset, io.length, io.data, fileClient_.get(), fd_));
-
-        requests.back()->Issue();
+    if (fd_ < 0) {
+        return -1;
+    } else if (iov.empty()) {
+        return 0;
     }
 
-    bool error = false;
-    ssize_t total = 0;
-    for (const auto &r : requests) {
-        auto nr = r->Wait();
-        if (nr < 0) {
-            error = true;
-            LOG(ERROR) << "AioWrite error, offset: " << r->offset
-                       << ", length: " << r->length;
-        } else {
-            total += nr;
-        }
+    auto merged = MergeContiguousParts(iov);
+    if (merged.size() == 1) {
+        return Write(merged[0].data, merged[0].offset, merged[0].length);
     }
 
-    return error ? -1 : total;
+    return SubmitBatch<AioWrite>(merged, fileClient_.get(), fd_);
 }
 
 bool BlockDeviceClientImpl::WritePadding(char *writeBuffer, off_t writeStart,
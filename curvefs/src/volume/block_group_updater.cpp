@@ -24,15 +24,23 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <mutex>
 
 #include "absl/memory/memory.h"
 #include "curvefs/src/volume/block_device_client.h"
+#include "include/client/libcurve.h"
+#include "src/common/fast_align.h"
 
 namespace curvefs {
 namespace volume {
 
+using ::curve::common::align_down;
+using ::curve::common::align_up;
+using ::curve::common::BITMAP_UNIT_SIZE;
+
 void BlockGroupBitmapUpdater::Update(const Extent& ext, Op op) {
     assert(ext.len != 0);
     std::lock_guard<std::mutex> lk(bitmapMtx_);
@@ -48,35 +56,75 @@ void BlockGroupBitmapUpdater::Update(const Extent& ext, Op op) {
         bitmap_.Clear(startIdx, endIdx);
     }
 
-    dirty_ = true;
+    MarkDirtyLocked(startIdx / BITMAP_UNIT_SIZE,
+                    endIdx / BITMAP_UNIT_SIZE + 1);
+    ++version_;
 }
 
-bool BlockGroupBitmapUpdater::Sync() {
-    std::unique_ptr<char[]> bitmap;
-    std::lock_guard<std::mutex> lk(syncMtx_);
+void BlockGroupBitmapUpdater::MarkDirtyLocked(uint64_t begin, uint64_t end) {
+    if (dirtyBegin_ == dirtyEnd_) {
+        dirtyBegin_ = begin;
+        dirtyEnd_ = end;
+        return;
+    }
 
+    dirtyBegin_ = std::min(dirtyBegin_, begin);
+    dirtyEnd_ = std::max(dirtyEnd_, end);
+}
+
+bool BlockGroupBitmapUpdater::Sync() {
+    uint64_t target = 0;
     {
         std::lock_guard<std::mutex> lk(bitmapMtx_);
+        target = version_;
+    }
 
-        if (!dirty_) {
+    std::lock_guard<std::mutex> syncLk(syncMtx_);
+    if (syncedVersion_ >= target) {
+        return true;
+    }
+
+    // write the dirty part which is aligned to io block of backend storage,
+    // so no extra padding read is issued
+    std::unique_ptr<char[]> bitmap;
+    uint64_t begin = 0;
+    uint64_t end = 0;
+    uint64_t version = 0;
+    {
+        std::lock_guard<std::mutex> lk(bitmapMtx_);
+        if (dirtyBegin_ == dirtyEnd_) {
+            syncedVersion_ = version_;
             return true;
         }
 
-        bitmap = absl::make_unique<char[]>(bitmapRange_.length);
-        mempcpy(bitmap.get(), bitmap_.GetBitmap(), bitmapRange_.length);
-        dirty_ = false;
-    }
+        const uint64_t start = bitmapRange_.offset;
+        begin = align_down(start + dirtyBegin_, IO_ALIGNED_BLOCK_SIZE);
+        begin = std::max(begin, start) - start;
+        end = align_up(start + dirtyEnd_, IO_ALIGNED_BLOCK_SIZE);
+        end = std::min(end - start, bitmapRange_.length);
 
-    auto ret = blockDev_->Write(bitmap.get(), bitmapRange_.offset,
-                                bitmapRange_.length);
+        bitmap = absl::make_unique<char[]>(end - begin);
+        std::memcpy(bitmap.get(), bitmap_.GetBitmap() + begin, end - begin);
+        version = version_;
+        dirtyBegin_ = dirtyEnd_ = 0;
+    }
 
-    if (ret < 0 || static_cast<size_t>(ret) != bitmapRange_.length) {
+    const size_t length = end - begin;
+    auto ret = blockDev_->Write(bitmap.get(), bitmapRange_.offset + begin,
+                                length);
+    if (ret < 0 || static_cast<size_t>(ret) != length) {
         LOG(ERROR) << "Sync block group bitmap failed, err: " << ret
-                   << ", block group offset: " << groupOffset_;
+                   << ", block group offset: " << groupOffset_
+                   << ", bitmap offset: " << bitmapRange_.offset + begin
+                   << ", length: " << length;
+
+        // written part is unknown, so sync it again next time
+        std::lock_guard<std::mutex> lk(bitmapMtx_);
+        MarkDirtyLocked(begin, end);
         return false;
     }
 
-    dirty_ = false;
+    syncedVersion_ = version;
     return true;
 }
 
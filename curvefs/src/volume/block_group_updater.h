@@ -50,8 +50,7 @@ class BlockGroupBitmapUpdater {
                             uint64_t groupOffset,
                             const BitmapRange& range,
                             BlockDeviceClient* blockDev)
-        : dirty_(false),
-          bitmap_(std::move(bitmap)),
+        : bitmap_(std::move(bitmap)),
           blockSize_(blockSize),
           groupSize_(groupSize),
           groupOffset_(groupOffset),
@@ -67,21 +66,35 @@ class BlockGroupBitmapUpdater {
     void Update(const Extent& ext, Op op);
 
     /**
-     * @brief Sync bitmap to backend storage if dirty
+     * @brief Sync bitmap to backend storage if dirty, only the changed part
+     *        is written. Concurrent callers are coalesced, a caller returns
+     *        directly if its updates are already written by others.
      * @return return true if success, otherwise, return false
      */
     bool Sync();
 
+ private:
+    // merge bytes [begin, end) of bitmap into dirty range
+    void MarkDirtyLocked(uint64_t begin, uint64_t end);
+
  private:
     std::mutex bitmapMtx_;
     std::mutex syncMtx_;
-    bool dirty_;
     Bitmap bitmap_;
     uint32_t blockSize_;
     uint32_t groupSize_;
     uint64_t groupOffset_;
     BitmapRange bitmapRange_;
     BlockDeviceClient* blockDev_;
+
+    // changed bytes of bitmap which are not synced, protected by bitmapMtx_
+    uint64_t dirtyBegin_ = 0;
+    uint64_t dirtyEnd_ = 0;
+
+    // increased by each update, protected by bitmapMtx_
+    uint64_t version_ = 0;
+    // all updates before this version are synced, protected by syncMtx_
+    uint64_t syncedVersion_ = 0;
 };
 
 }  // namespace volume
@@ -25,6 +25,7 @@
 #include <glog/logging.h>
 
 #include <iostream>
+#include <iterator>
 #include <ostream>
 #include <sstream>
 #include <utility>
@@ -45,9 +46,10 @@ FreeExtents::FreeExtents(const uint64_t off, const uint64_t len)
       maxExtentSize_(0),
       available_(len),
       extents_(),
+      sizeIndex_(),
       blocks_() {
     if (len != 0) {
-        extents_.emplace(off, maxLength_);
+        InsertExtent(off, maxLength_);
     }
 }
 
@@ -58,6 +60,7 @@ FreeExtents::FreeExtents(const uint64_t maxExtentSize)
       maxExtentSize_(maxExtentSize),
       available_(0),
       extents_(),
+      sizeIndex_(),
       blocks_() {}
 
 FreeExtents::FreeExtents(const uint64_t maxExtentSize,
@@ -69,8 +72,46 @@ FreeExtents::FreeExtents(const uint64_t maxExtentSize,
       maxExtentSize_(maxExtentSize),
       available_(0),
       extents_(),
+      sizeIndex_(),
       blocks_() {}
 
+FreeExtents::ExtentIter FreeExtents::InsertExtent(uint64_t off,
+                                                  uint64_t len) {
+    auto r = extents_.emplace(off, len);
+    if (r.second) {
+        sizeIndex_.emplace(len, off);
+    }
+    return r.first;
+}
+
+FreeExtents::ExtentIter FreeExtents::EraseExtent(ExtentIter iter) {
+    sizeIndex_.erase({iter->second, iter->first});
+    return extents_.erase(iter);
+}
+
+void FreeExtents::ResizeExtent(ExtentIter iter, uint64_t len) {
+    sizeIndex_.erase({iter->second, iter->first});
+    iter->second = len;
+    sizeIndex_.emplace(len, iter->first);
+}
+
+uint64_t FreeExtents::AllocFromExtent(ExtentIter iter,
+                                      uint64_t need,
+                                      std::vector<Extent>* exts) {
+    const uint64_t off = iter->first;
+    const uint64_t len = iter->second;
+    EraseExtent(iter);
+
+    if (len <= need) {
+        exts->emplace_back(off, len);
+        return len;
+    }
+
+    exts->emplace_back(off, need);
+    InsertExtent(off + need, len - need);
+    return need;
+}
+
 uint64_t FreeExtents::AllocInternal(const uint64_t size,
                                     const AllocateHint& hint,
                                     std::vector<Extent>* exts) {
@@ -79,31 +120,15 @@ uint64_t FreeExtents::AllocInternal(const uint64_t size,
     }
 
     uint64_t need = size;
-    std::map<uint64_t, uint64_t>::const_iterator iter;
+    ExtentIter iter;
 
     // 1. find extents that satisfy hint.leftOffset
     if (hint.leftOffset != AllocateHint::INVALID_OFFSET) {
-        iter = extents_.lower_bound(hint.leftOffset);
-
-        if (iter != extents_.end() && iter->first == hint.leftOffset) {
-            if (iter->second >= need) {
-                exts->emplace_back(iter->first, need);
-
-                if (iter->second == need) {
-                    extents_.erase(iter);
-                } else {
-                    auto newOff = iter->first + need;
-                    auto newLen = iter->second - need;
-                    extents_.erase(iter);
-                    extents_.emplace(newOff, newLen);
-                }
-
+        iter = extents_.find(hint.leftOffset);
+        if (iter != extents_.end()) {
+            need -= AllocFromExtent(iter, need, exts);
+            if (need == 0) {
                 return size;
-            } else {
-                need -= iter->second;
-                exts->emplace_back(iter->first, iter->second);
-
-                extents_.erase(iter);
             }
         }
     }
@@ -111,74 +136,30 @@ uint64_t FreeExtents::AllocInternal(const uint64_t size,
     // 2. find extents that satisfy hint.rightOffset
     if (hint.rightOffset != AllocateHint::INVALID_OFFSET &&
         hint.rightOffset >= need) {
-        iter = extents_.lower_bound(hint.rightOffset - need);
-        if (iter != extents_.end() &&
-            iter->first == (hint.rightOffset - need)) {
-            if (iter->second >= need) {
-                exts->emplace_back(iter->first, need);
-
-                if (iter->second == need) {
-                    extents_.erase(iter);
-                } else {
-                    auto newOff = iter->first + need;
-                    auto newLen = iter->second - need;
-                    extents_.erase(iter);
-                    extents_.emplace(newOff, newLen);
-                }
-
+        iter = extents_.find(hint.rightOffset - need);
+        if (iter != extents_.end()) {
+            need -= AllocFromExtent(iter, need, exts);
+            if (need == 0) {
                 return size;
-            } else {
-                need -= iter->second;
-                exts->emplace_back(iter->first, iter->second);
-
-                extents_.erase(iter);
             }
         }
     }
 
     // both leftOffset and rightOffset aren't satisfied
-    // first loop find a extent that satisfy needed size
-    iter = extents_.begin();
-    while (iter != extents_.end()) {
-        if (iter->second >= need) {
-            exts->emplace_back(iter->first, need);
-
-            // modify this extents
-            if (iter->second == need) {
-                extents_.erase(iter);
-            } else {
-                auto newOff = iter->first + need;
-                auto newLen = iter->second - need;
-                extents_.erase(iter);
-                extents_.emplace(newOff, newLen);
-            }
-
-            return size;
-        } else {
-            ++iter;
-        }
+    // find the smallest extent that satisfy needed size, and the one with
+    // lowest offset is chosen if there are several
+    auto fit = sizeIndex_.lower_bound({need, 0});
+    if (fit != sizeIndex_.end()) {
+        AllocFromExtent(extents_.find(fit->second), need, exts);
+        return size;
     }
 
-    // second loop consume all existing extent
+    // no extent is large enough, consume existing extents from lowest offset
     iter = extents_.begin();
     while (need > 0 && iter != extents_.end()) {
-        if (iter->second <= need) {
-            need -= iter->second;
-            exts->emplace_back(iter->first, iter->second);
-
-            // remove this extent
-            iter = extents_.erase(iter);
-        } else {  // iter->second > need
-            exts->emplace_back(iter->first, need);
-
-            auto newOff = iter->first + need;
-            auto newLen = iter->second - need;
-
-            extents_.erase(iter);
-            extents_.emplace(newOff, newLen);
-
-            return size;
-        }
+        auto next = std::next(iter);
+        need -= AllocFromExtent(iter, need, exts);
+        iter = next;
     }
 
     return size - need;
@@ -218,7 +199,7 @@ void FreeExtents::DeAllocInternal(const uint64_t off, const uint64_t len) {
 
     if (available_ == 0) {
         // FIXME: off/len may need recycle to blocks
-        extents_.emplace(off, len);
+        InsertExtent(off, len);
         return;
     }
 
@@ -228,23 +209,23 @@ void FreeExtents::DeAllocInternal(const uint64_t off, const uint64_t len) {
     if (iter != extents_.begin()) {
         --iter;
     }
-    if ((iter->first + iter->second) == off) {
-        iter->second += len;
+    if (iter != extents_.end() && (iter->first + iter->second) == off) {
+        ResizeExtent(iter, iter->second + len);
         curIter = iter;
     } else {
         // TODO(wuhanqing): should tackle iter->first + iter->second > off ?
-        auto r = extents_.emplace(off, len);
-        curIter = r.first;
+        curIter = InsertExtent(off, len);
     }
 
     // try merge with right extent
     const auto endOff = curIter->first + curIter->second;
-    iter = extents_.lower_bound(endOff);
-    if (iter != extents_.end() && iter->first == endOff) {
-        curIter->second += iter->second;
+    iter = extents_.find(endOff);
+    if (iter != extents_.end()) {
+        const auto rightLen = iter->second;
 
         // erase current iterator
-        extents_.erase(iter);
+        EraseExtent(iter);
+        ResizeExtent(curIter, curIter->second + rightLen);
     }
 
     // split it if it's big enough
@@ -256,21 +237,21 @@ void FreeExtents::DeAllocInternal(const uint64_t off, const uint64_t len) {
             }
 
             blocks_.emplace(curIter->first, curIter->second);
-            extents_.erase(curIter);
+            EraseExtent(curIter);
             return;
         } else {
             auto start = curIter->first;
             auto end = start + curIter->second;
-            extents_.erase(curIter);
+            EraseExtent(curIter);
 
             auto alignStart = align_up(start, maxExtentSize_);
             auto alignEnd = align_down(end, maxExtentSize_);
 
             if (start != alignStart) {
-                extents_.emplace(start, alignStart - start);
+                InsertExtent(start, alignStart - start);
             }
             if (end != alignEnd) {
-                extents_.emplace(alignEnd, end - alignEnd);
+                InsertExtent(alignEnd, end - alignEnd);
             }
 
             while (alignStart < alignEnd) {
@@ -291,12 +272,12 @@ void FreeExtents::MarkUsedInternal(const uint64_t off, const uint64_t len) {
     auto iter = extents_.lower_bound(off);
     if (iter != extents_.end() && iter->first == off) {
         if (iter->first == off && iter->second == len) {
-            extents_.erase(iter);
+            EraseExtent(iter);
         } else {
             auto newOff = iter->first + len;
             auto newLen = iter->second - len;
-            extents_.erase(iter);
-            extents_.emplace(newOff, newLen);
+            EraseExtent(iter);
+            InsertExtent(newOff, newLen);
         }
     } else {
         if (iter != extents_.begin()) {
@@ -304,19 +285,14 @@ void FreeExtents::MarkUsedInternal(const uint64_t off, const uint64_t len) {
         }
 
         if ((iter->first + iter->second) == (off + len)) {
-            auto newOff = iter->first;
-            auto newLen = iter->second - len;
-            extents_.erase(iter);
-            extents_.emplace(newOff, newLen);
+            ResizeExtent(iter, iter->second - len);
         } else {
             // [off, len] is in the middle of [iter->first, iter->second]
-            auto leftOff = iter->first;
             auto leftLen = off - iter->first;
             auto rightOff = off + len;
             auto rightLen = (iter->first + iter->second) - rightOff;
-            extents_.erase(iter);
-            extents_.emplace(leftOff, leftLen);
-            extents_.emplace(rightOff, rightLen);
+            ResizeExtent(iter, leftLen);
+            InsertExtent(rightOff, rightLen);
         }
     }
 }
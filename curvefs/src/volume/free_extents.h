@@ -25,6 +25,8 @@
 
 #include <cstdint>
 #include <map>
+#include <set>
+#include <utility>
 #include <vector>
 #include <cassert>
 
@@ -110,6 +112,8 @@ class FreeExtents {
     friend std::ostream& operator<<(std::ostream& os, const FreeExtents& e);
 
  private:
+    using ExtentIter = std::map<uint64_t, uint64_t>::iterator;
+
     uint64_t AllocInternal(uint64_t size,
                            const AllocateHint& hint,
                            std::vector<Extent>* exts);
@@ -118,6 +122,20 @@ class FreeExtents {
 
     void MarkUsedInternal(const uint64_t off, const uint64_t len);
 
+    // Below functions keep |extents_| and |sizeIndex_| consistent, all
+    // modifications of |extents_| should go through them
+    ExtentIter InsertExtent(uint64_t off, uint64_t len);
+
+    ExtentIter EraseExtent(ExtentIter iter);
+
+    void ResizeExtent(ExtentIter iter, uint64_t len);
+
+    // Allocate at most |need| bytes from the beginning of |iter|,
+    // return allocated size
+    uint64_t AllocFromExtent(ExtentIter iter,
+                             uint64_t need,
+                             std::vector<Extent>* exts);
+
  private:
     const uint64_t startOffset_;
     const uint64_t length_;
@@ -125,7 +143,11 @@ class FreeExtents {
     const uint64_t maxExtentSize_;
     uint64_t available_;
 
+    // free extents indexed by offset
     std::map<uint64_t, uint64_t> extents_;
+    // the same free extents indexed by <length, offset>, it's used for
+    // finding the smallest extent which is large enough
+    std::set<std::pair<uint64_t, uint64_t>> sizeIndex_;
     std::map<uint64_t, uint64_t> blocks_;
 };
 
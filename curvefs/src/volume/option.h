@@ -57,6 +57,19 @@ struct SpaceManagerOption {
 
     double threshold{1.0};
     uint64_t releaseInterSec{300};
+
+    // number of block groups' space kept in reserve, more block groups are
+    // allocated in background once available space is less than it,
+    // 0 means block groups are only allocated when space is exhausted
+    uint32_t reservedBlockGroups{0};
+
+    // milliseconds to wait before refilling again after a failed refill,
+    // it's doubled after each consecutive failure
+    uint32_t refillRetryIntervalMs{1000};
+
+    // number of threads which write bitmaps of different block groups back
+    // in parallel, bitmaps are written by the calling thread if it's 0
+    uint32_t bitmapSyncThreads{4};
 };
 
 }  // namespace volume
@@ -25,21 +25,41 @@
 #include <butil/time.h>
 #include <bvar/bvar.h>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>  // NOLINT
+#include <set>
 #include <unordered_set>
 #include <utility>
 
 #include "absl/cleanup/cleanup.h"
 #include "curvefs/src/volume/common.h"
+#include "src/common/concurrent/count_down_event.h"
 #include "src/common/fast_align.h"
 
 namespace curvefs {
 namespace volume {
 
 using ::curve::common::align_down;
+using ::curve::common::CountDownEvent;
 using ::curve::common::ReadLockGuard;
 using ::curve::common::WriteLockGuard;
 
+namespace {
+
+// upper bound of waiting after consecutive failed refills
+constexpr uint64_t kMaxRefillRetryIntervalMs = 30 * 1000;
+
+// Block group which current thread allocated from last time
+struct AllocateCursor {
+    const SpaceManager* owner = nullptr;
+    uint64_t blockGroupOffset = 0;
+};
+
+thread_local AllocateCursor allocateCursor;
+
+}  // namespace
+
 SpaceManagerImpl::SpaceManagerImpl(
     const SpaceManagerOption &option,
     const std::shared_ptr<MdsClient> &mdsClient,
@@ -50,8 +70,11 @@ SpaceManagerImpl::SpaceManagerImpl(
       blockGroupManager_(new BlockGroupManagerImpl(
           this, mdsClient, blockDev, option.blockGroupManagerOption,
           option.allocatorOption)),
-      allocating_(false), threshold_(option.threshold),
-      releaseInterSec_(option.releaseInterSec) {}
+      threshold_(option.threshold),
+      releaseInterSec_(option.releaseInterSec),
+      reservedBytes_(option.reservedBlockGroups * blockGroupSize_),
+      refillRetryIntervalMs_(option.refillRetryIntervalMs),
+      bitmapSyncThreads_(option.bitmapSyncThreads) {}
 
 bool SpaceManagerImpl::Alloc(uint32_t size,
                              const AllocateHint& hint,
@@ -61,8 +84,9 @@ bool SpaceManagerImpl::Alloc(uint32_t size,
     butil::Timer timer;
     timer.start();
 
+    const size_t begin = extents->size();
     if (availableBytes_.load(std::memory_order_acquire) < size) {
-        auto ret = AllocateBlockGroup(size);
+        auto ret = AllocateBlockGroupSync(size);
         if (!ret) {
             LOG(ERROR) << "Allocate block group error";
             metric_.errorCount << 1;
@@ -75,10 +99,11 @@ bool SpaceManagerImpl::Alloc(uint32_t size,
         auto allocated = AllocInternal(left, hint, extents);
         availableBytes_.fetch_sub(allocated, std::memory_order_relaxed);
         if (allocated < left) {
-            auto ret = AllocateBlockGroup(left);
+            auto ret = AllocateBlockGroupSync(left);
             if (!ret) {
                 LOG(ERROR) << "Allocate block group error";
                 metric_.errorCount << 1;
+                RollbackAlloc(extents, begin, false);
                 return false;
             }
         }
@@ -89,9 +114,12 @@ bool SpaceManagerImpl::Alloc(uint32_t size,
     if (!ret) {
         LOG(ERROR) << "Update bitmap failed";
         metric_.errorCount << 1;
+        RollbackAlloc(extents, begin, true);
         return false;
     }
 
+    TriggerRefill();
+
     timer.stop();
     metric_.allocLatency << timer.u_elapsed();
     metric_.allocSize << size;
@@ -132,6 +160,94 @@ bool SpaceManagerImpl::DeAlloc(uint64_t blockGroupOffset,
     return true;
 }
 
+bool SpaceManagerImpl::Free(const std::vector<Extent>& extents) {
+    butil::Timer timer;
+    timer.start();
+
+    std::set<uint64_t> blockGroups;
+    for (const auto& ext : extents) {
+        blockGroups.insert(align_down(ext.offset, blockGroupSize_));
+    }
+
+    // block group may be released after these extents are allocated
+    for (auto offset : blockGroups) {
+        if (!AcquireBlockGroup(offset)) {
+            LOG(WARNING) << "Acquire block group failed, block group offset: "
+                         << offset;
+            return false;
+        }
+    }
+
+    if (!UpdateBitmap(extents, BlockGroupBitmapUpdater::Op::Clear)) {
+        LOG(ERROR) << "Free update bitmap failed";
+        metric_.errorCount << 1;
+        return false;
+    }
+
+    uint64_t size = DeAllocFromAllocators(extents);
+    availableBytes_.fetch_add(size, std::memory_order_relaxed);
+
+    timer.stop();
+    metric_.deallocLatency << timer.u_elapsed();
+    metric_.allocSize << -size;
+
+    VLOG(9) << "Free success, " << extents;
+    return true;
+}
+
+uint64_t SpaceManagerImpl::DeAllocFromAllocators(
+    const std::vector<Extent>& extents) {
+    uint64_t size = 0;
+    ReadLockGuard lk(allocatorsLock_);
+    for (const auto& ext : extents) {
+        auto it = allocators_.find(align_down(ext.offset, blockGroupSize_));
+        CHECK(it != allocators_.end()) << "extent: " << ext;
+        if (!it->second->DeAlloc(ext.offset, ext.len)) {
+            LOG(WARNING) << "Free extent from allocator failed, " << ext;
+            continue;
+        }
+        size += ext.len;
+    }
+
+    return size;
+}
+
+void SpaceManagerImpl::RollbackAlloc(std::vector<Extent>* extents,
+                                     size_t begin, bool clearBitmap) {
+    std::vector<Extent> allocated(extents->begin() + begin, extents->end());
+    extents->resize(begin);
+    if (allocated.empty()) {
+        return;
+    }
+
+    // block group may be released after these extents are allocated
+    std::set<uint64_t> blockGroups;
+    for (const auto& ext : allocated) {
+        blockGroups.insert(align_down(ext.offset, blockGroupSize_));
+    }
+
+    for (auto offset : blockGroups) {
+        if (!AcquireBlockGroup(offset)) {
+            LOG(ERROR) << "Rollback allocation failed, acquire block group "
+                          "failed, block group offset: "
+                       << offset << ", extents: " << allocated;
+            return;
+        }
+    }
+
+    // bits are cleared in memory anyway, and the dirty range is written
+    // again by the next sync if this one fails
+    if (clearBitmap &&
+        !UpdateBitmap(allocated, BlockGroupBitmapUpdater::Op::Clear)) {
+        LOG(WARNING) << "Rollback allocation update bitmap failed, "
+                     << allocated;
+    }
+
+    availableBytes_.fetch_add(DeAllocFromAllocators(allocated),
+                              std::memory_order_relaxed);
+    VLOG(9) << "Rollback allocation success, " << allocated;
+}
+
 std::map<uint64_t, std::unique_ptr<Allocator>>::iterator
 SpaceManagerImpl::FindAllocator(const AllocateHint& hint) {
     if (hint.HasRightHint()) {
@@ -150,6 +266,15 @@ SpaceManagerImpl::FindAllocator(const AllocateHint& hint) {
         }
     }
 
+    // without hint, keep allocating from the block group of last time, so
+    // space of a thread stays together and threads spread over allocators
+    if (allocateCursor.owner == this) {
+        auto it = allocators_.find(allocateCursor.blockGroupOffset);
+        if (it != allocators_.end() && it->second->AvailableSize() > 0) {
+            return it;
+        }
+    }
+
     static thread_local unsigned int seed = time(nullptr);
     auto it = allocators_.begin();
     std::advance(it, rand_r(&seed) % allocators_.size());
@@ -173,6 +298,8 @@ int64_t SpaceManagerImpl::AllocInternal(int64_t size,
     do {
         left -= it->second->Alloc(left, hint, exts);
         if (left <= 0) {
+            allocateCursor.owner = this;
+            allocateCursor.blockGroupOffset = it->first;
             break;
         }
 
@@ -191,6 +318,10 @@ int64_t SpaceManagerImpl::AllocInternal(int64_t size,
 
 bool SpaceManagerImpl::UpdateBitmap(const std::vector<Extent> &exts,
                                     BlockGroupBitmapUpdater::Op op) {
+    butil::Timer timer;
+    timer.start();
+
+    // updaters can't be removed until their bitmaps are written back
     ReadLockGuard lk(updatersLock_);
 
     std::unordered_set<BlockGroupBitmapUpdater*> dirty;
@@ -200,11 +331,33 @@ bool SpaceManagerImpl::UpdateBitmap(const std::vector<Extent> &exts,
         dirty.insert(updater);
     }
 
-    for (auto d : dirty) {
-        d->Sync();
+    std::atomic<bool> succ(true);
+    if (dirty.size() == 1 || bitmapSyncPool_.ThreadOfNums() == 0) {
+        for (auto* d : dirty) {
+            if (!d->Sync()) {
+                succ.store(false, std::memory_order_relaxed);
+            }
+        }
+    } else {
+        CountDownEvent event(dirty.size());
+        std::vector<curve::common::Task> tasks;
+        tasks.reserve(dirty.size());
+        for (auto* d : dirty) {
+            tasks.emplace_back([d, &succ, &event]() {
+                if (!d->Sync()) {
+                    succ.store(false, std::memory_order_relaxed);
+                }
+                event.Signal();
+            });
+        }
+        bitmapSyncPool_.EnqueueBatch(std::move(tasks));
+        event.Wait();
     }
 
-    return true;
+    timer.stop();
+    metric_.bitmapSync << timer.u_elapsed();
+
+    return succ.load(std::memory_order_relaxed);
 }
 
 BlockGroupBitmapUpdater* SpaceManagerImpl::FindBitmapUpdater(
@@ -220,10 +373,95 @@ BlockGroupBitmapUpdater* SpaceManagerImpl::FindBitmapUpdater(
 }
 
 void SpaceManagerImpl::Run() {
+    if (bitmapSyncThreads_ > 0) {
+        bitmapSyncPool_.ExposeMetric("space_manager_bitmap_sync_pool");
+        bitmapSyncPool_.Start(bitmapSyncThreads_);
+    }
     releaseT_ = std::thread(&SpaceManagerImpl::ReleaseFullBlockGroups, this);
+    if (reservedBytes_ > 0) {
+        refillT_ = std::thread(&SpaceManagerImpl::RefillBlockGroups, this);
+        {
+            std::lock_guard<std::mutex> lk(refillMtx_);
+            refillStarted_ = true;
+        }
+        // fill the reserve before the first write
+        TriggerRefill();
+    }
     running_ = true;
 }
 
+void SpaceManagerImpl::TriggerRefill() {
+    if (availableBytes_.load(std::memory_order_relaxed) >= reservedBytes_) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk(refillMtx_);
+    if (!refillStarted_ || refillStopped_ || refillPending_) {
+        return;
+    }
+    refillPending_ = true;
+    refillCond_.notify_one();
+}
+
+void SpaceManagerImpl::RefillBlockGroups() {
+    uint64_t backoffMs = 0;
+    std::unique_lock<std::mutex> lk(refillMtx_);
+    while (true) {
+        refillCond_.wait(lk, [this]() {
+            return refillPending_ || refillStopped_;
+        });
+        if (refillStopped_) {
+            break;
+        }
+
+        lk.unlock();
+        butil::Timer timer;
+        timer.start();
+        // it does nothing if space has been refilled by writers
+        bool ret = AllocateBlockGroup(reservedBytes_);
+        timer.stop();
+        if (ret) {
+            metric_.refill << timer.u_elapsed();
+            backoffMs = 0;
+        } else {
+            backoffMs = NextRefillBackoff(backoffMs);
+            LOG(WARNING) << "Refill block groups failed, retry after "
+                         << backoffMs << "ms";
+            metric_.refillError << 1;
+        }
+        lk.lock();
+
+        // triggers are ignored while backing off, because refill is still
+        // pending, writers allocate block groups by themselves if needed
+        if (backoffMs > 0) {
+            refillCond_.wait_for(lk, std::chrono::milliseconds(backoffMs),
+                                 [this]() { return refillStopped_; });
+        }
+        refillPending_ = false;
+    }
+}
+
+uint64_t SpaceManagerImpl::NextRefillBackoff(uint64_t backoffMs) const {
+    const uint64_t maxBackoffMs =
+        std::max<uint64_t>(refillRetryIntervalMs_, kMaxRefillRetryIntervalMs);
+    if (backoffMs == 0) {
+        return refillRetryIntervalMs_;
+    }
+    return std::min(backoffMs * 2, maxBackoffMs);
+}
+
+void SpaceManagerImpl::StopRefill() {
+    {
+        std::lock_guard<std::mutex> lk(refillMtx_);
+        refillStopped_ = true;
+        refillCond_.notify_one();
+    }
+
+    if (refillT_.joinable()) {
+        refillT_.join();
+    }
+}
+
 
 void SpaceManagerImpl::ReleaseFullBlockGroups() {
     while (sleeper_.wait_for(std::chrono::seconds(releaseInterSec_))) {
@@ -264,6 +502,16 @@ void SpaceManagerImpl::ReleaseFullBlockGroups() {
             for (auto &id : selectBlockGroups) {
                 auto iter = allocators_.find(id);
                 assert(iter != allocators_.end());
+
+                // bitmap can't be written back after its updater is erased
+                auto updater = bitmapUpdaters_.find(id);
+                assert(updater != bitmapUpdaters_.end());
+                if (!updater->second->Sync()) {
+                    LOG(WARNING) << "Sync bitmap updater failed, keep block "
+                                    "group, id: " << id;
+                    continue;
+                }
+
                 auto availableSize = iter->second->AvailableSize();
 
                 availableBytes_.fetch_sub(availableSize,
@@ -288,6 +536,9 @@ void SpaceManagerImpl::ReleaseFullBlockGroups() {
 bool SpaceManagerImpl::Shutdown() {
     bool ret = false;
 
+    // no more block groups should be allocated after releasing
+    StopRefill();
+
     {
         WriteLockGuard allocLk(allocatorsLock_);
         WriteLockGuard updaterLk(updatersLock_);
@@ -309,6 +560,7 @@ bool SpaceManagerImpl::Shutdown() {
     if (running_) {
         sleeper_.interrupt();
         releaseT_.join();
+        bitmapSyncPool_.Stop();
         LOG(INFO) << "SpaceManagerImpl stop thread ok";
     }
     return ret;
@@ -346,7 +598,24 @@ bool SpaceManagerImpl::AllocateBlockGroup(uint64_t hint) {
     return true;
 }
 
+bool SpaceManagerImpl::AllocateBlockGroupSync(uint64_t hint) {
+    butil::Timer timer;
+    timer.start();
+    bool ret = AllocateBlockGroup(hint);
+    timer.stop();
+    metric_.allocStall << timer.u_elapsed();
+    return ret;
+}
+
 bool SpaceManagerImpl::AcquireBlockGroup(uint64_t blockGroupOffset) {
+    // deallocations of acquired block groups don't wait for each other
+    {
+        ReadLockGuard lk(updatersLock_);
+        if (bitmapUpdaters_.count(blockGroupOffset) != 0) {
+            return true;
+        }
+    }
+
     std::unique_lock<std::mutex> lk(mtx_);
     if (bitmapUpdaters_.find(blockGroupOffset) != bitmapUpdaters_.end()) {
         return true;
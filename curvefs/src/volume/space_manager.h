@@ -23,8 +23,11 @@
 #ifndef CURVEFS_SRC_VOLUME_SPACE_MANAGER_H_
 #define CURVEFS_SRC_VOLUME_SPACE_MANAGER_H_
 
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "src/common/interruptible_sleeper.h"
@@ -35,6 +38,7 @@
 #include "curvefs/src/volume/block_group_manager.h"
 #include "curvefs/src/volume/common.h"
 #include "src/common/concurrent/rw_lock.h"
+#include "src/common/concurrent/work_stealing_thread_pool.h"
 
 namespace curvefs {
 namespace volume {
@@ -53,6 +57,12 @@ class SpaceManager {
     virtual bool DeAlloc(uint64_t blockGroupOffset,
                          const std::vector<Extent> &extents) = 0;
 
+    /**
+     * @brief Give back extents which are allocated but never used, they're
+     *        available for later allocations
+     */
+    virtual bool Free(const std::vector<Extent>& extents) = 0;
+
     virtual void Run() = 0;
 
     virtual bool Shutdown() = 0;
@@ -77,6 +87,8 @@ class SpaceManagerImpl final : public SpaceManager {
     bool DeAlloc(uint64_t blockGroupOffset,
                  const std::vector<Extent> &extents) override;
 
+    bool Free(const std::vector<Extent>& extents) override;
+
     void Run() override;
 
     /**
@@ -94,6 +106,19 @@ class SpaceManagerImpl final : public SpaceManager {
     std::map<uint64_t, std::unique_ptr<Allocator>>::iterator FindAllocator(
         const AllocateHint& hint);
 
+    /**
+     * @brief Give back extents to their allocators
+     * @return total length of extents given back
+     */
+    uint64_t DeAllocFromAllocators(const std::vector<Extent>& extents);
+
+    /**
+     * @brief Give back extents appended to |extents| after |begin| by a
+     *        failed allocation, and clear their bits if |clearBitmap|
+     */
+    void RollbackAlloc(std::vector<Extent>* extents, size_t begin,
+                       bool clearBitmap);
+
     /**
      * @brief Find corresponding bitmap updater by extent
      */
@@ -104,9 +129,29 @@ class SpaceManagerImpl final : public SpaceManager {
 
     void ReleaseFullBlockGroups();
 
+    /**
+     * @brief Wake up refill thread if available space is less than reserved
+     */
+    void TriggerRefill();
+
+    void RefillBlockGroups();
+
+    /**
+     * @brief Get milliseconds to wait after a failed refill, it's doubled
+     *        after each consecutive failure
+     */
+    uint64_t NextRefillBackoff(uint64_t backoffMs) const;
+
+    void StopRefill();
+
  private:
     bool AllocateBlockGroup(uint64_t hint);
 
+    /**
+     * @brief Allocate block groups while the writer is waiting for space
+     */
+    bool AllocateBlockGroupSync(uint64_t hint);
+
     bool AcquireBlockGroup(uint64_t blockGroupOffset);
 
  private:
@@ -126,9 +171,7 @@ class SpaceManagerImpl final : public SpaceManager {
 
     std::unique_ptr<BlockGroupManager> blockGroupManager_;
 
-    bool allocating_;
     std::mutex mtx_;
-    std::condition_variable cond_;
 
     // releaseT_ is periodically release the allocated blockgroup
     double threshold_;
@@ -137,6 +180,22 @@ class SpaceManagerImpl final : public SpaceManager {
     bool running_{false};
     std::thread releaseT_;
 
+    // refillT_ allocates block groups in background when available space is
+    // less than reservedBytes_, so writers rarely wait for mds
+    uint64_t reservedBytes_;
+    std::mutex refillMtx_;
+    std::condition_variable refillCond_;
+    uint32_t refillRetryIntervalMs_;
+    // refillT_ is only touched by Run() and StopRefill(), others check
+    // refillStarted_ under refillMtx_
+    bool refillStarted_{false};
+    bool refillPending_{false};
+    bool refillStopped_{false};
+    std::thread refillT_;
+
+    // write bitmaps of block groups back in parallel
+    uint32_t bitmapSyncThreads_;
+    curve::common::WorkStealingThreadPool<> bitmapSyncPool_;
 
  private:
     struct Metric {
@@ -144,11 +203,20 @@ class SpaceManagerImpl final : public SpaceManager {
         bvar::LatencyRecorder deallocLatency;
         bvar::LatencyRecorder allocSize;
         bvar::Adder<uint64_t> errorCount;
+        // writers wait for allocating block groups from mds
+        bvar::LatencyRecorder allocStall;
+        // block groups allocated in background
+        bvar::LatencyRecorder refill;
+        bvar::Adder<uint64_t> refillError;
+        bvar::LatencyRecorder bitmapSync;
 
         Metric()
             : allocLatency("space_alloc_latency"),
               deallocLatency("space_dealloc_latency"),
-              allocSize("space_alloc_size"), errorCount("space_alloc_error") {}
+              allocSize("space_alloc_size"), errorCount("space_alloc_error"),
+              allocStall("space_alloc_stall"), refill("space_refill"),
+              refillError("space_refill_error"),
+              bitmapSync("space_bitmap_sync") {}
     };
 
     Metric metric_;
@@ -140,5 +140,59 @@ TEST_F(MemCachedTest, MultiThreadTask) {
         }
     }
 }
+
+TEST_F(MemCachedTest, BatchTask) {
+    std::vector<std::pair<std::string, std::string>> kvstr = {
+        {"b123", "1231"},
+        {"b456", "4561"},
+        {"b789", "7891"},
+    };
+
+    // batch set
+    CountDownEvent setEvent(kvstr.size());
+    std::vector<std::shared_ptr<SetKVCacheTask>> setTasks;
+    for (const auto &kv : kvstr) {
+        auto task = std::make_shared<SetKVCacheTask>(
+            kv.first, kv.second.c_str(), kv.second.length(),
+            [&setEvent](const std::shared_ptr<SetKVCacheTask> &task) {
+                setEvent.Signal();
+            });
+        setTasks.emplace_back(task);
+    }
+    manager_.BatchSet(setTasks);
+    setEvent.Wait();
+    for (const auto &task : setTasks) {
+        ASSERT_TRUE(task->res);
+    }
+
+    // batch get, include the same key twice and a not exist key
+    std::string notExist = "b000";
+    std::vector<std::string> keys = {kvstr[0].first, kvstr[1].first,
+                                     kvstr[2].first, kvstr[0].first,
+                                     notExist};
+    std::vector<std::unique_ptr<char[]>> results;
+    std::vector<std::shared_ptr<GetKVCacheTask>> getTasks;
+    CountDownEvent getEvent(keys.size());
+    for (const auto &key : keys) {
+        results.emplace_back(new char[4]);
+        auto task = std::make_shared<GetKVCacheTask>(
+            key, results.back().get(), 0, 4,
+            [&getEvent](const std::shared_ptr<GetKVCacheTask> &task) {
+                getEvent.Signal();
+            });
+        getTasks.emplace_back(task);
+    }
+    manager_.BatchGet(getTasks);
+    getEvent.Wait();
+
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(getTasks[i]->res);
+        ASSERT_EQ(0, memcmp(results[i].get(), kvstr[i % 3].second.c_str(), 4));
+    }
+    ASSERT_FALSE(getTasks[4]->res);
+    auto *metric = manager_.GetClientMetricForTesting();
+    ASSERT_EQ(1u, metric->kvClientGetDedup.get_value());
+}
+
 }  // namespace client
 }  // namespace curvefs
@@ -48,7 +48,7 @@ using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::SetArgReferee;
 using ::testing::WithArg;
-using curve::common::TaskThreadPool;
+using curve::common::WorkStealingThreadPool;
 
 // extern KVClientManager *g_kvClientManager;
 
@@ -103,8 +103,8 @@ class FileCacheManagerTest : public testing::Test {
     std::shared_ptr<MockInodeCacheManager> mockInodeManager_;
     std::shared_ptr<MockS3Client> mockS3Client_;
     std::shared_ptr<KVClientManager> kvClientManager_;
-    std::shared_ptr<TaskThreadPool<>> threadPool_ =
-        std::make_shared<TaskThreadPool<>>();
+    std::shared_ptr<WorkStealingThreadPool<>> threadPool_ =
+        std::make_shared<WorkStealingThreadPool<>>();
 };
 
 TEST_F(FileCacheManagerTest, test_FindOrCreateChunkCacheManager) {
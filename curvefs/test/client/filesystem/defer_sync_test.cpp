@@ -68,6 +68,33 @@ TEST_F(DeferSyncTest, Dirty) {
     deferSync->Stop();
 }
 
+TEST_F(DeferSyncTest, BatchSync) {
+    auto builder = DeferSyncBuilder();
+    auto deferSync = builder.SetOption([&](DeferSyncOption* option){
+        option->delay = 3;
+        option->batchSync = true;
+    }).SetMetaClient(metaClient_).Build();
+    deferSync->Start();
+
+    auto inode1 = MkInode(100, InodeOption().metaClient(metaClient_));
+    auto inode2 = MkInode(200, InodeOption().metaClient(metaClient_));
+    auto inode3 = MkInode(300, InodeOption().metaClient(metaClient_));
+    inode1->SetLength(100);  // make inode ditry to trigger sync
+    inode2->SetLength(200);
+
+    EXPECT_CALL_INDOE_SYNC_TIMES(*metaClient_, _, 0 /* times */);
+    EXPECT_CALL(*metaClient_, BatchUpdateInodeAttrAsync(_))
+        .WillOnce(Invoke([](UpdateInodeBatch* batch) {
+            ASSERT_EQ(batch->Size(), 2);  // inode3 isn't dirty
+        }));
+
+    deferSync->Push(inode1);
+    deferSync->Push(inode2);
+    deferSync->Push(inode3);
+    deferSync->Push(inode1);  // same inode only be synced once
+    deferSync->Stop();
+}
+
 }  // namespace filesystem
 }  // namespace client
 }  // namespace curvefs
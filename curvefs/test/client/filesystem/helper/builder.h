@@ -49,6 +49,7 @@ class DeferSyncBuilder {
         return DeferSyncOption {
             delay: 3,
             deferDirMtime: false,
+            batchSync: false,
         };
     }
 
@@ -63,8 +64,14 @@ class DeferSyncBuilder {
         return *this;
     }
 
+    DeferSyncBuilder SetMetaClient(
+        std::shared_ptr<MetaServerClient> metaClient) {
+        metaClient_ = metaClient;
+        return *this;
+    }
+
     std::shared_ptr<DeferSync> Build() {
-        return std::make_shared<DeferSync>(option_);
+        return std::make_shared<DeferSync>(option_, metaClient_);
     }
 
     std::shared_ptr<MockDentryCacheManager> GetDentryManager() {
@@ -79,6 +86,7 @@ class DeferSyncBuilder {
     DeferSyncOption option_;
     std::shared_ptr<MockDentryCacheManager> dentryManager_;
     std::shared_ptr<MockInodeCacheManager> inodeManager_;
+    std::shared_ptr<MetaServerClient> metaClient_;
 };
 
 class DirCacheBuilder {
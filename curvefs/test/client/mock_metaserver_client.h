@@ -62,6 +62,10 @@ class MockMetaServerClient : public MetaServerClient {
             const std::string &last, uint32_t count, bool onlyDir,
             std::list<Dentry> *dentryList));
 
+    MOCK_METHOD6(StreamListDentry, MetaStatusCode(uint32_t fsId,
+            uint64_t inodeid, const std::string &last, uint32_t count,
+            std::list<Dentry> *dentryList, bool *streamed));
+
     MOCK_METHOD1(CreateDentry, MetaStatusCode(const Dentry &dentry));
 
     MOCK_METHOD4(DeleteDentry, MetaStatusCode(
@@ -74,6 +78,9 @@ class MockMetaServerClient : public MetaServerClient {
     MOCK_METHOD4(GetInode, MetaStatusCode(
             uint32_t fsId, uint64_t inodeid, Inode *out, bool* streaming));
 
+    MOCK_METHOD3(GetInodeWithoutS3ChunkInfo, MetaStatusCode(
+            uint32_t fsId, uint64_t inodeid, Inode *out));
+
     MOCK_METHOD3(GetInodeAttr, MetaStatusCode(uint32_t fsId, uint64_t inodeid,
                                 InodeAttr *attr));
 
@@ -119,6 +126,8 @@ class MockMetaServerClient : public MetaServerClient {
                       MetaServerClientDone* done,
                       DataIndices));
 
+    MOCK_METHOD1(BatchUpdateInodeAttrAsync, void(UpdateInodeBatch* batch));
+
     MOCK_METHOD2(UpdateXattrAsync, void(const Inode &inode,
         MetaServerClientDone *done));
 
@@ -137,6 +146,13 @@ class MockMetaServerClient : public MetaServerClient {
             uint64_t, S3ChunkInfoList> &s3ChunkInfos,
         MetaServerClientDone *done));
 
+    MOCK_METHOD5(GetS3ChunkInfoByIndexes, MetaStatusCode(
+        uint32_t fsId, uint64_t inodeId,
+        const google::protobuf::Map<
+            uint64_t, S3ChunkInfoList> &s3ChunkInfos,
+        const std::vector<uint64_t> &chunkIndexes,
+        google::protobuf::Map<uint64_t, S3ChunkInfoList> *out));
+
     MOCK_METHOD2(CreateInode, MetaStatusCode(
             const InodeParam &param, Inode *out));
 
@@ -23,6 +23,10 @@
 #include <brpc/server.h>
 #include <gtest/gtest.h>
 
+#include <chrono>  // NOLINT
+#include <set>
+#include <thread>  // NOLINT
+
 #include "curvefs/src/client/rpcclient/metacache.h"
 #include "curvefs/test/client/rpcclient/mock_mds_client.h"
 #include "curvefs/test/client/rpcclient/mock_cli2_client.h"
@@ -222,6 +226,36 @@ TEST_F(MetaCacheTest, test_GetTarget) {
     metaCache_.MarkPartitionUnavailable(1);
 }
 
+TEST_F(MetaCacheTest, test_GetTargetReplica) {
+    uint32_t fsID = 1;
+    uint64_t inodeID = 1;
+    CopysetTarget target;
+    target.groupID = CopysetGroupID(1, 1);
+
+    LOG(INFO) << "test1: copyset not exist";
+    ASSERT_FALSE(metaCache_.GetTargetReplica(&target));
+
+    LOG(INFO) << "test2: select one of replicas";
+    std::vector<CopysetInfo<MetaserverID>> metaServerInfos;
+    metaServerInfos.push_back(metaServerList_);
+    EXPECT_CALL(*mockMdsClient_.get(), ListPartition(fsID, _))
+        .WillOnce(DoAll(SetArgPointee<1>(pInfoList_), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetCopysetOfPartitions(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(copysetMap_), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(_, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(metaServerInfos), Return(true)));
+    ASSERT_TRUE(metaCache_.GetTarget(fsID, inodeID, &target));
+
+    std::set<MetaserverID> selected;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(metaCache_.GetTargetReplica(&target));
+        ASSERT_EQ(expect.partitionID, target.partitionID);
+        ASSERT_EQ(9119 + target.metaServerID, target.endPoint.port);
+        selected.insert(target.metaServerID);
+    }
+    ASSERT_GT(selected.size(), 1);
+}
+
 TEST_F(MetaCacheTest, SetTxId) {
     CopysetTarget target;
     uint32_t partitionId;
@@ -341,6 +375,109 @@ TEST_F(MetaCacheTest, test_GetPartitionIdByInodeId) {
     ASSERT_EQ(pid, 1);
 }
 
+TEST_F(MetaCacheTest, test_RefreshAllLeaders) {
+    uint32_t fsID = 1;
+    uint64_t inodeID = 1;
+    CopysetTarget target;
+
+    // test1: no copyset cached, nothing to refresh
+    ASSERT_TRUE(metaCache_.RefreshAllLeaders());
+
+    std::vector<CopysetInfo<MetaserverID>> metaServerInfos;
+    metaServerInfos.push_back(metaServerList_);
+    EXPECT_CALL(*mockMdsClient_.get(), ListPartition(fsID, _))
+        .WillOnce(DoAll(SetArgPointee<1>(pInfoList_), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetCopysetOfPartitions(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(copysetMap_), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(_, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(metaServerInfos), Return(true)));
+    ASSERT_TRUE(metaCache_.GetTarget(fsID, inodeID, &target));
+    ASSERT_EQ(1, target.metaServerID);
+
+    // test2: refresh fail, keep the cached leader
+    EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(1, _, _))
+        .WillOnce(Return(false));
+    ASSERT_FALSE(metaCache_.RefreshAllLeaders());
+    ASSERT_TRUE(metaCache_.GetTarget(fsID, inodeID, &target));
+    ASSERT_EQ(1, target.metaServerID);
+
+    // test3: leader reported by mds is stale, keep the cached leader
+    // which is still trusted
+    metaServerInfos[0].UpdateLeaderIndex(1);
+    EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(1, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(metaServerInfos), Return(true)));
+    ASSERT_TRUE(metaCache_.RefreshAllLeaders());
+    ASSERT_TRUE(metaCache_.GetTarget(fsID, inodeID, &target));
+    ASSERT_EQ(1, target.metaServerID);
+
+    // test4: leader may change, the one reported by mds is taken without
+    // asking metaserver
+    CopysetInfo<MetaserverID> unstable = metaServerList_;
+    unstable.SetLeaderUnstableFlag();
+    metaCache_.UpdateCopysetInfo(target.groupID, unstable);
+    EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(1, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(metaServerInfos), Return(true)));
+    EXPECT_CALL(*mockCli2Client_.get(), GetLeader(_, _, _, _, _, _))
+        .Times(0);
+    ASSERT_TRUE(metaCache_.RefreshAllLeaders());
+    ASSERT_TRUE(metaCache_.GetTarget(fsID, inodeID, &target));
+    ASSERT_EQ(2, target.metaServerID);
+
+    // test5: mds do not know the leader, keep the cached one
+    metaServerInfos[0].UpdateLeaderIndex(-1);
+    EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(1, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(metaServerInfos), Return(true)));
+    ASSERT_TRUE(metaCache_.RefreshAllLeaders());
+    ASSERT_TRUE(metaCache_.GetTarget(fsID, inodeID, &target));
+    ASSERT_EQ(2, target.metaServerID);
+}
+
+TEST_F(MetaCacheTest, test_SelectTargetRefreshPartitions) {
+    uint32_t fsID = 1;
+    CopysetTarget target;
+    opt_.refreshPartitionIntervalSec = 1;
+    metaCache_.Init(opt_, mockCli2Client_, mockMdsClient_);
+
+    std::vector<CopysetInfo<MetaserverID>> metaServerInfos;
+    metaServerInfos.push_back(metaServerList_);
+    EXPECT_CALL(*mockMdsClient_.get(), ListPartition(fsID, _))
+        .WillOnce(DoAll(SetArgPointee<1>(pInfoList_), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetCopysetOfPartitions(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(copysetMap_), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(_, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(metaServerInfos), Return(true)));
+    ASSERT_TRUE(metaCache_.ListPartitions(fsID));
+
+    // test1: partitions are fresh, no rpc to mds
+    ASSERT_TRUE(metaCache_.SelectTarget(fsID, &target));
+    ASSERT_EQ(1, target.partitionID);
+
+    // test2: mds split partition 1, the new partition is selected
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    MetaCache::PartitionInfoList splitList;
+    PartitionInfo readonly = pInfoList_[0];
+    readonly.set_status(PartitionStatus::READONLY);
+    splitList.push_back(readonly);
+    PartitionInfo split = pInfoList2_[0];
+    split.set_partitionid(2);
+    splitList.push_back(split);
+    EXPECT_CALL(*mockMdsClient_.get(), ListPartition(fsID, _))
+        .WillOnce(DoAll(SetArgPointee<1>(splitList), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetCopysetOfPartitions(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(copysetMap_), Return(true)));
+    EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(_, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(metaServerInfos), Return(true)));
+    ASSERT_TRUE(metaCache_.SelectTarget(fsID, &target));
+    ASSERT_EQ(2, target.partitionID);
+
+    // test3: refresh fail, cached partitions are used
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    EXPECT_CALL(*mockMdsClient_.get(), ListPartition(fsID, _))
+        .WillOnce(Return(false));
+    ASSERT_TRUE(metaCache_.SelectTarget(fsID, &target));
+    ASSERT_EQ(2, target.partitionID);
+}
+
 }  // namespace rpcclient
 }  // namespace client
 }  // namespace curvefs
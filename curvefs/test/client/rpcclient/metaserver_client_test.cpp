@@ -33,6 +33,7 @@
 #include <thread>
 
 #include "absl/cleanup/cleanup.h"
+#include "src/common/concurrent/count_down_event.h"
 #include "curvefs/proto/metaserver.pb.h"
 #include "curvefs/src/client/rpcclient/metacache.h"
 #include "curvefs/src/client/rpcclient/metaserver_client.h"
@@ -61,6 +62,8 @@ using ::curvefs::metaserver::BatchGetInodeAttrRequest;
 using ::curvefs::metaserver::BatchGetInodeAttrResponse;
 using ::curvefs::metaserver::BatchGetXAttrRequest;
 using ::curvefs::metaserver::BatchGetXAttrResponse;
+using ::curvefs::metaserver::BatchUpdateInodeAttrRequest;
+using ::curvefs::metaserver::BatchUpdateInodeAttrResponse;
 using ::curvefs::metaserver::UpdateDeallocatableBlockGroupRequest;
 using ::curvefs::metaserver::UpdateDeallocatableBlockGroupResponse;
 using ::curvefs::common::StreamServer;
@@ -955,6 +958,67 @@ TEST_F(MetaServerClientImplTest, test_BatchGetInodeAttr) {
     ASSERT_EQ(MetaStatusCode::NOT_FOUND, status);
 }
 
+namespace {
+
+class CountDownDone : public MetaServerClientDone {
+ public:
+    explicit CountDownDone(curve::common::CountDownEvent *event)
+        : event_(event) {}
+
+    void Run() override { event_->Signal(); }
+
+ private:
+    curve::common::CountDownEvent *event_;
+};
+
+}  // namespace
+
+TEST_F(MetaServerClientImplTest, test_BatchUpdateInodeAttrAsync) {
+    uint32_t fsid = 1;
+    uint32_t partitionID = 200;
+    InodeAttr attr;
+    attr.set_length(4096);
+
+    curve::common::CountDownEvent event(2);
+    CountDownDone done1(&event);
+    CountDownDone done2(&event);
+    UpdateInodeBatch batch;
+    batch.Add(fsid, 1, attr, &done1);
+    batch.Add(fsid, 2, attr, &done2);
+
+    BatchUpdateInodeAttrResponse response;
+    response.set_statuscode(MetaStatusCode::OK);
+    response.add_updatestatus(MetaStatusCode::OK);
+    response.add_updatestatus(MetaStatusCode::NOT_FOUND);
+
+    EXPECT_CALL(*mockMetacache_.get(), GetPartitionIdByInodeId(_, _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(partitionID), Return(true)));
+    EXPECT_CALL(*mockMetacache_.get(), GetTarget(_, _, _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(target_), Return(true)));
+    EXPECT_CALL(mockMetaServerService_, UpdateInode(_, _, _, _)).Times(0);
+    EXPECT_CALL(mockMetaServerService_, BatchUpdateInodeAttr(_, _, _, _))
+        .WillOnce(DoAll(
+            Invoke([&](::google::protobuf::RpcController *,
+                       const BatchUpdateInodeAttrRequest *request,
+                       BatchUpdateInodeAttrResponse *,
+                       ::google::protobuf::Closure *) {
+                ASSERT_EQ(request->update_size(), 2);
+                ASSERT_EQ(request->update(0).inodeid(), 1);
+                ASSERT_EQ(request->update(0).partitionid(), partitionID);
+                ASSERT_EQ(request->update(1).length(), 4096);
+            }),
+            SetArgPointee<2>(response),
+            Invoke(SetRpcService<BatchUpdateInodeAttrRequest,
+                                 BatchUpdateInodeAttrResponse>)));
+
+    metaserverCli_.BatchUpdateInodeAttrAsync(&batch);
+    ASSERT_TRUE(batch.Empty());
+
+    event.Wait();
+    ASSERT_EQ(MetaStatusCode::OK, done1.GetStatusCode());
+    ASSERT_EQ(MetaStatusCode::NOT_FOUND, done2.GetStatusCode());
+}
+
 TEST_F(MetaServerClientImplTest, test_BatchGetXAttr) {
     // in
     uint32_t fsid = 1;
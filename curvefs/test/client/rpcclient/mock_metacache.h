@@ -56,6 +56,8 @@ class MockMetaCache : public MetaCache {
 
     MOCK_METHOD2(GetTargetLeader, bool(CopysetTarget *target, bool refresh));
 
+    MOCK_METHOD1(GetTargetReplica, bool(CopysetTarget *target));
+
     MOCK_METHOD3(GetPartitionIdByInodeId,
                  bool(uint32_t fsID, uint64_t inodeID, PartitionID *pid));
 };
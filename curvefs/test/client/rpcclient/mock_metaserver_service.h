@@ -94,6 +94,12 @@ class MockMetaServerService : public curvefs::metaserver::MetaServerService {
                       const ::curvefs::metaserver::UpdateInodeRequest *request,
                       ::curvefs::metaserver::UpdateInodeResponse *response,
                       ::google::protobuf::Closure *done));
+    MOCK_METHOD4(
+        BatchUpdateInodeAttr,
+        void(::google::protobuf::RpcController *controller,
+             const ::curvefs::metaserver::BatchUpdateInodeAttrRequest *request,
+             ::curvefs::metaserver::BatchUpdateInodeAttrResponse *response,
+             ::google::protobuf::Closure *done));
     MOCK_METHOD4(DeleteInode,
                  void(::google::protobuf::RpcController *controller,
                       const ::curvefs::metaserver::DeleteInodeRequest *request,
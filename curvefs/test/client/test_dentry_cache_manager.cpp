@@ -238,6 +238,60 @@ TEST_F(TestDentryCacheManager, ListDentryFailed) {
     ASSERT_EQ(0, out.size());
 }
 
+TEST_F(TestDentryCacheManager, StreamListDentry) {
+    uint64_t parent = 99;
+    uint32_t limit = 100;
+    std::list<Dentry> all;
+    all.resize(3 * limit + 1);
+
+    dCacheManager_->SetStreamListDentry(true);
+    EXPECT_CALL(*metaClient_, StreamListDentry(fsId_, parent, "", limit, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(all), SetArgPointee<5>(true),
+                        Return(MetaStatusCode::OK)));
+    EXPECT_CALL(*metaClient_, ListDentry(_, _, _, _, _, _))
+        .Times(0);
+
+    std::list<Dentry> out;
+    CURVEFS_ERROR ret = dCacheManager_->ListDentry(parent, &out, limit);
+    ASSERT_EQ(CURVEFS_ERROR::OK, ret);
+    ASSERT_EQ(3 * limit + 1, out.size());
+}
+
+TEST_F(TestDentryCacheManager, StreamListDentryNotSupported) {
+    uint64_t parent = 99;
+    uint32_t limit = 100;
+    std::list<Dentry> part1, part2;
+    part1.resize(limit);
+    part1.back().set_name("last");
+    part2.resize(limit - 1);
+
+    // server doesn't support streaming, list remaining page by page
+    dCacheManager_->SetStreamListDentry(true);
+    EXPECT_CALL(*metaClient_, StreamListDentry(fsId_, parent, "", limit, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(part1), SetArgPointee<5>(false),
+                        Return(MetaStatusCode::OK)));
+    EXPECT_CALL(*metaClient_, ListDentry(fsId_, parent, "last", limit, _, _))
+        .WillOnce(DoAll(SetArgPointee<5>(part2),
+                        Return(MetaStatusCode::OK)));
+
+    std::list<Dentry> out;
+    CURVEFS_ERROR ret = dCacheManager_->ListDentry(parent, &out, limit);
+    ASSERT_EQ(CURVEFS_ERROR::OK, ret);
+    ASSERT_EQ(2 * limit - 1, out.size());
+}
+
+TEST_F(TestDentryCacheManager, StreamListDentryFailed) {
+    uint64_t parent = 99;
+
+    dCacheManager_->SetStreamListDentry(true);
+    EXPECT_CALL(*metaClient_, StreamListDentry(fsId_, parent, _, _, _, _))
+        .WillOnce(Return(MetaStatusCode::RPC_STREAM_ERROR));
+
+    std::list<Dentry> out;
+    CURVEFS_ERROR ret = dCacheManager_->ListDentry(parent, &out, 100);
+    ASSERT_NE(CURVEFS_ERROR::OK, ret);
+}
+
 TEST_F(TestDentryCacheManager, GetTimeOutDentry) {
     curvefs::client::common::FLAGS_enableCto = false;
     uint64_t parent = 99;
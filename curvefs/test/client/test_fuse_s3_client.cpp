@@ -24,7 +24,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 
@@ -170,6 +173,8 @@ class TestFuseS3Client : public ::testing::Test {
         fuseClientOption_.fileSystemOption.maxNameLength = 20u;
         fuseClientOption_.listDentryThreads = 2;
         fuseClientOption_.warmupThreadsNum = 10;
+        fuseClientOption_.warmupMaxInflightObjects = 64;
+        fuseClientOption_.warmupBandwidthBytes = 0;
         {  // filesystem option
             auto option = FileSystemOption();
             option.maxNameLength = 20u;
@@ -969,6 +974,43 @@ TEST_F(TestFuseS3Client, warmUp_FetchChildDentry_suc_ListDentry) {
     ASSERT_FALSE(ret);
 }
 
+TEST_F(TestFuseS3Client, warmUp_progress_finishedBytes) {
+    warmup::WarmupProgress progress(
+        curvefs::client::common::WarmupStorageType::kWarmupStorageTypeDisk);
+    progress.AddTotal(3);
+    progress.FinishedPlusOne(4096);
+    progress.FinishedPlusOne(1024);
+    progress.FinishedPlusOne();
+    ASSERT_EQ(3u, progress.GetTotal());
+    ASSERT_EQ(3u, progress.GetFinished());
+    ASSERT_EQ(5120u, progress.GetFinishedBytes());
+
+    warmup::WarmupProgress copy;
+    copy = progress;
+    ASSERT_EQ(5120u, copy.GetFinishedBytes());
+}
+
+TEST_F(TestFuseS3Client, warmUp_inflightThrottle) {
+    warmup::WarmupInflightThrottle throttle(1);
+    ASSERT_TRUE(throttle.OnStart());
+
+    std::atomic<bool> started(false);
+    std::thread t([&]() {
+        // blocked until the first one completes
+        ASSERT_TRUE(throttle.OnStart());
+        started.store(true);
+        throttle.OnComplete();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(started.load());
+    throttle.OnComplete();
+    t.join();
+    ASSERT_TRUE(started.load());
+
+    throttle.Stop();
+    ASSERT_FALSE(throttle.OnStart());
+}
+
 TEST_F(TestFuseS3Client, warmUp_GetInodeSubPathParent_empty) {
     /*
 .(1) parent
@@ -341,5 +341,77 @@ TEST_F(TestInodeWrapper, TestSetXattr) {
     ASSERT_TRUE(inodeWrapper_->IsDirty());
 }
 
+TEST_F(TestInodeWrapper, TestLoadS3ChunkInfoLazily) {
+    Inode inode;
+    inode.set_fsid(1);
+    inode.set_inodeid(1);
+    inode.set_type(FsFileType::TYPE_S3);
+    auto inodeWrapper = std::make_shared<InodeWrapper>(inode, metaClient_);
+
+    // CASE 1: not in lazy load mode
+    {
+        auto lock = inodeWrapper->GetUniqueLock();
+        EXPECT_CALL(*metaClient_, GetS3ChunkInfoByIndexes(_, _, _, _, _))
+            .Times(0);
+        ASSERT_EQ(CURVEFS_ERROR::OK,
+                  inodeWrapper->LoadS3ChunkInfoLocked({0, 1}));
+    }
+
+    // CASE 2: load chunk 0 and 1, pending s3chunkinfo is sent together
+    inodeWrapper->EnableLazyLoadS3ChunkInfo();
+    S3ChunkInfo info;
+    info.set_chunkid(3);
+    info.set_compaction(0);
+    info.set_offset(0);
+    info.set_len(1024);
+    info.set_size(1024);
+    info.set_zero(false);
+    inodeWrapper->AppendS3ChunkInfo(1, info);
+    {
+        google::protobuf::Map<uint64_t, S3ChunkInfoList> remote;
+        info.set_chunkid(2);
+        AppendS3ChunkInfoToMap(1, info, &remote);
+        info.set_chunkid(3);
+        AppendS3ChunkInfoToMap(1, info, &remote);
+
+        auto lock = inodeWrapper->GetUniqueLock();
+        EXPECT_CALL(*metaClient_, GetS3ChunkInfoByIndexes(_, _, _, _, _))
+            .WillOnce(Invoke(
+                [&](uint32_t, uint64_t,
+                    const google::protobuf::Map<uint64_t, S3ChunkInfoList>& add,
+                    const std::vector<uint64_t>& chunkIndexes,
+                    google::protobuf::Map<uint64_t, S3ChunkInfoList>* out) {
+                    EXPECT_EQ(1, add.size());
+                    EXPECT_EQ(2, chunkIndexes.size());
+                    *out = remote;
+                    return MetaStatusCode::OK;
+                }));
+        ASSERT_EQ(CURVEFS_ERROR::OK,
+                  inodeWrapper->LoadS3ChunkInfoLocked({0, 1}));
+        ASSERT_TRUE(inodeWrapper->S3ChunkInfoEmptyNolock());
+        auto* m = inodeWrapper->GetChunkInfoMap();
+        ASSERT_EQ(1, m->size());
+        ASSERT_EQ(2, m->at(1).s3chunks_size());
+    }
+
+    // CASE 3: loaded chunks are not loaded again
+    {
+        auto lock = inodeWrapper->GetUniqueLock();
+        EXPECT_CALL(*metaClient_, GetS3ChunkInfoByIndexes(_, _, _, _, _))
+            .Times(0);
+        ASSERT_EQ(CURVEFS_ERROR::OK,
+                  inodeWrapper->LoadS3ChunkInfoLocked({0, 1}));
+    }
+
+    // CASE 4: load failed
+    {
+        auto lock = inodeWrapper->GetUniqueLock();
+        EXPECT_CALL(*metaClient_, GetS3ChunkInfoByIndexes(_, _, _, _, _))
+            .WillOnce(Return(MetaStatusCode::RPC_ERROR));
+        ASSERT_NE(CURVEFS_ERROR::OK,
+                  inodeWrapper->LoadS3ChunkInfoLocked({2}));
+    }
+}
+
 }  // namespace client
 }  // namespace curvefs
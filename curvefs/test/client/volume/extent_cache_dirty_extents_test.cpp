@@ -22,6 +22,10 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
+#include <memory>
+#include <vector>
+
 #include "curvefs/src/client/volume/extent_cache.h"
 #include "curvefs/src/client/volume/extent_slice.h"
 #include "curvefs/test/client/volume/common.h"
@@ -29,6 +33,24 @@
 namespace curvefs {
 namespace client {
 
+namespace {
+
+// enable delta flush in current scope
+class ScopedDeltaFlush {
+ public:
+    ScopedDeltaFlush() {
+        ExtentCacheOption option;
+        option.deltaFlush = true;
+        ExtentCache::SetOption(option);
+    }
+
+    ~ScopedDeltaFlush() {
+        ExtentCache::SetOption(ExtentCacheOption());
+    }
+};
+
+}  // namespace
+
 TEST(ExtentCacheGetDirtyExtentTest, EmptyTest) {
     ExtentCache cache;
     auto pb = cache.GetDirtyExtents();
@@ -236,5 +258,169 @@ TEST(ExtentCacheGetDirtyExtentTest, Case4) {
     ASSERT_EQ(true, third.isused());
 }
 
+// |----|----|----|----|
+//            ^^
+//          written
+// only extents changed since last flush are returned
+TEST(ExtentCacheGetDirtyExtentTest, OnlyChangedExtents) {
+    ScopedDeltaFlush deltaFlush;
+    ExtentCache cache;
+
+    PExtent pext;
+    pext.len = 4 * kMiB;
+    pext.pOffset = 0 * kMiB;
+    pext.UnWritten = true;
+    cache.Merge(0 * kMiB, pext);
+
+    pext.len = 4 * kMiB;
+    pext.pOffset = 8 * kMiB;
+    pext.UnWritten = true;
+    cache.Merge(4 * kMiB, pext);
+
+    pext.len = 4 * kMiB;
+    pext.pOffset = 16 * kMiB;
+    pext.UnWritten = true;
+    cache.Merge(8 * kMiB, pext);
+
+    pext.len = 4 * kMiB;
+    pext.pOffset = 24 * kMiB;
+    pext.UnWritten = true;
+    cache.Merge(12 * kMiB, pext);
+
+    auto pb = cache.GetDirtyExtents();
+    ASSERT_TRUE(pb.delta());
+    ASSERT_EQ(1, pb.slices().size());
+    ASSERT_EQ(4, pb.slices(0).extents_size());
+
+    cache.MarkWritten(8 * kMiB, 2 * kMiB);
+
+    pb = cache.GetDirtyExtents();
+    ASSERT_TRUE(pb.delta());
+    ASSERT_EQ(1, pb.slices().size());
+
+    // unwritten part of the split extent is unchanged, metaserver keeps it
+    // when merging the written part
+    const auto& slice = pb.slices(0);
+    ASSERT_EQ(1, slice.extents_size());
+
+    auto& first = slice.extents(0);
+    ASSERT_EQ(2 * kMiB, first.length());
+    ASSERT_EQ(16 * kMiB, first.volumeoffset());
+    ASSERT_EQ(8 * kMiB, first.fsoffset());
+    ASSERT_EQ(true, first.isused());
+
+    pb = cache.GetDirtyExtents();
+    ASSERT_TRUE(pb.slices().empty());
+}
+
+// |----|----|
+//  ^^
+// written
+// whole slice is returned if delta flush is disabled, metaservers of older
+// versions replace the stored slice with it
+TEST(ExtentCacheGetDirtyExtentTest, DeltaFlushDisabled) {
+    ExtentCache cache;
+
+    PExtent pext;
+    pext.len = 4 * kMiB;
+    pext.pOffset = 0 * kMiB;
+    pext.UnWritten = true;
+    cache.Merge(0 * kMiB, pext);
+
+    pext.len = 4 * kMiB;
+    pext.pOffset = 8 * kMiB;
+    pext.UnWritten = true;
+    cache.Merge(4 * kMiB, pext);
+
+    auto pb = cache.GetDirtyExtents();
+    ASSERT_FALSE(pb.delta());
+    ASSERT_EQ(1, pb.slices().size());
+    ASSERT_EQ(2, pb.slices(0).extents_size());
+
+    cache.MarkWritten(0, 2 * kMiB);
+
+    pb = cache.GetDirtyExtents();
+    ASSERT_FALSE(pb.delta());
+    ASSERT_EQ(1, pb.slices().size());
+    ASSERT_EQ(3, pb.slices(0).extents_size());
+
+    pb = cache.GetDirtyExtents();
+    ASSERT_TRUE(pb.slices().empty());
+}
+
+// |----|--------------|
+//  ^^^^ ^^^^^^^^^^^^^^^
+// written   trimmed
+// unwritten extents beyond file length are trimmed, and the whole slice is
+// synced since removal can't be merged
+TEST(ExtentCacheGetDirtyExtentTest, TrimUnwritten) {
+    ScopedDeltaFlush deltaFlush;
+    ExtentCache cache;
+
+    PExtent pext;
+    pext.len = 4 * kMiB;
+    pext.pOffset = 8 * kMiB;
+    pext.UnWritten = true;
+    cache.Merge(0, pext);
+
+    cache.MarkWritten(0, 1 * kMiB);
+    cache.GetDirtyExtents();
+
+    std::map<uint64_t, PExtent> trimmed;
+    cache.TrimUnwritten(1 * kMiB - 100, &trimmed);
+
+    ASSERT_EQ(1, trimmed.size());
+    ASSERT_EQ(1 * kMiB, trimmed.begin()->first);
+    ASSERT_EQ(PExtent(3 * kMiB, 9 * kMiB, true), trimmed.begin()->second);
+
+    auto pb = cache.GetDirtyExtents();
+    ASSERT_FALSE(pb.delta());
+    ASSERT_EQ(1, pb.slices_size());
+    ASSERT_EQ(1, pb.slices(0).extents_size());
+
+    auto& ext = pb.slices(0).extents(0);
+    ASSERT_EQ(0, ext.fsoffset());
+    ASSERT_EQ(8 * kMiB, ext.volumeoffset());
+    ASSERT_EQ(1 * kMiB, ext.length());
+    ASSERT_TRUE(ext.isused());
+
+    pb = cache.GetDirtyExtents();
+    ASSERT_TRUE(pb.slices().empty());
+
+    // nothing left to trim
+    trimmed.clear();
+    cache.TrimUnwritten(1 * kMiB, &trimmed);
+    ASSERT_TRUE(trimmed.empty());
+    ASSERT_FALSE(cache.HasDirtyExtents());
+}
+
+// extents under writing are not trimmed even if file length isn't updated
+TEST(ExtentCacheGetDirtyExtentTest, TrimUnwrittenKeepsIssuedWrites) {
+    ExtentCache cache;
+
+    std::vector<WritePart> allocated;
+    std::vector<AllocPart> needAlloc;
+    std::unique_ptr<char[]> data(new char[2 * kMiB]);
+    cache.DivideForWrite(0, 2 * kMiB, data.get(), &allocated, &needAlloc);
+
+    PExtent pext;
+    pext.len = 4 * kMiB;
+    pext.pOffset = 8 * kMiB;
+    pext.UnWritten = true;
+    cache.Merge(0, pext);
+
+    std::map<uint64_t, PExtent> trimmed;
+    cache.TrimUnwritten(0, &trimmed);
+
+    ASSERT_EQ(1, trimmed.size());
+    ASSERT_EQ(2 * kMiB, trimmed.begin()->first);
+    ASSERT_EQ(PExtent(2 * kMiB, 10 * kMiB, true), trimmed.begin()->second);
+
+    auto extents = cache.GetExtentsForTesting();
+    ASSERT_EQ(1, extents.size());
+    ASSERT_EQ(1, extents[0].size());
+    ASSERT_EQ(PExtent(2 * kMiB, 8 * kMiB, true), extents[0][0]);
+}
+
 }  // namespace client
 }  // namespace curvefs
@@ -50,6 +50,31 @@ TEST(ExtentCacheReadDivideTest, DivideWhenNoExtents) {
     ASSERT_EQ(data.get(), holes[0].data);
 }
 
+// read crosses the boundary of the third and the fourth slice
+TEST(ExtentCacheReadDivideTest, DivideWhenCrossSliceBoundary) {
+    ExtentCache cache;
+    std::vector<ReadPart> reads;
+    std::vector<ReadPart> holes;
+
+    off_t offset = 3 * kGiB - 4 * kKiB;
+    size_t length = 8 * kKiB;
+
+    std::unique_ptr<char[]> data(new char[length]);
+
+    cache.DivideForRead(offset, length, data.get(), &reads, &holes);
+
+    ASSERT_TRUE(reads.empty());
+    ASSERT_EQ(2, holes.size());
+
+    ASSERT_EQ(offset, holes[0].offset);
+    ASSERT_EQ(4 * kKiB, holes[0].length);
+    ASSERT_EQ(data.get(), holes[0].data);
+
+    ASSERT_EQ(3 * kGiB, holes[1].offset);
+    ASSERT_EQ(4 * kKiB, holes[1].length);
+    ASSERT_EQ(data.get() + 4 * kKiB, holes[1].data);
+}
+
 // read    |----|           |----|
 // extent       |----|               |----|
 TEST(ExtentCacheReadDivideTest, DivideCase1) {
@@ -69,6 +69,34 @@ TEST_F(ExtentCacheWriteDivideTest, DivideWhenHasNoExtents) {
     ASSERT_FALSE(needAlloc[0].allocInfo.rightHintAvailable);
 }
 
+// write crosses the boundary of the third and the fourth slice, the offset
+// within a slice must be taken by `& (sliceSize - 1)`, `& ~sliceSize` only
+// clears one bit and is wrong beyond the second slice
+TEST_F(ExtentCacheWriteDivideTest, DivideWhenCrossSliceBoundary) {
+    ExtentCache cache;
+    std::vector<WritePart> allocated;
+    std::vector<AllocPart> needAlloc;
+
+    off_t offset = 3 * kGiB - 16 * kKiB;
+    size_t length = 32 * kKiB;
+
+    std::unique_ptr<char[]> data(new char[length]);
+
+    cache.DivideForWrite(offset, length, data.get(), &allocated, &needAlloc);
+
+    ASSERT_EQ(0, allocated.size());
+    ASSERT_EQ(2, needAlloc.size());
+
+    ASSERT_EQ(data.get(), needAlloc[0].data);
+    ASSERT_EQ(offset, needAlloc[0].allocInfo.lOffset);
+    ASSERT_EQ(16 * kKiB, needAlloc[0].allocInfo.len);
+    ASSERT_EQ(16 * kKiB, needAlloc[0].writelength);
+
+    ASSERT_EQ(data.get() + 16 * kKiB, needAlloc[1].data);
+    ASSERT_EQ(3 * kGiB, needAlloc[1].allocInfo.lOffset);
+    ASSERT_EQ(16 * kKiB, needAlloc[1].writelength);
+}
+
 TEST_F(ExtentCacheWriteDivideTest, DivideWhenHasNoExtents1) {
     ExtentCache cache;
     std::vector<WritePart> allocated;
@@ -934,5 +962,81 @@ TEST_F(ExtentCacheWriteDivideTest, DivideCase19_UnalignedWrite3) {
     ASSERT_EQ(1228, part.length);
 }
 
+// write    |-|-----|-|
+// extents  |-------|
+// following writes of a sequential stream fall into the extent allocated
+// before, and the one beyond it reserves larger space
+TEST_F(ExtentCacheWriteDivideTest, DivideSequentialWrite) {
+    ExtentCache cache;
+    std::vector<WritePart> allocated;
+    std::vector<AllocPart> needAlloc;
+
+    std::unique_ptr<char[]> data(new char[32 * kKiB]);
+
+    // first write isn't treated as sequential
+    cache.DivideForWrite(0, 4 * kKiB, data.get(), &allocated, &needAlloc);
+    ASSERT_EQ(0, allocated.size());
+    ASSERT_EQ(1, needAlloc.size());
+    ASSERT_EQ(0, needAlloc[0].allocInfo.lOffset);
+    ASSERT_EQ(option_.preAllocSize, needAlloc[0].allocInfo.len);
+
+    PExtent pext;
+    pext.pOffset = 100 * kMiB;
+    pext.len = option_.preAllocSize;
+    cache.Merge(0, pext);
+
+    allocated.clear();
+    needAlloc.clear();
+    cache.DivideForWrite(4 * kKiB, 28 * kKiB, data.get(), &allocated,
+                         &needAlloc);
+    ASSERT_EQ(1, allocated.size());
+    ASSERT_EQ(0, needAlloc.size());
+    ASSERT_EQ(data.get(), allocated[0].data);
+    ASSERT_EQ(100 * kMiB + 4 * kKiB, allocated[0].offset);
+    ASSERT_EQ(28 * kKiB, allocated[0].length);
+
+    allocated.clear();
+    needAlloc.clear();
+    cache.DivideForWrite(32 * kKiB, 4 * kKiB, data.get(), &allocated,
+                         &needAlloc);
+    ASSERT_EQ(0, allocated.size());
+    ASSERT_EQ(1, needAlloc.size());
+    ASSERT_EQ(32 * kKiB, needAlloc[0].allocInfo.lOffset);
+    ASSERT_EQ(option_.appendPreAllocSize, needAlloc[0].allocInfo.len);
+    ASSERT_TRUE(needAlloc[0].allocInfo.leftHintAvailable);
+    ASSERT_EQ(100 * kMiB + 32 * kKiB, needAlloc[0].allocInfo.pOffsetLeft);
+    ASSERT_EQ(4 * kKiB, needAlloc[0].writelength);
+}
+
+// write              |--|
+// extents       |--|
+// slice    |-----------|
+// reserved space of sequential write doesn't go beyond the slice
+TEST_F(ExtentCacheWriteDivideTest, DivideSequentialWriteAtSliceEnd) {
+    ExtentCache cache;
+    std::vector<WritePart> allocated;
+    std::vector<AllocPart> needAlloc;
+
+    std::unique_ptr<char[]> data(new char[4 * kKiB]);
+
+    PExtent pext;
+    pext.pOffset = 100 * kMiB;
+    pext.len = 4 * kKiB;
+    cache.Merge(option_.sliceSize - 8 * kKiB, pext);
+
+    cache.DivideForWrite(option_.sliceSize - 8 * kKiB, 4 * kKiB, data.get(),
+                         &allocated, &needAlloc);
+    ASSERT_EQ(1, allocated.size());
+    ASSERT_EQ(0, needAlloc.size());
+
+    allocated.clear();
+    cache.DivideForWrite(option_.sliceSize - 4 * kKiB, 4 * kKiB, data.get(),
+                         &allocated, &needAlloc);
+    ASSERT_EQ(0, allocated.size());
+    ASSERT_EQ(1, needAlloc.size());
+    ASSERT_EQ(option_.sliceSize - 4 * kKiB, needAlloc[0].allocInfo.lOffset);
+    ASSERT_EQ(4 * kKiB, needAlloc[0].allocInfo.len);
+}
+
 }  // namespace client
 }  // namespace curvefs
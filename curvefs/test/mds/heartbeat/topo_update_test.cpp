@@ -31,9 +31,12 @@ using ::curvefs::mds::topology::MockIdGenerator;
 using ::curvefs::mds::topology::MockStorage;
 using ::curvefs::mds::topology::MockTokenGenerator;
 using ::curvefs::mds::topology::MockTopology;
+using ::curvefs::mds::topology::PartitionStatistic;
 using ::curvefs::mds::topology::TopoStatusCode;
 using ::testing::_;
+using ::testing::AllOf;
 using ::testing::DoAll;
+using ::testing::Field;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 
@@ -115,7 +118,7 @@ TEST_F(TestTopoUpdater, test_UpdatePartitionTopo_case2) {
     }
 
     {
-        // status is not available
+        // status is not available, statistic is updated with status kept
         partition2.SetStatus(PartitionStatus::READWRITE);
         partitionList.clear();
         partitionList.push_back(partition2);
@@ -125,6 +128,28 @@ TEST_F(TestTopoUpdater, test_UpdatePartitionTopo_case2) {
         EXPECT_CALL(*topology_, GetPartition(_, _))
             .WillOnce(DoAll(SetArgPointee<1>(partition1), Return(true)));
 
+        EXPECT_CALL(*topology_,
+                    UpdatePartitionStatistic(
+                        _, AllOf(Field(&PartitionStatistic::status,
+                                       PartitionStatus::DELETING),
+                                 Field(&PartitionStatistic::inodeNum, 5))))
+            .WillOnce(Return(TopoStatusCode::TOPO_OK));
+
+        updater_->UpdatePartitionTopo(copysetId, partitionList);
+    }
+
+    {
+        // status and statistic are not changed
+        partitionList.clear();
+        partitionList.push_back(partition1);
+        EXPECT_CALL(*topology_, GetPartitionInfosInCopyset(_))
+            .WillOnce(Return(topoPartitionList));
+
+        EXPECT_CALL(*topology_, GetPartition(_, _))
+            .WillOnce(DoAll(SetArgPointee<1>(partition1), Return(true)));
+
+        EXPECT_CALL(*topology_, UpdatePartitionStatistic(_, _)).Times(0);
+
         updater_->UpdatePartitionTopo(copysetId, partitionList);
     }
 
@@ -203,6 +228,53 @@ TEST_F(TestTopoUpdater, test_UpdatePartitionTopo_case4) {
     updater_->UpdatePartitionTopo(copysetId, partitionList);
 }
 
+// partition split by mds, metaserver still reports READWRITE
+TEST_F(TestTopoUpdater, test_UpdatePartitionTopo_case5) {
+    CopySetIdType copysetId = 1;
+
+    ::curvefs::mds::topology::Partition partitionInTopo;
+    partitionInTopo.SetStatus(PartitionStatus::READONLY);
+    partitionInTopo.SetInodeNum(10);
+    std::list<::curvefs::mds::topology::Partition> topoPartitionList;
+    topoPartitionList.push_back(partitionInTopo);
+
+    ::curvefs::mds::topology::Partition partition;
+    partition.SetStatus(PartitionStatus::READWRITE);
+    partition.SetInodeNum(10);
+    std::list<::curvefs::mds::topology::Partition> partitionList;
+    partitionList.push_back(partition);
+
+    {
+        // status is kept and nothing changes
+        EXPECT_CALL(*topology_, GetPartitionInfosInCopyset(_))
+            .WillOnce(Return(topoPartitionList));
+        EXPECT_CALL(*topology_, GetPartition(_, _))
+            .WillOnce(DoAll(SetArgPointee<1>(partitionInTopo), Return(true)));
+        EXPECT_CALL(*topology_, UpdatePartitionStatistic(_, _)).Times(0);
+
+        updater_->UpdatePartitionTopo(copysetId, partitionList);
+    }
+
+    {
+        // statistic is updated, status is kept
+        partition.SetInodeNum(20);
+        partitionList.clear();
+        partitionList.push_back(partition);
+        EXPECT_CALL(*topology_, GetPartitionInfosInCopyset(_))
+            .WillOnce(Return(topoPartitionList));
+        EXPECT_CALL(*topology_, GetPartition(_, _))
+            .WillOnce(DoAll(SetArgPointee<1>(partitionInTopo), Return(true)));
+        EXPECT_CALL(*topology_,
+                    UpdatePartitionStatistic(
+                        _, AllOf(Field(&PartitionStatistic::status,
+                                       PartitionStatus::READONLY),
+                                 Field(&PartitionStatistic::inodeNum, 20))))
+            .WillOnce(Return(TopoStatusCode::TOPO_OK));
+
+        updater_->UpdatePartitionTopo(copysetId, partitionList);
+    }
+}
+
 TEST_F(TestTopoUpdater, test_PartitionStatusAvailable) {
     ASSERT_TRUE(updater_->CanPartitionStatusChange(PartitionStatus::READWRITE,
                                                    PartitionStatus::READWRITE));
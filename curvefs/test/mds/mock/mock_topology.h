@@ -261,6 +261,9 @@ class MockTopology : public TopologyImpl {
     MOCK_METHOD2(UpdatePartitionStatistic,
                  TopoStatusCode(uint32_t partitionId,
                                 PartitionStatistic statistic));
+    MOCK_METHOD2(UpdatePartitionRequestNum,
+                 TopoStatusCode(PartitionIdType partitionId,
+                                uint64_t requestNum));
 
     // find
     MOCK_CONST_METHOD1(FindPool, PoolIdType(const std::string &poolName));
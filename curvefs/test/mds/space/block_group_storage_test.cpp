@@ -88,6 +88,39 @@ TEST_F(BlockGroupStorageTest, TestPutBlockGroup_Success) {
     ASSERT_EQ(SpaceOk, storage_->PutBlockGroup(kFsId, kOffset, *blockGroup_));
 }
 
+TEST_F(BlockGroupStorageTest, TestPutBlockGroups_Success) {
+    std::vector<BlockGroup> groups(6, *blockGroup_);
+    for (size_t i = 0; i < groups.size(); ++i) {
+        groups[i].set_offset(kOffset + i * groups[i].size());
+    }
+
+    // 6 block groups = 3 + 3
+    EXPECT_CALL(*etcdclient_, TxnN(_))
+        .Times(2)
+        .WillRepeatedly(Invoke([](const std::vector<Operation>& ops) {
+            EXPECT_EQ(3, ops.size());
+            return EtcdErrCode::EtcdOK;
+        }));
+    EXPECT_CALL(*etcdclient_, Put(_, _)).Times(0);
+    ASSERT_EQ(SpaceOk, storage_->PutBlockGroups(kFsId, groups));
+
+    // 4 block groups = 3 + 1
+    groups.resize(4);
+    EXPECT_CALL(*etcdclient_, TxnN(_)).WillOnce(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*etcdclient_, Put(_, _)).WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(SpaceOk, storage_->PutBlockGroups(kFsId, groups));
+}
+
+TEST_F(BlockGroupStorageTest, TestPutBlockGroups_TxnError) {
+    std::vector<BlockGroup> groups(5, *blockGroup_);
+
+    EXPECT_CALL(*etcdclient_, TxnN(_))
+        .WillOnce(Return(EtcdErrCode::EtcdInternal));
+    EXPECT_CALL(*etcdclient_, Put(_, _)).Times(0);
+
+    ASSERT_EQ(SpaceErrStorage, storage_->PutBlockGroups(kFsId, groups));
+}
+
 TEST_F(BlockGroupStorageTest, TestRemoveBlockGroup_RemoveSuccess) {
     EXPECT_CALL(*etcdclient_, Delete(_)).WillOnce(Return(EtcdErrCode::EtcdOK));
 
@@ -26,7 +26,14 @@
 #include <brpc/server.h>
 #include <gtest/gtest.h>
 #include <cassert>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "curvefs/proto/common.pb.h"
@@ -215,10 +222,48 @@ TEST_F(VolumeSpaceTest, TestAllocateBlockGroups_PersistBlockGroupError) {
 
     EXPECT_CALL(*storage_, PutBlockGroup(_, _, _))
         .WillOnce(Return(SpaceErrStorage));
+    EXPECT_CALL(*storage_, RemoveBlockGroup(_, _))
+        .Times(kAllocateOnce)
+        .WillRepeatedly(Return(SpaceOk));
 
     std::vector<BlockGroup> groups;
     EXPECT_EQ(SpaceErrStorage,
               space->AllocateBlockGroups(kAllocateOnce, kOwner, &groups));
+    EXPECT_TRUE(groups.empty());
+
+    // failed block groups are given back and can be allocated again
+    EXPECT_CALL(*storage_, PutBlockGroup(_, _, _))
+        .WillRepeatedly(Return(SpaceOk));
+    ASSERT_EQ(SpaceOk,
+              space->AllocateBlockGroups(kAllocateOnce, kOwner, &groups));
+    ASSERT_EQ(kAllocateOnce, groups.size());
+    ASSERT_EQ(0, groups[0].offset());
+}
+
+TEST_F(VolumeSpaceTest, TestAllocateBlockGroups_PersistWithoutShardLock) {
+    auto space = CreateOneEmptyVolumeSpace();
+    VolumeSpace* raw = space.get();
+
+    // shard's lock isn't held while persisting, otherwise releasing block
+    // groups here deadlocks, and groups being allocated are invisible to it
+    EXPECT_CALL(*storage_, PutBlockGroup(_, _, _))
+        .Times(kAllocateOnce)
+        .WillRepeatedly(Invoke([raw](uint32_t, uint64_t,
+                                     const BlockGroup&) -> SpaceErrCode {
+            EXPECT_EQ(SpaceOk, raw->ReleaseBlockGroups(kOwner));
+            return SpaceOk;
+        }));
+
+    std::vector<BlockGroup> groups;
+    ASSERT_EQ(SpaceOk,
+              space->AllocateBlockGroups(kAllocateOnce, kOwner, &groups));
+    ASSERT_EQ(kAllocateOnce, groups.size());
+
+    // they're allocated once persisted
+    EXPECT_CALL(*storage_, RemoveBlockGroup(_, _))
+        .Times(kAllocateOnce)
+        .WillRepeatedly(Return(SpaceOk));
+    ASSERT_EQ(SpaceOk, space->ReleaseBlockGroups(groups));
 }
 
 TEST_F(VolumeSpaceTest, TestAllocateBlockGroups) {
@@ -259,6 +304,117 @@ TEST_F(VolumeSpaceTest, TestAllocateBlockGroups) {
               space->AllocateBlockGroups(kAllocateOnce, kOwner, &groups));
 }
 
+TEST_F(VolumeSpaceTest, TestAllocateBlockGroups_AdjacentGroups) {
+    auto space = CreateOneEmptyVolumeSpace();
+
+    EXPECT_CALL(*storage_, PutBlockGroup(_, _, _))
+        .WillRepeatedly(Return(SpaceOk));
+
+    // allocations of one owner come from the same stripe of block groups
+    std::vector<BlockGroup> groups;
+    for (int i = 0; i < 4; ++i) {
+        std::vector<BlockGroup> newGroups;
+        ASSERT_EQ(SpaceOk, space->AllocateBlockGroups(1, kOwner, &newGroups));
+        groups.insert(groups.end(), newGroups.begin(), newGroups.end());
+    }
+
+    for (size_t i = 1; i < groups.size(); ++i) {
+        ASSERT_EQ(groups[i - 1].offset() + kBlockGroupSize,
+                  groups[i].offset());
+    }
+}
+
+TEST_F(VolumeSpaceTest, TestAllocateBlockGroups_Concurrent) {
+    auto space = CreateOneEmptyVolumeSpace();
+    constexpr auto totalGroups = kVolumeSize / kBlockGroupSize;
+
+    EXPECT_CALL(*storage_, PutBlockGroup(_, _, _))
+        .Times(totalGroups)
+        .WillRepeatedly(Return(SpaceOk));
+
+    constexpr int kThreads = 8;
+    std::vector<std::vector<BlockGroup>> allocated(kThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&space, &allocated, i]() {
+            const std::string owner = "owner-" + std::to_string(i);
+            while (true) {
+                std::vector<BlockGroup> groups;
+                space->AllocateBlockGroups(2, owner, &groups);
+                if (groups.empty()) {
+                    break;
+                }
+                allocated[i].insert(allocated[i].end(), groups.begin(),
+                                    groups.end());
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::set<uint64_t> offsets;
+    for (auto& groups : allocated) {
+        for (auto& group : groups) {
+            ASSERT_TRUE(offsets.insert(group.offset()).second);
+        }
+    }
+    ASSERT_EQ(totalGroups, offsets.size());
+}
+
+TEST_F(VolumeSpaceTest, TestAllocateAndReleaseBlockGroups_Concurrent) {
+    auto space = CreateOneEmptyVolumeSpace();
+
+    // records in storage, persisting is slow to expose reordered writes
+    std::mutex mtx;
+    std::map<uint64_t, BlockGroup> persisted;
+    EXPECT_CALL(*storage_, PutBlockGroup(_, _, _))
+        .WillRepeatedly(Invoke([&](uint32_t, uint64_t offset,
+                                   const BlockGroup& group) -> SpaceErrCode {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            std::lock_guard<std::mutex> lk(mtx);
+            persisted[offset] = group;
+            return SpaceOk;
+        }));
+
+    constexpr int kOwners = 4;
+    constexpr int kLoops = 50;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kOwners; ++i) {
+        const std::string owner = "owner-" + std::to_string(i);
+        threads.emplace_back([&space, owner]() {
+            for (int j = 0; j < kLoops; ++j) {
+                std::vector<BlockGroup> groups;
+                space->AllocateBlockGroups(2, owner, &groups);
+            }
+        });
+        threads.emplace_back([&space, owner]() {
+            for (int j = 0; j < kLoops; ++j) {
+                space->ReleaseBlockGroups(owner);
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (int i = 0; i < kOwners; ++i) {
+        ASSERT_EQ(SpaceOk,
+                  space->ReleaseBlockGroups("owner-" + std::to_string(i)));
+    }
+
+    // every block group is released, so the last record of each one must
+    // not have an owner
+    std::lock_guard<std::mutex> lk(mtx);
+    ASSERT_FALSE(persisted.empty());
+    for (const auto& record : persisted) {
+        ASSERT_FALSE(record.second.has_owner())
+            << record.second.ShortDebugString();
+    }
+}
+
 TEST_F(VolumeSpaceTest, TestAutoExtendVolume_ExtendError) {
     volume_.set_autoextend(true);
     volume_.set_extendfactor(kExtendFactor);
@@ -374,9 +530,10 @@ TEST_F(VolumeSpaceTest, TestAutoExtendVolumeSuccess) {
     std::vector<BlockGroup> newGroups;
     ASSERT_EQ(SpaceOk, space->AllocateBlockGroups(1, kOwner, &newGroups));
 
-    ASSERT_EQ(totalGroups + 1, space->allocatedGroups_.size());
-    ASSERT_TRUE(space->availableGroups_.empty());
-    ASSERT_FALSE(space->cleanGroups_.empty());
+    auto counts = space->CountGroups();
+    ASSERT_EQ(totalGroups + 1, counts.allocated);
+    ASSERT_EQ(0, counts.available);
+    ASSERT_NE(0, counts.clean);
 
     server.Stop(0);
     server.Join();
@@ -537,7 +694,7 @@ TEST_F(VolumeSpaceTest, Test_CalBlockGroupAvailableForDeAllocate) {
         space = CreateVolumeSpaceWithTwoGroups(false);
         sleep(1);
         ASSERT_EQ(0, space->waitDeallocateGroups_.size());
-        ASSERT_EQ(2, space->availableGroups_.size());
+        ASSERT_EQ(2, space->CountGroups().available);
     }
 
     // 2. test cal one and issue
@@ -550,8 +707,9 @@ TEST_F(VolumeSpaceTest, Test_CalBlockGroupAvailableForDeAllocate) {
         space->CalBlockGroupAvailableForDeAllocate();
         ASSERT_EQ(1, space->waitDeallocateGroups_.size());
         ASSERT_EQ(exists[0].offset(), space->waitDeallocateGroups_[0].offset());
-        ASSERT_EQ(1, space->availableGroups_.size());
-        ASSERT_EQ(exists[0].offset(), space->availableGroups_[0].offset());
+        ASSERT_EQ(1, space->CountGroups().available);
+        ASSERT_EQ(1, space->ShardOf(exists[1].offset())
+                         .availableGroups.count(exists[1].offset()));
         ASSERT_EQ(kBlockGroupSize / 2, space->summary_[exists[0].offset()]);
         ASSERT_EQ(kBlockGroupSize / 4, space->summary_[exists[1].offset()]);
 
@@ -637,8 +795,9 @@ TEST_F(VolumeSpaceTest, Test_CalBlockGroupAvailableForDeAllocate) {
         space->CalBlockGroupAvailableForDeAllocate();
         ASSERT_EQ(1, space->waitDeallocateGroups_.count(exists[1].offset()));
         ASSERT_EQ(1, space->waitDeallocateGroups_.size());
-        ASSERT_EQ(1, space->availableGroups_.count(exists[0].offset()));
-        ASSERT_EQ(1, space->availableGroups_.size());
+        ASSERT_EQ(1, space->ShardOf(exists[0].offset())
+                         .availableGroups.count(exists[0].offset()));
+        ASSERT_EQ(1, space->CountGroups().available);
     }
 }
 
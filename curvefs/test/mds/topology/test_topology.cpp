@@ -1224,6 +1224,46 @@ TEST_F(TestTopology, UpdatePartitionTxIds_success) {
     ASSERT_EQ(TopoStatusCode::TOPO_OK, ret);
 }
 
+TEST_F(TestTopology, UpdatePartitionStatistic_KeepReadOnly) {
+    PoolIdType poolId = 0x11;
+    ZoneIdType zoneId = 0x21;
+    ServerIdType serverId = 0x31;
+    MetaServerIdType msId = 0x41;
+    CopySetIdType csId = 0x51;
+    PartitionIdType pId = 0x61;
+    PrepareAddPool(poolId);
+    PrepareAddZone(zoneId);
+    PrepareAddServer(serverId);
+    PrepareAddMetaServer(msId,
+            "metaserver",
+            "token",
+            serverId);
+    PrepareAddCopySet(csId, poolId, {});
+    PrepareAddPartition(0x01, poolId, csId, pId, 1, 100);
+
+    EXPECT_CALL(*storage_, UpdatePartition(_))
+        .Times(2)
+        .WillRepeatedly(Return(true));
+    ASSERT_EQ(TopoStatusCode::TOPO_OK,
+              topology_->UpdatePartitionStatus(pId,
+                                               PartitionStatus::READONLY));
+
+    // statistic reported with READWRITE doesn't bring it back
+    PartitionStatistic statistic;
+    statistic.status = PartitionStatus::READWRITE;
+    statistic.inodeNum = 10;
+    statistic.dentryNum = 20;
+    statistic.nextId = 11;
+    ASSERT_EQ(TopoStatusCode::TOPO_OK,
+              topology_->UpdatePartitionStatistic(pId, statistic));
+
+    Partition partition;
+    ASSERT_TRUE(topology_->GetPartition(pId, &partition));
+    ASSERT_EQ(PartitionStatus::READONLY, partition.GetStatus());
+    ASSERT_EQ(10, partition.GetInodeNum());
+    ASSERT_EQ(20, partition.GetDentryNum());
+}
+
 TEST_F(TestTopology, FindPool_success) {
     PoolIdType poolId = 0x01;
     std::string poolName = "pool1";
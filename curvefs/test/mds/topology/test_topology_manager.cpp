@@ -33,6 +33,7 @@
 
 #include "curvefs/proto/topology.pb.h"
 #include "curvefs/src/mds/common/mds_define.h"
+#include "curvefs/src/mds/topology/partition_splitter.h"
 #include "curvefs/src/mds/topology/topology_item.h"
 #include "curvefs/src/mds/topology/topology_manager.h"
 #include "curvefs/test/mds/mock/mock_metaserver.h"
@@ -3069,6 +3070,299 @@ TEST_F(TestTopologyManager, test_AllocOrGetMemcacheCluster_StorageFail) {
     ASSERT_EQ(TopoStatusCode::TOPO_STORGE_FAIL, response.statuscode());
 }
 
+TEST_F(TestTopologyManager, test_SplitPartition) {
+    FsIdType fsId = 0x01;
+    PoolIdType poolId = 0x11;
+    CopySetIdType copysetId1 = 0x51;
+    CopySetIdType copysetId2 = 0x52;
+    CopySetIdType copysetId3 = 0x53;
+    PartitionIdType hotId = 0x61;
+    PartitionIdType busyId = 0x62;
+    PartitionIdType newId = 0x63;
+
+    PrepareAddPool(poolId);
+    PrepareAddZone(0x21, "zone1", poolId);
+    PrepareAddZone(0x22, "zone2", poolId);
+    PrepareAddZone(0x23, "zone3", poolId);
+    PrepareAddServer(0x31, "server1", "127.0.0.1", 0, "127.0.0.1", 0,
+                     0x21, 0x11);
+    PrepareAddServer(0x32, "server2", "127.0.0.1", 0, "127.0.0.1", 0,
+                     0x22, 0x11);
+    PrepareAddServer(0x33, "server3", "127.0.0.1", 0, "127.0.0.1", 0,
+                     0x23, 0x11);
+    PrepareAddMetaServer(0x41, "ms1", "token1", 0x31, "127.0.0.1",
+                         7777, "ip2", 8888);
+    PrepareAddMetaServer(0x42, "ms2", "token2", 0x32, "127.0.0.1",
+                         7777, "ip2", 8888);
+    PrepareAddMetaServer(0x43, "ms3", "token3", 0x33, "127.0.0.1",
+                         7777, "ip2", 8888);
+
+    std::set<MetaServerIdType> replicas;
+    replicas.insert(0x41);
+    replicas.insert(0x42);
+    replicas.insert(0x43);
+    PrepareAddCopySet(copysetId1, poolId, replicas);
+    PrepareAddCopySet(copysetId2, poolId, replicas);
+    PrepareAddCopySet(copysetId3, poolId, replicas);
+
+    Partition hot(fsId, poolId, copysetId1, hotId, 0, 99);
+    hot.SetRequestRate(1000);
+    Partition busy(fsId, poolId, copysetId2, busyId, 100, 199);
+    busy.SetRequestRate(100);
+    EXPECT_CALL(*storage_, StoragePartition(_))
+        .Times(2)
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*storage_, StorageClusterInfo(_))
+        .Times(2)
+        .WillRepeatedly(Return(true));
+    ASSERT_EQ(TopoStatusCode::TOPO_OK, topology_->AddPartition(hot));
+    ASSERT_EQ(TopoStatusCode::TOPO_OK, topology_->AddPartition(busy));
+
+    // partition not found
+    PartitionInfo newPartition;
+    ASSERT_EQ(TopoStatusCode::TOPO_PARTITION_NOT_FOUND,
+              serviceManager_->SplitPartition(0x70, &newPartition));
+
+    // create partition on metaserver fail, hot partition is untouched
+    EXPECT_CALL(*idGenerator_, GenPartitionId()).WillOnce(Return(newId));
+    EXPECT_CALL(*mockMetaserverClient_,
+                CreatePartition(fsId, poolId, copysetId3, newId, _, _, _))
+        .WillOnce(Return(FSStatusCode::UNKNOWN_ERROR));
+    ASSERT_EQ(TopoStatusCode::TOPO_CREATE_PARTITION_FAIL,
+              serviceManager_->SplitPartition(hotId, &newPartition));
+    Partition partition;
+    ASSERT_TRUE(topology_->GetPartition(hotId, &partition));
+    ASSERT_EQ(PartitionStatus::READWRITE, partition.GetStatus());
+
+    // new partition is created on the idle copyset
+    EXPECT_CALL(*idGenerator_, GenPartitionId()).WillOnce(Return(newId));
+    EXPECT_CALL(*storage_, StoragePartition(_)).WillOnce(Return(true));
+    EXPECT_CALL(*storage_, StorageClusterInfo(_)).WillOnce(Return(true));
+    EXPECT_CALL(*storage_, UpdatePartition(_)).WillOnce(Return(true));
+    EXPECT_CALL(*mockMetaserverClient_,
+                CreatePartition(fsId, poolId, copysetId3, newId, _, _, _))
+        .WillOnce(Return(FSStatusCode::OK));
+    ASSERT_EQ(TopoStatusCode::TOPO_OK,
+              serviceManager_->SplitPartition(hotId, &newPartition));
+    ASSERT_EQ(newId, newPartition.partitionid());
+    ASSERT_EQ(copysetId3, newPartition.copysetid());
+    ASSERT_EQ(PartitionStatus::READWRITE, newPartition.status());
+    ASSERT_TRUE(topology_->GetPartition(hotId, &partition));
+    ASSERT_EQ(PartitionStatus::READONLY, partition.GetStatus());
+
+    // READONLY partition is not split again
+    ASSERT_EQ(TopoStatusCode::TOPO_INVALID_PARAM,
+              serviceManager_->SplitPartition(hotId, &newPartition));
+}
+
+TEST_F(TestTopologyManager, test_PartitionSplitter_SplitHotPartitions) {
+    FsIdType fsId = 0x01;
+    PoolIdType poolId = 0x11;
+    CopySetIdType copysetId1 = 0x51;
+    CopySetIdType copysetId2 = 0x52;
+    PartitionIdType hotId = 0x61;
+    PartitionIdType coldId = 0x62;
+    PartitionIdType newId = 0x63;
+
+    PrepareAddPool(poolId);
+    PrepareAddZone(0x21, "zone1", poolId);
+    PrepareAddZone(0x22, "zone2", poolId);
+    PrepareAddZone(0x23, "zone3", poolId);
+    PrepareAddServer(0x31, "server1", "127.0.0.1", 0, "127.0.0.1", 0,
+                     0x21, 0x11);
+    PrepareAddServer(0x32, "server2", "127.0.0.1", 0, "127.0.0.1", 0,
+                     0x22, 0x11);
+    PrepareAddServer(0x33, "server3", "127.0.0.1", 0, "127.0.0.1", 0,
+                     0x23, 0x11);
+    PrepareAddMetaServer(0x41, "ms1", "token1", 0x31, "127.0.0.1",
+                         7777, "ip2", 8888);
+    PrepareAddMetaServer(0x42, "ms2", "token2", 0x32, "127.0.0.1",
+                         7777, "ip2", 8888);
+    PrepareAddMetaServer(0x43, "ms3", "token3", 0x33, "127.0.0.1",
+                         7777, "ip2", 8888);
+
+    std::set<MetaServerIdType> replicas;
+    replicas.insert(0x41);
+    replicas.insert(0x42);
+    replicas.insert(0x43);
+    PrepareAddCopySet(copysetId1, poolId, replicas);
+    PrepareAddCopySet(copysetId2, poolId, replicas);
+
+    Partition hot(fsId, poolId, copysetId1, hotId, 0, 99);
+    hot.SetRequestRate(1000);
+    Partition cold(fsId, poolId, copysetId2, coldId, 100, 199);
+    cold.SetRequestRate(10);
+    EXPECT_CALL(*storage_, StoragePartition(_))
+        .Times(2)
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*storage_, StorageClusterInfo(_))
+        .Times(2)
+        .WillRepeatedly(Return(true));
+    ASSERT_EQ(TopoStatusCode::TOPO_OK, topology_->AddPartition(hot));
+    ASSERT_EQ(TopoStatusCode::TOPO_OK, topology_->AddPartition(cold));
+
+    TopologyOption option;
+    option.splitPartitionRequestRate = 500;
+    PartitionSplitter splitter(topology_, serviceManager_);
+    splitter.Init(option);
+
+    EXPECT_CALL(*idGenerator_, GenPartitionId()).WillOnce(Return(newId));
+    EXPECT_CALL(*storage_, StoragePartition(_)).WillOnce(Return(true));
+    EXPECT_CALL(*storage_, StorageClusterInfo(_)).WillOnce(Return(true));
+    EXPECT_CALL(*storage_, UpdatePartition(_)).WillOnce(Return(true));
+    EXPECT_CALL(*mockMetaserverClient_,
+                CreatePartition(fsId, poolId, copysetId2, newId, _, _, _))
+        .WillOnce(Return(FSStatusCode::OK));
+    ASSERT_EQ(1, splitter.SplitHotPartitions());
+
+    Partition partition;
+    ASSERT_TRUE(topology_->GetPartition(hotId, &partition));
+    ASSERT_EQ(PartitionStatus::READONLY, partition.GetStatus());
+    ASSERT_TRUE(topology_->GetPartition(newId, &partition));
+    ASSERT_EQ(PartitionStatus::READWRITE, partition.GetStatus());
+
+    // no hot partition any more
+    ASSERT_EQ(0, splitter.SplitHotPartitions());
+}
+
+TEST_F(TestTopologyManager, test_SplitPartition_NoAvailableCopyset) {
+    // only one copyset, partitions 0x61 and 0x62 belong to fs 0x01
+    PrepareTopo();
+
+    PartitionInfo newPartition;
+    ASSERT_EQ(TopoStatusCode::TOPO_GET_AVAILABLE_COPYSET_ERROR,
+              serviceManager_->SplitPartition(0x61, &newPartition));
+    Partition partition;
+    ASSERT_TRUE(topology_->GetPartition(0x61, &partition));
+    ASSERT_EQ(PartitionStatus::READWRITE, partition.GetStatus());
+}
+
+TEST_F(TestTopologyManager, test_SplitPartition_UpdateStatusFail) {
+    FsIdType fsId = 0x01;
+    PoolIdType poolId = 0x11;
+    CopySetIdType copysetId2 = 0x52;
+    PartitionIdType hotId = 0x61;
+    PartitionIdType newId = 0x64;
+
+    PrepareTopo();
+    std::set<MetaServerIdType> replicas;
+    replicas.insert(0x41);
+    replicas.insert(0x42);
+    replicas.insert(0x43);
+    PrepareAddCopySet(copysetId2, poolId, replicas);
+
+    EXPECT_CALL(*idGenerator_, GenPartitionId()).WillOnce(Return(newId));
+    EXPECT_CALL(*storage_, StoragePartition(_)).WillOnce(Return(true));
+    EXPECT_CALL(*storage_, StorageClusterInfo(_)).WillOnce(Return(true));
+    EXPECT_CALL(*mockMetaserverClient_,
+                CreatePartition(fsId, poolId, copysetId2, newId, _, _, _))
+        .WillOnce(Return(FSStatusCode::OK));
+    EXPECT_CALL(*storage_, UpdatePartition(_)).WillOnce(Return(false));
+
+    PartitionInfo newPartition;
+    ASSERT_EQ(TopoStatusCode::TOPO_STORGE_FAIL,
+              serviceManager_->SplitPartition(hotId, &newPartition));
+
+    // the hot partition keeps serving, the new one is available as well
+    Partition partition;
+    ASSERT_TRUE(topology_->GetPartition(hotId, &partition));
+    ASSERT_EQ(PartitionStatus::READWRITE, partition.GetStatus());
+    ASSERT_TRUE(topology_->GetPartition(newId, &partition));
+    ASSERT_EQ(PartitionStatus::READWRITE, partition.GetStatus());
+}
+
+TEST_F(TestTopologyManager, test_PartitionSplitter_HotPartitionFilter) {
+    FsIdType fsId = 0x01;
+    PoolIdType poolId = 0x11;
+    CopySetIdType copysetId = 0x51;
+    CopySetIdType copysetId2 = 0x52;
+    PartitionIdType readonlyId = 0x64;
+    PartitionIdType newId = 0x65;
+
+    // partitions 0x61, 0x62 and 0x63 are on copyset 0x51
+    PrepareTopo();
+    std::set<MetaServerIdType> replicas;
+    replicas.insert(0x41);
+    replicas.insert(0x42);
+    replicas.insert(0x43);
+    PrepareAddCopySet(copysetId2, poolId, replicas);
+    PrepareAddPartition(fsId, poolId, copysetId, readonlyId, 101, 200);
+
+    PartitionStatistic statistic;
+    statistic.status = PartitionStatus::READWRITE;
+    statistic.inodeNum = 1000;
+    statistic.dentryNum = 0;
+    statistic.nextId = 0;
+    EXPECT_CALL(*storage_, UpdatePartition(_)).WillOnce(Return(true));
+    ASSERT_EQ(TopoStatusCode::TOPO_OK,
+              topology_->UpdatePartitionStatistic(0x61, statistic));
+    statistic.status = PartitionStatus::READONLY;
+    EXPECT_CALL(*storage_, UpdatePartition(_)).WillOnce(Return(true));
+    ASSERT_EQ(TopoStatusCode::TOPO_OK,
+              topology_->UpdatePartitionStatistic(readonlyId, statistic));
+
+    PartitionSplitter splitter(topology_, serviceManager_);
+
+    // both limits are disabled
+    TopologyOption option;
+    splitter.Init(option);
+    ASSERT_EQ(0, splitter.SplitHotPartitions());
+
+    // split fail, try again next round
+    option.splitPartitionInodeNum = 500;
+    splitter.Init(option);
+    EXPECT_CALL(*idGenerator_, GenPartitionId()).WillOnce(Return(newId));
+    EXPECT_CALL(*mockMetaserverClient_,
+                CreatePartition(fsId, poolId, copysetId2, newId, _, _, _))
+        .WillOnce(Return(FSStatusCode::UNKNOWN_ERROR));
+    ASSERT_EQ(0, splitter.SplitHotPartitions());
+
+    // only the READWRITE partition with too many inodes is split
+    EXPECT_CALL(*idGenerator_, GenPartitionId()).WillOnce(Return(newId));
+    EXPECT_CALL(*storage_, StoragePartition(_)).WillOnce(Return(true));
+    EXPECT_CALL(*storage_, StorageClusterInfo(_)).WillOnce(Return(true));
+    EXPECT_CALL(*storage_, UpdatePartition(_)).WillOnce(Return(true));
+    EXPECT_CALL(*mockMetaserverClient_,
+                CreatePartition(fsId, poolId, copysetId2, newId, _, _, _))
+        .WillOnce(Return(FSStatusCode::OK));
+    ASSERT_EQ(1, splitter.SplitHotPartitions());
+
+    Partition partition;
+    ASSERT_TRUE(topology_->GetPartition(0x61, &partition));
+    ASSERT_EQ(PartitionStatus::READONLY, partition.GetStatus());
+    ASSERT_TRUE(topology_->GetPartition(0x62, &partition));
+    ASSERT_EQ(PartitionStatus::READWRITE, partition.GetStatus());
+    ASSERT_EQ(0, splitter.SplitHotPartitions());
+}
+
+TEST_F(TestTopologyManager, test_PartitionSplitter_Disabled) {
+    TopologyOption option;
+    option.splitPartitionIntervalSec = 0;
+    option.splitPartitionInodeNum = 1;
+    PartitionSplitter splitter(topology_, serviceManager_);
+    splitter.Init(option);
+
+    // background thread isn't started, stop is a no-op
+    splitter.Run();
+    splitter.Stop();
+}
+
+TEST(TestPartition, test_UpdateRequestRate) {
+    Partition partition;
+    partition.UpdateRequestRate(100, 1000);
+    ASSERT_EQ(0, partition.GetRequestRate());
+
+    partition.UpdateRequestRate(300, 3000);
+    ASSERT_EQ(100, partition.GetRequestRate());
+    ASSERT_EQ(300, partition.GetRequestNum());
+
+    // request number is reset by leader change, keep the last rate
+    partition.UpdateRequestRate(50, 4000);
+    ASSERT_EQ(100, partition.GetRequestRate());
+    partition.UpdateRequestRate(250, 5000);
+    ASSERT_EQ(200, partition.GetRequestRate());
+}
+
 }  // namespace topology
 }  // namespace mds
 }  // namespace curvefs
@@ -0,0 +1,281 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#include "curvefs/src/metaserver/copyset/apply_batch.h"
+
+#include <brpc/controller.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "curvefs/src/metaserver/copyset/copyset_node.h"
+#include "curvefs/test/metaserver/copyset/mock/mock_copyset_node_manager.h"
+#include "curvefs/test/metaserver/mock/mock_metastore.h"
+#include "src/common/timeutility.h"
+
+namespace curvefs {
+namespace metaserver {
+namespace copyset {
+
+using ::curve::common::TimeUtility;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+namespace {
+
+class FakeClosure : public google::protobuf::Closure {
+ public:
+    void Run() override { ++runTimes_; }
+
+    int RunTimes() const { return runTimes_; }
+
+ private:
+    int runTimes_ = 0;
+};
+
+MetaStatusCode FakeCreateDentry(const CreateDentryRequest*,
+                                CreateDentryResponse* response) {
+    response->set_statuscode(MetaStatusCode::OK);
+    return MetaStatusCode::OK;
+}
+
+}  // namespace
+
+class ApplyBatchTest : public testing::Test {
+ protected:
+    void SetUp() override {
+        braft::Configuration conf;
+        node_ = absl::make_unique<CopysetNode>(100, 100, conf,
+                                               &mockNodeManager_);
+        mockMetaStore_ = new mock::MockMetaStore();
+        node_->SetMetaStore(mockMetaStore_);
+
+        ON_CALL(*mockMetaStore_, Clear()).WillByDefault(Return(true));
+    }
+
+    // Item of a batch, the operator is owned by test
+    struct Item {
+        CreateDentryRequest request;
+        CreateDentryResponse response;
+        FakeClosure closure;
+        std::unique_ptr<CreateDentryOperator> op;
+    };
+
+    std::unique_ptr<Item> NewItem(uint32_t partitionId) {
+        auto item = absl::make_unique<Item>();
+        item->request.set_partitionid(partitionId);
+        item->op = absl::make_unique<CreateDentryOperator>(
+            node_.get(), &cntl_, &item->request, &item->response, nullptr);
+        return item;
+    }
+
+ protected:
+    MockCopysetNodeManager mockNodeManager_;
+    std::unique_ptr<CopysetNode> node_;
+    mock::MockMetaStore* mockMetaStore_;
+    brpc::Controller cntl_;
+};
+
+TEST_F(ApplyBatchTest, CanApplyInBatchTest) {
+    EXPECT_TRUE(ApplyBatch::CanApplyInBatch(OperatorType::CreateDentry));
+    EXPECT_TRUE(ApplyBatch::CanApplyInBatch(OperatorType::UpdateInode));
+    EXPECT_TRUE(
+        ApplyBatch::CanApplyInBatch(OperatorType::BatchUpdateInodeAttr));
+
+    EXPECT_FALSE(ApplyBatch::CanApplyInBatch(OperatorType::GetDentry));
+    EXPECT_FALSE(ApplyBatch::CanApplyInBatch(OperatorType::ListDentry));
+    EXPECT_FALSE(
+        ApplyBatch::CanApplyInBatch(OperatorType::GetOrModifyS3ChunkInfo));
+}
+
+TEST_F(ApplyBatchTest, DeferredClosureTest) {
+    // run before release
+    {
+        FakeClosure closure;
+        auto* deferred = new DeferredClosure(&closure);
+        deferred->Run();
+        EXPECT_EQ(0, closure.RunTimes());
+        deferred->Release();
+        EXPECT_EQ(1, closure.RunTimes());
+    }
+
+    // release before run
+    {
+        FakeClosure closure;
+        auto* deferred = new DeferredClosure(&closure);
+        deferred->Release();
+        EXPECT_EQ(0, closure.RunTimes());
+        deferred->Run();
+        EXPECT_EQ(1, closure.RunTimes());
+    }
+}
+
+TEST_F(ApplyBatchTest, SingleOperatorTest) {
+    auto item = NewItem(1);
+
+    EXPECT_CALL(*mockMetaStore_, BeginApplyBatch()).Times(0);
+    EXPECT_CALL(*mockMetaStore_, CommitApplyBatch()).Times(0);
+    EXPECT_CALL(*mockMetaStore_, CreateDentry(_, _))
+        .WillOnce(Invoke(FakeCreateDentry));
+
+    ApplyBatch batch(node_.get(), 1);
+    batch.Add(item->op.get(), 1, &item->closure,
+              TimeUtility::GetTimeofDayUs());
+    batch.Apply();
+
+    EXPECT_EQ(1, item->closure.RunTimes());
+    EXPECT_EQ(MetaStatusCode::OK, item->response.statuscode());
+}
+
+TEST_F(ApplyBatchTest, CommitSuccessTest) {
+    std::vector<std::unique_ptr<Item>> items;
+    ApplyBatch batch(node_.get(), 1);
+    for (int i = 0; i < 3; ++i) {
+        items.push_back(NewItem(1));
+        batch.Add(items.back()->op.get(), i + 1, &items.back()->closure,
+                  TimeUtility::GetTimeofDayUs());
+    }
+
+    EXPECT_CALL(*mockMetaStore_, BeginApplyBatch()).WillOnce(Return(true));
+    EXPECT_CALL(*mockMetaStore_, CreateDentry(_, _))
+        .Times(3)
+        .WillRepeatedly(Invoke(FakeCreateDentry));
+    // responses are sent only after the batch is committed
+    EXPECT_CALL(*mockMetaStore_, CommitApplyBatch())
+        .WillOnce(Invoke([&items]() {
+            for (const auto& item : items) {
+                EXPECT_EQ(0, item->closure.RunTimes());
+            }
+            return true;
+        }));
+
+    batch.Apply();
+
+    EXPECT_EQ(0, batch.Size());
+    for (const auto& item : items) {
+        EXPECT_EQ(1, item->closure.RunTimes());
+        EXPECT_EQ(MetaStatusCode::OK, item->response.statuscode());
+    }
+}
+
+TEST_F(ApplyBatchTest, CommitFailedTest) {
+    std::vector<std::unique_ptr<Item>> items;
+    ApplyBatch batch(node_.get(), 1);
+    for (int i = 0; i < 3; ++i) {
+        items.push_back(NewItem(1));
+        batch.Add(items.back()->op.get(), i + 1, &items.back()->closure,
+                  TimeUtility::GetTimeofDayUs());
+    }
+
+    EXPECT_CALL(*mockMetaStore_, BeginApplyBatch()).WillOnce(Return(true));
+    EXPECT_CALL(*mockMetaStore_, CreateDentry(_, _))
+        .Times(3)
+        .WillRepeatedly(Invoke(FakeCreateDentry));
+    EXPECT_CALL(*mockMetaStore_, CommitApplyBatch()).WillOnce(Return(false));
+
+    batch.Apply();
+
+    for (const auto& item : items) {
+        EXPECT_EQ(1, item->closure.RunTimes());
+        EXPECT_EQ(MetaStatusCode::STORAGE_INTERNAL_ERROR,
+                  item->response.statuscode());
+    }
+}
+
+TEST_F(ApplyBatchTest, BatchNotSupportedTest) {
+    std::vector<std::unique_ptr<Item>> items;
+    ApplyBatch batch(node_.get(), 1);
+    for (int i = 0; i < 2; ++i) {
+        items.push_back(NewItem(1));
+        batch.Add(items.back()->op.get(), i + 1, &items.back()->closure,
+                  TimeUtility::GetTimeofDayUs());
+    }
+
+    // operators are applied one by one and respond immediately
+    EXPECT_CALL(*mockMetaStore_, BeginApplyBatch()).WillOnce(Return(false));
+    EXPECT_CALL(*mockMetaStore_, CommitApplyBatch()).Times(0);
+    EXPECT_CALL(*mockMetaStore_, CreateDentry(_, _))
+        .WillOnce(Invoke(FakeCreateDentry))
+        .WillOnce(Invoke([&items](const CreateDentryRequest* request,
+                                  CreateDentryResponse* response) {
+            EXPECT_EQ(1, items[0]->closure.RunTimes());
+            return FakeCreateDentry(request, response);
+        }));
+
+    batch.Apply();
+
+    for (const auto& item : items) {
+        EXPECT_EQ(1, item->closure.RunTimes());
+    }
+}
+
+TEST_F(ApplyBatchTest, GroupTest) {
+    std::vector<std::shared_ptr<ApplyBatch>> pushed;
+    ApplyBatchGroup group(node_.get(), 2,
+                          [&pushed](const std::shared_ptr<ApplyBatch>& batch) {
+                              pushed.push_back(batch);
+                          });
+
+    EXPECT_TRUE(group.CanBatch(OperatorType::CreateDentry));
+    EXPECT_FALSE(group.CanBatch(OperatorType::GetDentry));
+
+    std::vector<std::unique_ptr<Item>> items;
+    for (uint32_t partitionId : {1, 2, 1, 2, 1}) {
+        items.push_back(NewItem(partitionId));
+        group.Add(items.back()->op.get(), items.size(),
+                  &items.back()->closure, TimeUtility::GetTimeofDayUs());
+    }
+
+    // batches are pushed once they're full
+    ASSERT_EQ(2, pushed.size());
+    EXPECT_EQ(1, pushed[0]->HashCode());
+    EXPECT_EQ(2, pushed[0]->Size());
+    EXPECT_EQ(2, pushed[1]->HashCode());
+    EXPECT_EQ(2, pushed[1]->Size());
+
+    // pending batches are pushed before an operator which can't be batched
+    group.PushAll();
+    ASSERT_EQ(3, pushed.size());
+    EXPECT_EQ(1, pushed[2]->HashCode());
+    EXPECT_EQ(1, pushed[2]->Size());
+
+    group.PushAll();
+    EXPECT_EQ(3, pushed.size());
+
+    // nothing is applied
+    for (const auto& item : items) {
+        EXPECT_EQ(0, item->closure.RunTimes());
+    }
+}
+
+TEST_F(ApplyBatchTest, GroupDisabledTest) {
+    ApplyBatchGroup group(node_.get(), 1,
+                          [](const std::shared_ptr<ApplyBatch>&) {});
+    EXPECT_FALSE(group.CanBatch(OperatorType::CreateDentry));
+    EXPECT_FALSE(group.CanBatch(OperatorType::GetDentry));
+}
+
+}  // namespace copyset
+}  // namespace metaserver
+}  // namespace curvefs
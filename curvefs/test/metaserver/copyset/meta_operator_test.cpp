@@ -22,14 +22,24 @@
 
 #include "curvefs/src/metaserver/copyset/meta_operator.h"
 
+#include <brpc/channel.h>
 #include <brpc/server.h>
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <regex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "curvefs/src/common/rpc_stream.h"
+#include "curvefs/test/metaserver/copyset/mock/mock_copyset_node.h"
 #include "curvefs/test/metaserver/copyset/mock/mock_copyset_node_manager.h"
 #include "curvefs/test/metaserver/copyset/mock/mock_raft_node.h"
 #include "curvefs/test/metaserver/mock/mock_metastore.h"
@@ -37,11 +47,14 @@
 #include "src/common/timeutility.h"
 #include "test/fs/mock_local_filesystem.h"
 
+DECLARE_int64(list_dentry_stream_max_buf_size);
+
 namespace curvefs {
 namespace metaserver {
 namespace copyset {
 
 const int kDummyServerPort = 32000;
+const int kListDentryServerPort = 32001;
 
 template <typename RequestT, typename ResponseT,
           MetaStatusCode code = MetaStatusCode::UNKNOWN_ERROR>
@@ -94,6 +107,10 @@ using ::testing::Invoke;
 using ::testing::Return;
 using ::testing::AtLeast;
 using ::testing::SetArgPointee;
+using ::curvefs::common::StreamClient;
+using ::curvefs::common::StreamOptions;
+using ::curvefs::common::StreamServer;
+using ::curvefs::common::StreamStatus;
 
 class MetaOperatorTest : public testing::Test {
  protected:
@@ -140,6 +157,7 @@ TEST_F(MetaOperatorTest, OperatorTypeTest) {
     TEST_OPERATOR_TYPE(BatchGetXAttr);
     TEST_OPERATOR_TYPE(CreateInode);
     TEST_OPERATOR_TYPE(UpdateInode);
+    TEST_OPERATOR_TYPE(BatchUpdateInodeAttr);
     TEST_OPERATOR_TYPE(GetOrModifyS3ChunkInfo);
     TEST_OPERATOR_TYPE(DeleteInode);
     TEST_OPERATOR_TYPE(CreateRootInode);
@@ -190,6 +208,7 @@ TEST_F(MetaOperatorTest, OnApplyErrorTest) {
     OPERATOR_ON_APPLY_TEST(BatchGetXAttr);
     OPERATOR_ON_APPLY_TEST(CreateInode);
     OPERATOR_ON_APPLY_TEST(UpdateInode);
+    OPERATOR_ON_APPLY_TEST(BatchUpdateInodeAttr);
     OPERATOR_ON_APPLY_TEST(DeleteInode);
     OPERATOR_ON_APPLY_TEST(CreateRootInode);
     OPERATOR_ON_APPLY_TEST(CreateManageInode);
@@ -308,6 +327,7 @@ TEST_F(MetaOperatorTest, OnApplyFromLogErrorTest) {
     OPERATOR_ON_APPLY_FROM_LOG_TEST(DeleteDentry);
     OPERATOR_ON_APPLY_FROM_LOG_TEST(CreateInode);
     OPERATOR_ON_APPLY_FROM_LOG_TEST(UpdateInode);
+    OPERATOR_ON_APPLY_FROM_LOG_TEST(BatchUpdateInodeAttr);
     OPERATOR_ON_APPLY_FROM_LOG_TEST(DeleteInode);
     OPERATOR_ON_APPLY_FROM_LOG_TEST(CreateRootInode);
     OPERATOR_ON_APPLY_FROM_LOG_TEST(CreateManageInode);
@@ -506,6 +526,100 @@ TEST_F(MetaOperatorTest, PropostTest_IsNotLeaseLeader) {
     EXPECT_FALSE(response.has_appliedindex());
 }
 
+TEST_F(MetaOperatorTest, PropostTest_FollowerRead) {
+    curve::fs::MockLocalFileSystem localFs;
+    MockCopysetNode node;
+    CopysetNodeOptions options;
+    options.dataUri = "local:///mnt/data";
+    options.localFileSystem = &localFs;
+    options.storageOptions.type = "memory";
+    options.enableFollowerRead = true;
+
+    EXPECT_CALL(localFs, Mkdir(_))
+        .WillOnce(Return(0));
+
+    EXPECT_TRUE(node.Init(options));
+    auto* mockMetaStore = new mock::MockMetaStore();
+    node.SetMetaStore(mockMetaStore);
+    auto* mockRaftNode = new MockRaftNode();
+    node.SetRaftNode(mockRaftNode);
+
+    ON_CALL(*mockMetaStore, Clear())
+        .WillByDefault(Return(true));
+    EXPECT_CALL(*mockRaftNode, apply(_))
+        .Times(0);
+    EXPECT_CALL(*mockRaftNode, shutdown(_))
+        .Times(AtLeast(1));
+    EXPECT_CALL(*mockRaftNode, join())
+        .Times(AtLeast(1));
+    EXPECT_CALL(node, IsLeaderTerm())
+        .WillRepeatedly(Return(false));
+
+    // CASE 1: fetch read index failed, redirect to leader
+    {
+        EXPECT_CALL(node, FetchReadIndex(_))
+            .WillOnce(Return(false));
+
+        GetDentryRequest request;
+        GetDentryResponse response;
+        auto op = absl::make_unique<GetDentryOperator>(
+            &node, nullptr, &request, &response, nullptr);
+        op->Propose();
+        EXPECT_EQ(MetaStatusCode::REDIRECTED, response.statuscode());
+    }
+
+    // CASE 2: wait apply timeout, redirect to leader
+    {
+        EXPECT_CALL(node, FetchReadIndex(_))
+            .WillOnce(DoAll(SetArgPointee<0>(200), Return(true)));
+        EXPECT_CALL(node, WaitScheduledIndex(200))
+            .WillOnce(Return(false));
+
+        GetDentryRequest request;
+        GetDentryResponse response;
+        auto op = absl::make_unique<GetDentryOperator>(
+            &node, nullptr, &request, &response, nullptr);
+        op->Propose();
+        EXPECT_EQ(MetaStatusCode::REDIRECTED, response.statuscode());
+    }
+
+    // CASE 3: read from local FSM
+    {
+        EXPECT_CALL(node, FetchReadIndex(_))
+            .WillOnce(DoAll(SetArgPointee<0>(200), Return(true)));
+        EXPECT_CALL(node, WaitScheduledIndex(200))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*mockMetaStore, GetDentry(_, _))
+            .WillOnce(Return(MetaStatusCode::OK));
+
+        GetDentryRequest request;
+        GetDentryResponse response;
+        auto op = absl::make_unique<GetDentryOperator>(
+            &node, nullptr, &request, &response, nullptr);
+        op->Propose();
+        op.release();
+
+        node.FlushApplyQueue();
+        EXPECT_TRUE(response.has_appliedindex());
+        EXPECT_EQ(200, response.appliedindex());
+    }
+
+    // CASE 4: write request is always redirected
+    {
+        EXPECT_CALL(node, FetchReadIndex(_))
+            .Times(0);
+
+        CreateInodeRequest request;
+        CreateInodeResponse response;
+        auto op = absl::make_unique<CreateInodeOperator>(
+            &node, nullptr, &request, &response, nullptr);
+        op->Propose();
+        EXPECT_EQ(MetaStatusCode::REDIRECTED, response.statuscode());
+    }
+
+    node.Stop();
+}
+
 TEST_F(MetaOperatorTest, PropostTest_PropostTaskFailed) {
     PoolId poolId = 100;
     CopysetId copysetId = 100;
@@ -556,6 +670,253 @@ TEST_F(MetaOperatorTest, PropostTest_PropostTaskFailed) {
     EXPECT_FALSE(response.has_appliedindex());
 }
 
+namespace {
+
+// list at most |count| entries of |names| after request's last
+MetaStatusCode FakeListDentry(const std::vector<std::string>& names,
+                              const ListDentryRequest* request,
+                              ListDentryResponse* response) {
+    auto it = names.begin();
+    if (request->has_last()) {
+        it = std::upper_bound(names.begin(), names.end(), request->last());
+    }
+    for (; it != names.end() &&
+           static_cast<uint32_t>(response->dentrys_size()) < request->count();
+         ++it) {
+        auto* dentry = response->add_dentrys();
+        dentry->set_fsid(request->fsid());
+        dentry->set_inodeid(100);
+        dentry->set_parentinodeid(request->dirinodeid());
+        dentry->set_name(*it);
+        dentry->set_txid(request->txid());
+    }
+    response->set_statuscode(MetaStatusCode::OK);
+    return MetaStatusCode::OK;
+}
+
+class FakeListDentryService : public MetaServerService {
+ public:
+    explicit FakeListDentryService(CopysetNode* node)
+        : node_(node), applied_(false) {}
+
+    void ListDentry(google::protobuf::RpcController* cntl,
+                    const ListDentryRequest* request,
+                    ListDentryResponse* response,
+                    google::protobuf::Closure* done) override {
+        ListDentryOperator op(node_, cntl, request, response, nullptr);
+        op.OnApply(1, done, TimeUtility::GetTimeofDayUs());
+        applied_.store(true);
+    }
+
+    bool Applied() const { return applied_.load(); }
+
+ private:
+    CopysetNode* node_;
+    std::atomic<bool> applied_;
+};
+
+}  // namespace
+
+TEST_F(MetaOperatorTest, ListDentryStreamingTest) {
+    auto node = std::make_shared<CopysetNode>(100, 100, braft::Configuration(),
+                                              &mockNodeManager_);
+    auto* mockMetaStore = new mock::MockMetaStore();
+    node->SetMetaStore(mockMetaStore);
+    auto streamServer = std::make_shared<StreamServer>();
+
+    std::vector<std::string> names;
+    for (int i = 0; i < 10; ++i) {
+        names.push_back("dentry" + std::to_string(i));
+    }
+
+    ON_CALL(*mockMetaStore, Clear())
+        .WillByDefault(Return(true));
+    EXPECT_CALL(*mockMetaStore, ListDentry(_, _))
+        .WillRepeatedly(Invoke([&](const ListDentryRequest* request,
+                                   ListDentryResponse* response) {
+            return FakeListDentry(names, request, response);
+        }));
+    EXPECT_CALL(*mockMetaStore, GetStreamServer())
+        .WillOnce(Return(streamServer));
+    EXPECT_CALL(mockNodeManager_, GetSharedCopysetNode(100, 100))
+        .WillOnce(Return(node));
+
+    // only one unconsumed message is allowed, so a sender is blocked until
+    // client consumes the previous page
+    auto oldMaxBufSize = FLAGS_list_dentry_stream_max_buf_size;
+    FLAGS_list_dentry_stream_max_buf_size = 1;
+
+    FakeListDentryService service(node.get());
+    brpc::Server server;
+    ASSERT_EQ(0, server.AddService(&service, brpc::SERVER_DOESNT_OWN_SERVICE));
+    ASSERT_EQ(0, server.Start(kListDentryServerPort, nullptr));
+
+    brpc::Channel channel;
+    ASSERT_EQ(0, channel.Init(
+                     ("127.0.0.1:" + std::to_string(kListDentryServerPort))
+                         .c_str(),
+                     nullptr));
+
+    // pages are consumed only after OnApply returns, if they're sent in
+    // OnApply, it's blocked by the stream buffer and never returns
+    std::vector<std::string> received;
+    bool consumedAfterApplied = true;
+    auto callback = [&](butil::IOBuf* buffer) -> bool {
+        for (int i = 0; i < 5000 && !service.Applied(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        consumedAfterApplied = consumedAfterApplied && service.Applied();
+
+        DentryVec page;
+        butil::IOBufAsZeroCopyInputStream wrapper(*buffer);
+        if (!page.ParseFromZeroCopyStream(&wrapper)) {
+            return false;
+        }
+        for (const auto& dentry : page.dentrys()) {
+            received.push_back(dentry.name());
+        }
+        return true;
+    };
+
+    StreamClient streamClient;
+    brpc::Controller cntl;
+    auto connection =
+        streamClient.Connect(&cntl, callback, StreamOptions(10000));
+    ASSERT_NE(nullptr, connection);
+
+    ListDentryRequest request;
+    ListDentryResponse response;
+    request.set_poolid(100);
+    request.set_copysetid(100);
+    request.set_partitionid(1);
+    request.set_fsid(1);
+    request.set_dirinodeid(1);
+    request.set_txid(0);
+    request.set_count(3);
+    request.set_streaming(true);
+
+    MetaServerService_Stub stub(&channel);
+    stub.ListDentry(&cntl, &request, &response, nullptr);
+    ASSERT_FALSE(cntl.Failed()) << cntl.ErrorText();
+    ASSERT_EQ(MetaStatusCode::OK, response.statuscode());
+    ASSERT_TRUE(response.streaming());
+    ASSERT_EQ(3, response.dentrys_size());
+
+    ASSERT_EQ(StreamStatus::STREAM_OK, connection->WaitAllDataReceived());
+    streamClient.Close(connection);
+    ASSERT_TRUE(consumedAfterApplied);
+    ASSERT_EQ(std::vector<std::string>(names.begin() + 3, names.end()),
+              received);
+
+    server.Stop(0);
+    server.Join();
+    FLAGS_list_dentry_stream_max_buf_size = oldMaxBufSize;
+
+    // wait sender to release the copyset
+    testing::Mock::VerifyAndClearExpectations(&mockNodeManager_);
+    while (node.use_count() > 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_F(MetaOperatorTest, ListDentryStreamingFailedTest) {
+    auto node = std::make_shared<CopysetNode>(100, 100, braft::Configuration(),
+                                              &mockNodeManager_);
+    auto* mockMetaStore = new mock::MockMetaStore();
+    node->SetMetaStore(mockMetaStore);
+    auto streamServer = std::make_shared<StreamServer>();
+
+    std::vector<std::string> names;
+    for (int i = 0; i < 10; ++i) {
+        names.push_back("dentry" + std::to_string(i));
+    }
+
+    // the first page is in response, the second page is streamed, and
+    // listing the third page fails
+    ON_CALL(*mockMetaStore, Clear())
+        .WillByDefault(Return(true));
+    EXPECT_CALL(*mockMetaStore, ListDentry(_, _))
+        .WillOnce(Invoke([&](const ListDentryRequest* request,
+                             ListDentryResponse* response) {
+            return FakeListDentry(names, request, response);
+        }))
+        .WillOnce(Invoke([&](const ListDentryRequest* request,
+                             ListDentryResponse* response) {
+            return FakeListDentry(names, request, response);
+        }))
+        .WillOnce(Return(MetaStatusCode::STORAGE_INTERNAL_ERROR));
+    EXPECT_CALL(*mockMetaStore, GetStreamServer())
+        .WillOnce(Return(streamServer));
+    EXPECT_CALL(mockNodeManager_, GetSharedCopysetNode(100, 100))
+        .WillOnce(Return(node));
+
+    FakeListDentryService service(node.get());
+    brpc::Server server;
+    ASSERT_EQ(0, server.AddService(&service, brpc::SERVER_DOESNT_OWN_SERVICE));
+    ASSERT_EQ(0, server.Start(kListDentryServerPort, nullptr));
+
+    brpc::Channel channel;
+    ASSERT_EQ(0, channel.Init(
+                     ("127.0.0.1:" + std::to_string(kListDentryServerPort))
+                         .c_str(),
+                     nullptr));
+
+    std::vector<std::string> received;
+    auto callback = [&](butil::IOBuf* buffer) -> bool {
+        DentryVec page;
+        butil::IOBufAsZeroCopyInputStream wrapper(*buffer);
+        if (!page.ParseFromZeroCopyStream(&wrapper)) {
+            return false;
+        }
+        for (const auto& dentry : page.dentrys()) {
+            received.push_back(dentry.name());
+        }
+        return true;
+    };
+
+    // idle timeout is long enough that only an error sent by server can
+    // finish the stream in time
+    StreamClient streamClient;
+    brpc::Controller cntl;
+    auto connection =
+        streamClient.Connect(&cntl, callback, StreamOptions(60000));
+    ASSERT_NE(nullptr, connection);
+
+    ListDentryRequest request;
+    ListDentryResponse response;
+    request.set_poolid(100);
+    request.set_copysetid(100);
+    request.set_partitionid(1);
+    request.set_fsid(1);
+    request.set_dirinodeid(1);
+    request.set_txid(0);
+    request.set_count(3);
+    request.set_streaming(true);
+
+    MetaServerService_Stub stub(&channel);
+    stub.ListDentry(&cntl, &request, &response, nullptr);
+    ASSERT_FALSE(cntl.Failed()) << cntl.ErrorText();
+    ASSERT_EQ(MetaStatusCode::OK, response.statuscode());
+    ASSERT_TRUE(response.streaming());
+    ASSERT_EQ(3, response.dentrys_size());
+
+    auto start = TimeUtility::GetTimeofDayMs();
+    ASSERT_EQ(StreamStatus::STREAM_ERROR, connection->WaitAllDataReceived());
+    ASSERT_LT(TimeUtility::GetTimeofDayMs() - start, 30000);
+    streamClient.Close(connection);
+    ASSERT_EQ(std::vector<std::string>(names.begin() + 3, names.begin() + 6),
+              received);
+
+    server.Stop(0);
+    server.Join();
+
+    // wait sender to release the copyset
+    testing::Mock::VerifyAndClearExpectations(&mockNodeManager_);
+    while (node.use_count() > 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
 }  // namespace copyset
 }  // namespace metaserver
 }  // namespace curvefs
@@ -48,6 +48,8 @@ class MockCopysetNode : public CopysetNode {
     MOCK_CONST_METHOD0(IsLeaderTerm, bool());
     MOCK_METHOD1(Propose, void(const braft::Task& task));
     MOCK_METHOD(void, GetLeaderLeaseStatus, (braft::LeaderLeaseStatus*), (override));  // NOLINT
+    MOCK_METHOD1(FetchReadIndex, bool(int64_t*));
+    MOCK_METHOD1(WaitScheduledIndex, bool(int64_t));
     MOCK_METHOD2(GetConfChange, void(ConfigChangeType *type, Peer *alterPeer));
 
     MOCK_CONST_METHOD0(GetPoolId, PoolId());
@@ -118,6 +118,7 @@ TEST(RaftLogCodecTest, DecodeFailedTest) {
     DECODE_FAILED_TEST(GetInode);
     DECODE_FAILED_TEST(CreateInode);
     DECODE_FAILED_TEST(UpdateInode);
+    DECODE_FAILED_TEST(BatchUpdateInodeAttr);
     DECODE_FAILED_TEST(DeleteInode);
     DECODE_FAILED_TEST(CreateRootInode);
     DECODE_FAILED_TEST(CreateManageInode);
@@ -151,6 +152,7 @@ TEST(RaftLogCodecTest, DecodeSuccessTest) {
     ENCODE_DECODE_TEST(GetInode);
     ENCODE_DECODE_TEST(CreateInode);
     ENCODE_DECODE_TEST(UpdateInode);
+    ENCODE_DECODE_TEST(BatchUpdateInodeAttr);
     ENCODE_DECODE_TEST(DeleteInode);
     ENCODE_DECODE_TEST(CreateRootInode);
     ENCODE_DECODE_TEST(CreateManageInode);
@@ -57,6 +57,7 @@ class DentryStorageTest : public ::testing::Test {
     }
 
     void TearDown() override {
+        FLAGS_storage_binary_key = false;
         ASSERT_TRUE(kvStorage_->Close());
         auto output = execShell("rm -rf " + dataDir_);
         ASSERT_EQ(output.size(), 0);
@@ -533,5 +534,49 @@ TEST_F(DentryStorageTest, HandleTx) {
     ASSERT_EQ(dentry.inodeid(), 1);
 }
 
+TEST_F(DentryStorageTest, MigrateKeys) {
+    FLAGS_storage_binary_key = true;
+    DentryStorage storage(kvStorage_, nameGenerator_, 0);
+
+    // dentrys written with legacy text keys
+    std::string table = nameGenerator_->GetDentryTableName();
+    for (const auto& name : std::vector<std::string>{"A", "B:", "C"}) {
+        DentryVec vec;
+        *vec.add_dentrys() = GenDentry(1, 0, name, 0, 1, false);
+        auto s = kvStorage_->SSet(table, "3:1:0:" + name, vec);
+        ASSERT_TRUE(s.ok());
+    }
+
+    Dentry dentry = GenDentry(1, 0, "B:", 0, 0, false);
+    ASSERT_EQ(storage.Get(&dentry), MetaStatusCode::NOT_FOUND);
+
+    ASSERT_EQ(storage.MigrateKeys(), MetaStatusCode::OK);
+    ASSERT_EQ(storage.Get(&dentry), MetaStatusCode::OK);
+    ASSERT_EQ(dentry.inodeid(), 1);
+
+    std::vector<Dentry> dentrys;
+    dentry = GenDentry(1, 0, "", 0, 0, false);
+    ASSERT_EQ(storage.List(dentry, &dentrys, 0), MetaStatusCode::OK);
+    ASSERT_EQ(dentrys.size(), 3);
+    ASSERT_EQ(dentrys[0].name(), "A");
+    ASSERT_EQ(dentrys[1].name(), "B:");
+    ASSERT_EQ(dentrys[2].name(), "C");
+
+    // migrate again is a no-op
+    ASSERT_EQ(storage.MigrateKeys(), MetaStatusCode::OK);
+    ASSERT_EQ(kvStorage_->SSize(table), 3);
+
+    // binary keys are rewritten back to text once the encoding is disabled
+    FLAGS_storage_binary_key = false;
+    ASSERT_EQ(storage.MigrateKeys(), MetaStatusCode::OK);
+    ASSERT_EQ(kvStorage_->SSize(table), 3);
+    DentryVec vec;
+    ASSERT_TRUE(kvStorage_->SGet(table, "3:1:0:B:", &vec).ok());
+
+    dentry = GenDentry(1, 0, "B:", 0, 0, false);
+    ASSERT_EQ(storage.Get(&dentry), MetaStatusCode::OK);
+    ASSERT_EQ(dentry.inodeid(), 1);
+}
+
 }  // namespace metaserver
 }  // namespace curvefs
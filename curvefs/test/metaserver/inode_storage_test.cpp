@@ -619,6 +619,44 @@ TEST_F(InodeStorageTest, ModifyInodeS3ChunkInfoList) {
     }
 }
 
+TEST_F(InodeStorageTest, GetInodeS3ChunkInfoListByChunkIndexes) {
+    uint32_t fsId = 1;
+    uint64_t inodeId = 1;
+    InodeStorage storage(kvStorage_, nameGenerator_, 0);
+
+    std::vector<uint64_t> chunkIndexs{1, 2, 10, 11};
+    std::vector<S3ChunkInfoList> lists2add{
+        GenS3ChunkInfoList(1, 1),
+        GenS3ChunkInfoList(2, 2),
+        GenS3ChunkInfoList(3, 3),
+        GenS3ChunkInfoList(4, 4),
+    };
+    for (size_t i = 0; i < chunkIndexs.size(); i++) {
+        MetaStatusCode rc = storage.ModifyInodeS3ChunkInfoList(
+            fsId, inodeId, chunkIndexs[i], &lists2add[i], nullptr);
+        ASSERT_EQ(rc, MetaStatusCode::OK);
+    }
+
+    // chunk 1 must not match chunk 10 and 11 by prefix
+    std::vector<uint64_t> expectIndexs{1, 11};
+    std::vector<S3ChunkInfoList> expectLists{lists2add[0], lists2add[3]};
+    auto iterator = storage.GetInodeS3ChunkInfoList(fsId, inodeId,
+                                                    {1, 11, 100});
+    ASSERT_EQ(iterator->Status(), 0);
+
+    size_t size = 0;
+    Key4S3ChunkInfoList key;
+    S3ChunkInfoList list4get;
+    for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+        ASSERT_TRUE(conv_->ParseFromString(iterator->Key(), &key));
+        ASSERT_TRUE(iterator->ParseFromValue(&list4get));
+        ASSERT_EQ(key.chunkIndex, expectIndexs[size]);
+        ASSERT_TRUE(EqualS3ChunkInfoList(list4get, expectLists[size]));
+        size++;
+    }
+    ASSERT_EQ(size, expectIndexs.size());
+}
+
 TEST_F(InodeStorageTest, PaddingInodeS3ChunkInfo) {
     uint32_t fsId = 1;
     uint64_t inodeId = 1;
@@ -742,7 +780,9 @@ TEST_F(InodeStorageTest, TestUpdateVolumeExtentSlice) {
 
         const std::string expectTableName =
             nameGenerator_->GetVolumeExtentTableName();
-        const std::string expectKey = "4:1:1:" + std::to_string(slice.offset());
+        const std::string expectKey =
+            storage::Key4VolumeExtentSlice(fsId, inodeId, slice.offset())
+                .SerializeToString();
         EXPECT_CALL(*kvStorage, SSet(expectTableName, expectKey, _))
             .WillOnce(Return(test.second));
 
@@ -850,6 +890,70 @@ TEST_F(InodeStorageTest, TestGetAllVolumeExtent) {
     }
 }
 
+static void SetExtent(VolumeExtent *ext, uint64_t fsOffset,
+                      uint64_t volumeOffset, uint64_t length, bool used) {
+    ext->set_fsoffset(fsOffset);
+    ext->set_volumeoffset(volumeOffset);
+    ext->set_length(length);
+    ext->set_isused(used);
+}
+
+TEST_F(InodeStorageTest, TestMergeVolumeExtentSlice) {
+    StorageOptions opts;
+    opts.compression = false;
+
+    std::shared_ptr<KVStorage> memStore =
+        std::make_shared<storage::MemoryStorage>(opts);
+    std::shared_ptr<KVStorage> kvStore = kvStorage_;
+
+    for (auto &store : {memStore, kvStore}) {
+        InodeStorage storage(store, nameGenerator_, 0);
+        const uint32_t fsId = 1;
+        const uint64_t inodeId = 3;
+
+        // merge into a non-existent slice
+        VolumeExtentSlice delta;
+        delta.set_offset(0);
+        SetExtent(delta.add_extents(), 0, 100, 40, false);
+        SetExtent(delta.add_extents(), 40, 200, 40, false);
+        ASSERT_EQ(MetaStatusCode::OK,
+                  storage.MergeVolumeExtentSlice(fsId, inodeId, delta));
+
+        // middle of first extent is written, and the second extent is
+        // written and merged with its right neighbour
+        delta.clear_extents();
+        SetExtent(delta.add_extents(), 10, 110, 10, true);
+        SetExtent(delta.add_extents(), 40, 200, 60, true);
+        ASSERT_EQ(MetaStatusCode::OK,
+                  storage.MergeVolumeExtentSlice(fsId, inodeId, delta));
+
+        VolumeExtentSlice expected;
+        expected.set_offset(0);
+        SetExtent(expected.add_extents(), 0, 100, 10, false);
+        SetExtent(expected.add_extents(), 10, 110, 10, true);
+        SetExtent(expected.add_extents(), 20, 120, 20, false);
+        SetExtent(expected.add_extents(), 40, 200, 60, true);
+
+        VolumeExtentSlice slice;
+        ASSERT_EQ(MetaStatusCode::OK,
+                  storage.GetVolumeExtentByOffset(fsId, inodeId, 0, &slice));
+        ASSERT_EQ(expected, slice);
+
+        // remaining parts of first extent are written
+        delta.clear_extents();
+        SetExtent(delta.add_extents(), 0, 100, 40, true);
+        ASSERT_EQ(MetaStatusCode::OK,
+                  storage.MergeVolumeExtentSlice(fsId, inodeId, delta));
+
+        expected.clear_extents();
+        SetExtent(expected.add_extents(), 0, 100, 40, true);
+        SetExtent(expected.add_extents(), 40, 200, 60, true);
+        ASSERT_EQ(MetaStatusCode::OK,
+                  storage.GetVolumeExtentByOffset(fsId, inodeId, 0, &slice));
+        ASSERT_EQ(expected, slice);
+    }
+}
+
 static std::string ToString(storage::STORAGE_TYPE type) {
     switch (type) {
     case storage::STORAGE_TYPE::MEMORY_STORAGE:
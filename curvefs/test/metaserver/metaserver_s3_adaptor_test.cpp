@@ -231,6 +231,77 @@ TEST_F(MetaserverS3AdaptorTest, test_delete_batch_chunks) {
     ASSERT_EQ(ret, 0);
 }
 
+TEST_F(MetaserverS3AdaptorTest, test_delete_inodes_in_batch) {
+    S3ClientAdaptorOption option;
+    option.blockSize = 1 * 1024 * 1024;
+    option.chunkSize = 4 * 1024 * 1024;
+    option.batchSize = 5;
+    option.objectPrefix = 0;
+    option.enableBatchDelete = true;
+    metaserverS3ClientAdaptor_->Init(option, mockMetaserverS3Client_);
+
+    // 3 inodes with 9 objects each, objects of different inodes and
+    // chunk indexes are merged into full batches
+    std::list<Inode> inodes;
+    for (uint64_t i = 1; i <= 3; i++) {
+        Inode inode;
+        InitInode(&inode);
+        inode.set_inodeid(i);
+        if (i == 3) {
+            auto infoList = inode.s3chunkinfomap().at(0);
+            inode.mutable_s3chunkinfomap()->insert({1, infoList});
+            inode.mutable_s3chunkinfomap()->erase(0);
+        }
+        inodes.push_back(inode);
+    }
+
+    std::set<std::string> deleteObject;
+    std::vector<size_t> batchSizes;
+    EXPECT_CALL(*mockMetaserverS3Client_, DeleteBatch(_))
+        .Times(6)
+        .WillRepeatedly(
+            Invoke([&](const std::list<std::string>& nameList) {
+                batchSizes.push_back(nameList.size());
+                deleteObject.insert(nameList.begin(), nameList.end());
+                return 0;
+            }));
+    ASSERT_EQ(0, metaserverS3ClientAdaptor_->DeleteInodes(inodes));
+    ASSERT_EQ(27, deleteObject.size());
+    ASSERT_EQ(std::vector<size_t>({5, 5, 5, 5, 5, 2}), batchSizes);
+
+    // delete fail
+    EXPECT_CALL(*mockMetaserverS3Client_, DeleteBatch(_))
+        .WillOnce(Return(-1));
+    ASSERT_EQ(-1, metaserverS3ClientAdaptor_->DeleteInodes(inodes));
+}
+
+TEST_F(MetaserverS3AdaptorTest, test_delete_throttle) {
+    S3ClientAdaptorOption option;
+    option.blockSize = 1 * 1024 * 1024;
+    option.chunkSize = 4 * 1024 * 1024;
+    option.batchSize = 1;
+    option.objectPrefix = 0;
+    option.enableBatchDelete = true;
+    option.deleteRequestsPerSec = 4;
+    metaserverS3ClientAdaptor_->Init(option, mockMetaserverS3Client_);
+
+    S3ClientAdaptorOption getOption;
+    metaserverS3ClientAdaptor_->GetS3ClientAdaptorOption(&getOption);
+    ASSERT_EQ(4, getOption.deleteRequestsPerSec);
+
+    curvefs::metaserver::Inode inode;
+    InitInode(&inode);
+
+    // 9 objects and 1 object per request, at 4 requests per second
+    EXPECT_CALL(*mockMetaserverS3Client_, DeleteBatch(_))
+        .Times(9)
+        .WillRepeatedly(Return(0));
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(0, metaserverS3ClientAdaptor_->Delete(inode));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_GE(elapsed, std::chrono::seconds(1));
+}
+
 TEST_F(MetaserverS3AdaptorTest, test_delete_batch_idempotence) {
     S3ClientAdaptorOption option;
     option.blockSize = 1 * 1024 * 1024;
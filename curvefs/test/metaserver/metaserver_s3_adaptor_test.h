@@ -25,9 +25,12 @@
 #include <google/protobuf/util/message_differencer.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <functional>
+#include <list>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "curvefs/src/metaserver/s3/metaserver_s3_adaptor.h"
 #include "curvefs/test/client/mock_client_s3.h"
@@ -86,6 +86,7 @@ TEST_F(MetaServerServiceTest2, ServiceOverload) {
     TEST_SERVICE_OVERLOAD(GetInode);
     TEST_SERVICE_OVERLOAD(CreateInode);
     TEST_SERVICE_OVERLOAD(UpdateInode);
+    TEST_SERVICE_OVERLOAD(BatchUpdateInodeAttr);
     TEST_SERVICE_OVERLOAD(DeleteInode);
     TEST_SERVICE_OVERLOAD(CreateRootInode);
     TEST_SERVICE_OVERLOAD(CreateManageInode);
@@ -124,6 +125,7 @@ TEST_F(MetaServerServiceTest2, CopysetNodeNotFound) {
     TEST_COPYSETNODE_NOTFOUND(BatchGetXAttr);
     TEST_COPYSETNODE_NOTFOUND(CreateInode);
     TEST_COPYSETNODE_NOTFOUND(UpdateInode);
+    TEST_COPYSETNODE_NOTFOUND(BatchUpdateInodeAttr);
     TEST_COPYSETNODE_NOTFOUND(DeleteInode);
     TEST_COPYSETNODE_NOTFOUND(CreateRootInode);
     TEST_COPYSETNODE_NOTFOUND(CreateManageInode);
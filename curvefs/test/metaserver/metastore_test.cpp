@@ -522,6 +522,12 @@ TEST_F(MetastoreTest, test_inode) {
     ASSERT_EQ(getResponse.inode().type(), type);
     ASSERT_TRUE(CompareInode(createResponse.inode(), getResponse.inode()));
 
+    // only inode creating requests which reach the partition are counted
+    std::list<PartitionInfo> partitionList;
+    ASSERT_TRUE(metastore.GetPartitionInfoList(&partitionList));
+    ASSERT_EQ(1, partitionList.size());
+    ASSERT_EQ(3, partitionList.front().requestnum());
+
     GetInodeRequest getRequest2;
     GetInodeResponse getResponse2;
     getRequest2.set_poolid(poolId);
@@ -1360,6 +1366,100 @@ TEST_F(MetastoreTest, testBatchGetInodeAttr) {
     }
 }
 
+TEST_F(MetastoreTest, testBatchUpdateInodeAttr) {
+    MetaStoreImpl metastore(copyset_.get(), options_);
+    ASSERT_TRUE(metastore.InitStorage());
+
+    uint32_t poolId = 2;
+    uint32_t copysetId = 3;
+    uint32_t partitionId = 1;
+    uint32_t fsId = 1;
+
+    BatchUpdateInodeAttrRequest batchRequest;
+    BatchUpdateInodeAttrResponse batchResponse;
+    batchRequest.set_poolid(poolId);
+    batchRequest.set_copysetid(copysetId);
+    batchRequest.set_partitionid(partitionId);
+    batchRequest.set_fsid(fsId);
+
+    // partition not found
+    MetaStatusCode ret =
+        metastore.BatchUpdateInodeAttr(&batchRequest, &batchResponse);
+    ASSERT_EQ(ret, MetaStatusCode::PARTITION_NOT_FOUND);
+
+    // create partition1
+    CreatePartitionRequest createPartitionRequest;
+    CreatePartitionResponse createPartitionResponse;
+    PartitionInfo partitionInfo1;
+    partitionInfo1.set_fsid(fsId);
+    partitionInfo1.set_poolid(poolId);
+    partitionInfo1.set_copysetid(copysetId);
+    partitionInfo1.set_partitionid(partitionId);
+    partitionInfo1.set_start(100);
+    partitionInfo1.set_end(1000);
+    createPartitionRequest.mutable_partition()->CopyFrom(partitionInfo1);
+    ret = metastore.CreatePartition(&createPartitionRequest,
+                                    &createPartitionResponse);
+    ASSERT_EQ(ret, MetaStatusCode::OK);
+
+    // create two inodes
+    CreateInodeRequest createRequest;
+    CreateInodeResponse createResponse;
+    createRequest.set_poolid(poolId);
+    createRequest.set_copysetid(copysetId);
+    createRequest.set_partitionid(partitionId);
+    createRequest.set_fsid(fsId);
+    createRequest.set_length(0);
+    createRequest.set_uid(100);
+    createRequest.set_gid(200);
+    createRequest.set_mode(777);
+    createRequest.set_type(FsFileType::TYPE_FILE);
+
+    ret = metastore.CreateInode(&createRequest, &createResponse);
+    ASSERT_EQ(ret, MetaStatusCode::OK);
+    uint64_t inodeId1 = createResponse.inode().inodeid();
+    ret = metastore.CreateInode(&createRequest, &createResponse);
+    ASSERT_EQ(ret, MetaStatusCode::OK);
+    uint64_t inodeId2 = createResponse.inode().inodeid();
+
+    auto addUpdate = [&](uint64_t inodeId, uint64_t length) {
+        UpdateInodeRequest *update = batchRequest.add_update();
+        update->set_poolid(poolId);
+        update->set_copysetid(copysetId);
+        update->set_partitionid(partitionId);
+        update->set_fsid(fsId);
+        update->set_inodeid(inodeId);
+        update->set_length(length);
+    };
+    addUpdate(inodeId1, 4096);
+    addUpdate(inodeId2, 8192);
+    addUpdate(inodeId2 + 100, 1);  // not exist
+
+    ret = metastore.BatchUpdateInodeAttr(&batchRequest, &batchResponse);
+    ASSERT_EQ(ret, MetaStatusCode::OK);
+    ASSERT_EQ(batchResponse.statuscode(), MetaStatusCode::OK);
+    ASSERT_EQ(batchResponse.updatestatus_size(), 3);
+    ASSERT_EQ(batchResponse.updatestatus(0), MetaStatusCode::OK);
+    ASSERT_EQ(batchResponse.updatestatus(1), MetaStatusCode::OK);
+    ASSERT_EQ(batchResponse.updatestatus(2), MetaStatusCode::NOT_FOUND);
+
+    GetInodeRequest getRequest;
+    GetInodeResponse getResponse;
+    getRequest.set_poolid(poolId);
+    getRequest.set_copysetid(copysetId);
+    getRequest.set_partitionid(partitionId);
+    getRequest.set_fsid(fsId);
+    getRequest.set_inodeid(inodeId1);
+    ret = metastore.GetInode(&getRequest, &getResponse);
+    ASSERT_EQ(ret, MetaStatusCode::OK);
+    ASSERT_EQ(getResponse.inode().length(), 4096);
+
+    getRequest.set_inodeid(inodeId2);
+    ret = metastore.GetInode(&getRequest, &getResponse);
+    ASSERT_EQ(ret, MetaStatusCode::OK);
+    ASSERT_EQ(getResponse.inode().length(), 8192);
+}
+
 TEST_F(MetastoreTest, testBatchGetXAttr) {
     MetaStoreImpl metastore(copyset_.get(), options_);
     ASSERT_TRUE(metastore.InitStorage());
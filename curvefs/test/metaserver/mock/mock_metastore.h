@@ -79,6 +79,9 @@ class MockMetaStore : public curvefs::metaserver::MetaStore {
                                              DeleteInodeResponse*));
     MOCK_METHOD2(UpdateInode, MetaStatusCode(const UpdateInodeRequest*,
                                              UpdateInodeResponse*));
+    MOCK_METHOD2(BatchUpdateInodeAttr,
+                 MetaStatusCode(const BatchUpdateInodeAttrRequest*,
+                                BatchUpdateInodeAttrResponse*));
 
     MOCK_METHOD2(PrepareRenameTx, MetaStatusCode(const PrepareRenameTxRequest*,
                                                  PrepareRenameTxResponse*));
@@ -105,6 +108,9 @@ class MockMetaStore : public curvefs::metaserver::MetaStore {
     MOCK_METHOD2(UpdateDeallocatableBlockGroup,
                  MetaStatusCode(const UpdateDeallocatableBlockGroupRequest *,
                                 UpdateDeallocatableBlockGroupResponse *));
+
+    MOCK_METHOD0(BeginApplyBatch, bool());
+    MOCK_METHOD0(CommitApplyBatch, bool());
 };
 
 }  // namespace mock
@@ -24,6 +24,7 @@
 
 #include <gmock/gmock.h>
 
+#include <list>
 #include <memory>
 #include <string>
 
@@ -41,6 +42,7 @@ class MockS3ClientAdaptor : public S3ClientAdaptor {
                  void(const S3ClientAdaptorOption& option, S3Client* client));
     MOCK_METHOD1(Delete, int(const Inode& inode));
     MOCK_METHOD1(DeleteBatch, int(const Inode& inode));
+    MOCK_METHOD1(DeleteInodes, int(const std::list<Inode>& inodes));
     MOCK_METHOD5(Reinit, void(const S3ClientAdaptorOption& option,
         const std::string& ak, const std::string& sk,
         const std::string& endpoint, const std::string& bucketName));
@@ -36,9 +36,11 @@
 using ::curvefs::client::rpcclient::MockMdsClient;
 using ::curvefs::mds::FSStatusCode;
 using ::testing::_;
+using ::testing::DoAll;
 using ::testing::Invoke;
 using ::testing::Matcher;
 using ::testing::Return;
+using ::testing::SetArgPointee;
 
 using ::curvefs::metaserver::storage::KVStorage;
 using ::curvefs::metaserver::storage::RandomStoragePath;
@@ -183,7 +185,12 @@ TEST_F(PartitionCleanManagerTest, test1) {
             task.done->Run();
         }));
 
-    EXPECT_CALL(*s3Adaptor_, Delete(_)).WillOnce(Return(0));
+    EXPECT_CALL(*s3Adaptor_, DeleteInodes(_))
+        .WillOnce(Invoke([inode1](const std::list<Inode>& inodes) {
+            EXPECT_EQ(1, inodes.size());
+            EXPECT_EQ(inode1.inodeid(), inodes.front().inodeid());
+            return 0;
+        }));
     EXPECT_CALL(*s3Adaptor_, GetS3ClientAdaptorOption(_));
     EXPECT_CALL(*s3Adaptor_, Reinit(_, _, _, _, _));
 
@@ -216,5 +223,63 @@ TEST_F(PartitionCleanManagerTest, GetFsInfoFail) {
               MetaStatusCode::S3_DELETE_ERR);
 }
 
+TEST_F(PartitionCleanManagerTest, CleanDataAndDeleteInodesInBatch) {
+    // fsinfo of fs 2 may be cached by other cases
+    uint32_t fsId = 20;
+    PartitionInfo partitionInfo;
+    partitionInfo.set_partitionid(1);
+    partitionInfo.set_fsid(fsId);
+    partitionInfo.set_start(0);
+    partitionInfo.set_end(2000);
+    auto partition = std::make_shared<Partition>(partitionInfo, kvStorage_);
+    PartitionCleaner cleaner(partition);
+    cleaner.SetMdsClient(mdsCli_);
+    cleaner.SetS3Aapter(s3Adaptor_);
+    cleaner.SetCopysetNode(copyset_);
+    cleaner.SetIndoDeletePeriod(0);
+
+    InodeParam param;
+    param.fsId = fsId;
+    param.gid = 0;
+    param.uid = 0;
+    param.mode = 0;
+    param.type = FsFileType::TYPE_S3;
+    param.length = 0;
+    param.rdev = 0;
+    param.symlink = "";
+    std::list<Inode> inodes;
+    for (int i = 0; i < 3; i++) {
+        Inode inode;
+        ASSERT_EQ(partition->CreateInode(param, &inode), MetaStatusCode::OK);
+        inodes.push_back(inode);
+    }
+
+    FsInfo fsInfo;
+    fsInfo.set_fsid(fsId);
+    fsInfo.mutable_detail()->mutable_s3info();
+    EXPECT_CALL(*mdsCli_, GetFsInfo(Matcher<uint32_t>(fsId), _))
+        .WillOnce(DoAll(SetArgPointee<1>(fsInfo), Return(FSStatusCode::OK)));
+    EXPECT_CALL(*s3Adaptor_, GetS3ClientAdaptorOption(_)).Times(2);
+    EXPECT_CALL(*s3Adaptor_, Reinit(_, _, _, _, _)).Times(2);
+
+    // s3 data deletion failed, no inode is deleted
+    EXPECT_CALL(*s3Adaptor_, DeleteInodes(_))
+        .WillOnce(Return(-1))
+        .WillOnce(Invoke([](const std::list<Inode>& batch) {
+            EXPECT_EQ(3, batch.size());
+            return 0;
+        }));
+    EXPECT_CALL(*copyset_, Propose(_))
+        .Times(3)
+        .WillRepeatedly(Invoke([](const braft::Task& task) {
+            task.done->Run();
+        }));
+    ASSERT_EQ(cleaner.CleanDataAndDeleteInodes(inodes),
+              MetaStatusCode::S3_DELETE_ERR);
+
+    // all s3 data are deleted in one request, then inodes one by one
+    ASSERT_EQ(cleaner.CleanDataAndDeleteInodes(inodes), MetaStatusCode::OK);
+}
+
 }  // namespace metaserver
 }  // namespace curvefs
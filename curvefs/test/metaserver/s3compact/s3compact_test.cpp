@@ -22,8 +22,13 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <memory>
+#include <thread>
 
+#include "curvefs/src/metaserver/s3compact_budget.h"
 #include "curvefs/src/metaserver/s3compact_manager.h"
 #include "curvefs/src/metaserver/s3compact_worker.h"
 #include "curvefs/src/metaserver/s3compact_inode.h"
@@ -33,6 +38,7 @@
 #include "curvefs/test/metaserver/s3compact/mock_s3compact_inode.h"
 #include "curvefs/test/metaserver/s3compact/mock_s3infocache.h"
 #include "curvefs/test/metaserver/storage/utils.h"
+#include "src/common/string_util.h"
 #include "src/fs/ext4_filesystem_impl.h"
 
 using ::curvefs::metaserver::copyset::CopysetNode;
@@ -481,72 +487,233 @@ TEST_F(S3CompactTest, test_BuildValidList) {
     ASSERT_TRUE(validList.empty());
 }
 
-TEST_F(S3CompactTest, test_ReadFullChunk) {
+TEST_F(S3CompactTest, test_MergeChunk) {
     int ret;
     std::list<struct CompactInodeJob::Node> validList;
     struct CompactInodeJob::S3CompactCtx ctx {
         1, 1, PartitionInfo(), 4, 64, 0, 0, s3adapter_.get()
     };
     struct CompactInodeJob::S3NewChunkInfo newChunkInfo;
-    std::string fullChunk;
+    uint64_t chunkLen;
+    std::vector<std::string> objsAdded;
+    std::map<std::string, std::string> objsPut;
 
     auto reset = [&]() {
         validList.clear();
-        fullChunk.clear();
         newChunkInfo = {};
+        chunkLen = 0;
+        objsAdded.clear();
+        objsPut.clear();
     };
 
-    EXPECT_CALL(*s3adapter_, DeleteObject(_)).WillRepeatedly(Return(0));
+    // content of object is filled with 'a' + chunkid
     auto mock_getobj = [&](const Aws::String& key, std::string* data) {
-        data->clear();
-        data->append(ctx.blockSize, '\0');
+        std::vector<std::string> items;
+        curve::common::SplitString(std::string(key.c_str()), "_", &items);
+        data->assign(ctx.blockSize, 'a' + std::stoull(items[2]));
+        return 0;
+    };
+    auto mock_putobj = [&](const Aws::String& key, const std::string& data) {
+        objsPut[std::string(key.c_str())] = data;
         return 0;
     };
     EXPECT_CALL(*s3adapter_, GetObject(_, _))
         .WillRepeatedly(testing::Invoke(mock_getobj));
+    EXPECT_CALL(*s3adapter_, PutObject(_, _))
+        .WillRepeatedly(testing::Invoke(mock_putobj));
 
     validList.emplace_back(0, 1, 0, 0, 0, 0, true);
-    ret = impl_->ReadFullChunk(ctx, validList, &fullChunk, &newChunkInfo);
+    ret = impl_->MergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                            &objsAdded);
     ASSERT_EQ(ret, 0);
     ASSERT_EQ(newChunkInfo.newChunkId, 0);
     ASSERT_EQ(newChunkInfo.newCompaction, 1);
+    ASSERT_EQ(chunkLen, 2);
+    ASSERT_EQ(objsAdded.size(), 1);
+    ASSERT_EQ(objsPut[objsAdded[0]], std::string(2, '\0'));
 
     reset();
     validList.emplace_back(0, 0, 1, 1, 0, 1, false);
     validList.emplace_back(1, 10, 0, 0, 1, 11, false);
     validList.emplace_back(13, 13, 2, 0, 13, 14, false);
-    ret = impl_->ReadFullChunk(ctx, validList, &fullChunk, &newChunkInfo);
+    ret = impl_->MergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                            &objsAdded);
     ASSERT_EQ(ret, 0);
     ASSERT_EQ(newChunkInfo.newChunkId, 2);
     ASSERT_EQ(newChunkInfo.newCompaction, 1);
-    ASSERT_EQ(fullChunk.size(), 14);
+    ASSERT_EQ(chunkLen, 14);
+    ASSERT_EQ(objsAdded.size(), 4);
+    ASSERT_EQ(objsAdded[0], "1_1_2_0_1");
+    ASSERT_EQ(objsAdded[3], "1_1_2_3_1");
+    std::string merged;
+    for (const auto& obj : objsAdded) {
+        merged += objsPut[obj];
+    }
+    ASSERT_EQ(merged, "b" + std::string(10, 'a') + std::string(2, '\0') + "c");
 
+    // put failed
+    reset();
+    EXPECT_CALL(*s3adapter_, PutObject(_, _)).WillRepeatedly(Return(-1));
+    validList.emplace_back(0, 9, 2, 3, 0, 10, false);
+    ret = impl_->MergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                            &objsAdded);
+    ASSERT_EQ(ret, -1);
+    ASSERT_TRUE(objsAdded.empty());
+
+    // get failed
     reset();
     EXPECT_CALL(*s3adapter_, GetObject(_, _)).WillRepeatedly(Return(-1));
     validList.emplace_back(0, 1, 1, 1, 0, 0, false);
-    ret = impl_->ReadFullChunk(ctx, validList, &fullChunk, &newChunkInfo);
+    ret = impl_->MergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                            &objsAdded);
     ASSERT_EQ(ret, -1);
 }
 
-TEST_F(S3CompactTest, test_WriteFullChunk) {
+TEST_F(S3CompactTest, test_MergeChunkWithBudget) {
+    S3CompactBudget budget(8, 0);
+    workerOptions_.budget = &budget;
     struct CompactInodeJob::S3CompactCtx ctx {
-        100, 1, PartitionInfo(), 4, 16, 0, 0, s3adapter_.get()
+        1, 1, PartitionInfo(), 4, 64, 0, 0, s3adapter_.get()
     };
-    struct CompactInodeJob::S3NewChunkInfo newChunkInfo {
-        2, 0, 3
+    struct CompactInodeJob::S3NewChunkInfo newChunkInfo;
+    uint64_t chunkLen;
+    std::vector<std::string> objsAdded;
+    std::list<struct CompactInodeJob::Node> validList;
+    validList.emplace_back(0, 9, 2, 3, 0, 10, false);
+
+    // memory is reserved during merging and released after it
+    auto mock_getobj = [&](const Aws::String& key, std::string* data) {
+        EXPECT_EQ(budget.MemoryInUse(), 2 * ctx.blockSize);
+        data->assign(ctx.blockSize, 'a');
+        return 0;
     };
+    EXPECT_CALL(*s3adapter_, GetObject(_, _))
+        .WillRepeatedly(testing::Invoke(mock_getobj));
     EXPECT_CALL(*s3adapter_, PutObject(_, _)).WillRepeatedly(Return(0));
-    std::string fullChunk(10, '0');
+    int ret = impl_->MergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                                &objsAdded);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(objsAdded.size(), 3);
+    ASSERT_EQ(budget.MemoryInUse(), 0);
+
+    // stopped
+    budget.Stop();
+    objsAdded.clear();
+    ret = impl_->MergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                            &objsAdded);
+    ASSERT_EQ(ret, -1);
+    ASSERT_TRUE(objsAdded.empty());
+    workerOptions_.budget = nullptr;
+}
+
+TEST_F(S3CompactTest, test_MergeChunkInterleavedObjects) {
+    struct CompactInodeJob::S3CompactCtx ctx {
+        1, 1, PartitionInfo(), 4, 64, 0, 0, s3adapter_.get()
+    };
+    struct CompactInodeJob::S3NewChunkInfo newChunkInfo;
+    uint64_t chunkLen;
     std::vector<std::string> objsAdded;
-    int ret = impl_->WriteFullChunk(ctx, newChunkInfo, fullChunk, &objsAdded);
+    std::map<std::string, std::string> objsPut;
+    std::map<std::string, int> objsGet;
+
+    // chunk 1 overwrites the middle of chunk 0: A, B, A
+    std::list<struct CompactInodeJob::Node> validList;
+    validList.emplace_back(0, 0, 0, 0, 0, 4, false);
+    validList.emplace_back(1, 1, 1, 0, 1, 1, false);
+    validList.emplace_back(2, 3, 0, 0, 0, 4, false);
+
+    auto mock_getobj = [&](const Aws::String& key, std::string* data) {
+        std::vector<std::string> items;
+        curve::common::SplitString(std::string(key.c_str()), "_", &items);
+        data->assign(ctx.blockSize, 'a' + std::stoull(items[2]));
+        objsGet[std::string(key.c_str())]++;
+        return 0;
+    };
+    auto mock_putobj = [&](const Aws::String& key, const std::string& data) {
+        objsPut[std::string(key.c_str())] = data;
+        return 0;
+    };
+    EXPECT_CALL(*s3adapter_, GetObject(_, _))
+        .WillRepeatedly(testing::Invoke(mock_getobj));
+    EXPECT_CALL(*s3adapter_, PutObject(_, _))
+        .WillRepeatedly(testing::Invoke(mock_putobj));
+
+    // each object is read once
+    int ret = impl_->MergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                                &objsAdded);
     ASSERT_EQ(ret, 0);
-    ASSERT_EQ(objsAdded[0], "1_100_2_0_3");
-    ASSERT_EQ(objsAdded[1], "1_100_2_1_3");
-    ASSERT_EQ(objsAdded[2], "1_100_2_2_3");
+    ASSERT_EQ(objsGet.size(), 2);
+    for (const auto& obj : objsGet) {
+        ASSERT_EQ(obj.second, 1) << obj.first;
+    }
+    ASSERT_EQ(objsAdded.size(), 1);
+    ASSERT_EQ(objsPut[objsAdded[0]], "abaa");
+
+    // no spare memory in budget, object A is read again
+    S3CompactBudget budget(2 * ctx.blockSize, 0);
+    workerOptions_.budget = &budget;
+    objsGet.clear();
+    objsPut.clear();
+    objsAdded.clear();
+    newChunkInfo = {};
+    ret = impl_->MergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                            &objsAdded);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(objsGet.size(), 2);
+    int gets = 0;
+    for (const auto& obj : objsGet) {
+        gets += obj.second;
+    }
+    ASSERT_EQ(gets, 3);
+    ASSERT_EQ(objsPut[objsAdded[0]], "abaa");
+    ASSERT_EQ(budget.MemoryInUse(), 0);
+
+    // enough memory, cached object is accounted and released
+    S3CompactBudget largeBudget(4 * ctx.blockSize, 0);
+    workerOptions_.budget = &largeBudget;
+    objsGet.clear();
+    objsAdded.clear();
+    newChunkInfo = {};
+    ret = impl_->MergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                            &objsAdded);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(objsGet.size(), 2);
+    for (const auto& obj : objsGet) {
+        ASSERT_EQ(obj.second, 1) << obj.first;
+    }
+    ASSERT_EQ(largeBudget.MemoryInUse(), 0);
+    workerOptions_.budget = nullptr;
+}
 
-    EXPECT_CALL(*s3adapter_, PutObject(_, _)).WillRepeatedly(Return(-1));
-    ret = impl_->WriteFullChunk(ctx, newChunkInfo, fullChunk, &objsAdded);
-    ASSERT_EQ(ret, -1);
+TEST_F(S3CompactTest, test_S3CompactBudget) {
+    S3CompactBudget budget(10, 0);
+    ASSERT_TRUE(budget.AcquireMemory(6));
+
+    std::atomic<bool> acquired(false);
+    std::thread th([&]() {
+        ASSERT_TRUE(budget.AcquireMemory(6));
+        acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(acquired);
+    budget.ReleaseMemory(6);
+    th.join();
+    ASSERT_TRUE(acquired);
+    budget.ReleaseMemory(6);
+
+    // larger than limit, granted if nothing is reserved
+    ASSERT_TRUE(budget.AcquireMemory(20));
+    budget.ReleaseMemory(20);
+    ASSERT_EQ(budget.MemoryInUse(), 0);
+
+    // only reserved if available right now
+    ASSERT_TRUE(budget.TryAcquireMemory(6));
+    ASSERT_FALSE(budget.TryAcquireMemory(6));
+    budget.ReleaseMemory(6);
+
+    budget.Stop();
+    ASSERT_FALSE(budget.AcquireMemory(1));
+    ASSERT_FALSE(budget.TryAcquireMemory(1));
 }
 
 TEST_F(S3CompactTest, test_CompactChunks) {
@@ -24,6 +24,7 @@
 #include <glog/logging.h>
 
 #include <unordered_map>
+#include <vector>
 
 #include "curvefs/src/metaserver/storage/converter.h"
 
@@ -33,9 +34,9 @@ namespace storage {
 
 class ConverterTest : public testing::Test {
  protected:
-    void SetUp() override {}
+    void SetUp() override { FLAGS_storage_binary_key = true; }
 
-    void TearDown() override {}
+    void TearDown() override { FLAGS_storage_binary_key = false; }
 
  protected:
     Converter conv_;
@@ -66,7 +67,8 @@ TEST_F(ConverterTest, Key4Dentry) {
         LOG(INFO) << "TEST " << path;
         Key4Dentry key(1, 1, path);
         std::string skey = conv_.SerializeToString(key);
-        ASSERT_EQ(skey, "3:1:1:" + path);
+        ASSERT_EQ(skey, std::string("\x03\0\0\0\x01\0\0\0\0\0\0\0\x01", 13) +
+                            path);
 
         Key4Dentry out;
         ASSERT_TRUE(conv_.ParseFromString(skey, &out));
@@ -79,7 +81,7 @@ TEST_F(ConverterTest, Key4Dentry) {
         LOG(INFO) << "TEST " << path;
         Key4Dentry key(100, 1001, path);
         std::string skey = conv_.SerializeToString(key);
-        ASSERT_EQ(skey, "3:100:1001:" + path);
+        ASSERT_EQ(skey.size(), 13 + path.size());
 
         Key4Dentry out;
         ASSERT_TRUE(conv_.ParseFromString(skey, &out));
@@ -92,7 +94,8 @@ TEST_F(ConverterTest, Key4Dentry) {
 TEST_F(ConverterTest, Prefix4SameParentDentry) {
     Prefix4SameParentDentry prefix(1, 100);
     std::string sprefix = conv_.SerializeToString(prefix);
-    ASSERT_EQ(sprefix, "3:1:100:");
+    ASSERT_EQ(sprefix,
+              std::string("\x03\0\0\0\x01\0\0\0\0\0\0\0\x64", 13));
 
     Prefix4SameParentDentry out;
     ASSERT_TRUE(conv_.ParseFromString(sprefix, &out));
@@ -103,7 +106,8 @@ TEST_F(ConverterTest, Prefix4SameParentDentry) {
 TEST_F(ConverterTest, Key4InodeAuxInfo) {
     Key4InodeAuxInfo key(1, 1);
     std::string skey = conv_.SerializeToString(key);
-    ASSERT_EQ(skey, "5:1:1");
+    ASSERT_EQ(skey,
+              std::string("\x05\0\0\0\x01\0\0\0\0\0\0\0\x01", 13));
 
     Key4InodeAuxInfo out;
     ASSERT_TRUE(conv_.ParseFromString(skey, &out));
@@ -111,6 +115,101 @@ TEST_F(ConverterTest, Key4InodeAuxInfo) {
     ASSERT_EQ(out.inodeId, 1);
 }
 
+TEST_F(ConverterTest, KeyOrder) {
+    // keys sort in the same order as their fields
+    std::vector<Key4S3ChunkInfoList> keys{
+        {1, 1, 0, 1, 1, 0},      {1, 1, 0, 2, 2, 0},
+        {1, 1, 2, 10, 10, 0},    {1, 1, 10, 3, 3, 0},
+        {1, 2, 0, 1, 1, 0},      {1, 256, 0, 1, 1, 0},
+        {2, 1, 0, 1, 1, 0},      {256, 0, 0, 0, 0, 0},
+    };
+
+    for (size_t i = 1; i < keys.size(); i++) {
+        ASSERT_LT(conv_.SerializeToString(keys[i - 1]),
+                  conv_.SerializeToString(keys[i]));
+    }
+
+    Prefix4ChunkIndexS3ChunkInfoList prefix(1, 1, 0);
+    std::string sprefix = conv_.SerializeToString(prefix);
+    ASSERT_EQ(conv_.SerializeToString(keys[0]).compare(0, sprefix.size(),
+                                                       sprefix), 0);
+    ASSERT_NE(conv_.SerializeToString(keys[2]).compare(0, sprefix.size(),
+                                                       sprefix), 0);
+
+    Key4Dentry d1(1, 1, "a");
+    Key4Dentry d2(1, 1, "ab");
+    Key4Dentry d3(1, 2, "");
+    ASSERT_LT(conv_.SerializeToString(d1), conv_.SerializeToString(d2));
+    ASSERT_LT(conv_.SerializeToString(d2), conv_.SerializeToString(d3));
+}
+
+TEST_F(ConverterTest, ParseLegacyKey) {
+    ASSERT_TRUE(IsLegacyKey("1:1:100"));
+    ASSERT_FALSE(IsLegacyKey(conv_.SerializeToString(Key4Inode(1, 100))));
+    ASSERT_FALSE(IsLegacyKey(""));
+
+    Key4Inode inode;
+    ASSERT_TRUE(conv_.ParseFromString("1:1:100", &inode));
+    ASSERT_EQ(inode.fsId, 1);
+    ASSERT_EQ(inode.inodeId, 100);
+
+    Key4Dentry dentry;
+    ASSERT_TRUE(conv_.ParseFromString("3:1:100:/a:b", &dentry));
+    ASSERT_EQ(dentry.fsId, 1);
+    ASSERT_EQ(dentry.parentInodeId, 100);
+    ASSERT_EQ(dentry.name, "/a:b");
+
+    Key4S3ChunkInfoList list;
+    ASSERT_TRUE(conv_.ParseFromString(
+        "2:1:100:3:00000000000000000004:00000000000000000005:6", &list));
+    ASSERT_EQ(list.fsId, 1);
+    ASSERT_EQ(list.inodeId, 100);
+    ASSERT_EQ(list.chunkIndex, 3);
+    ASSERT_EQ(list.firstChunkId, 4);
+    ASSERT_EQ(list.lastChunkId, 5);
+    ASSERT_EQ(list.size, 6);
+
+    // re-encoded key is parsed back to the same fields
+    Key4S3ChunkInfoList out;
+    ASSERT_TRUE(conv_.ParseFromString(conv_.SerializeToString(list), &out));
+    ASSERT_EQ(out.chunkIndex, 3);
+    ASSERT_EQ(out.lastChunkId, 5);
+    ASSERT_EQ(out.size, 6);
+
+    // type mismatch or truncated key
+    ASSERT_FALSE(conv_.ParseFromString("3:1:100", &inode));
+    std::string skey = conv_.SerializeToString(Key4Inode(1, 100));
+    ASSERT_FALSE(conv_.ParseFromString(skey.substr(0, skey.size() - 1),
+                                       &inode));
+}
+
+TEST_F(ConverterTest, LegacyEncoding) {
+    FLAGS_storage_binary_key = false;
+
+    ASSERT_EQ(conv_.SerializeToString(Key4Inode(1, 100)), "1:1:100");
+    ASSERT_EQ(conv_.SerializeToString(Key4Dentry(1, 100, "/a:b")),
+              "3:1:100:/a:b");
+    ASSERT_EQ(conv_.SerializeToString(Prefix4SameParentDentry(1, 100)),
+              "3:1:100:");
+    ASSERT_EQ(conv_.SerializeToString(Key4S3ChunkInfoList(1, 100, 3, 4, 5, 6)),
+              "2:1:100:3:00000000000000000004:00000000000000000005:6");
+    ASSERT_EQ(conv_.SerializeToString(Prefix4InodeS3ChunkInfoList(1, 100)),
+              "2:1:100:");
+
+    std::string skey = conv_.SerializeToString(Key4InodeAuxInfo(1, 100));
+    ASSERT_TRUE(IsLegacyKey(skey));
+    ASSERT_TRUE(IsCurrentEncodingKey(skey));
+
+    Key4InodeAuxInfo out;
+    ASSERT_TRUE(conv_.ParseFromString(skey, &out));
+    ASSERT_EQ(out.fsId, 1);
+    ASSERT_EQ(out.inodeId, 100);
+
+    FLAGS_storage_binary_key = true;
+    ASSERT_FALSE(IsCurrentEncodingKey(skey));
+    ASSERT_TRUE(IsCurrentEncodingKey(conv_.SerializeToString(out)));
+}
+
 TEST_F(ConverterTest, NameGenerator) {
     NameGenerator ng(1);
     ASSERT_EQ(ng.GetFixedLength(), 6);
@@ -20,13 +20,19 @@
  * Author: Jingli Chen (Wine93)
  */
 
+#include <bvar/bvar.h>
 #include <gtest/gtest.h>
 
+#include <future>  // NOLINT
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "src/fs/ext4_filesystem_impl.h"
 #include "curvefs/src/metaserver/storage/storage.h"
 #include "curvefs/src/metaserver/storage/memory_storage.h"
 #include "curvefs/test/metaserver/storage/storage_test.h"
+#include "curvefs/test/metaserver/storage/utils.h"
 
 namespace curvefs {
 namespace metaserver {
@@ -36,6 +42,7 @@ using ::curvefs::metaserver::storage::KVStorage;
 using ::curvefs::metaserver::storage::MemoryStorage;
 using ::curvefs::metaserver::storage::StorageOptions;
 using STORAGE_TYPE = ::curvefs::metaserver::storage::KVStorage::STORAGE_TYPE;
+using ::curve::fs::Ext4FileSystemImpl;
 
 class MemoryStorageTest : public testing::Test {
  protected:
@@ -89,6 +96,211 @@ TEST_F(MemoryStorageTest, SClearTest) { TestSClear(kvStorage_);
 TEST_F(MemoryStorageTest, MixOperatorTest) { TestMixOperator(kvStorage_);
                                              TestMixOperator(kvStorage2_); }
 
+TEST_F(MemoryStorageTest, ArenaMemoryUsageMetricTest) {
+    const std::string metric =
+        "metaserver_memory_storage_table_hash_arena_memory_usage";
+    auto memoryUsage = [&metric]() -> uint64_t {
+        std::string usage = bvar::Variable::describe_exposed(metric);
+        return usage.empty() ? 0 : std::stoull(usage);
+    };
+
+    // arena usage is only exposed for tables with compression
+    for (bool compression : {false, true}) {
+        StorageOptions options;
+        options.dataDir = "/tmp";
+        options.compression = compression;
+        MemoryStorage storage(options);
+        ASSERT_TRUE(bvar::Variable::describe_exposed(metric).empty());
+
+        for (int i = 0; i < 100; i++) {
+            std::string key = "key" + std::to_string(i);
+            ASSERT_TRUE(storage.HSet("hash", key, Value(key)).ok());
+        }
+        if (!compression) {
+            ASSERT_TRUE(bvar::Variable::describe_exposed(metric).empty());
+            continue;
+        }
+        uint64_t usage = memoryUsage();
+        ASSERT_GT(usage, 0);
+
+        // overwrite reuses the freed memory
+        for (int i = 0; i < 100; i++) {
+            std::string key = "key" + std::to_string(i);
+            ASSERT_TRUE(storage.HSet("hash", key, Value(key)).ok());
+        }
+        ASSERT_EQ(memoryUsage(), usage);
+
+        Dentry dentry;
+        ASSERT_TRUE(storage.HGet("hash", "key1", &dentry).ok());
+        ASSERT_EQ(dentry.name(), "key1");
+
+        ASSERT_TRUE(storage.HClear("hash").ok());
+        ASSERT_EQ(memoryUsage(), 0);
+    }
+}
+
+TEST_F(MemoryStorageTest, IncrementalCheckpointTest) {
+    auto fs = Ext4FileSystemImpl::getInstance();
+    for (bool compression : {false, true}) {
+        std::string basedir = RandomStoragePath("./memory_storage");
+        std::vector<std::string> dirs{basedir + "/snapshot1",
+                                      basedir + "/snapshot2",
+                                      basedir + "/snapshot3"};
+        for (const auto& dir : dirs) {
+            ASSERT_EQ(fs->Mkdir(dir), 0);
+        }
+
+        StorageOptions options;
+        options.dataDir = basedir + "/data1";
+        options.compression = compression;
+        options.maxDeltaSegments = 16;
+        MemoryStorage storage(options);
+
+        // CASE 1: first checkpoint saves a base segment
+        for (int i = 0; i < 10; i++) {
+            std::string key = "key" + std::to_string(i);
+            ASSERT_TRUE(storage.HSet("hash", key, Value(key)).ok());
+            ASSERT_TRUE(storage.SSet("sorted", key, Value(key)).ok());
+        }
+        std::vector<std::string> files;
+        ASSERT_TRUE(storage.Checkpoint(dirs[0], &files));
+        ASSERT_EQ(files.size(), 1);
+
+        // CASE 2: modifications are saved as a delta segment
+        ASSERT_TRUE(storage.HDel("hash", "key1").ok());
+        ASSERT_TRUE(storage.HSet("hash", "key2", Value("new")).ok());
+        ASSERT_TRUE(storage.SClear("sorted").ok());
+        ASSERT_TRUE(storage.SSet("sorted", "key", Value("key")).ok());
+        files.clear();
+        ASSERT_TRUE(storage.Checkpoint(dirs[1], &files));
+        ASSERT_EQ(files.size(), 2);
+
+        // CASE 3: recover from the chain, older snapshot isn't needed
+        ASSERT_EQ(fs->Delete(dirs[0]), 0);
+        options.dataDir = basedir + "/data2";
+        MemoryStorage recovered(options);
+        ASSERT_TRUE(recovered.Recover(dirs[1]));
+
+        Dentry dentry;
+        ASSERT_EQ(recovered.HSize("hash"), 9);
+        ASSERT_EQ(recovered.SSize("sorted"), 1);
+        ASSERT_TRUE(recovered.HGet("hash", "key1", &dentry).IsNotFound());
+        ASSERT_TRUE(recovered.HGet("hash", "key2", &dentry).ok());
+        ASSERT_EQ(dentry.name(), "new");
+        ASSERT_TRUE(recovered.SGet("sorted", "key", &dentry).ok());
+        ASSERT_TRUE(recovered.SGet("sorted", "key0", &dentry).IsNotFound());
+
+        // CASE 4: recovered storage continues the chain
+        ASSERT_TRUE(recovered.HDel("hash", "key3").ok());
+        files.clear();
+        ASSERT_TRUE(recovered.Checkpoint(dirs[2], &files));
+        ASSERT_EQ(files.size(), 3);
+
+        MemoryStorage recovered2(options);
+        ASSERT_TRUE(recovered2.Recover(dirs[2]));
+        ASSERT_EQ(recovered2.HSize("hash"), 8);
+
+        ASSERT_EQ(fs->Delete(basedir), 0);
+    }
+}
+
+TEST_F(MemoryStorageTest, RebaseCheckpointTest) {
+    auto fs = Ext4FileSystemImpl::getInstance();
+    std::string basedir = RandomStoragePath("./memory_storage");
+
+    StorageOptions options;
+    options.dataDir = basedir + "/data";
+    options.compression = false;
+    options.maxDeltaSegments = 2;
+    MemoryStorage storage(options);
+
+    for (int i = 0; i < 100; i++) {
+        std::string key = "key" + std::to_string(i);
+        ASSERT_TRUE(storage.HSet("hash", key, Value(key)).ok());
+    }
+
+    // base, base + 1 delta, base + 2 deltas, then a new base
+    std::vector<size_t> expected{1, 2, 3, 1};
+    for (size_t i = 0; i < expected.size(); i++) {
+        std::string dir = basedir + "/snapshot" + std::to_string(i);
+        ASSERT_EQ(fs->Mkdir(dir), 0);
+        ASSERT_TRUE(storage.HSet("hash", "key", Value("key")).ok());
+
+        std::vector<std::string> files;
+        ASSERT_TRUE(storage.Checkpoint(dir, &files));
+        ASSERT_EQ(files.size(), expected[i]);
+    }
+
+    // rebase if deltas are larger than base
+    ASSERT_TRUE(storage.HClear("hash").ok());
+    for (int i = 0; i < 200; i++) {
+        std::string key = "key" + std::to_string(i);
+        ASSERT_TRUE(storage.HSet("hash", key, Value(key)).ok());
+    }
+    std::string dir = basedir + "/snapshot";
+    ASSERT_EQ(fs->Mkdir(dir), 0);
+    std::vector<std::string> files;
+    ASSERT_TRUE(storage.Checkpoint(dir, &files));
+    ASSERT_EQ(files.size(), 1);
+
+    ASSERT_EQ(fs->Delete(basedir), 0);
+}
+
+TEST_F(MemoryStorageTest, BackgroundCheckpointTest) {
+    auto fs = Ext4FileSystemImpl::getInstance();
+    for (bool compression : {false, true}) {
+        std::string basedir = RandomStoragePath("./memory_storage");
+        std::vector<std::string> dirs{basedir + "/snapshot1",
+                                      basedir + "/snapshot2"};
+        for (const auto& dir : dirs) {
+            ASSERT_EQ(fs->Mkdir(dir), 0);
+        }
+
+        StorageOptions options;
+        options.dataDir = basedir + "/data1";
+        options.compression = compression;
+        std::vector<std::promise<size_t>> promises(dirs.size());
+        MemoryStorage storage(options);
+        for (int i = 0; i < 10; i++) {
+            std::string key = "key" + std::to_string(i);
+            ASSERT_TRUE(storage.HSet("hash", key, Value(key)).ok());
+        }
+
+        // modifications after returning aren't saved in the checkpoint,
+        // for both base and delta segments
+        for (size_t i = 0; i < dirs.size(); i++) {
+            auto* promise = &promises[i];
+            storage.CheckpointBackground(
+                dirs[i], [promise](bool succ,
+                                   const std::vector<std::string>& files) {
+                    promise->set_value(succ ? files.size() : 0);
+                });
+            ASSERT_TRUE(storage.HSet("hash", "key0", Value("new")).ok());
+            ASSERT_TRUE(storage.HDel("hash", "key1").ok());
+            ASSERT_EQ(i + 1, promise->get_future().get());
+
+            if (i == 0) {
+                ASSERT_TRUE(storage.HSet("hash", "key0", Value("key0")).ok());
+                ASSERT_TRUE(storage.HSet("hash", "key1", Value("key1")).ok());
+            }
+        }
+
+        for (size_t i = 0; i < dirs.size(); i++) {
+            options.dataDir = basedir + "/recovered" + std::to_string(i);
+            MemoryStorage recovered(options);
+            ASSERT_TRUE(recovered.Recover(dirs[i]));
+
+            Dentry dentry;
+            ASSERT_EQ(recovered.HSize("hash"), 10);
+            ASSERT_TRUE(recovered.HGet("hash", "key0", &dentry).ok());
+            ASSERT_EQ(dentry.name(), "key0");
+            ASSERT_TRUE(recovered.HGet("hash", "key1", &dentry).ok());
+        }
+
+        ASSERT_EQ(fs->Delete(basedir), 0);
+    }
+}
+
 }  // namespace storage
 }  // namespace metaserver
 }  // namespace curvefs
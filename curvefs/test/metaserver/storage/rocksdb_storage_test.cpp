@@ -29,7 +29,11 @@
 #include <unistd.h>
 
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include "curvefs/src/metaserver/storage/converter.h"
 #include "curvefs/src/metaserver/storage/storage.h"
 #include "curvefs/src/metaserver/storage/utils.h"
 #include "curvefs/test/metaserver/storage/storage_test.h"
@@ -73,10 +77,48 @@ class RocksDBStorageTest : public testing::Test {
 
     void TearDown() override {
         std::string ret;
+        FLAGS_rocksdb_separate_column_families = false;
         ASSERT_TRUE(kvStorage_->Close());
         ASSERT_TRUE(ExecShell("rm -rf " + dirname_, &ret));
     }
 
+    // reopen a clean database with separate column families
+    void EnableSeparateColumnFamilies() {
+        FLAGS_rocksdb_separate_column_families = true;
+        ASSERT_TRUE(kvStorage_->Close());
+        kvStorage_ = std::make_shared<RocksDBStorage>(options_);
+        ASSERT_TRUE(kvStorage_->Open());
+    }
+
+    static size_t CountColumnFamilies(KVStorage* kvStorage) {
+        return dynamic_cast<RocksDBStorage*>(kvStorage)->handles_.size();
+    }
+
+    static size_t CountKeys(KVStorage* kvStorage, ColumnFamilyIndex index) {
+        auto* storage = dynamic_cast<RocksDBStorage*>(kvStorage);
+        std::unique_ptr<rocksdb::Iterator> iter(storage->db_->NewIterator(
+            rocksdb::ReadOptions(), storage->GetColumnFamilyHandle(index)));
+        size_t count = 0;
+        for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+            count++;
+        }
+        return count;
+    }
+
+    // write key into ordered or unordered column family directly,
+    // just like a database created before tables have own column family
+    static void LegacySet(KVStorage* kvStorage, const std::string& name,
+                          const std::string& key, const ValueType& value,
+                          bool ordered) {
+        auto* storage = dynamic_cast<RocksDBStorage*>(kvStorage);
+        auto handle = storage->GetColumnFamilyHandle(
+            ordered ? kOrderedColumnFamily : kUnorderedColumnFamily);
+        auto s = storage->db_->Put(storage->dbWriteOptions_, handle,
+                                   storage->ToInternalKey(name, key, ordered),
+                                   value.SerializeAsString());
+        ASSERT_TRUE(s.ok()) << s.ToString();
+    }
+
     bool ExecShell(const std::string& cmd, std::string* ret) {
         std::array<char, 128> buffer;
         std::unique_ptr<FILE, decltype(&pclose)>
@@ -176,6 +218,60 @@ TEST_F(RocksDBStorageTest, HClearTestSMixOperator) {
 }
 TEST_F(RocksDBStorageTest, Transaction) { TestTransaction(kvStorage_); }
 
+TEST_F(RocksDBStorageTest, TestBatch) {
+    Status s;
+    Dentry value;
+
+    ASSERT_TRUE(kvStorage_->BeginBatch());
+    // only one batch in a thread
+    ASSERT_FALSE(kvStorage_->BeginBatch());
+
+    // CASE 1: read your own writes
+    ASSERT_TRUE(kvStorage_->SSet("partition:1", "key1", Value("value1")).ok());
+    ASSERT_TRUE(kvStorage_->HSet("partition:1", "key2", Value("value2")).ok());
+    ASSERT_TRUE(kvStorage_->SGet("partition:1", "key1", &value).ok());
+    ASSERT_EQ(value, Value("value1"));
+    ASSERT_EQ(kvStorage_->SSize("partition:1"), 1);
+
+    // CASE 2: modifications are invisible to other threads before commit
+    std::thread([&]() {
+        Dentry dentry;
+        ASSERT_TRUE(
+            kvStorage_->SGet("partition:1", "key1", &dentry).IsNotFound());
+        ASSERT_TRUE(
+            kvStorage_->HGet("partition:1", "key2", &dentry).IsNotFound());
+    }).join();
+
+    // CASE 3: transaction inside batch
+    auto txn = kvStorage_->BeginTransaction();
+    ASSERT_NE(txn, nullptr);
+    ASSERT_TRUE(txn->SSet("partition:1", "key3", Value("value3")).ok());
+    ASSERT_TRUE(txn->SDel("partition:1", "key1").ok());
+    ASSERT_TRUE(txn->Rollback().ok());
+
+    txn = kvStorage_->BeginTransaction();
+    ASSERT_NE(txn, nullptr);
+    ASSERT_TRUE(txn->SSet("partition:1", "key4", Value("value4")).ok());
+    ASSERT_TRUE(txn->Commit().ok());
+
+    ASSERT_TRUE(kvStorage_->CommitBatch().ok());
+    // no pending batch
+    ASSERT_TRUE(kvStorage_->CommitBatch().ok());
+
+    // CASE 4: all committed modifications are visible
+    std::thread([&]() {
+        Dentry dentry;
+        ASSERT_TRUE(kvStorage_->SGet("partition:1", "key1", &dentry).ok());
+        ASSERT_EQ(dentry, Value("value1"));
+        ASSERT_TRUE(kvStorage_->HGet("partition:1", "key2", &dentry).ok());
+        ASSERT_EQ(dentry, Value("value2"));
+        ASSERT_TRUE(
+            kvStorage_->SGet("partition:1", "key3", &dentry).IsNotFound());
+        ASSERT_TRUE(kvStorage_->SGet("partition:1", "key4", &dentry).ok());
+        ASSERT_EQ(dentry, Value("value4"));
+    }).join();
+}
+
 TEST_F(RocksDBStorageTest, TestCleanOpen) {
     ASSERT_TRUE(kvStorage_->Close());
 
@@ -294,6 +390,147 @@ TEST_F(RocksDBStorageTest, TestCheckpointAndRecover) {
     EXPECT_EQ(Value("7"), dummyDentry);
 }
 
+TEST_F(RocksDBStorageTest, TestTableColumnFamily) {
+    NameGenerator nameGenerator(1);
+    const std::string prefix(13, 'p');
+    Dentry value;
+
+    EnableSeparateColumnFamilies();
+
+    ASSERT_TRUE(kvStorage_->HSet(nameGenerator.GetInodeTableName(), "inode",
+                                 Value("inode")).ok());
+    ASSERT_TRUE(kvStorage_->SSet(nameGenerator.GetDentryTableName(),
+                                 prefix + "dentry1", Value("dentry1")).ok());
+    ASSERT_TRUE(kvStorage_->SSet(nameGenerator.GetDentryTableName(),
+                                 prefix + "dentry2", Value("dentry2")).ok());
+    ASSERT_TRUE(kvStorage_->SSet(nameGenerator.GetS3ChunkInfoTableName(),
+                                 prefix + "chunk", Value("chunk")).ok());
+    ASSERT_TRUE(kvStorage_->SSet(nameGenerator.GetVolumeExtentTableName(),
+                                 prefix + "extent", Value("extent")).ok());
+    ASSERT_TRUE(kvStorage_->HSet("partition:1", "key", Value("value")).ok());
+
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kInodeColumnFamily));
+    ASSERT_EQ(2, CountKeys(kvStorage_.get(), kDentryColumnFamily));
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kS3ChunkInfoColumnFamily));
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kOrderedColumnFamily));
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kUnorderedColumnFamily));
+
+    ASSERT_TRUE(kvStorage_->HGet(nameGenerator.GetInodeTableName(), "inode",
+                                 &value).ok());
+    ASSERT_EQ(Value("inode"), value);
+
+    // seek by full prefix and by shorter one
+    ASSERT_EQ(2, kvStorage_->SSize(nameGenerator.GetDentryTableName()));
+    std::vector<std::string> keys;
+    auto iterator =
+        kvStorage_->SSeek(nameGenerator.GetDentryTableName(), prefix);
+    for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+        keys.push_back(iterator->Key());
+    }
+    ASSERT_EQ(keys, std::vector<std::string>(
+                        {prefix + "dentry1", prefix + "dentry2"}));
+
+    keys.clear();
+    iterator = kvStorage_->SSeek(nameGenerator.GetDentryTableName(), "p");
+    for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+        keys.push_back(iterator->Key());
+    }
+    ASSERT_EQ(2, keys.size());
+
+    ASSERT_TRUE(kvStorage_->HClear(nameGenerator.GetInodeTableName()).ok());
+    ASSERT_EQ(0, kvStorage_->HSize(nameGenerator.GetInodeTableName()));
+}
+
+TEST_F(RocksDBStorageTest, TestRecoverFromLegacyColumnFamily) {
+    ASSERT_TRUE(kvStorage_->Close());
+
+    MockLocalFileSystem mockfs;
+    options_.localFileSystem = &mockfs;
+
+    EXPECT_CALL(mockfs, DirExists(_))
+        .WillOnce(Invoke([this](const std::string& dir) {
+            return localfs_->DirExists(dir);
+        }));
+
+    EXPECT_CALL(mockfs, Delete(_))
+        .Times(2)
+        .WillRepeatedly(Invoke(
+            [this](const std::string& dir) { return localfs_->Delete(dir); }));
+
+    EXPECT_CALL(mockfs, List(_, _))
+        .WillOnce(Invoke(
+            [this](const std::string& dir, std::vector<std::string>* files) {
+                return localfs_->List(dir, files);
+            }));
+
+    kvStorage_ = std::make_shared<RocksDBStorage>(options_);
+    ASSERT_TRUE(kvStorage_->Open());
+    ASSERT_EQ(2, CountColumnFamilies(kvStorage_.get()));
+
+    NameGenerator nameGenerator(1);
+    const std::string prefix(13, 'p');
+    LegacySet(kvStorage_.get(), nameGenerator.GetInodeTableName(), "inode",
+              Value("inode"), false);
+    LegacySet(kvStorage_.get(), nameGenerator.GetDentryTableName(),
+              prefix + "dentry", Value("dentry"), true);
+    LegacySet(kvStorage_.get(), nameGenerator.GetS3ChunkInfoTableName(),
+              prefix + "chunk", Value("chunk"), true);
+    // table `1` isn't generated by NameGenerator, it shouldn't be migrated
+    LegacySet(kvStorage_.get(), "1", "legacy-key", Value("value"), false);
+
+    std::vector<std::string> files;
+    ASSERT_TRUE(kvStorage_->Checkpoint(dirname_, &files));
+    FLAGS_rocksdb_separate_column_families = true;
+    ASSERT_TRUE(kvStorage_->Recover(dirname_));
+
+    ASSERT_EQ(5, CountColumnFamilies(kvStorage_.get()));
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kInodeColumnFamily));
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kDentryColumnFamily));
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kS3ChunkInfoColumnFamily));
+    ASSERT_EQ(0, CountKeys(kvStorage_.get(), kOrderedColumnFamily));
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kUnorderedColumnFamily));
+
+    Dentry value;
+    ASSERT_TRUE(kvStorage_->HGet(nameGenerator.GetInodeTableName(), "inode",
+                                 &value).ok());
+    ASSERT_EQ(Value("inode"), value);
+    ASSERT_TRUE(kvStorage_->SGet(nameGenerator.GetDentryTableName(),
+                                 prefix + "dentry", &value).ok());
+    ASSERT_EQ(Value("dentry"), value);
+    ASSERT_TRUE(kvStorage_->SGet(nameGenerator.GetS3ChunkInfoTableName(),
+                                 prefix + "chunk", &value).ok());
+    ASSERT_EQ(Value("chunk"), value);
+    ASSERT_TRUE(kvStorage_->HGet("1", "legacy-key", &value).ok());
+    ASSERT_EQ(Value("value"), value);
+}
+
+TEST_F(RocksDBStorageTest, TestSeparateColumnFamiliesDisabled) {
+    NameGenerator nameGenerator(1);
+    Dentry value;
+
+    // disabled by default, tables are stored as older versions do
+    ASSERT_EQ(2, CountColumnFamilies(kvStorage_.get()));
+    ASSERT_TRUE(kvStorage_->HSet(nameGenerator.GetInodeTableName(), "inode",
+                                 Value("inode")).ok());
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kUnorderedColumnFamily));
+
+    // column families are kept after disabling again
+    EnableSeparateColumnFamilies();
+    ASSERT_TRUE(kvStorage_->HSet(nameGenerator.GetInodeTableName(), "inode",
+                                 Value("inode")).ok());
+    std::vector<std::string> files;
+    ASSERT_TRUE(kvStorage_->Checkpoint(dirname_, &files));
+
+    FLAGS_rocksdb_separate_column_families = false;
+    ASSERT_TRUE(kvStorage_->Recover(dirname_));
+    ASSERT_EQ(5, CountColumnFamilies(kvStorage_.get()));
+    ASSERT_EQ(1, CountKeys(kvStorage_.get(), kInodeColumnFamily));
+    ASSERT_EQ(0, CountKeys(kvStorage_.get(), kUnorderedColumnFamily));
+    ASSERT_TRUE(kvStorage_->HGet(nameGenerator.GetInodeTableName(), "inode",
+                                 &value).ok());
+    ASSERT_EQ(Value("inode"), value);
+}
+
 }  // namespace storage
 }  // namespace metaserver
 }  // namespace curvefs
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "curvefs/src/metaserver/storage/slab_arena.h"
+
+namespace curvefs {
+namespace metaserver {
+namespace storage {
+
+TEST(SlabArenaTest, AllocateAndReuse) {
+    SlabArena arena;
+    ASSERT_EQ(arena.MemoryUsage(), 0);
+
+    // CASE 1: small values share one slab
+    std::vector<ArenaValue> values;
+    for (int i = 0; i < 100; i++) {
+        values.emplace_back(&arena, std::string(30, 'a' + i % 26));
+    }
+    ASSERT_EQ(arena.UsedBytes(), 100 * 32);
+    ASSERT_EQ(arena.MemoryUsage(), 4 * 1024);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(values[i].ToString(), std::string(30, 'a' + i % 26));
+    }
+
+    // CASE 2: freed slots are reused by values of the same class
+    char* freed = values[10].MutableData();
+    values[10] = ArenaValue();
+    ArenaValue reused(&arena, std::string(20, 'x'));
+    ASSERT_EQ(reused.Data(), freed);
+    ASSERT_EQ(reused.ToString(), std::string(20, 'x'));
+    ASSERT_EQ(arena.MemoryUsage(), 4 * 1024);
+
+    // CASE 3: large value is allocated from heap
+    ArenaValue large(&arena, std::string(4096, 'l'));
+    ASSERT_EQ(large.ToString(), std::string(4096, 'l'));
+    ASSERT_EQ(arena.MemoryUsage(), 4 * 1024 + 4096);
+
+    // CASE 4: swap and move keep the bytes
+    ArenaValue moved(std::move(reused));
+    ASSERT_EQ(reused.Size(), 0);
+    ASSERT_EQ(moved.ToString(), std::string(20, 'x'));
+
+    // CASE 5: slabs are released after all small values are gone
+    values.clear();
+    moved = ArenaValue();
+    ASSERT_EQ(arena.MemoryUsage(), 4096);
+    large = ArenaValue();
+    ASSERT_EQ(arena.MemoryUsage(), 0);
+    ASSERT_EQ(arena.UsedBytes(), 0);
+}
+
+TEST(SlabArenaTest, EmptyValue) {
+    SlabArena arena;
+    ArenaValue value(&arena, std::string());
+    ASSERT_EQ(value.Size(), 0);
+    ASSERT_EQ(value.ToString(), "");
+    ASSERT_EQ(arena.MemoryUsage(), 0);
+}
+
+TEST(SlabArenaTest, ContainerOwnsArena) {
+    using ContainerType =
+        ArenaContainer<std::unordered_map<std::string, ArenaValue>>;
+    auto container = std::make_shared<ContainerType>();
+    for (int i = 0; i < 1000; i++) {
+        ArenaValue value(container->Arena(), std::to_string(i));
+        (*container)[std::to_string(i)].Swap(value);
+    }
+    ASSERT_EQ(container->size(), 1000);
+    ASSERT_GT(container->Arena()->MemoryUsage(), 0);
+    ASSERT_EQ((*container)["999"].ToString(), "999");
+
+    container->clear();
+    ASSERT_EQ(container->Arena()->MemoryUsage(), 0);
+
+    // values are destroyed before the arena
+    ArenaValue value(container->Arena(), "value");
+    (*container)["key"].Swap(value);
+    container.reset();
+}
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace curvefs
@@ -23,6 +23,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <utility>
+#include <vector>
+
 #include "curvefs/src/metaserver/trash_manager.h"
 #include "curvefs/src/metaserver/storage/storage.h"
 #include "curvefs/src/metaserver/storage/rocksdb_storage.h"
@@ -39,6 +42,7 @@ using ::testing::ReturnArg;
 using ::testing::DoAll;
 using ::testing::SetArgPointee;
 using ::testing::SaveArg;
+using ::testing::Invoke;
 
 namespace curvefs {
 namespace metaserver {
@@ -200,5 +204,104 @@ TEST_F(TestTrash, testAdd3ItemAndNoDelete) {
     trashManager_->Fini();
 }
 
+TEST_F(TestTrash, testDeleteInodesInBatch) {
+    auto s3Adaptor = std::make_shared<MockS3ClientAdaptor>();
+    TrashOption option;
+    option.expiredAfterSec = 0;
+    option.deleteBatchInodeNum = 2;
+    option.mdsClient = std::make_shared<MockMdsClient>();
+    option.s3Adaptor = s3Adaptor;
+    TrashImpl trash(inodeStorage_);
+    trash.Init(option);
+
+    inodeStorage_->Insert(GenInodeHasChunks(1, 1));
+    inodeStorage_->Insert(GenInodeHasChunks(1, 2));
+    inodeStorage_->Insert(GenInodeHasChunks(1, 3));
+    inodeStorage_->Insert(GenInodeHasChunks(2, 1));
+    inodeStorage_->Insert(GenInodeHasChunks(2, 2));
+    ASSERT_EQ(inodeStorage_->Size(), 5);
+
+    trash.Add(1, 1, 0);
+    trash.Add(1, 2, 0);
+    trash.Add(1, 3, 0);
+    trash.Add(2, 1, 0);
+    trash.Add(2, 2, 0);
+
+    // a batch is sent when it's full or the fs changes
+    std::vector<std::pair<uint32_t, size_t>> batches;
+    EXPECT_CALL(*s3Adaptor, DeleteInodes(_))
+        .Times(3)
+        .WillRepeatedly(Invoke([&](const std::list<Inode>& inodes) -> int {
+            for (const auto& inode : inodes) {
+                EXPECT_EQ(inodes.front().fsid(), inode.fsid());
+            }
+            batches.emplace_back(inodes.front().fsid(), inodes.size());
+            return 0;
+        }));
+    trash.ScanTrash();
+
+    std::vector<std::pair<uint32_t, size_t>> expected = {
+        {1, 2}, {1, 1}, {2, 2}};
+    ASSERT_EQ(expected, batches);
+
+    std::list<TrashItem> list;
+    trash.ListItems(&list);
+    ASSERT_EQ(0, list.size());
+    ASSERT_EQ(inodeStorage_->Size(), 0);
+}
+
+TEST_F(TestTrash, testDeleteInodesInBatchPartialFailed) {
+    auto s3Adaptor = std::make_shared<MockS3ClientAdaptor>();
+    TrashOption option;
+    option.expiredAfterSec = 0;
+    option.deleteBatchInodeNum = 2;
+    option.mdsClient = std::make_shared<MockMdsClient>();
+    option.s3Adaptor = s3Adaptor;
+    TrashImpl trash(inodeStorage_);
+    trash.Init(option);
+
+    inodeStorage_->Insert(GenInodeHasChunks(1, 1));
+    inodeStorage_->Insert(GenInodeHasChunks(1, 2));
+    inodeStorage_->Insert(GenInodeHasChunks(1, 3));
+    inodeStorage_->Insert(GenInodeHasChunks(1, 4));
+    inodeStorage_->Insert(GenInodeHasChunks(1, 5));
+    ASSERT_EQ(inodeStorage_->Size(), 5);
+
+    for (uint64_t inodeId = 1; inodeId <= 5; ++inodeId) {
+        trash.Add(1, inodeId, 0);
+    }
+
+    // only items of the failed batch are kept in trash
+    EXPECT_CALL(*s3Adaptor, DeleteInodes(_))
+        .WillOnce(Return(0))
+        .WillOnce(Return(-1))
+        .WillOnce(Return(0));
+    trash.ScanTrash();
+
+    std::list<TrashItem> list;
+    trash.ListItems(&list);
+    ASSERT_EQ(2, list.size());
+    ASSERT_EQ(3, list.front().inodeId);
+    ASSERT_EQ(4, list.back().inodeId);
+    ASSERT_EQ(inodeStorage_->Size(), 2);
+    Inode inode;
+    ASSERT_EQ(MetaStatusCode::OK,
+              inodeStorage_->Get(Key4Inode(1, 3), &inode));
+    ASSERT_EQ(MetaStatusCode::OK,
+              inodeStorage_->Get(Key4Inode(1, 4), &inode));
+
+    // retained items are deleted by next scan
+    std::list<Inode> retried;
+    EXPECT_CALL(*s3Adaptor, DeleteInodes(_))
+        .WillOnce(DoAll(SaveArg<0>(&retried), Return(0)));
+    trash.ScanTrash();
+
+    ASSERT_EQ(2, retried.size());
+    list.clear();
+    trash.ListItems(&list);
+    ASSERT_EQ(0, list.size());
+    ASSERT_EQ(inodeStorage_->Size(), 0);
+}
+
 }  // namespace metaserver
 }  // namespace curvefs
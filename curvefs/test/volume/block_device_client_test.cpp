@@ -23,7 +23,9 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <cstring>
+#include <mutex>
 #include "absl/memory/memory.h"
 
 #include "curvefs/src/volume/block_device_client.h"
@@ -628,5 +630,68 @@ TEST_F(BlockDeviceClientTest, WritevTest_AllUnAlignedSuccess) {
     ASSERT_EQ(4 * (2 * kKiB), client_->Writev(iov));
 }
 
+TEST_F(BlockDeviceClientTest, WritevTest_MergeContiguousParts) {
+    ON_CALL(*fileClient_, Open(_, _, _))
+        .WillByDefault(Return(1));
+
+    char data[16 * kKiB];
+
+    // first three parts are contiguous both on device and in memory,
+    // the last one is not
+    std::vector<WritePart> iov{
+        { 0 * kKiB, 2 * kKiB, data},
+        { 2 * kKiB, 2 * kKiB, data + 2 * kKiB},
+        { 4 * kKiB, 4 * kKiB, data + 4 * kKiB},
+        { 4 * kMiB, 8 * kKiB, data + 8 * kKiB},
+    };
+
+    EXPECT_CALL(*fileClient_, AioRead(_, _, _))
+        .Times(0);
+
+    std::vector<std::pair<off_t, size_t>> writes;
+    std::mutex mtx;
+    EXPECT_CALL(*fileClient_, AioWrite(_, _, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([&](int fd, CurveAioContext* aio,
+                                   UserDataType type) -> int {
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                writes.emplace_back(aio->offset, aio->length);
+            }
+            return FakeAioRequest{}(fd, aio, type);
+        }));
+
+    ASSERT_TRUE(client_->Open({}, {}));
+    ASSERT_EQ(16 * kKiB, client_->Writev(iov));
+
+    std::sort(writes.begin(), writes.end());
+    std::vector<std::pair<off_t, size_t>> expected{
+        {0, 8 * kKiB}, {4 * kMiB, 8 * kKiB}};
+    ASSERT_EQ(expected, writes);
+}
+
+TEST_F(BlockDeviceClientTest, ReadvTest_MergeIntoOneRequest) {
+    ON_CALL(*fileClient_, Open(_, _, _))
+        .WillByDefault(Return(1));
+
+    char data[8 * kKiB];
+
+    std::vector<ReadPart> iov{
+        { 4 * kMiB, 4 * kKiB, data},
+        { 4 * kMiB + 4 * kKiB, 4 * kKiB, data + 4 * kKiB},
+    };
+
+    EXPECT_CALL(*fileClient_, AioRead(_, _, _))
+        .WillOnce(Invoke([](int fd, CurveAioContext* aio,
+                            UserDataType type) -> int {
+            EXPECT_EQ(4 * kMiB, aio->offset);
+            EXPECT_EQ(8 * kKiB, aio->length);
+            return FakeAioRequest{}(fd, aio, type);
+        }));
+
+    ASSERT_TRUE(client_->Open({}, {}));
+    ASSERT_EQ(8 * kKiB, client_->Readv(iov));
+}
+
 }  // namespace volume
 }  // namespace curvefs
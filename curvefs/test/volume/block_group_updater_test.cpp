@@ -107,5 +107,53 @@ TEST_F(BlockGroupBitmapUpdaterTest, SyncTest_WriteFailed) {
     ASSERT_FALSE(updater_->Sync());
 }
 
+TEST_F(BlockGroupBitmapUpdaterTest, SyncTest_RetryAfterWriteFailed) {
+    auto start = kBlockGroupOffset;
+    auto end = kBlockGroupOffset + kBlockGroupSize;
+    updater_->Update({start, end}, BlockGroupBitmapUpdater::Set);
+
+    EXPECT_CALL(*mockBlockDev_, Write(_, _, _))
+        .WillOnce(Return(-1))
+        .WillOnce(
+            Invoke([](const char*, off_t, size_t length) { return length; }));
+
+    ASSERT_FALSE(updater_->Sync());
+    ASSERT_TRUE(updater_->Sync());
+    ASSERT_TRUE(updater_->Sync());
+}
+
+TEST(BlockGroupBitmapUpdaterSyncTest, SyncTest_OnlyDirtyPart) {
+    constexpr uint64_t blockGroupSize = 1 * kGiB;
+    constexpr uint64_t bitmapLength =
+        blockGroupSize / kBlockSize / curve::common::BITMAP_UNIT_SIZE;
+
+    MockBlockDeviceClient blockDev;
+    Bitmap bitmap(blockGroupSize / kBlockSize);
+    bitmap.Clear();
+    BlockGroupBitmapUpdater updater(std::move(bitmap), kBlockSize,
+                                    blockGroupSize, kBlockGroupOffset,
+                                    {kBlockGroupOffset, bitmapLength},
+                                    &blockDev);
+
+    // bits of [512MiB, 513MiB) are in the 5th 4KiB of bitmap, and bits of
+    // [640MiB, 641MiB) are in the 6th one
+    updater.Update({kBlockGroupOffset + 512 * kMiB, 1 * kMiB},
+                   BlockGroupBitmapUpdater::Set);
+    updater.Update({kBlockGroupOffset + 640 * kMiB, 1 * kMiB},
+                   BlockGroupBitmapUpdater::Set);
+
+    EXPECT_CALL(blockDev, Write(_, _, _))
+        .WillOnce(Invoke([](const char* data, off_t offset, size_t length) {
+            EXPECT_EQ(kBlockGroupOffset + 4 * 4 * kKiB, offset);
+            EXPECT_EQ(2 * 4 * kKiB, length);
+            // bits of [512MiB, 513MiB) start from the beginning
+            EXPECT_EQ(static_cast<char>(0xff), data[0]);
+            EXPECT_EQ(0, data[32]);
+            return length;
+        }));
+
+    ASSERT_TRUE(updater.Sync());
+}
+
 }  // namespace volume
 }  // namespace curvefs
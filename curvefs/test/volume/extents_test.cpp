@@ -339,5 +339,47 @@ TEST(ExtentTest, TestMarkUsed) {
     EXPECT_EQ(0, freeExt.AvailableExtents().size());
 }
 
+TEST(ExtentTest, TestAllocBestFit) {
+    FreeExtents freeExt(0, 16 * kMiB);
+
+    // free extents: [0, 4MiB), [5MiB, 6MiB), [8MiB, 10MiB), [12MiB, 16MiB)
+    freeExt.MarkUsed(4 * kMiB, 1 * kMiB);
+    freeExt.MarkUsed(6 * kMiB, 2 * kMiB);
+    freeExt.MarkUsed(10 * kMiB, 2 * kMiB);
+    ASSERT_EQ(11 * kMiB, freeExt.AvailableSize());
+    ASSERT_EQ(4, freeExt.AvailableExtents().size());
+
+    AllocateHint hint;
+    Extents exts;
+    ASSERT_EQ(1 * kMiB, freeExt.Alloc(1 * kMiB, hint, &exts));
+    ASSERT_EQ(Extents({{5 * kMiB, 1 * kMiB}}), exts);
+
+    exts.clear();
+    ASSERT_EQ(2 * kMiB, freeExt.Alloc(2 * kMiB, hint, &exts));
+    ASSERT_EQ(Extents({{8 * kMiB, 2 * kMiB}}), exts);
+
+    // both of remaining extents are 4MiB, the lower one is chosen
+    exts.clear();
+    ASSERT_EQ(3 * kMiB, freeExt.Alloc(3 * kMiB, hint, &exts));
+    ASSERT_EQ(Extents({{0, 3 * kMiB}}), exts);
+
+    // no extent is large enough, extents are consumed from lowest offset
+    exts.clear();
+    ASSERT_EQ(5 * kMiB, freeExt.Alloc(6 * kMiB, hint, &exts));
+    ASSERT_EQ(Extents({{3 * kMiB, 1 * kMiB}, {12 * kMiB, 4 * kMiB}}), exts);
+    ASSERT_EQ(0, freeExt.AvailableSize());
+    ASSERT_TRUE(freeExt.AvailableExtents().empty());
+
+    // merge with both neighbours when free
+    freeExt.DeAlloc(0, 2 * kMiB);
+    freeExt.DeAlloc(4 * kMiB, 2 * kMiB);
+    freeExt.DeAlloc(2 * kMiB, 2 * kMiB);
+    ASSERT_EQ(ExtentMap({{0, 6 * kMiB}}), freeExt.AvailableExtents());
+
+    exts.clear();
+    ASSERT_EQ(6 * kMiB, freeExt.Alloc(6 * kMiB, hint, &exts));
+    ASSERT_EQ(Extents({{0, 6 * kMiB}}), exts);
+}
+
 }  // namespace volume
 }  // namespace curvefs
@@ -37,6 +37,7 @@ class MockSpaceManager : public SpaceManager {
     MOCK_METHOD3(Alloc,
                  bool(uint32_t, const AllocateHint &, std::vector<Extent> *));
     MOCK_METHOD2(DeAlloc, bool(uint64_t, const std::vector<Extent> &));
+    MOCK_METHOD1(Free, bool(const std::vector<Extent> &));
     MOCK_METHOD0(Shutdown, bool());
     MOCK_METHOD0(Run, void());
     MOCK_METHOD0(GetBlockGroupSize, uint64_t());
@@ -29,9 +29,12 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <iterator>
 #include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "curvefs/proto/space.pb.h"
 #include "curvefs/src/volume/common.h"
@@ -218,5 +221,118 @@ TEST_F(SpaceManagerImplTest, TestMultiThreadAlloc) {
     ASSERT_TRUE(spaceManager_->Shutdown());
 }
 
+TEST_F(SpaceManagerImplTest, TestAllocRollbackWhenUpdateBitmapFailed) {
+    mds::space::BlockGroup group;
+    group.set_offset(0);
+    group.set_size(kBlockGroupSize);
+    group.set_available(kBlockGroupSize / 2);
+    group.set_bitmaplocation(curvefs::common::BitmapLocation::AtStart);
+
+    // only one block group is given, so later allocations fail if any space
+    // of the failed allocation is leaked
+    EXPECT_CALL(*mdsClient_, AllocateVolumeBlockGroup(_, _, _, _))
+        .WillOnce(Invoke(MockAllocateBlockGroup{group}));
+
+    EXPECT_CALL(*devClient_, Read(_, _, _))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Invoke(MockRead));
+
+    EXPECT_CALL(*devClient_, Write(_, _, _))
+        .WillOnce(Return(-1))
+        .WillRepeatedly(Invoke(MockWrite));
+
+    std::vector<Extent> ext;
+    ASSERT_FALSE(spaceManager_->Alloc(kBlockSize, {}, &ext));
+    ASSERT_TRUE(ext.empty());
+
+    // all space except bitmap is available again
+    ASSERT_TRUE(
+        spaceManager_->Alloc(kBlockGroupSize - kBlockSize, {}, &ext));
+    uint64_t allocated = 0;
+    for (const auto& e : ext) {
+        allocated += e.len;
+    }
+    ASSERT_EQ(kBlockGroupSize - kBlockSize, allocated);
+
+    EXPECT_CALL(*mdsClient_, ReleaseVolumeBlockGroup(_, _, _))
+        .WillOnce(Return(SpaceErrCode::SpaceOk));
+    ASSERT_TRUE(spaceManager_->Shutdown());
+}
+
+TEST_F(SpaceManagerImplTest, TestRefillBlockGroupInBackground) {
+    opt_.reservedBlockGroups = 1;
+    opt_.releaseInterSec = 300;
+    // longer than the test, so failed refill isn't retried
+    opt_.refillRetryIntervalMs = 60 * 1000;
+    spaceManager_.reset(new SpaceManagerImpl(opt_, mdsClient_, devClient_));
+
+    mds::space::BlockGroup group;
+    group.set_offset(0);
+    group.set_size(kBlockGroupSize);
+    group.set_available(kBlockGroupSize / 2);
+    group.set_bitmaplocation(curvefs::common::BitmapLocation::AtStart);
+
+    // the reserve is never satisfied by one half-used block group, so the
+    // following refills get no space
+    std::atomic<bool> refilled(false);
+    std::atomic<int> refillFailures(0);
+    std::thread::id refillThread;
+    EXPECT_CALL(*mdsClient_, AllocateVolumeBlockGroup(_, _, _, _))
+        .WillOnce(Invoke(
+            [&](uint32_t fsId, uint32_t count, const std::string& owner,
+                std::vector<mds::space::BlockGroup>* groups) {
+                refillThread = std::this_thread::get_id();
+                auto ret = MockAllocateBlockGroup{group}(fsId, count, owner,
+                                                         groups);
+                refilled.store(true);
+                return ret;
+            }))
+        .WillRepeatedly(Invoke(
+            [&](uint32_t, uint32_t, const std::string&,
+                std::vector<mds::space::BlockGroup>*) {
+                refillFailures.fetch_add(1);
+                return SpaceErrCode::SpaceErrNoSpace;
+            }));
+
+    EXPECT_CALL(*devClient_, Read(_, _, _))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Invoke(MockRead));
+
+    EXPECT_CALL(*devClient_, Write(_, _, _))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Invoke(MockWrite));
+
+    spaceManager_->Run();
+    while (!refilled.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_NE(std::this_thread::get_id(), refillThread);
+
+    // allocate from the reserved block group, and the refill triggered by
+    // it fails
+    for (int i = 0; i < 10; ++i) {
+        std::vector<Extent> ext;
+        ASSERT_TRUE(spaceManager_->Alloc(kBlockSize, {}, &ext));
+        ASSERT_EQ(1, ext.size());
+    }
+    while (refillFailures.load() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // triggers are ignored while backing off
+    for (int i = 0; i < 10; ++i) {
+        std::vector<Extent> ext;
+        ASSERT_TRUE(spaceManager_->Alloc(kBlockSize, {}, &ext));
+        ASSERT_EQ(1, ext.size());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(1, refillFailures.load());
+
+    // shutdown doesn't wait for the backoff
+    EXPECT_CALL(*mdsClient_, ReleaseVolumeBlockGroup(_, _, _))
+        .WillOnce(Return(SpaceErrCode::SpaceOk));
+    ASSERT_TRUE(spaceManager_->Shutdown());
+}
+
 }  // namespace volume
 }  // namespace curvefs
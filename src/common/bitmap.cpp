@@ -22,6 +22,7 @@
 
 #include <glog/logging.h>
 #include <memory.h>
+#include <algorithm>
 #include <utility>
 #include <string>
 #include "src/common/bitmap.h"
@@ -29,6 +30,27 @@
 namespace curve {
 namespace common {
 
+namespace {
+
+const uint32_t kWordBits = 64;
+const uint64_t kAllOnes = ~0ULL;
+
+// mask of bits [offset, 63] in a word
+inline uint64_t HeadMask(uint32_t offset) {
+    return kAllOnes << offset;
+}
+
+// mask of bits [0, offset] in a word
+inline uint64_t TailMask(uint32_t offset) {
+    return kAllOnes >> (kWordBits - 1 - offset);
+}
+
+inline uint8_t ByteMask(uint32_t first, uint32_t last) {
+    return static_cast<uint8_t>((0xff << first) & (0xff >> (7 - last)));
+}
+
+}  // namespace
+
 std::string BitRangeVecToString(const std::vector<BitRange> &ranges) {
     std::stringstream ss;
     for (uint32_t i = 0; i < ranges.size(); ++i) {
@@ -138,10 +160,7 @@ void Bitmap::Set(uint32_t index) {
 }
 
 void Bitmap::Set(uint32_t startIndex, uint32_t endIndex) {
-    // TODO(wuhanqing): implement fast algorithm if one byte is all set
-    for (uint32_t index = startIndex; index <= endIndex; ++index) {
-        Set(index);
-    }
+    FillRange(startIndex, endIndex, true);
 }
 
 void Bitmap::Clear() {
@@ -154,10 +173,109 @@ void Bitmap::Clear(uint32_t index) {
 }
 
 void Bitmap::Clear(uint32_t startIndex, uint32_t endIndex) {
-    // TODO(wuhanqing): implement fast algorithm if one byte is all clear
-    for (uint32_t index = startIndex; index <= endIndex; ++index) {
-        Clear(index);
+    FillRange(startIndex, endIndex, false);
+}
+
+void Bitmap::FillRange(uint32_t startIndex, uint32_t endIndex, bool set) {
+    if (bits_ == 0) {
+        return;
+    }
+    endIndex = std::min(endIndex, bits_ - 1);
+    if (startIndex > endIndex) {
+        return;
     }
+
+    // the partial bytes at both ends are updated by mask, and the whole
+    // bytes between them are filled at once
+    const uint32_t first = indexOfUnit(startIndex);
+    const uint32_t last = indexOfUnit(endIndex);
+    const uint32_t firstBit = startIndex % BITMAP_UNIT_SIZE;
+    const uint32_t lastBit = endIndex % BITMAP_UNIT_SIZE;
+    uint8_t* units = reinterpret_cast<uint8_t*>(bitmap_);
+
+    if (first == last) {
+        const uint8_t m = ByteMask(firstBit, lastBit);
+        units[first] = set ? (units[first] | m) : (units[first] & ~m);
+        return;
+    }
+
+    const uint8_t head = ByteMask(firstBit, 7);
+    const uint8_t tail = ByteMask(0, lastBit);
+    units[first] = set ? (units[first] | head) : (units[first] & ~head);
+    units[last] = set ? (units[last] | tail) : (units[last] & ~tail);
+    if (last - first > 1) {
+        memset(units + first + 1, set ? 0xff : 0, last - first - 1);
+    }
+}
+
+uint64_t Bitmap::LoadWord(uint32_t wordIndex) const {
+    const uint32_t offset = wordIndex * sizeof(uint64_t);
+    const uint32_t length =
+        std::min<uint32_t>(sizeof(uint64_t), unitCount() - offset);
+    uint64_t word = 0;
+    memcpy(&word, bitmap_ + offset, length);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+uint32_t Bitmap::FindFirst(uint32_t startIndex,
+                           uint32_t endIndex,
+                           bool set) const {
+    if (bits_ == 0) {
+        return NO_POS;
+    }
+    endIndex = std::min(endIndex, bits_ - 1);
+    if (startIndex > endIndex) {
+        return NO_POS;
+    }
+
+    // search for set bits, and clear bits are searched in the flipped word
+    const uint64_t flip = set ? 0 : kAllOnes;
+    const uint32_t lastWord = endIndex / kWordBits;
+    uint32_t wordIndex = startIndex / kWordBits;
+    uint64_t word =
+        (LoadWord(wordIndex) ^ flip) & HeadMask(startIndex % kWordBits);
+
+    while (wordIndex < lastWord) {
+        if (word != 0) {
+            return wordIndex * kWordBits + __builtin_ctzll(word);
+        }
+        word = LoadWord(++wordIndex) ^ flip;
+    }
+
+    word &= TailMask(endIndex % kWordBits);
+    if (word == 0) {
+        return NO_POS;
+    }
+    return wordIndex * kWordBits + __builtin_ctzll(word);
+}
+
+uint32_t Bitmap::Count(uint32_t startIndex, uint32_t endIndex) const {
+    if (bits_ == 0) {
+        return 0;
+    }
+    endIndex = std::min(endIndex, bits_ - 1);
+    if (startIndex > endIndex) {
+        return 0;
+    }
+
+    const uint32_t lastWord = endIndex / kWordBits;
+    uint32_t wordIndex = startIndex / kWordBits;
+    uint64_t word = LoadWord(wordIndex) & HeadMask(startIndex % kWordBits);
+    uint32_t count = 0;
+    while (wordIndex < lastWord) {
+        count += __builtin_popcountll(word);
+        word = LoadWord(++wordIndex);
+    }
+
+    word &= TailMask(endIndex % kWordBits);
+    return count + __builtin_popcountll(word);
+}
+
+uint32_t Bitmap::Count() const {
+    return Count(0, bits_ - 1);
 }
 
 bool Bitmap::Test(uint32_t index) const {
@@ -168,54 +286,19 @@ bool Bitmap::Test(uint32_t index) const {
 }
 
 uint32_t Bitmap::NextSetBit(uint32_t index) const {
-    for (; index < bits_; ++index) {
-        if (Test(index))
-            break;
-    }
-    if (index >= bits_)
-        index = NO_POS;
-    return index;
+    return FindFirst(index, bits_ - 1, true);
 }
 
 uint32_t Bitmap::NextSetBit(uint32_t startIndex, uint32_t endIndex) const {
-    uint32_t index = startIndex;
-    // bitmap中最后一个bit的index值
-    uint32_t lastIndex = bits_ - 1;
-    // endIndex值不能超过lastIndex
-    if (endIndex > lastIndex)
-        endIndex = lastIndex;
-    for (; index <= endIndex; ++index) {
-        if (Test(index))
-            break;
-    }
-    if (index > endIndex)
-        index = NO_POS;
-    return index;
+    return FindFirst(startIndex, endIndex, true);
 }
 
 uint32_t Bitmap::NextClearBit(uint32_t index) const {
-    for (; index < bits_; ++index) {
-        if (!Test(index))
-            break;
-    }
-    if (index >= bits_)
-        index = NO_POS;
-    return index;
+    return FindFirst(index, bits_ - 1, false);
 }
 
 uint32_t Bitmap::NextClearBit(uint32_t startIndex, uint32_t endIndex) const {
-    uint32_t index = startIndex;
-    uint32_t lastIndex = bits_ - 1;
-    // endIndex值不能超过lastIndex
-    if (endIndex > lastIndex)
-        endIndex = lastIndex;
-    for (; index <= endIndex; ++index) {
-        if (!Test(index))
-            break;
-    }
-    if (index > endIndex)
-        index = NO_POS;
-    return index;
+    return FindFirst(startIndex, endIndex, false);
 }
 
 void Bitmap::Divide(uint32_t startIndex,
@@ -158,6 +158,18 @@ class Bitmap {
      * @return: 首个位为0的位置，如果指定范围内不存在则返回NO_POS
      */
     uint32_t NextClearBit(uint32_t startIndex, uint32_t endIndex) const;
+    /**
+     * 统计指定起始位置到结束位置之间位为1的个数
+     * @param startIndex: 起始位置，包含此位置
+     * @param endIndex: 结束位置，包含此位置
+     * @return: 位为1的个数
+     */
+    uint32_t Count(uint32_t startIndex, uint32_t endIndex) const;
+    /**
+     * 统计bitmap中位为1的个数
+     * @return: 位为1的个数
+     */
+    uint32_t Count() const;
     /**
      * 将bitmap的指定区域分割成若干连续区域，划分依据为位状态，连续区域内的位状态一致
      * 例如：00011100会被划分为三个区域，[0,2]、[3,5]、[6,7]
@@ -182,6 +194,15 @@ class Bitmap {
     const char* GetBitmap() const;
 
  private:
+    // 将[startIndex, endIndex]范围内的位置为1或0，首尾不完整的字节按掩码
+    // 修改，中间的字节整体填充
+    void FillRange(uint32_t startIndex, uint32_t endIndex, bool set);
+    // 读取第wordIndex个64位字，第i位对应bitmap中的第wordIndex * 64 + i位，
+    // 超出bitmap长度的部分为0
+    uint64_t LoadWord(uint32_t wordIndex) const;
+    // 以64位字为单位查找[startIndex, endIndex]范围内首个状态为set的位
+    uint32_t FindFirst(uint32_t startIndex, uint32_t endIndex, bool set) const;
+
     // bitmap的字节数
     int unitCount() const {
         // 同 (bits_ + BITMAP_UNIT_SIZE - 1) / BITMAP_UNIT_SIZE
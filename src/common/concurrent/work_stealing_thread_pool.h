@@ -0,0 +1,391 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#ifndef SRC_COMMON_CONCURRENT_WORK_STEALING_THREAD_POOL_H_
+#define SRC_COMMON_CONCURRENT_WORK_STEALING_THREAD_POOL_H_
+
+#include <bvar/bvar.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>               //NOLINT
+#include <climits>
+#include <condition_variable>   //NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>                //NOLINT
+#include <string>
+#include <thread>               //NOLINT
+#include <utility>
+#include <vector>
+
+#include "src/common/concurrent/task_thread_pool.h"
+#include "src/common/uncopyable.h"
+
+namespace curve {
+namespace common {
+
+// A thread pool with the same interface as TaskThreadPool, but each worker
+// has its own task deque and lock. Tasks are spread over workers, and an
+// idle worker steals tasks from others, so producers and workers rarely
+// contend on one lock. The global lock is only taken to sleep or to wake up
+// idle workers and blocked producers.
+template <typename MutexT = std::mutex,
+          typename CondVarT = std::condition_variable>
+class WorkStealingThreadPool : public Uncopyable {
+ public:
+    WorkStealingThreadPool()
+        : capacity_(-1), running_(false), size_(0), sleepingWorkers_(0),
+          waitingProducers_(0), nextWorker_(0) {}
+
+    virtual ~WorkStealingThreadPool() {
+        if (running_.load(std::memory_order_acquire)) {
+            Stop();
+        }
+    }
+
+    /**
+     * @brief Pin workers to |cpus| in turn, it must be called before Start().
+     *        Workers aren't pinned by default.
+     */
+    void SetCpuAffinity(const std::vector<int>& cpus) {
+        cpus_ = cpus;
+    }
+
+    /**
+     * @brief Expose queue latency and steal count with |prefix|, it must be
+     *        called before Start()
+     */
+    void ExposeMetric(const std::string& prefix) {
+        metric_.reset(new Metric(prefix));
+    }
+
+    /**
+     * @brief Start the thread pool
+     * @param numThreads number of workers, must be greater than 0
+     * @param queueCapacity maximum number of pending tasks, must be greater
+     *        than 0
+     * @return 0 if succeeded, -1 if arguments are invalid
+     */
+    int Start(int numThreads, int queueCapacity = INT_MAX) {
+        if (0 >= queueCapacity) {
+            return -1;
+        }
+        capacity_ = queueCapacity;
+
+        if (0 >= numThreads) {
+            return -1;
+        }
+
+        if (!running_.exchange(true, std::memory_order_acq_rel)) {
+            size_.store(0);
+            workers_.clear();
+            threads_.clear();
+            workers_.reserve(numThreads);
+            threads_.reserve(numThreads);
+            for (int i = 0; i < numThreads; ++i) {
+                workers_.emplace_back(new Worker());
+            }
+            for (int i = 0; i < numThreads; ++i) {
+                threads_.emplace_back(new std::thread(
+                    std::bind(&WorkStealingThreadPool::ThreadFunc, this, i)));
+                SetAffinity(i);
+            }
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Stop the thread pool, pending tasks are dropped
+     */
+    void Stop() {
+        if (running_.exchange(false, std::memory_order_acq_rel)) {
+            {
+                std::lock_guard<MutexT> guard(mutex_);
+                notEmpty_.notify_all();
+            }
+            for (auto& thr : threads_) {
+                thr->join();
+            }
+        }
+    }
+
+    /**
+     * @brief Push a task to the pool, it blocks if the queue is full. Tasks
+     *        submitted by a worker are pushed to its own deque.
+     */
+    template <class F, class... Args>
+    void Enqueue(F&& f, Args&&... args) {
+        Reserve(1);
+        Push(Item(std::bind(std::forward<F>(f), std::forward<Args>(args)...),
+                  Now()));
+        WakeUpWorkers(1);
+    }
+
+    /**
+     * @brief Push tasks to the pool, they're spread over workers with one
+     *        lock per worker. It blocks while the queue is full.
+     */
+    void EnqueueBatch(std::vector<Task> tasks) {
+        size_t pushed = 0;
+        while (pushed < tasks.size()) {
+            const size_t n = Reserve(tasks.size() - pushed);
+            PushBatch(&tasks, pushed, n);
+            WakeUpWorkers(n);
+            pushed += n;
+        }
+    }
+
+    int QueueCapacity() const {
+        return capacity_;
+    }
+
+    /* number of tasks pushed but not taken by workers, thread safe */
+    int QueueSize() const {
+        return static_cast<int>(size_.load());
+    }
+
+    int ThreadOfNums() const {
+        return threads_.size();
+    }
+
+ private:
+    struct Item {
+        Item() = default;
+
+        Item(Task task, uint64_t enqueueTime)
+            : task(std::move(task)), enqueueTime(enqueueTime) {}
+
+        Task task;
+        uint64_t enqueueTime = 0;
+    };
+
+    struct Worker {
+        MutexT mutex;
+        std::deque<Item> tasks;
+    };
+
+    struct Metric {
+        explicit Metric(const std::string& prefix)
+            : queueLatency(prefix, "queue_latency"),
+              steal(prefix, "steal_count") {}
+
+        bvar::LatencyRecorder queueLatency;
+        bvar::Adder<uint64_t> steal;
+    };
+
+    // worker of the pool which current thread belongs to
+    struct WorkerContext {
+        const void* pool = nullptr;
+        size_t index = 0;
+    };
+
+    static WorkerContext& CurrentWorker() {
+        static thread_local WorkerContext context;
+        return context;
+    }
+
+    uint64_t Now() const {
+        if (metric_ == nullptr) {
+            return 0;
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void SetAffinity(int index) {
+        if (cpus_.empty()) {
+            return;
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus_[index % cpus_.size()], &set);
+        pthread_setaffinity_np(threads_[index]->native_handle(), sizeof(set),
+                               &set);
+    }
+
+    // Reserve slots for at most |count| tasks, block until at least one
+    // slot is available, and return the number of reserved slots
+    size_t Reserve(size_t count) {
+        const int64_t capacity = capacity_;
+        int64_t size = size_.load();
+        while (true) {
+            if (size >= capacity) {
+                std::unique_lock<MutexT> guard(mutex_);
+                waitingProducers_.fetch_add(1);
+                while (size_.load() >= capacity) {
+                    notFull_.wait(guard);
+                }
+                waitingProducers_.fetch_sub(1);
+                size = size_.load();
+                continue;
+            }
+
+            const int64_t n = std::min<int64_t>(count, capacity - size);
+            if (size_.compare_exchange_weak(size, size + n)) {
+                return n;
+            }
+        }
+    }
+
+    size_t TargetWorker() {
+        const WorkerContext& context = CurrentWorker();
+        if (context.pool == this) {
+            return context.index;
+        }
+        return nextWorker_.fetch_add(1, std::memory_order_relaxed) %
+               workers_.size();
+    }
+
+    void Push(Item&& item) {
+        Worker* worker = workers_[TargetWorker()].get();
+        std::lock_guard<MutexT> guard(worker->mutex);
+        worker->tasks.push_back(std::move(item));
+    }
+
+    void PushBatch(std::vector<Task>* tasks, size_t begin, size_t n) {
+        const uint64_t now = Now();
+        const size_t numWorkers = workers_.size();
+        const size_t perWorker = (n + numWorkers - 1) / numWorkers;
+        size_t cur = begin;
+        const size_t end = begin + n;
+        while (cur < end) {
+            Worker* worker = workers_[TargetWorker()].get();
+            const size_t last = std::min(end, cur + perWorker);
+            std::lock_guard<MutexT> guard(worker->mutex);
+            for (; cur < last; ++cur) {
+                worker->tasks.emplace_back(std::move((*tasks)[cur]), now);
+            }
+        }
+    }
+
+    void WakeUpWorkers(size_t n) {
+        if (sleepingWorkers_.load() == 0) {
+            return;
+        }
+
+        std::lock_guard<MutexT> guard(mutex_);
+        if (n == 1) {
+            notEmpty_.notify_one();
+        } else {
+            notEmpty_.notify_all();
+        }
+    }
+
+    // Take a task from the head of worker's own deque, or steal one from
+    // the tail of others
+    bool Take(size_t index, Item* item) {
+        {
+            Worker* worker = workers_[index].get();
+            std::lock_guard<MutexT> guard(worker->mutex);
+            if (!worker->tasks.empty()) {
+                *item = std::move(worker->tasks.front());
+                worker->tasks.pop_front();
+                return true;
+            }
+        }
+
+        for (size_t i = 1; i < workers_.size(); ++i) {
+            Worker* victim = workers_[(index + i) % workers_.size()].get();
+            std::lock_guard<MutexT> guard(victim->mutex);
+            if (!victim->tasks.empty()) {
+                *item = std::move(victim->tasks.back());
+                victim->tasks.pop_back();
+                if (metric_ != nullptr) {
+                    metric_->steal << 1;
+                }
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ThreadFunc(size_t index) {
+        CurrentWorker().pool = this;
+        CurrentWorker().index = index;
+
+        while (running_.load(std::memory_order_acquire)) {
+            Item item;
+            if (Take(index, &item)) {
+                size_.fetch_sub(1);
+                if (waitingProducers_.load() > 0) {
+                    std::lock_guard<MutexT> guard(mutex_);
+                    notFull_.notify_one();
+                }
+
+                if (metric_ != nullptr) {
+                    metric_->queueLatency << (Now() - item.enqueueTime);
+                }
+                item.task();
+                continue;
+            }
+
+            if (size_.load() > 0) {
+                // slots are reserved but tasks are not pushed yet
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<MutexT> guard(mutex_);
+            sleepingWorkers_.fetch_add(1);
+            while (size_.load() == 0 &&
+                   running_.load(std::memory_order_acquire)) {
+                notEmpty_.wait(guard);
+            }
+            sleepingWorkers_.fetch_sub(1);
+        }
+
+        CurrentWorker().pool = nullptr;
+    }
+
+ private:
+    // only for sleeping and waking up
+    MutexT mutex_;
+    CondVarT notEmpty_;
+    CondVarT notFull_;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::unique_ptr<std::thread>> threads_;
+    std::vector<int> cpus_;
+    int capacity_;
+    std::atomic<bool> running_;
+
+    // number of reserved slots, including tasks being pushed
+    std::atomic<int64_t> size_;
+    std::atomic<uint32_t> sleepingWorkers_;
+    std::atomic<uint32_t> waitingProducers_;
+    std::atomic<uint64_t> nextWorker_;
+
+    std::unique_ptr<Metric> metric_;
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_CONCURRENT_WORK_STEALING_THREAD_POOL_H_
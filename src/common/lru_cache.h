@@ -26,11 +26,15 @@
 #include <bvar/bvar.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <iterator>
 #include <list>
 #include <string>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/timeutility.h"
 
@@ -467,6 +471,336 @@ std::shared_ptr<CacheMetrics>
 }
 
 
+struct ShardedLRUCacheOption {
+    // number of shards, each one has its own lock, it's no more than
+    // |maxCount| or |maxBytes| if capacity is limited
+    uint32_t shardNum = 16;
+    // the maximum number of items of all shards, 0 indicates unlimited
+    uint64_t maxCount = 0;
+    // the maximum bytes of all shards counted by traits, 0 indicates
+    // unlimited
+    uint64_t maxBytes = 0;
+    // if true, a hit only sets the reference bit of the item under read lock,
+    // and referenced items get a second chance when evicting (CLOCK), instead
+    // of being moved to the head on each hit
+    bool secondChance = false;
+    // metrics of each shard are exposed with this prefix if not empty
+    std::string metricPrefix;
+};
+
+// ShardedLRUCache has the same interface as LRUCache, but keys are
+// distributed to shards by hash, and each shard is an independent lru with
+// its own lock, so operations on different shards don't block each other.
+// Capacity is split exactly among shards, so that the sum of them is the
+// capacity, thus eviction order is only kept within a shard.
+template <typename K, typename V,
+    typename KeyTraits = CacheTraits<K>,
+    typename ValueTraits = CacheTraits<V>,
+    typename Hash = std::hash<K>>
+class ShardedLRUCache : public LRUCacheInterface<K, V> {
+ public:
+    explicit ShardedLRUCache(
+        std::shared_ptr<CacheMetrics> cacheMetrics = nullptr)
+      : ShardedLRUCache(ShardedLRUCacheOption(), cacheMetrics) {}
+
+    explicit ShardedLRUCache(uint64_t maxCount,
+        std::shared_ptr<CacheMetrics> cacheMetrics = nullptr)
+      : ShardedLRUCache(MakeOption(maxCount), cacheMetrics) {}
+
+    explicit ShardedLRUCache(const ShardedLRUCacheOption &option,
+        std::shared_ptr<CacheMetrics> cacheMetrics = nullptr);
+
+    void Put(const K &key, const V &value) override;
+
+    /**
+     * @brief Store key-value to the cache, and return the eliminated one.
+     *        If more than one item is eliminated for byte capacity, only the
+     *        oldest one is returned.
+     */
+    bool Put(const K &key, const V &value, V *eliminated) override;
+
+    bool Get(const K &key, V *value) override;
+
+    void Remove(const K &key) override;
+
+    uint64_t Size() override;
+
+    std::shared_ptr<CacheMetrics> GetCacheMetrics() const;
+
+ private:
+    struct Item {
+        Item(const V &value, uint64_t bytes)
+          : key(nullptr), value(value), bytes(bytes), referenced(false) {}
+
+        const K* key;
+        V value;
+        uint64_t bytes;
+        std::atomic<bool> referenced;
+    };
+
+    using ItemIterator = typename std::list<Item>::iterator;
+
+    struct Shard {
+        ::curve::common::RWLock lock;
+        std::list<Item> ll;
+        std::unordered_map<K, ItemIterator, Hash> cache;
+        uint64_t bytes = 0;
+        // capacity of this shard, 0 indicates unlimited
+        uint64_t maxCount = 0;
+        uint64_t maxBytes = 0;
+        std::unique_ptr<CacheMetrics> metrics;
+    };
+
+    static ShardedLRUCacheOption MakeOption(uint64_t maxCount) {
+        ShardedLRUCacheOption option;
+        option.maxCount = maxCount;
+        return option;
+    }
+
+    Shard* GetShard(const K &key) const {
+        // keys like inode ids are continuous, mix bits before picking shard
+        uint64_t hash = static_cast<uint64_t>(Hash()(key));
+        hash = (hash ^ (hash >> 31)) * 0x9E3779B97F4A7C15ULL;
+        return shards_[(hash >> 32) % shards_.size()].get();
+    }
+
+    bool OverCapacity(const Shard &shard) const {
+        return (shard.maxCount != 0 && shard.ll.size() > shard.maxCount) ||
+               (shard.maxBytes != 0 && shard.bytes > shard.maxBytes);
+    }
+
+    // capacity of the |index|th shard, the remainder goes to the first
+    // shards one by one
+    static uint64_t ShardCapacity(uint64_t total, uint32_t shardNum,
+                                  uint32_t index) {
+        return total / shardNum + (index < total % shardNum ? 1 : 0);
+    }
+
+    bool PutLocked(Shard *shard, const K &key, const V &value,
+                   V *eliminated);
+
+    void RemoveElement(Shard *shard, const ItemIterator &elem);
+
+    void OnAdd(Shard *shard, uint64_t bytes);
+
+    void OnRemove(Shard *shard, uint64_t bytes);
+
+ private:
+    std::vector<std::unique_ptr<Shard>> shards_;
+    bool secondChance_;
+    // cache related metric data of all shards
+    std::shared_ptr<CacheMetrics> cacheMetrics_;
+};
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::ShardedLRUCache(
+    const ShardedLRUCacheOption &option,
+    std::shared_ptr<CacheMetrics> cacheMetrics)
+  : secondChance_(option.secondChance),
+    cacheMetrics_(cacheMetrics) {
+    // small caches have fewer shards, so that no shard has zero capacity,
+    // which means unlimited
+    uint32_t shardNum = std::max(option.shardNum, 1U);
+    if (option.maxCount != 0 && option.maxCount < shardNum) {
+        shardNum = option.maxCount;
+    }
+    if (option.maxBytes != 0 && option.maxBytes < shardNum) {
+        shardNum = option.maxBytes;
+    }
+
+    shards_.reserve(shardNum);
+    for (uint32_t i = 0; i < shardNum; ++i) {
+        shards_.emplace_back(new Shard());
+        shards_.back()->maxCount = ShardCapacity(option.maxCount, shardNum, i);
+        shards_.back()->maxBytes = ShardCapacity(option.maxBytes, shardNum, i);
+        if (!option.metricPrefix.empty()) {
+            shards_.back()->metrics.reset(new CacheMetrics(
+                option.metricPrefix + "_shard_" + std::to_string(i)));
+        }
+    }
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+uint64_t ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Size() {
+    uint64_t size = 0;
+    for (auto &shard : shards_) {
+        ::curve::common::ReadLockGuard guard(shard->lock);
+        size += shard->cache.size();
+    }
+    return size;
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+void ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Put(
+    const K &key, const V &value) {
+    V eliminated;
+    Shard* shard = GetShard(key);
+    ::curve::common::WriteLockGuard guard(shard->lock);
+    PutLocked(shard, key, value, &eliminated);
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+bool ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Put(
+    const K &key, const V &value, V *eliminated) {
+    Shard* shard = GetShard(key);
+    ::curve::common::WriteLockGuard guard(shard->lock);
+    return PutLocked(shard, key, value, eliminated);
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+bool ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Get(
+    const K &key, V *value) {
+    Shard* shard = GetShard(key);
+    if (secondChance_) {
+        ::curve::common::ReadLockGuard guard(shard->lock);
+        auto iter = shard->cache.find(key);
+        if (iter == shard->cache.end()) {
+            if (cacheMetrics_ != nullptr) {
+                cacheMetrics_->OnCacheMiss();
+            }
+            if (shard->metrics != nullptr) {
+                shard->metrics->OnCacheMiss();
+            }
+            return false;
+        }
+
+        iter->second->referenced.store(true, std::memory_order_relaxed);
+        *value = iter->second->value;
+    } else {
+        ::curve::common::WriteLockGuard guard(shard->lock);
+        auto iter = shard->cache.find(key);
+        if (iter == shard->cache.end()) {
+            if (cacheMetrics_ != nullptr) {
+                cacheMetrics_->OnCacheMiss();
+            }
+            if (shard->metrics != nullptr) {
+                shard->metrics->OnCacheMiss();
+            }
+            return false;
+        }
+
+        // update the position of the target item in the list
+        shard->ll.splice(shard->ll.begin(), shard->ll, iter->second);
+        *value = iter->second->value;
+    }
+
+    if (cacheMetrics_ != nullptr) {
+        cacheMetrics_->OnCacheHit();
+    }
+    if (shard->metrics != nullptr) {
+        shard->metrics->OnCacheHit();
+    }
+    return true;
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+void ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Remove(
+    const K &key) {
+    Shard* shard = GetShard(key);
+    ::curve::common::WriteLockGuard guard(shard->lock);
+    auto iter = shard->cache.find(key);
+    if (iter != shard->cache.end()) {
+        RemoveElement(shard, iter->second);
+    }
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+std::shared_ptr<CacheMetrics>
+    ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::GetCacheMetrics()
+        const {
+    return cacheMetrics_;
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+bool ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::PutLocked(
+    Shard *shard, const K &key, const V &value, V *eliminated) {
+    auto iter = shard->cache.find(key);
+
+    // delete the old value if already exist
+    if (iter != shard->cache.end()) {
+        RemoveElement(shard, iter->second);
+    }
+
+    // put new value
+    const uint64_t bytes =
+        KeyTraits::CountBytes(key) + ValueTraits::CountBytes(value);
+    shard->ll.emplace_front(value, bytes);
+    const ItemIterator inserted = shard->ll.begin();
+    iter = shard->cache.emplace(key, inserted).first;
+    inserted->key = &iter->first;
+    OnAdd(shard, bytes);
+
+    bool hasEliminated = false;
+    while (OverCapacity(*shard) && shard->ll.size() > 1) {
+        auto oldest = std::prev(shard->ll.end());
+        // the new item is never evicted by itself
+        if (oldest == inserted ||
+            (secondChance_ &&
+             oldest->referenced.load(std::memory_order_relaxed))) {
+            oldest->referenced.store(false, std::memory_order_relaxed);
+            shard->ll.splice(shard->ll.begin(), shard->ll, oldest);
+            continue;
+        }
+
+        if (!hasEliminated) {
+            *eliminated = oldest->value;
+            hasEliminated = true;
+        }
+        RemoveElement(shard, oldest);
+    }
+
+    return hasEliminated;
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+void ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::RemoveElement(
+    Shard *shard, const ItemIterator &elem) {
+    const ItemIterator elemTmp = elem;
+    OnRemove(shard, elemTmp->bytes);
+    shard->cache.erase(*(elemTmp->key));
+    shard->ll.erase(elemTmp);
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+void ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::OnAdd(
+    Shard *shard, uint64_t bytes) {
+    shard->bytes += bytes;
+    if (cacheMetrics_ != nullptr) {
+        cacheMetrics_->UpdateAddToCacheCount();
+        cacheMetrics_->UpdateAddToCacheBytes(bytes);
+    }
+    if (shard->metrics != nullptr) {
+        shard->metrics->UpdateAddToCacheCount();
+        shard->metrics->UpdateAddToCacheBytes(bytes);
+    }
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+void ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::OnRemove(
+    Shard *shard, uint64_t bytes) {
+    shard->bytes -= bytes;
+    if (cacheMetrics_ != nullptr) {
+        cacheMetrics_->UpdateRemoveFromCacheCount();
+        cacheMetrics_->UpdateRemoveFromCacheBytes(bytes);
+    }
+    if (shard->metrics != nullptr) {
+        shard->metrics->UpdateRemoveFromCacheCount();
+        shard->metrics->UpdateRemoveFromCacheBytes(bytes);
+    }
+}
+
+
 // TimedLRUCache
 template <typename K,  typename V,
     typename KeyTraits = CacheTraits<K>,
@@ -22,6 +22,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include "src/common/bitmap.h"
 
 namespace curve {
@@ -415,5 +419,75 @@ TEST(BitmapTEST, divide_test) {
     }
 }
 
+TEST(BitmapTEST, count_test) {
+    Bitmap bitmap(200);
+    ASSERT_EQ(0, bitmap.Count());
+
+    bitmap.Set(3, 130);
+    ASSERT_EQ(128, bitmap.Count());
+    ASSERT_EQ(128, bitmap.Count(0, 199));
+    ASSERT_EQ(1, bitmap.Count(130, 199));
+    ASSERT_EQ(61, bitmap.Count(3, 63));
+    ASSERT_EQ(0, bitmap.Count(131, 1000));
+    ASSERT_EQ(0, bitmap.Count(10, 9));
+
+    bitmap.Set();
+    ASSERT_EQ(200, bitmap.Count());
+    ASSERT_EQ(200, bitmap.Count(0, 1000));
+
+    Bitmap empty(0);
+    ASSERT_EQ(0, empty.Count());
+    ASSERT_EQ(Bitmap::NO_POS, empty.NextSetBit(0));
+    ASSERT_EQ(Bitmap::NO_POS, empty.NextClearBit(0));
+}
+
+// compare with the result of testing bit by bit
+TEST(BitmapTEST, random_range_test) {
+    std::mt19937 gen(1234);
+    for (uint32_t bits : {1, 7, 63, 64, 65, 200, 1024, 4099}) {
+        Bitmap bitmap(bits);
+        std::vector<bool> expected(bits, false);
+        std::uniform_int_distribution<uint32_t> dist(0, bits + 8);
+
+        for (int round = 0; round < 200; ++round) {
+            uint32_t start = dist(gen);
+            uint32_t end = dist(gen);
+            bool set = gen() % 2;
+            if (set) {
+                bitmap.Set(start, end);
+            } else {
+                bitmap.Clear(start, end);
+            }
+            for (uint32_t i = start; i <= end && i < bits; ++i) {
+                expected[i] = set;
+            }
+
+            for (uint32_t i = 0; i < bits; ++i) {
+                ASSERT_EQ(expected[i], bitmap.Test(i));
+            }
+
+            start = dist(gen);
+            end = dist(gen);
+            uint32_t nextSet = Bitmap::NO_POS;
+            uint32_t nextClear = Bitmap::NO_POS;
+            uint32_t count = 0;
+            for (uint32_t i = start; i <= end && i < bits; ++i) {
+                if (expected[i]) {
+                    nextSet = std::min(nextSet, i);
+                    ++count;
+                } else {
+                    nextClear = std::min(nextClear, i);
+                }
+            }
+            ASSERT_EQ(nextSet, bitmap.NextSetBit(start, end));
+            ASSERT_EQ(nextClear, bitmap.NextClearBit(start, end));
+            ASSERT_EQ(count, bitmap.Count(start, end));
+
+            uint32_t all = std::count(expected.begin(), expected.end(), true);
+            ASSERT_EQ(all, bitmap.Count());
+        }
+    }
+}
+
 }  // namespace common
 }  // namespace curve
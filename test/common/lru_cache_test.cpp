@@ -23,6 +23,10 @@
 #include <gtest/gtest.h>
 #include <glog/logging.h>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "src/common/lru_cache.h"
 #include "src/common/timeutility.h"
@@ -353,7 +357,182 @@ TEST(TimedCaCheTest, test_timeout) {
     ASSERT_EQ(0, cache->Size());
 }
 
-}  // namespace common
-}  // namespace curve
+TEST(ShardedCacheTest, test_cache_with_capacity_limit) {
+    ShardedLRUCacheOption option;
+    option.shardNum = 1;
+    option.maxCount = 5;
+    auto cache = std::make_shared<ShardedLRUCache<std::string, std::string>>(
+        option, std::make_shared<CacheMetrics>("ShardedLruCache"));
 
+    for (int i = 1; i <= 6; i++) {
+        std::string eliminated;
+        bool ret =
+            cache->Put(std::to_string(i), std::to_string(i), &eliminated);
+        ASSERT_EQ(i > 5, ret);
+        if (ret) {
+            ASSERT_EQ("1", eliminated);
+        }
+    }
 
+    std::string res;
+    ASSERT_FALSE(cache->Get("1", &res));
+    ASSERT_EQ(5, cache->Size());
+    ASSERT_EQ(5, cache->GetCacheMetrics()->cacheCount.get_value());
+    ASSERT_EQ(10, cache->GetCacheMetrics()->cacheBytes.get_value());
+
+    // "3" is the least recently used one after "2" is accessed
+    ASSERT_TRUE(cache->Get("2", &res));
+    std::string eliminated;
+    ASSERT_TRUE(cache->Put("7", "7", &eliminated));
+    ASSERT_EQ("3", eliminated);
+
+    cache->Remove("2");
+    ASSERT_FALSE(cache->Get("2", &res));
+    ASSERT_EQ(4, cache->Size());
+    ASSERT_EQ(4, cache->GetCacheMetrics()->cacheCount.get_value());
+}
+
+TEST(ShardedCacheTest, test_cache_with_bytes_limit) {
+    ShardedLRUCacheOption option;
+    option.shardNum = 1;
+    option.maxBytes = 30;
+    ShardedLRUCache<std::string, std::string> cache(option);
+
+    // each item is 10 bytes
+    std::string eliminated;
+    ASSERT_FALSE(cache.Put("k1", "value001", &eliminated));
+    ASSERT_FALSE(cache.Put("k2", "value002", &eliminated));
+    ASSERT_FALSE(cache.Put("k3", "value003", &eliminated));
+    ASSERT_EQ(3, cache.Size());
+
+    // 20 bytes item evicts two items
+    ASSERT_TRUE(cache.Put("k4", "value004value0004", &eliminated));
+    ASSERT_EQ("value001", eliminated);
+    ASSERT_EQ(2, cache.Size());
+
+    std::string res;
+    ASSERT_FALSE(cache.Get("k2", &res));
+    ASSERT_TRUE(cache.Get("k3", &res));
+    ASSERT_TRUE(cache.Get("k4", &res));
+
+    // item larger than capacity is still kept
+    ASSERT_TRUE(cache.Put("k5", std::string(100, 'x'), &eliminated));
+    ASSERT_EQ(1, cache.Size());
+    ASSERT_TRUE(cache.Get("k5", &res));
+}
+
+TEST(ShardedCacheTest, test_second_chance) {
+    ShardedLRUCacheOption option;
+    option.shardNum = 1;
+    option.maxCount = 2;
+    option.secondChance = true;
+    ShardedLRUCache<std::string, std::string> cache(option);
+
+    std::string eliminated;
+    cache.Put("1", "1");
+    cache.Put("2", "2");
+
+    // "1" is referenced, so "2" is evicted
+    std::string res;
+    ASSERT_TRUE(cache.Get("1", &res));
+    ASSERT_TRUE(cache.Put("3", "3", &eliminated));
+    ASSERT_EQ("2", eliminated);
+
+    // "1" is moved to the head with its reference bit cleared when it gets
+    // the second chance
+    ASSERT_TRUE(cache.Put("4", "4", &eliminated));
+    ASSERT_EQ("3", eliminated);
+    ASSERT_TRUE(cache.Put("5", "5", &eliminated));
+    ASSERT_EQ("1", eliminated);
+    ASSERT_TRUE(cache.Get("4", &res));
+    ASSERT_TRUE(cache.Get("5", &res));
+}
+
+TEST(ShardedCacheTest, TestShardMetric) {
+    ShardedLRUCacheOption option;
+    option.shardNum = 4;
+    option.metricPrefix = "sharded_lru_cache_test";
+    auto cache = std::make_shared<ShardedLRUCache<uint64_t, uint64_t>>(
+        option, std::make_shared<CacheMetrics>("ShardedLruCacheMetric"));
+
+    for (uint64_t i = 0; i < 100; ++i) {
+        cache->Put(i, i);
+    }
+
+    uint64_t out;
+    for (uint64_t i = 0; i < 200; ++i) {
+        ASSERT_EQ(i < 100, cache->Get(i, &out));
+    }
+
+    ASSERT_EQ(100, cache->Size());
+    ASSERT_EQ(100, cache->GetCacheMetrics()->cacheCount.get_value());
+    ASSERT_EQ(100, cache->GetCacheMetrics()->cacheHit.get_value());
+    ASSERT_EQ(100, cache->GetCacheMetrics()->cacheMiss.get_value());
+
+    // keys are spread over all shards
+    int64_t total = 0;
+    for (int i = 0; i < 4; ++i) {
+        std::string count = bvar::Variable::describe_exposed(
+            "sharded_lru_cache_test_shard_" + std::to_string(i) +
+            "_cache_count");
+        ASSERT_FALSE(count.empty());
+        ASSERT_GT(std::stoll(count), 0);
+        total += std::stoll(count);
+    }
+    ASSERT_EQ(100, total);
+}
+
+TEST(ShardedCacheTest, TestMultiThread) {
+    ShardedLRUCacheOption option;
+    option.maxCount = 1000;
+    option.secondChance = true;
+    ShardedLRUCache<uint64_t, uint64_t> cache(option);
+
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < 8; ++t) {
+        threads.emplace_back([&cache, t]() {
+            for (uint64_t i = 0; i < 10000; ++i) {
+                uint64_t key = (i * 8 + t) % 4096;
+                uint64_t out;
+                if (!cache.Get(key, &out)) {
+                    cache.Put(key, key);
+                } else {
+                    ASSERT_EQ(key, out);
+                }
+                if (i % 7 == 0) {
+                    cache.Remove(key);
+                }
+            }
+        });
+    }
+
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    // capacity is split exactly among shards
+    ASSERT_LE(cache.Size(), 1000);
+}
+
+TEST(ShardedCacheTest, TestCapacityNotExceeded) {
+    // 1003 items don't divide evenly into 16 shards
+    ShardedLRUCacheOption option;
+    option.maxCount = 1003;
+    ShardedLRUCache<uint64_t, uint64_t> cache(option);
+    for (uint64_t i = 0; i < 100000; ++i) {
+        cache.Put(i, i);
+        ASSERT_LE(cache.Size(), option.maxCount);
+    }
+
+    // bytes smaller than the number of shards use fewer shards
+    ShardedLRUCacheOption bytesOption;
+    bytesOption.maxBytes = 10;
+    ShardedLRUCache<std::string, std::string> bytesCache(bytesOption);
+    for (int i = 0; i < 50; ++i) {
+        bytesCache.Put(std::string(1, 'A' + i), "");
+    }
+    ASSERT_LE(bytesCache.Size(), 10);
+}
+
+}  // namespace common
+}  // namespace curve
@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2022 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Date: 2022-11-14
+ */
+
+#include "src/common/concurrent/work_stealing_thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/common/concurrent/count_down_event.h"
+
+namespace curve {
+namespace common {
+
+namespace {
+
+int TestAdd(int a, double b, CountDownEvent* cond) {
+    double c = a + b;
+    (void)c;
+    cond->Signal();
+    return 0;
+}
+
+}  // namespace
+
+TEST(WorkStealingThreadPoolTest, StartWithInvalidArguments) {
+    {
+        WorkStealingThreadPool<> pool;
+        ASSERT_EQ(-1, pool.Start(2, 0));
+    }
+
+    {
+        WorkStealingThreadPool<> pool;
+        ASSERT_EQ(-1, pool.Start(0, 1));
+    }
+
+    {
+        WorkStealingThreadPool<> pool;
+        ASSERT_EQ(-1, pool.Start(-2, -1));
+    }
+
+    {
+        WorkStealingThreadPool<> pool;
+        ASSERT_EQ(0, pool.Start(4));
+        ASSERT_EQ(INT_MAX, pool.QueueCapacity());
+        ASSERT_EQ(4, pool.ThreadOfNums());
+        ASSERT_EQ(0, pool.QueueSize());
+        pool.Stop();
+    }
+}
+
+TEST(WorkStealingThreadPoolTest, RunTasks) {
+    const int kMaxLoop = 1000;
+    const int kProducers = 3;
+    std::atomic<int32_t> runTaskCount(0);
+    CountDownEvent cond(kProducers * kMaxLoop + 1);
+
+    WorkStealingThreadPool<> pool;
+    pool.ExposeMetric("work_stealing_thread_pool_test");
+    ASSERT_EQ(0, pool.Start(4, 15));
+
+    pool.Enqueue(TestAdd, 1, 1.234, &cond);
+
+    auto task = [&]() {
+        runTaskCount.fetch_add(1);
+        cond.Signal();
+    };
+    auto produce = [&]() {
+        for (int i = 0; i < kMaxLoop; ++i) {
+            pool.Enqueue(task);
+        }
+    };
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kProducers; ++i) {
+        producers.emplace_back(produce);
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    cond.Wait();
+    ASSERT_EQ(kProducers * kMaxLoop, runTaskCount.load());
+    ASSERT_EQ(0, pool.QueueSize());
+    pool.Stop();
+}
+
+TEST(WorkStealingThreadPoolTest, EnqueueBatch) {
+    const int kTasks = 100;
+    std::atomic<int32_t> runTaskCount(0);
+    CountDownEvent cond(kTasks);
+
+    WorkStealingThreadPool<> pool;
+    pool.SetCpuAffinity({0});
+    ASSERT_EQ(0, pool.Start(4, 8));
+
+    // batch is larger than queue capacity, it's pushed in several rounds
+    std::vector<Task> tasks;
+    for (int i = 0; i < kTasks; ++i) {
+        tasks.emplace_back([&]() {
+            runTaskCount.fetch_add(1);
+            cond.Signal();
+        });
+    }
+    pool.EnqueueBatch(std::move(tasks));
+
+    cond.Wait();
+    ASSERT_EQ(kTasks, runTaskCount.load());
+    pool.Stop();
+}
+
+TEST(WorkStealingThreadPoolTest, EnqueueBlocksWhenQueueIsFull) {
+    const int kQueueCapacity = 4;
+    std::atomic<bool> release(false);
+    std::atomic<int32_t> runTaskCount(0);
+    CountDownEvent cond(1 + kQueueCapacity + 1);
+
+    WorkStealingThreadPool<> pool;
+    ASSERT_EQ(0, pool.Start(1, kQueueCapacity));
+
+    auto task = [&]() {
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        runTaskCount.fetch_add(1);
+        cond.Signal();
+    };
+
+    // the only worker is blocked by the first task
+    pool.Enqueue(task);
+    while (pool.QueueSize() != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (int i = 0; i < kQueueCapacity; ++i) {
+        pool.Enqueue(task);
+    }
+    ASSERT_EQ(kQueueCapacity, pool.QueueSize());
+
+    std::atomic<bool> enqueued(false);
+    std::thread producer([&]() {
+        pool.Enqueue(task);
+        enqueued.store(true);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(enqueued.load());
+
+    release.store(true);
+    producer.join();
+    cond.Wait();
+    ASSERT_TRUE(enqueued.load());
+    ASSERT_EQ(kQueueCapacity + 2, runTaskCount.load());
+    pool.Stop();
+}
+
+TEST(WorkStealingThreadPoolTest, IdleWorkerStealsTasks) {
+    const int kThreadNums = 4;
+    std::atomic<bool> release(false);
+    std::atomic<int32_t> running(0);
+    CountDownEvent cond(kThreadNums);
+
+    WorkStealingThreadPool<> pool;
+    ASSERT_EQ(0, pool.Start(kThreadNums));
+
+    // tasks submitted by a worker go to its own deque, so all of them can
+    // run at the same time only if other workers steal them
+    auto task = [&]() {
+        running.fetch_add(1);
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        cond.Signal();
+    };
+    pool.Enqueue([&]() {
+        for (int i = 0; i < kThreadNums - 1; ++i) {
+            pool.Enqueue(task);
+        }
+        task();
+    });
+
+    while (running.load() != kThreadNums) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    release.store(true);
+    cond.Wait();
+    pool.Stop();
+}
+
+}  // namespace common
+}  // namespace curve